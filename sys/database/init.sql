@@ -15,7 +15,10 @@ CREATE TABLE IF NOT EXISTS `user` (
     phone VARCHAR(20),
     email VARCHAR(100),
     created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-    updated_at DATETIME DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP
+    updated_at DATETIME DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP,
+    -- 分页索引（与列表排序一致）
+    INDEX idx_user_created (created_at DESC, id DESC),
+    INDEX idx_user_role_created (role, created_at DESC, id DESC)
 ) ENGINE=InnoDB;
 
 -- ========== 教师表 ==========
@@ -44,7 +47,8 @@ CREATE TABLE IF NOT EXISTS student (
     phone VARCHAR(20),
     email VARCHAR(100),
     created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
-    FOREIGN KEY (user_id) REFERENCES `user`(id) ON DELETE SET NULL
+    FOREIGN KEY (user_id) REFERENCES `user`(id) ON DELETE SET NULL,
+    INDEX idx_student_class_code (class_name, student_code)
 ) ENGINE=InnoDB;
 
 -- ========== 教室基本信息 ==========
@@ -106,7 +110,9 @@ CREATE TABLE IF NOT EXISTS class_info (
     class_name VARCHAR(100) NOT NULL COMMENT '班级名称',
     major VARCHAR(100) COMMENT '专业',
     grade INT COMMENT '年级',
+    department VARCHAR(100) COMMENT '所属院系',
     student_count INT DEFAULT 0 COMMENT '学生人数',
+    remark TEXT,
     created_at DATETIME DEFAULT CURRENT_TIMESTAMP
 ) ENGINE=InnoDB;
 
@@ -133,7 +139,10 @@ CREATE TABLE IF NOT EXISTS schedule (
     FOREIGN KEY (class_id) REFERENCES class_info(id) ON DELETE SET NULL,
     INDEX idx_schedule_time (semester, weekday, start_section, end_section),
     INDEX idx_schedule_classroom (classroom_id, semester),
-    INDEX idx_schedule_teacher (teacher_id, semester)
+    INDEX idx_schedule_teacher (teacher_id, semester),
+    -- 分页索引（与列表排序一致）
+    INDEX idx_schedule_page (weekday, start_section, id),
+    INDEX idx_schedule_semester_page (semester, weekday, start_section, id)
 ) ENGINE=InnoDB;
 
 -- ========== 学生选课 ==========
@@ -147,7 +156,11 @@ CREATE TABLE IF NOT EXISTS enrollment (
     created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
     FOREIGN KEY (student_id) REFERENCES student(id) ON DELETE CASCADE,
     FOREIGN KEY (course_id) REFERENCES course(id) ON DELETE CASCADE,
-    UNIQUE KEY uk_enrollment (student_id, course_id, semester)
+    UNIQUE KEY uk_enrollment (student_id, course_id, semester),
+    -- 分页索引（与列表排序一致）
+    INDEX idx_enrollment_created (created_at DESC, id DESC),
+    INDEX idx_enrollment_student_created (student_id, created_at DESC, id DESC),
+    INDEX idx_enrollment_course_created (course_id, created_at DESC, id DESC)
 ) ENGINE=InnoDB;
 
 -- ========== 教室预约/临时占用 ==========
@@ -166,7 +179,11 @@ CREATE TABLE IF NOT EXISTS booking (
     created_at DATETIME DEFAULT CURRENT_TIMESTAMP,
     FOREIGN KEY (classroom_id) REFERENCES classroom(id) ON DELETE CASCADE,
     FOREIGN KEY (applicant_id) REFERENCES `user`(id) ON DELETE CASCADE,
-    FOREIGN KEY (approver_id) REFERENCES `user`(id) ON DELETE SET NULL
+    FOREIGN KEY (approver_id) REFERENCES `user`(id) ON DELETE SET NULL,
+    -- 分页索引（与列表排序一致）
+    INDEX idx_booking_page (booking_date DESC, start_section, id),
+    INDEX idx_booking_status_page (status, booking_date DESC, start_section, id),
+    INDEX idx_booking_classroom_page (classroom_id, booking_date DESC, start_section, id)
 ) ENGINE=InnoDB;
 
 -- ========== 操作日志 ==========
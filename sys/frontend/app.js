@@ -119,6 +119,12 @@ async function api(endpoint, options = {}, retryCount = 0) {
         ...options
     };
     
+    // 携带登录会话
+    const token = localStorage.getItem('token');
+    if (token) {
+        config.headers['Authorization'] = 'Bearer ' + token;
+    }
+    
     // 添加超时控制
     const controller = new AbortController();
     const timeoutId = setTimeout(() => controller.abort(), 30000); // 30秒超时
@@ -166,6 +172,129 @@ async function apiWithLoading(endpoint, options = {}, loadingMsg = '加载中...
     }
 }
 
+// ========== 变更推送 ==========
+// 登录后通过 SSE 订阅数据变更，当前页面相关的主题有变化时重新加载，不需要手动刷新或轮询
+let changeStream = null;
+let changeReloadTimer = null;
+
+// 各页面依赖的数据主题
+const PAGE_TOPICS = {
+    dashboard: ['classroom', 'course', 'schedule', 'notice'],
+    classrooms: ['classroom', 'equipment'],
+    courses: ['course'],
+    schedules: ['schedule', 'course', 'classroom'],
+    timetable: ['schedule', 'enrollment'],
+    available: ['schedule', 'booking', 'classroom'],
+    equipment: ['equipment'],
+    classes: ['class'],
+    bookings: ['booking'],
+    enrollment: ['enrollment', 'course'],
+    notices: ['notice'],
+    statistics: ['schedule', 'classroom'],
+    users: ['user']
+};
+
+function reloadCurrentPage() {
+    const page = document.querySelector('.nav-item.active')?.dataset.page || 'dashboard';
+    switch (page) {
+        case 'dashboard': initDashboard(); break;
+        case 'classrooms': loadClassrooms(); break;
+        case 'courses': loadCourses(); break;
+        case 'schedules': loadSchedules(); break;
+        case 'equipment': loadEquipments(); break;
+        case 'classes': loadClasses(); break;
+        case 'bookings': loadBookings(); break;
+        case 'enrollment': loadEnrollment(); break;
+        case 'notices': loadNotices(); break;
+        case 'statistics': loadStatistics(); break;
+        case 'users': loadUsers(); break;
+        // 课表、空闲教室是按条件查询的结果，不自动重新查询
+    }
+}
+
+function onDataChanged(topic) {
+    const page = document.querySelector('.nav-item.active')?.dataset.page || 'dashboard';
+    if (!(PAGE_TOPICS[page] || []).includes(topic)) return;
+    // 批量操作会连续产生多条事件，合并成一次刷新
+    clearTimeout(changeReloadTimer);
+    changeReloadTimer = setTimeout(reloadCurrentPage, 300);
+}
+
+function connectChangeStream() {
+    closeChangeStream();
+    const token = localStorage.getItem('token');
+    if (!token || typeof EventSource === 'undefined') return;
+    changeStream = new EventSource(`${API_BASE}/events?token=${encodeURIComponent(token)}`);
+    for (const topic of ['classroom', 'equipment', 'course', 'schedule', 'class', 'notice', 'booking', 'enrollment', 'user']) {
+        changeStream.addEventListener(topic, () => onDataChanged(topic));
+    }
+    // 断线后浏览器自动重连；会话失效（401）时不再重连
+    changeStream.onerror = () => {
+        if (changeStream && changeStream.readyState === EventSource.CLOSED) changeStream = null;
+    };
+}
+
+function closeChangeStream() {
+    if (changeStream) {
+        changeStream.close();
+        changeStream = null;
+    }
+    clearTimeout(changeReloadTimer);
+}
+
+// 教室占用看板：WebSocket 订阅 room-status 的二进制增量，原地更新教室和预约的状态标签，
+// 不必等整页重新加载
+let roomStatusSocket = null;
+let roomStatusRetry = 0;
+let roomStatusTimer = null;
+const ROOM_STATUS = { 0: 'available', 1: 'maintenance', 2: 'disabled' };
+const BOOKING_STATE = { 0: 'pending', 1: 'approved', 2: 'rejected', 3: 'cancelled' };
+
+function applyRoomStatus(buffer) {
+    const view = new DataView(buffer);
+    if (view.byteLength === 6 && view.getUint8(0) === 1) {
+        // [1][u32 教室id][u8 状态]
+        const status = ROOM_STATUS[view.getUint8(5)];
+        const cell = document.querySelector(`tr[data-room-id="${view.getUint32(1)}"] .room-status`);
+        if (cell && status) cell.innerHTML = getStatusBadge(status);
+    } else if (view.byteLength === 16 && view.getUint8(0) === 2) {
+        // [2][u32 教室id][u32 预约id][u8 状态][u32 日期][u8 起始节][u8 结束节]
+        const state = BOOKING_STATE[view.getUint8(9)];
+        const cell = document.querySelector(`tr[data-booking-id="${view.getUint32(5)}"] .booking-status`);
+        if (cell && state) cell.innerHTML = getBookingStatusBadge(state);
+    }
+}
+
+function connectRoomStatus() {
+    closeRoomStatus();
+    const token = localStorage.getItem('token');
+    if (!token || typeof WebSocket === 'undefined') return;
+    const scheme = location.protocol === 'https:' ? 'wss' : 'ws';
+    const socket = new WebSocket(`${scheme}://${location.host}${API_BASE}/ws?topics=room-status&format=binary&token=${encodeURIComponent(token)}`);
+    socket.binaryType = 'arraybuffer';
+    socket.onopen = () => { roomStatusRetry = 0; };
+    socket.onmessage = (event) => {
+        if (event.data instanceof ArrayBuffer) applyRoomStatus(event.data);
+    };
+    // 断线后退避重连（最长 30 秒）；主动关闭时 roomStatusSocket 已置空
+    socket.onclose = () => {
+        if (roomStatusSocket !== socket) return;
+        roomStatusSocket = null;
+        const delay = Math.min(30000, 1000 * 2 ** roomStatusRetry++);
+        roomStatusTimer = setTimeout(connectRoomStatus, delay);
+    };
+    roomStatusSocket = socket;
+}
+
+function closeRoomStatus() {
+    clearTimeout(roomStatusTimer);
+    if (roomStatusSocket) {
+        const socket = roomStatusSocket;
+        roomStatusSocket = null;
+        socket.close();
+    }
+}
+
 function showAlert(message, type = 'success') {
     // 创建容器（如果不存在）
     let container = document.getElementById('alertContainer');
@@ -573,6 +702,8 @@ document.getElementById('loginForm').addEventListener('submit', async (e) => {
         currentUser = result.user;
         localStorage.setItem('token', result.token);
         localStorage.setItem('user', JSON.stringify(result.user));
+        connectChangeStream();
+        connectRoomStatus();
         
         // 登录成功动画
         submitBtn.innerHTML = '<i class="bi bi-check-circle me-2"></i>登录成功!';
@@ -664,6 +795,11 @@ function logout() {
     mainContainer.style.opacity = '0';
     mainContainer.style.transform = 'scale(0.98)';
     
+    closeChangeStream();
+    closeRoomStatus();
+    // 通知服务器注销会话（失败不影响本地退出）
+    api('/logout', { method: 'POST' }).catch(() => {});
+    
     setTimeout(() => {
         localStorage.removeItem('token');
         localStorage.removeItem('user');
@@ -1023,13 +1159,13 @@ async function loadClassrooms() {
             html = '<tr><td colspan="7" class="text-center py-5"><div class="empty-state"><i class="bi bi-door-open"></i><p>暂无教室数据</p></div></td></tr>';
         } else {
             classrooms.forEach((c, index) => {
-                html += `<tr class="table-row-animate" style="animation-delay: ${index * 0.05}s">
+                html += `<tr class="table-row-animate" style="animation-delay: ${index * 0.05}s" data-room-id="${c.id}">
                     <td><span class="fw-medium">${c.classroom_code}</span></td>
                     <td>${c.name}</td>
                     <td>${c.building || '<span class="text-muted">-</span>'}</td>
                     <td>${getCategoryName(c.category)}</td>
                     <td><span class="badge bg-secondary">${c.seats}座</span></td>
-                    <td>${getStatusBadge(c.status)}</td>
+                    <td class="room-status">${getStatusBadge(c.status)}</td>
                     <td>
                         <div class="action-buttons">
                             <button class="btn-action btn-action-view" data-tooltip="查看详情" onclick="viewClassroomDetail(${c.id})">
@@ -2460,6 +2596,8 @@ document.addEventListener('DOMContentLoaded', () => {
         // 根据角色更新UI
         updateUIByRole();
         
+        connectChangeStream();
+        connectRoomStatus();
         initDashboard();
     }
 });
@@ -2484,13 +2622,13 @@ async function loadBookings() {
         } else {
             paginatedData.forEach((b, index) => {
                 const statusBadge = getBookingStatusBadge(b.status);
-                html += `<tr class="table-row-animate" style="animation-delay: ${index * 0.05}s">
+                html += `<tr class="table-row-animate" style="animation-delay: ${index * 0.05}s" data-booking-id="${b.id}">
                     <td><span class="fw-medium">${b.classroom_name}</span></td>
                     <td>${b.applicant_name}</td>
                     <td><i class="bi bi-calendar3 me-1"></i>${b.booking_date}</td>
                     <td><i class="bi bi-clock me-1"></i>第${b.start_section}-${b.end_section}节</td>
                     <td>${b.purpose || '<span class="text-muted">-</span>'}</td>
-                    <td>${statusBadge}</td>
+                    <td class="booking-status">${statusBadge}</td>
                     <td>
                         <div class="action-buttons">
                             ${b.status === 'pending' && currentUser.role === 'admin' ? `
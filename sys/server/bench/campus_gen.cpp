@@ -0,0 +1,577 @@
+// 校园数据生成器：按规模生成一致的测试数据，用于扩展性测试和压测
+// 生成的数据在 init.sql、more_data.sql 之后加载（通知表由 more_data.sql 创建）：
+//
+//   ./campus_gen --scale 10 --output campus.sql                 # 多行 INSERT
+//   mysql classroom_system < campus.sql
+//   DB_BACKEND=sqlite DB_SCRIPTS=../../database/init.sql,../../database/more_data.sql,campus.sql ./classroom_server
+//
+//   ./campus_gen --scale 50 --semesters 4 --format tsv --output campus_data   # 约 100 万条选课
+//   cd campus_data && mysql --local-infile=1 classroom_system < load.sql       # LOAD DATA，仅 MySQL
+//
+// 参数（--scale 按比例放大默认值，单项参数优先）:
+//   --buildings 4  --rooms 20（每栋）  --teachers 50  --classes 20  --class-size 40
+//   --required 3（每班每学期必修课数）  --electives 20（每学期选修课数）
+//   --per-student 6（每名学生每学期课程数，必修之外按热度选修）  --skew 1.0（选修热度的 Zipf 指数）
+//   --semesters 2  --semester 2024-2025-1（第一个学期，之后依次递推，最后一个为当前学期）
+//   --bookings 20（每间教室每学期预约数）  --notices 25（每学期通知数）
+//   --format sql|tsv  --output campus.sql（tsv 时为目录）  --batch 1000（每条 INSERT 的行数）
+//   --id-offset 100000（生成数据的 id 从 offset+1 开始，避免与示例数据冲突）  --seed 42
+//
+// 排课在每个学期内无冲突（教室、教师、班级），学生选修课时也避开自己已有的课。
+// 用户名为 gt1..gtN（教师）和 gs1..gsN（学生），密码均为 123456
+#include "password_hasher.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include <sys/stat.h>
+
+namespace {
+
+struct Config {
+    int scale = 1;
+    int buildings = -1;
+    int rooms = 20;
+    int teachers = -1;
+    int classes = -1;
+    int classSize = 40;
+    int required = 3;
+    int electives = -1;
+    int perStudent = 6;
+    double skew = 1.0;
+    int semesters = 2;
+    std::string semester = "2024-2025-1";
+    int bookings = 20;
+    int notices = 25;
+    std::string format = "sql";
+    std::string output;
+    int batch = 1000;
+    long long idOffset = 100000;
+    unsigned seed = 42;
+};
+
+// 批量写出：sql 格式为多行 INSERT，tsv 格式为每表一个文件加 load.sql（LOAD DATA LOCAL INFILE）
+class BulkWriter {
+public:
+    BulkWriter(bool tsv, const std::string& output, int batch) : tsv_(tsv), output_(output), batch_(batch) {}
+
+    bool open() {
+        if (tsv_) {
+            mkdir(output_.c_str(), 0755);
+            script_.open(output_ + "/load.sql");
+        } else {
+            script_.open(output_);
+        }
+        if (!script_) return false;
+        script_ << "SET FOREIGN_KEY_CHECKS = 0;\nSET UNIQUE_CHECKS = 0;\nSTART TRANSACTION;\n";
+        return true;
+    }
+
+    // 同一张表可以多次 begin，tsv 格式下追加到同一个文件
+    void begin(const std::string& table, const std::string& columns) {
+        finish();
+        table_ = table;
+        columns_ = columns;
+        if (tsv_) {
+            auto& file = files_[table];
+            if (!file) {
+                std::string name = table;
+                name.erase(std::remove(name.begin(), name.end(), '`'), name.end());
+                file = std::make_unique<std::ofstream>(output_ + "/" + name + ".tsv", std::ios::binary);
+                loads_.push_back("LOAD DATA LOCAL INFILE '" + name + ".tsv' INTO TABLE " + table +
+                                 " CHARACTER SET utf8mb4 FIELDS TERMINATED BY '\\t' LINES TERMINATED BY '\\n' (" +
+                                 columns + ");\n");
+            }
+            current_ = file.get();
+        } else {
+            current_ = &script_;
+        }
+    }
+
+    BulkWriter& num(long long value) {
+        separator();
+        buf_ += std::to_string(value);
+        return *this;
+    }
+
+    // 已格式化的数值（如 DECIMAL），原样写出
+    BulkWriter& raw(const char* value) {
+        separator();
+        buf_ += value;
+        return *this;
+    }
+
+    BulkWriter& str(const std::string& value) {
+        separator();
+        if (!tsv_) buf_ += '\'';
+        for (char c : value) {
+            if (tsv_ ? (c == '\t' || c == '\n' || c == '\\') : (c == '\'' || c == '\\')) buf_ += '\\';
+            buf_ += c;
+        }
+        if (!tsv_) buf_ += '\'';
+        return *this;
+    }
+
+    BulkWriter& null() {
+        separator();
+        buf_ += tsv_ ? "\\N" : "NULL";
+        return *this;
+    }
+
+    void end() {
+        buf_ += tsv_ ? "\n" : ")";
+        fields_ = 0;
+        rows_++;
+        if (!tsv_ && ++pending_ == batch_) {
+            buf_ += ";\n";
+            pending_ = 0;
+        }
+        if (buf_.size() >= (1 << 20)) flush();
+    }
+
+    void finish() {
+        if (pending_ > 0) buf_ += ";\n";
+        pending_ = 0;
+        flush();
+    }
+
+    void close() {
+        finish();
+        for (const auto& load : loads_) script_ << load;
+        script_ << "COMMIT;\nSET UNIQUE_CHECKS = 1;\nSET FOREIGN_KEY_CHECKS = 1;\n";
+        files_.clear();
+        script_.close();
+    }
+
+    long long rows() const { return rows_; }
+
+private:
+    void separator() {
+        if (fields_++ > 0) {
+            buf_ += tsv_ ? "\t" : ", ";
+        } else if (!tsv_) {
+            buf_ += pending_ == 0 ? "INSERT INTO " + table_ + " (" + columns_ + ") VALUES\n(" : ",\n(";
+        }
+    }
+
+    void flush() {
+        if (current_ && !buf_.empty()) current_->write(buf_.data(), static_cast<std::streamsize>(buf_.size()));
+        buf_.clear();
+    }
+
+    bool tsv_;
+    std::string output_;
+    int batch_;
+    std::ofstream script_;
+    std::map<std::string, std::unique_ptr<std::ofstream>> files_;
+    std::vector<std::string> loads_;
+    std::ofstream* current_ = nullptr;
+    std::string table_;
+    std::string columns_;
+    std::string buf_;
+    int fields_ = 0;
+    int pending_ = 0;
+    long long rows_ = 0;
+};
+
+using Days = std::chrono::sys_days;
+
+std::string formatDate(Days day) {
+    std::chrono::year_month_day ymd{day};
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%04d-%02u-%02u", static_cast<int>(ymd.year()),
+             static_cast<unsigned>(ymd.month()), static_cast<unsigned>(ymd.day()));
+    return buf;
+}
+
+// 第一周的周一：秋季学期 9 月 1 日、春季学期 2 月 20 日之后的第一个周一
+Days semesterStart(int year, int term) {
+    using namespace std::chrono;
+    Days day = term == 1 ? Days{std::chrono::year{year} / September / 1}
+                         : Days{std::chrono::year{year + 1} / February / 20};
+    while (weekday{day} != Monday) day += days{1};
+    return day;
+}
+
+struct Semester {
+    std::string name;
+    Days start;
+};
+
+// 从 "2024-2025-1" 开始依次递推：2024-2025-2、2025-2026-1 ...
+std::vector<Semester> semesterSequence(const std::string& first, int count) {
+    int year = std::atoi(first.c_str());
+    int term = first.empty() || first.back() != '2' ? 1 : 2;
+    std::vector<Semester> result;
+    for (int i = 0; i < count; i++) {
+        result.push_back({std::to_string(year) + "-" + std::to_string(year + 1) + "-" + std::to_string(term),
+                          semesterStart(year, term)});
+        if (++term > 2) {
+            term = 1;
+            year++;
+        }
+    }
+    return result;
+}
+
+// 按 1/rank^s 的热度抽样
+class ZipfSampler {
+public:
+    ZipfSampler(int n, double s) : cdf_(n) {
+        double sum = 0;
+        for (int i = 0; i < n; i++) {
+            sum += 1.0 / std::pow(i + 1, s);
+            cdf_[i] = sum;
+        }
+        for (double& v : cdf_) v /= sum;
+    }
+
+    int sample(std::mt19937_64& rng) const {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return static_cast<int>(std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin());
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+const char* kSurnames[] = {"王", "李", "张", "刘", "陈", "杨", "赵", "黄", "周", "吴", "徐", "孙", "胡", "朱", "高", "林"};
+const char* kGiven[] = {"伟", "芳", "娜", "敏", "静", "强", "磊", "洋", "艳", "勇", "军", "杰", "涛", "明", "超", "婷"};
+const char* kDepartments[] = {"计算机学院", "软件学院", "数学学院", "物理学院", "外语学院", "经济学院"};
+const char* kMajors[] = {"计算机科学与技术", "软件工程", "应用数学", "应用物理", "英语", "经济学"};
+const char* kTitles[] = {"教授", "副教授", "讲师", "助教"};
+const char* kRequiredNames[] = {"程序设计", "数据结构", "操作系统", "计算机网络", "数据库原理", "高等数学",
+                                "线性代数", "大学物理", "大学英语", "概率论", "编译原理", "离散数学"};
+const char* kElectiveNames[] = {"人工智能导论", "机器学习", "音乐鉴赏", "电影艺术", "心理学", "创业基础",
+                                "摄影", "日语入门", "区块链技术", "艺术史", "围棋", "数据可视化"};
+const char* kCategories[] = {"large", "medium", "medium", "small", "small", "ladder", "lab", "meeting"};
+const int kSeats[] = {120, 80, 60, 45, 30, 200, 60, 30};
+const char* kPurposes[] = {"班会", "社团活动", "学术讲座", "考研辅导", "小组讨论", "期中答疑"};
+const char* kNoticeTypes[] = {"system", "academic", "activity"};
+const char* kNoticeTitles[] = {"选课通知", "教室调整", "考试安排", "讲座预告", "系统维护", "假期安排"};
+const char* kBookingStatus[] = {"approved", "approved", "approved", "approved", "approved", "approved",
+                                "pending", "pending", "rejected", "cancelled"};
+
+template <size_t N>
+const char* pick(const char* (&values)[N], std::mt19937_64& rng) {
+    return values[rng() % N];
+}
+
+std::string randomName(std::mt19937_64& rng) {
+    return std::string(pick(kSurnames, rng)) + pick(kGiven, rng);
+}
+
+constexpr int kDays = 5;                  // 排课：周一至周五
+constexpr int kBlocks = 5;                // 每天 5 个两节段（1-2 ... 9-10）
+constexpr int kSlots = kDays * kBlocks;   // 每周 25 个时段，用 32 位掩码表示
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--scale") cfg.scale = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--buildings") cfg.buildings = std::atoi(value.c_str());
+        else if (arg == "--rooms") cfg.rooms = std::atoi(value.c_str());
+        else if (arg == "--teachers") cfg.teachers = std::atoi(value.c_str());
+        else if (arg == "--classes") cfg.classes = std::atoi(value.c_str());
+        else if (arg == "--class-size") cfg.classSize = std::atoi(value.c_str());
+        else if (arg == "--required") cfg.required = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--electives") cfg.electives = std::atoi(value.c_str());
+        else if (arg == "--per-student") cfg.perStudent = std::atoi(value.c_str());
+        else if (arg == "--skew") cfg.skew = std::atof(value.c_str());
+        else if (arg == "--semesters") cfg.semesters = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--semester") cfg.semester = value;
+        else if (arg == "--bookings") cfg.bookings = std::atoi(value.c_str());
+        else if (arg == "--notices") cfg.notices = std::atoi(value.c_str());
+        else if (arg == "--format") cfg.format = value;
+        else if (arg == "--output") cfg.output = value;
+        else if (arg == "--batch") cfg.batch = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--id-offset") cfg.idOffset = std::atoll(value.c_str());
+        else if (arg == "--seed") cfg.seed = static_cast<unsigned>(std::atoi(value.c_str()));
+        else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (cfg.format != "sql" && cfg.format != "tsv") {
+        std::cerr << "--format 只支持 sql 或 tsv" << std::endl;
+        return 1;
+    }
+    if (cfg.buildings < 0) cfg.buildings = 4 * cfg.scale;
+    if (cfg.teachers < 0) cfg.teachers = 50 * cfg.scale;
+    if (cfg.classes < 0) cfg.classes = 20 * cfg.scale;
+    if (cfg.electives < 0) cfg.electives = 20 * cfg.scale;
+    if (cfg.output.empty()) cfg.output = cfg.format == "tsv" ? "campus_data" : "campus.sql";
+    if (cfg.buildings <= 0 || cfg.rooms <= 0 || cfg.teachers <= 0 || cfg.classes <= 0 || cfg.classSize <= 0) {
+        std::cerr << "教室、教师、班级数量必须大于 0" << std::endl;
+        return 1;
+    }
+
+    BulkWriter w(cfg.format == "tsv", cfg.output, cfg.batch);
+    if (!w.open()) {
+        std::cerr << "无法写入 " << cfg.output << std::endl;
+        return 1;
+    }
+    auto started = std::chrono::steady_clock::now();
+    std::mt19937_64 rng(cfg.seed);
+    const long long base = cfg.idOffset + 1;
+    const std::string passwordHash = PasswordHasher::hash("123456");
+    const std::vector<Semester> semesters = semesterSequence(cfg.semester, cfg.semesters);
+
+    // ========== 教室 ==========
+    const int roomCount = cfg.buildings * cfg.rooms;
+    std::vector<int> roomSeats(roomCount);
+    int maxSeats = 0;
+    w.begin("classroom", "id, classroom_code, name, building, floor, location, category, seats, orientation, status");
+    for (int b = 0; b < cfg.buildings; b++) {
+        std::string building = "G" + std::to_string(b + 1) + "楼";
+        for (int r = 0; r < cfg.rooms; r++) {
+            int index = b * cfg.rooms + r;
+            int floor = r / 10 + 1;
+            int category = static_cast<int>(rng() % 8);
+            roomSeats[index] = kSeats[category];
+            maxSeats = std::max(maxSeats, roomSeats[index]);
+            std::string roomCode = "G" + std::to_string(b + 1) + "-" + std::to_string(floor * 100 + r % 10 + 1);
+            w.num(base + index).str(roomCode).str(building + roomCode).str(building).num(floor)
+             .str(building + std::to_string(floor) + "层").str(kCategories[category]).num(roomSeats[index])
+             .str("南").str("available").end();
+        }
+    }
+
+    // ========== 教师、学生账号 ==========
+    const long long studentCount = static_cast<long long>(cfg.classes) * cfg.classSize;
+    const long long teacherUserBase = base;
+    const long long studentUserBase = base + cfg.teachers;
+    w.begin("`user`", "id, username, password_hash, role, real_name");
+    for (int t = 0; t < cfg.teachers; t++) {
+        w.num(teacherUserBase + t).str("gt" + std::to_string(t + 1)).str(passwordHash).str("teacher")
+         .str(randomName(rng)).end();
+    }
+    for (long long s = 0; s < studentCount; s++) {
+        w.num(studentUserBase + s).str("gs" + std::to_string(s + 1)).str(passwordHash).str("student")
+         .str(randomName(rng)).end();
+    }
+
+    w.begin("teacher", "id, user_id, teacher_code, name, department, title");
+    for (int t = 0; t < cfg.teachers; t++) {
+        w.num(base + t).num(teacherUserBase + t).str("GT" + std::to_string(t + 1)).str(randomName(rng))
+         .str(kDepartments[t % 6]).str(pick(kTitles, rng)).end();
+    }
+
+    // ========== 班级、学生 ==========
+    std::vector<std::string> classNames(cfg.classes);
+    w.begin("class_info", "id, class_code, class_name, major, grade, department, student_count");
+    for (int c = 0; c < cfg.classes; c++) {
+        int grade = 2021 + c % 4;
+        classNames[c] = std::string(kMajors[c % 6]) + std::to_string(grade) + "级" + std::to_string(c / 24 + 1) + "班";
+        w.num(base + c).str("GC" + std::to_string(c + 1)).str(classNames[c]).str(kMajors[c % 6]).num(grade)
+         .str(kDepartments[c % 6]).num(cfg.classSize).end();
+    }
+
+    w.begin("student", "id, user_id, student_code, name, major, class_name, grade");
+    for (long long s = 0; s < studentCount; s++) {
+        int c = static_cast<int>(s / cfg.classSize);
+        w.num(base + s).num(studentUserBase + s).str("G" + std::to_string(s + 1)).str(randomName(rng))
+         .str(kMajors[c % 6]).str(classNames[c]).num(2021 + c % 4).end();
+    }
+
+    // ========== 每学期的课程、排课、选课 ==========
+    // 必修课属于一个班级，选修课全校可选；每门课每周两次，每次 2 节，持续 16 周
+    const int requiredCount = cfg.classes * cfg.required;
+    const int coursesPerSemester = requiredCount + cfg.electives;
+    const int electivesPerStudent = std::max(0, cfg.perStudent - cfg.required);
+    // 选修容量约为平均需求的 1.3 倍，热门课程会被选满
+    const int electiveCapacity = cfg.electives == 0 ? 0 : std::max(1, std::min(maxSeats,
+        static_cast<int>(std::ceil(1.3 * studentCount * electivesPerStudent / cfg.electives))));
+
+    long long courseId = base;
+    long long scheduleId = base;
+    long long enrollmentId = base;
+    long long unplaced = 0;
+    long long electiveShortfall = 0;
+    long long currentFirstCourse = base;
+    std::vector<std::vector<uint32_t>> roomBusyBySemester;
+
+    ZipfSampler zipf(std::max(1, cfg.electives), cfg.skew);
+    std::normal_distribution<double> gradeDist(80, 8);
+
+    for (size_t si = 0; si < semesters.size(); si++) {
+        const Semester& sem = semesters[si];
+        const bool current = si + 1 == semesters.size();
+        std::vector<uint32_t> roomBusy(roomCount, 0);
+        std::vector<uint32_t> teacherBusy(cfg.teachers, 0);
+        std::vector<uint32_t> classBusy(cfg.classes, 0);
+        std::vector<uint32_t> courseSlots(coursesPerSemester, 0);
+        std::vector<int> courseTeacher(coursesPerSemester);
+        const long long firstCourse = courseId;
+        currentFirstCourse = firstCourse;
+
+        w.begin("course", "id, course_code, name, teacher_id, credits, hours, course_type, capacity, semester");
+        for (int k = 0; k < coursesPerSemester; k++) {
+            bool elective = k >= requiredCount;
+            courseTeacher[k] = static_cast<int>((si * 7 + k) % cfg.teachers);
+            w.num(courseId++).str("GK" + std::to_string(si + 1) + "-" + std::to_string(k + 1))
+             .str(elective ? pick(kElectiveNames, rng) : pick(kRequiredNames, rng))
+             .num(base + courseTeacher[k]).raw(elective ? "2.0" : "3.0").num(elective ? 32 : 48)
+             .str(elective ? "elective" : "required").num(elective ? electiveCapacity : cfg.classSize)
+             .str(sem.name).end();
+        }
+
+        w.begin("schedule", "id, course_id, classroom_id, teacher_id, class_id, semester, weekday, start_section, "
+                            "end_section, start_week, end_week, week_type");
+        for (int k = 0; k < coursesPerSemester; k++) {
+            bool elective = k >= requiredCount;
+            int classIndex = elective ? -1 : k / cfg.required;
+            int teacher = courseTeacher[k];
+            int seatsNeeded = std::min(elective ? electiveCapacity : cfg.classSize, maxSeats);
+            for (int lesson = 0; lesson < 2; lesson++) {
+                bool placed = false;
+                int startSlot = static_cast<int>(rng() % kSlots);
+                for (int attempt = 0; attempt < kSlots && !placed; attempt++) {
+                    int slot = (startSlot + attempt) % kSlots;
+                    uint32_t bit = 1u << slot;
+                    if ((courseSlots[k] | teacherBusy[teacher]) & bit) continue;
+                    if (classIndex >= 0 && (classBusy[classIndex] & bit)) continue;
+                    int roomStart = static_cast<int>(rng() % roomCount);
+                    for (int r = 0; r < roomCount; r++) {
+                        int room = (roomStart + r) % roomCount;
+                        if ((roomBusy[room] & bit) || roomSeats[room] < seatsNeeded) continue;
+                        roomBusy[room] |= bit;
+                        teacherBusy[teacher] |= bit;
+                        courseSlots[k] |= bit;
+                        if (classIndex >= 0) classBusy[classIndex] |= bit;
+                        int section = (slot % kBlocks) * 2 + 1;
+                        w.num(scheduleId++).num(firstCourse + k).num(base + room).num(base + teacher);
+                        if (classIndex >= 0) w.num(base + classIndex); else w.null();
+                        w.str(sem.name).num(slot / kBlocks + 1).num(section).num(section + 1).num(1).num(16)
+                         .str("all").end();
+                        placed = true;
+                        break;
+                    }
+                }
+                if (!placed) unplaced++;
+            }
+        }
+        roomBusyBySemester.push_back(roomBusy);
+
+        // 选课：本班必修全部选上，其余按热度（打乱后的 Zipf 排名）选修，
+        // 跳过已满、没排上课和与已选课程时间冲突的选修课（已选的课程必然冲突，不会重复）
+        std::vector<int> popularity(cfg.electives);
+        for (int e = 0; e < cfg.electives; e++) popularity[e] = e;
+        std::shuffle(popularity.begin(), popularity.end(), rng);
+        std::vector<int> seatsTaken(cfg.electives, 0);
+
+        w.begin("enrollment", "id, student_id, course_id, semester, status, grade");
+        auto enroll = [&](long long student, int k) {
+            w.num(enrollmentId++).num(base + student).num(firstCourse + k).str(sem.name);
+            if (current) {
+                w.str(rng() % 100 < 3 ? "dropped" : "enrolled").null();
+            } else {
+                char grade[16];
+                snprintf(grade, sizeof(grade), "%.1f", std::clamp(gradeDist(rng), 40.0, 100.0));
+                w.str("completed").raw(grade);
+            }
+            w.end();
+        };
+        for (long long s = 0; s < studentCount; s++) {
+            int classIndex = static_cast<int>(s / cfg.classSize);
+            uint32_t busy = classBusy[classIndex];
+            for (int j = 0; j < cfg.required; j++) enroll(s, classIndex * cfg.required + j);
+
+            for (int n = 0; n < electivesPerStudent && cfg.electives > 0; n++) {
+                int rank = zipf.sample(rng);
+                bool found = false;
+                for (int probe = 0; probe < cfg.electives; probe++) {
+                    int e = popularity[(rank + probe) % cfg.electives];
+                    uint32_t slots = courseSlots[requiredCount + e];
+                    if (seatsTaken[e] >= electiveCapacity || slots == 0 || (slots & busy)) continue;
+                    seatsTaken[e]++;
+                    busy |= slots;
+                    enroll(s, requiredCount + e);
+                    found = true;
+                    break;
+                }
+                if (!found) {
+                    electiveShortfall += electivesPerStudent - n;
+                    break;
+                }
+            }
+        }
+    }
+
+    // ========== 教室预约：每学期每间教室若干次，避开排课和已有预约 ==========
+    long long bookingId = base;
+    w.begin("booking", "id, classroom_id, applicant_id, booking_date, start_section, end_section, purpose, "
+                       "status, approver_id, approved_at, created_at");
+    std::unordered_set<uint64_t> booked;
+    for (size_t si = 0; si < semesters.size(); si++) {
+        for (int room = 0; room < roomCount; room++) {
+            for (int b = 0; b < cfg.bookings; b++) {
+                for (int attempt = 0; attempt < 20; attempt++) {
+                    int day = static_cast<int>(rng() % (16 * 7));
+                    int weekday = day % 7;
+                    int block = static_cast<int>(rng() % 6);          // 第 11-12 节只用于预约
+                    if (weekday < kDays && block < kBlocks &&
+                        (roomBusyBySemester[si][room] >> (weekday * kBlocks + block) & 1)) continue;
+                    uint64_t key = (static_cast<uint64_t>(si) << 48) | (static_cast<uint64_t>(room) << 16) |
+                                   static_cast<uint64_t>(day * 8 + block);
+                    if (!booked.insert(key).second) continue;
+
+                    Days date = semesters[si].start + std::chrono::days{day};
+                    std::string created = formatDate(date - std::chrono::days{1 + rng() % 14}) + " 10:00:00";
+                    std::string status = pick(kBookingStatus, rng);
+                    long long applicant = base + static_cast<long long>(rng() % (cfg.teachers + studentCount));
+                    w.num(bookingId++).num(base + room).num(applicant).str(formatDate(date))
+                     .num(block * 2 + 1).num(block * 2 + 2).str(pick(kPurposes, rng)).str(status);
+                    if (status == "approved" || status == "rejected") w.num(1).str(created); else w.null().null();
+                    w.str(created).end();
+                    break;
+                }
+            }
+        }
+    }
+
+    // ========== 通知（表由 more_data.sql 创建），作者为管理员或教师 ==========
+    long long noticeId = base;
+    w.begin("notice", "id, title, content, author_id, notice_type, is_top, publish_time, expire_time, status, view_count");
+    for (size_t si = 0; si < semesters.size(); si++) {
+        bool current = si + 1 == semesters.size();
+        for (int n = 0; n < cfg.notices; n++) {
+            Days date = semesters[si].start + std::chrono::days{static_cast<int>(rng() % (16 * 7))};
+            std::string title = semesters[si].name + " " + pick(kNoticeTitles, rng);
+            long long author = rng() % 4 == 0 ? 1 : teacherUserBase + static_cast<long long>(rng() % cfg.teachers);
+            w.num(noticeId++).str(title).str(title + "，请相关师生留意。").num(author)
+             .str(pick(kNoticeTypes, rng)).num(rng() % 20 == 0 ? 1 : 0)
+             .str(formatDate(date) + " 08:00:00").str(formatDate(date + std::chrono::days{30}) + " 23:59:59")
+             .str(current ? "published" : "expired").num(static_cast<long long>(1000 / (1 + rng() % 1000))).end();
+        }
+    }
+
+    w.close();
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    std::cout << "学期 " << semesters.size() << "（" << semesters.front().name << " ~ " << semesters.back().name << "）"
+              << "，教室 " << roomCount << "，教师 " << cfg.teachers << "，班级 " << cfg.classes
+              << "，学生 " << studentCount << "\n"
+              << "课程 " << (courseId - base) << "，排课 " << (scheduleId - base) << "（未能安排 " << unplaced << " 次）"
+              << "，选课 " << (enrollmentId - base) << "（选修缺额 " << electiveShortfall << "）"
+              << "，预约 " << (bookingId - base) << "，通知 " << (noticeId - base) << "\n"
+              << "共 " << w.rows() << " 行，写入 " << cfg.output << "，耗时 " << seconds << " 秒\n"
+              << "压测参数（当前学期）: --id-base " << cfg.idOffset << " --user-prefix gs --users " << studentCount
+              << " --students " << studentCount << " --classrooms " << roomCount
+              << " --course-base " << (currentFirstCourse - 1) << " --courses " << coursesPerSemester
+              << " --semester " << semesters.back().name << std::endl;
+    return 0;
+}
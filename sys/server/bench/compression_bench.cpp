@@ -0,0 +1,117 @@
+// 响应压缩的CPU开销与节省的字节
+// 输入取自 sys/database 下建库脚本的数据（按倍数复制），按列表接口的方式序列化为 JSON，
+// 分别取 20 / 200 / 2000 行作为一页，对各压缩级别测量压缩率、每个响应的压缩耗时和吞吐，
+// 以及每毫秒CPU省下的字节数；同时对比每个响应新建 z_stream 与线程内复用的差别
+//
+// 用法: compression_bench [--sql-dir=../database] [--scale=20] [--rounds=200]
+#include "compression.hpp"
+#include "json.hpp"
+#include "db.hpp"
+#include "sql_fixture.hpp"
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+DbResult toDbResult(const SqlTable& table, size_t rows) {
+    DbResult result;
+    rows = std::min(rows, table.rows.size());
+    result.reserve(rows);
+    for (size_t r = 0; r < rows; r++) {
+        DbRow dbRow;
+        for (size_t i = 0; i < table.columns.size(); i++) {
+            dbRow[table.columns[i]] = table.rows[r][i];
+        }
+        result.push_back(std::move(dbRow));
+    }
+    return result;
+}
+
+// 每个响应的平均压缩耗时（微秒）
+double timeCompress(const std::string& body, int level, int rounds, size_t& compressedSize) {
+    auto& compressor = ResponseCompressor::local();
+    std::string out;
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; i++) {
+        compressor.compress(ContentCoding::Gzip, level, body, out);
+    }
+    compressedSize = out.size();
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+}
+
+// 每次新建并释放 z_stream（不复用）时的平均耗时（微秒）
+double timeFresh(const std::string& body, int level, int rounds) {
+    std::string out(compressBound(body.size()) + 32, '\0');
+    auto start = Clock::now();
+    for (int i = 0; i < rounds; i++) {
+        z_stream zs{};
+        deflateInit2(&zs, level, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(body.data()));
+        zs.avail_in = static_cast<uInt>(body.size());
+        zs.next_out = reinterpret_cast<Bytef*>(out.data());
+        zs.avail_out = static_cast<uInt>(out.size());
+        deflate(&zs, Z_FINISH);
+        deflateEnd(&zs);
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / rounds;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    std::string sqlDir = "../database";
+    int scale = 20;
+    int rounds = 200;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--sql-dir=", 0) == 0) sqlDir = arg.substr(10);
+        else if (arg.rfind("--scale=", 0) == 0) scale = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.rfind("--rounds=", 0) == 0) rounds = std::max(1, std::atoi(arg.c_str() + 9));
+    }
+
+    SqlFixture fixture;
+    if (fixture.load(sqlDir + "/init.sql") == 0) {
+        std::cerr << "找不到 init.sql，请用 --sql-dir 指定 sys/database 目录" << std::endl;
+        return 1;
+    }
+    fixture.load(sqlDir + "/more_data.sql");
+    auto tables = fixture.scaled(scale);
+
+    std::cout << std::fixed;
+    std::cout << std::left << std::setw(24) << "响应" << std::right << std::setw(10) << "原始(B)"
+              << std::setw(7) << "级别" << std::setw(10) << "压缩(B)" << std::setw(8) << "比例"
+              << std::setw(11) << "耗时(us)" << std::setw(10) << "MB/s" << std::setw(14) << "省B/CPU-ms"
+              << std::setw(12) << "新建(us)" << "\n";
+    for (const char* name : {"schedule", "user", "enrollment", "course", "classroom"}) {
+        auto it = tables.find(name);
+        if (it == tables.end() || it->second.rows.empty()) continue;
+        for (size_t rows : {20, 200, 2000}) {
+            if (rows > it->second.rows.size()) continue;
+            std::string body = Json::fromDbResult(toDbResult(it->second, rows));
+            std::string label = std::string(name) + " x" + std::to_string(rows);
+            // 大响应少跑几轮
+            int n = std::max(5, static_cast<int>(rounds * 20000 / std::max<size_t>(body.size(), 20000)));
+            for (int level : {1, 3, 6, 9}) {
+                size_t compressed = 0;
+                double us = timeCompress(body, level, n, compressed);
+                double fresh = timeFresh(body, level, n);
+                double saved = static_cast<double>(body.size() - compressed);
+                std::cout << std::left << std::setw(22) << label << std::right
+                          << std::setw(10) << body.size() << std::setw(5) << level
+                          << std::setw(10) << compressed
+                          << std::setw(7) << std::setprecision(1) << 100.0 * compressed / body.size() << "%"
+                          << std::setw(10) << std::setprecision(1) << us
+                          << std::setw(10) << std::setprecision(0) << body.size() / us
+                          << std::setw(12) << std::setprecision(0) << saved / (us / 1000.0)
+                          << std::setw(12) << std::setprecision(1) << fresh << "\n";
+            }
+        }
+    }
+    return 0;
+}
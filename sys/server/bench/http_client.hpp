@@ -0,0 +1,83 @@
+#ifndef BENCH_HTTP_CLIENT_HPP
+#define BENCH_HTTP_CLIENT_HPP
+
+// 性能测试用的最小阻塞HTTP客户端（每个请求一个连接，与服务器的短连接模式一致）
+#include <string>
+#include <map>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+struct BenchResponse {
+    int status = 0;
+    std::map<std::string, std::string> headers;
+    std::string body;
+};
+
+inline bool benchRequest(const std::string& host, int port, const std::string& method,
+                         const std::string& target, const std::string& body, BenchResponse& out,
+                         const std::string& extraHeaders = "") {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, host.c_str(), &addr.sin_addr);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return false;
+    }
+
+    std::string request = method + " " + target + " HTTP/1.1\r\n"
+        "Host: " + host + "\r\n"
+        "Content-Type: application/json\r\n"
+        "Content-Length: " + std::to_string(body.size()) + "\r\n"
+        "Connection: close\r\n" + extraHeaders + "\r\n" + body;
+
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, 0);
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        sent += n;
+    }
+
+    std::string raw;
+    char buffer[16384];
+    ssize_t n;
+    while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        raw.append(buffer, n);
+    }
+    close(fd);
+
+    size_t headerEnd = raw.find("\r\n\r\n");
+    if (headerEnd == std::string::npos || raw.compare(0, 5, "HTTP/") != 0) return false;
+
+    size_t sp = raw.find(' ');
+    out.status = std::atoi(raw.c_str() + sp + 1);
+    out.headers.clear();
+    size_t pos = raw.find("\r\n") + 2;
+    while (pos < headerEnd) {
+        size_t eol = raw.find("\r\n", pos);
+        size_t colon = raw.find(':', pos);
+        if (colon != std::string::npos && colon < eol) {
+            std::string value = raw.substr(colon + 1, eol - colon - 1);
+            value.erase(0, value.find_first_not_of(' '));
+            out.headers[raw.substr(pos, colon - pos)] = value;
+        }
+        pos = eol + 2;
+    }
+    out.body = raw.substr(headerEnd + 4);
+    return true;
+}
+
+#endif // BENCH_HTTP_CLIENT_HPP
@@ -0,0 +1,69 @@
+#ifndef BENCH_LATENCY_HISTOGRAM_HPP
+#define BENCH_LATENCY_HISTOGRAM_HPP
+
+// HDR风格的延迟直方图（微秒）：每个二次幂区间分64段，相对误差约1.6%，范围到约 2^42 微秒
+// 计数为原子变量，多个压测线程可以直接并发记录
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+class LatencyHistogram {
+public:
+    static constexpr int kSubBits = 6;
+    static constexpr int kSub = 1 << kSubBits;                     // 64
+    static constexpr int kMaxExponent = 42;
+    static constexpr int kBuckets = (kMaxExponent - kSubBits + 2) * kSub;
+
+    void record(uint64_t micros) {
+        buckets_[indexOf(micros)].fetch_add(1, std::memory_order_relaxed);
+        count_.fetch_add(1, std::memory_order_relaxed);
+        sum_.fetch_add(micros, std::memory_order_relaxed);
+        uint64_t max = max_.load(std::memory_order_relaxed);
+        while (micros > max && !max_.compare_exchange_weak(max, micros, std::memory_order_relaxed)) {}
+    }
+
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t max() const { return max_.load(std::memory_order_relaxed); }
+    double mean() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(sum_.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    // 返回第 p 百分位（0~100）所在区间的上界
+    uint64_t percentile(double p) const {
+        uint64_t n = count();
+        if (n == 0) return 0;
+        uint64_t target = static_cast<uint64_t>(p / 100.0 * static_cast<double>(n) + 0.5);
+        target = std::clamp<uint64_t>(target, 1, n);
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; i++) {
+            seen += buckets_[i].load(std::memory_order_relaxed);
+            if (seen >= target) return std::min(upperBound(i), max());
+        }
+        return max();
+    }
+
+private:
+    static int indexOf(uint64_t v) {
+        if (v < 2 * kSub) return static_cast<int>(v);
+        int exponent = 63 - __builtin_clzll(v);                    // >= 7
+        int shift = exponent - kSubBits;
+        int index = (shift + 1) * kSub + static_cast<int>((v >> shift) - kSub);
+        return std::min(index, kBuckets - 1);
+    }
+
+    static uint64_t upperBound(int index) {
+        if (index < 2 * kSub) return static_cast<uint64_t>(index);
+        int shift = index / kSub - 1;
+        uint64_t mantissa = static_cast<uint64_t>(index % kSub + kSub);
+        return ((mantissa + 1) << shift) - 1;
+    }
+
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+    std::atomic<uint64_t> max_{0};
+};
+
+#endif // BENCH_LATENCY_HISTOGRAM_HPP
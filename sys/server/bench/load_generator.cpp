@@ -0,0 +1,422 @@
+// 服务器压测工具
+// 按固定到达率（开环）发送混合请求：登录风暴、学生课表、空闲教室查询、抢课、教室预约。
+// 第 i 个请求的计划发送时间固定为 start + i / rate，延迟从计划时间开始计算，
+// 压测线程被拖慢时排队时间也计入延迟，避免 coordinated omission 低估尾延迟。
+// 结果输出为表格和JSON文件，便于在不同提交之间对比。
+// 压测前后各抓取一次服务器的 /metrics，输出网络IO模式（threads/epoll/io_uring）和平均每个请求的系统调用次数。
+//
+// 注意：抢课和预约会真实写入数据库，请对测试库运行。
+//
+// 用法: load_generator [选项]
+//   --host 127.0.0.1  --port 8080
+//   --rate 200            每秒请求数（所有场景合计）
+//   --duration 30         持续秒数（不含预热）
+//   --warmup 3            预热秒数，期间的请求不计入结果
+//   --workers 256         并发连接线程数上限
+//   --mix login=5,timetable=50,available=25,enroll=10,booking=10
+//   --users 10 --user-prefix student --password 123456
+//   --students 10 --courses 18 --classrooms 20 --semester 2024-2025-1
+//   --hot-courses 3       抢课集中的热门课程数
+//   --id-base 0 --course-base <id-base>   学生/教室 id 为 id-base+1..，课程 id 为 course-base+1..
+//                         （对 campus_gen 生成的数据压测时使用，campus_gen 会打印对应参数）
+//   --seed 1              场景和参数的随机种子（相同种子得到相同的请求序列）
+//   --label <名称>         写入结果文件，例如提交号
+//   --output results.json
+#include "http_client.hpp"
+#include "latency_histogram.hpp"
+#include "json.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <ctime>
+#include <cstdlib>
+#include <functional>
+#include <array>
+#include <algorithm>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Config {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    double rate = 200;
+    int duration = 30;
+    int warmup = 3;
+    int workers = 256;
+    std::string mix = "login=5,timetable=50,available=25,enroll=10,booking=10";
+    int users = 10;
+    std::string userPrefix = "student";
+    std::string password = "123456";
+    int students = 10;
+    int courses = 18;
+    int classrooms = 20;
+    int hotCourses = 3;
+    long long idBase = 0;
+    long long courseBase = -1;
+    std::string semester = "2024-2025-1";
+    uint64_t seed = 1;
+    std::string label;
+    std::string output = "results.json";
+};
+
+struct Request {
+    std::string method;
+    std::string target;
+    std::string body;
+};
+
+// 单个场景的统计
+struct Scenario {
+    std::string name;
+    int weight = 0;
+    std::function<Request(std::mt19937_64&)> build;
+
+    LatencyHistogram latency;       // 从计划发送时间算起
+    LatencyHistogram service;       // 从实际发送时间算起
+    std::atomic<uint64_t> errors{0};
+    std::array<std::atomic<uint64_t>, 6> status{};     // 0=连接失败, 1..5 = 1xx..5xx
+};
+
+std::string token;      // 预先登录获得，供非登录场景携带
+
+void buildScenarios(const Config& cfg, std::vector<std::unique_ptr<Scenario>>& scenarios) {
+    auto add = [&](const std::string& name, std::function<Request(std::mt19937_64&)> build) {
+        auto s = std::make_unique<Scenario>();
+        s->name = name;
+        s->build = std::move(build);
+        scenarios.push_back(std::move(s));
+    };
+    auto uniform = [](std::mt19937_64& rng, int lo, int hi) {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    };
+
+    add("login", [=](std::mt19937_64& rng) {
+        std::string user = cfg.userPrefix + std::to_string(uniform(rng, 1, cfg.users));
+        return Request{"POST", "/api/login",
+                       "{\"username\": \"" + user + "\", \"password\": \"" + cfg.password + "\"}"};
+    });
+
+    add("timetable", [=](std::mt19937_64& rng) {
+        return Request{"GET", "/api/students/" + std::to_string(cfg.idBase + uniform(rng, 1, cfg.students)) +
+                       "/timetable?semester=" + cfg.semester, ""};
+    });
+
+    add("available", [=](std::mt19937_64& rng) {
+        int start = uniform(rng, 1, 11);
+        std::string target = "/api/available-classrooms?semester=" + cfg.semester +
+            "&weekday=" + std::to_string(uniform(rng, 1, 5)) +
+            "&start_section=" + std::to_string(start) +
+            "&end_section=" + std::to_string(std::min(12, start + 1)) +
+            "&week=" + std::to_string(uniform(rng, 1, 16));
+        return Request{"GET", target, ""};
+    });
+
+    // 抢课：大部分请求集中在少数热门课程上
+    add("enroll", [=](std::mt19937_64& rng) {
+        int course = uniform(rng, 1, 10) <= 8 ? uniform(rng, 1, std::max(1, cfg.hotCourses))
+                                             : uniform(rng, 1, cfg.courses);
+        course += cfg.courseBase;
+        return Request{"POST", "/api/enrollments",
+                       "{\"student_id\": " + std::to_string(cfg.idBase + uniform(rng, 1, cfg.students)) +
+                       ", \"course_id\": " + std::to_string(course) +
+                       ", \"semester\": \"" + cfg.semester + "\"}"};
+    });
+
+    add("booking", [=](std::mt19937_64& rng) {
+        std::time_t day = std::time(nullptr) + uniform(rng, 1, 30) * 86400;
+        char date[16];
+        std::strftime(date, sizeof(date), "%Y-%m-%d", std::localtime(&day));
+        int start = uniform(rng, 1, 11);
+        return Request{"POST", "/api/bookings",
+                       "{\"classroom_id\": " + std::to_string(cfg.idBase + uniform(rng, 1, cfg.classrooms)) +
+                       ", \"applicant_id\": 1, \"booking_date\": \"" + date +
+                       "\", \"start_section\": " + std::to_string(start) +
+                       ", \"end_section\": " + std::to_string(start + 1) +
+                       ", \"purpose\": \"压测\"}"};
+    });
+}
+
+bool parseMix(const std::string& mix, std::vector<std::unique_ptr<Scenario>>& scenarios) {
+    std::istringstream iss(mix);
+    std::string item;
+    while (std::getline(iss, item, ',')) {
+        size_t eq = item.find('=');
+        std::string name = item.substr(0, eq);
+        int weight = eq == std::string::npos ? 1 : std::atoi(item.c_str() + eq + 1);
+        bool found = false;
+        for (auto& s : scenarios) {
+            if (s->name == name) {
+                s->weight = weight;
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "未知场景: " << name << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// /metrics 中与网络IO相关的计数
+struct ServerIo {
+    bool ok = false;
+    std::string backend;
+    double requests = 0;                        // http_requests_total 合计
+    std::map<std::string, double> syscalls;     // server_io_syscalls_total，按 call 标签
+};
+
+ServerIo scrapeServerIo(const Config& cfg) {
+    ServerIo io;
+    BenchResponse res;
+    if (!benchRequest(cfg.host, cfg.port, "GET", "/metrics", "", res) || res.status != 200) return io;
+    io.ok = true;
+
+    auto label = [](const std::string& line, const std::string& name) {
+        size_t pos = line.find(name + "=\"");
+        if (pos == std::string::npos) return std::string();
+        pos += name.size() + 2;
+        return line.substr(pos, line.find('"', pos) - pos);
+    };
+    std::istringstream iss(res.body);
+    std::string line;
+    while (std::getline(iss, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        double value = std::atof(line.c_str() + line.rfind(' ') + 1);
+        if (line.compare(0, 20, "http_requests_total{") == 0) {
+            io.requests += value;
+        } else if (line.compare(0, 25, "server_io_syscalls_total{") == 0) {
+            io.syscalls[label(line, "call")] += value;
+        } else if (line.compare(0, 18, "server_io_backend{") == 0) {
+            io.backend = label(line, "backend");
+        }
+    }
+    return io;
+}
+
+std::string latencyJson(const LatencyHistogram& h) {
+    auto ms = [](uint64_t us) { return Json::number(us / 1000.0); };
+    std::map<std::string, std::string> data;
+    data["p50"] = ms(h.percentile(50));
+    data["p90"] = ms(h.percentile(90));
+    data["p99"] = ms(h.percentile(99));
+    data["p999"] = ms(h.percentile(99.9));
+    data["max"] = ms(h.max());
+    data["mean"] = Json::number(h.mean() / 1000.0);
+    return Json::object(data);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--host") cfg.host = value;
+        else if (arg == "--port") cfg.port = std::atoi(value.c_str());
+        else if (arg == "--rate") cfg.rate = std::atof(value.c_str());
+        else if (arg == "--duration") cfg.duration = std::atoi(value.c_str());
+        else if (arg == "--warmup") cfg.warmup = std::atoi(value.c_str());
+        else if (arg == "--workers") cfg.workers = std::atoi(value.c_str());
+        else if (arg == "--mix") cfg.mix = value;
+        else if (arg == "--users") cfg.users = std::atoi(value.c_str());
+        else if (arg == "--user-prefix") cfg.userPrefix = value;
+        else if (arg == "--password") cfg.password = value;
+        else if (arg == "--students") cfg.students = std::atoi(value.c_str());
+        else if (arg == "--courses") cfg.courses = std::atoi(value.c_str());
+        else if (arg == "--classrooms") cfg.classrooms = std::atoi(value.c_str());
+        else if (arg == "--hot-courses") cfg.hotCourses = std::atoi(value.c_str());
+        else if (arg == "--id-base") cfg.idBase = std::atoll(value.c_str());
+        else if (arg == "--course-base") cfg.courseBase = std::atoll(value.c_str());
+        else if (arg == "--semester") cfg.semester = value;
+        else if (arg == "--seed") cfg.seed = std::strtoull(value.c_str(), nullptr, 10);
+        else if (arg == "--label") cfg.label = value;
+        else if (arg == "--output") cfg.output = value;
+        else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return 1;
+        }
+    }
+    if (cfg.rate <= 0 || cfg.duration <= 0 || cfg.workers <= 0) {
+        std::cerr << "rate/duration/workers 必须大于0" << std::endl;
+        return 1;
+    }
+    if (cfg.courseBase < 0) cfg.courseBase = cfg.idBase;
+
+    std::vector<std::unique_ptr<Scenario>> scenarios;
+    buildScenarios(cfg, scenarios);
+    if (!parseMix(cfg.mix, scenarios)) return 1;
+
+    // 预先登录一次，其余场景以该用户身份访问
+    BenchResponse loginRes;
+    std::string loginBody = "{\"username\": \"" + cfg.userPrefix + "1\", \"password\": \"" + cfg.password + "\"}";
+    if (!benchRequest(cfg.host, cfg.port, "POST", "/api/login", loginBody, loginRes)) {
+        std::cerr << "无法连接服务器 " << cfg.host << ":" << cfg.port << std::endl;
+        return 1;
+    }
+    token = Json::parse(loginRes.body)["token"];
+    ServerIo ioBefore = scrapeServerIo(cfg);
+
+    // 按权重预先生成场景序列，相同种子得到相同的请求顺序
+    long total = static_cast<long>(cfg.rate * (cfg.duration + cfg.warmup));
+    long warmupCount = static_cast<long>(cfg.rate * cfg.warmup);
+    std::vector<int> weights;
+    for (auto& s : scenarios) weights.push_back(s->weight);
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+    std::mt19937_64 planRng(cfg.seed);
+    std::vector<uint8_t> plan(total);
+    for (auto& p : plan) p = static_cast<uint8_t>(pick(planRng));
+
+    std::cout << "压测: " << cfg.host << ":" << cfg.port << "  " << cfg.rate << " 请求/秒 x " << cfg.duration
+              << " 秒（预热 " << cfg.warmup << " 秒），最多 " << cfg.workers << " 个并发连接" << std::endl;
+
+    auto interval = std::chrono::duration<double>(1.0 / cfg.rate);
+    std::atomic<long> next{0};
+    std::atomic<long> lateStarts{0};
+    auto start = Clock::now() + std::chrono::milliseconds(100);
+    auto measureStart = start + std::chrono::duration_cast<Clock::duration>(interval * warmupCount);
+
+    std::vector<std::thread> workers;
+    for (int w = 0; w < cfg.workers; w++) {
+        workers.emplace_back([&, w] {
+            std::mt19937_64 rng(cfg.seed * 7919 + w);
+            std::string auth = token.empty() ? "" : "Authorization: Bearer " + token + "\r\n";
+            while (true) {
+                long i = next.fetch_add(1);
+                if (i >= total) break;
+                auto intended = start + std::chrono::duration_cast<Clock::duration>(interval * i);
+                std::this_thread::sleep_until(intended);
+
+                Scenario& scenario = *scenarios[plan[i]];
+                Request request = scenario.build(rng);
+                auto sent = Clock::now();
+                if (sent - intended > std::chrono::milliseconds(1)) lateStarts++;
+
+                BenchResponse res;
+                bool ok = benchRequest(cfg.host, cfg.port, request.method, request.target, request.body, res,
+                                       scenario.name == "login" ? "" : auth);
+                auto done = Clock::now();
+                if (i < warmupCount) continue;
+
+                auto us = [](Clock::duration d) {
+                    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(d).count());
+                };
+                scenario.latency.record(us(done - intended));
+                scenario.service.record(us(done - sent));
+                int cls = ok ? std::clamp(res.status / 100, 1, 5) : 0;
+                scenario.status[cls]++;
+                if (!ok || cls == 5) scenario.errors++;
+            }
+        });
+    }
+    for (auto& t : workers) t.join();
+    double elapsed = std::chrono::duration<double>(Clock::now() - measureStart).count();
+    ServerIo ioAfter = scrapeServerIo(cfg);
+
+    // ===== 输出 =====
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << std::left << std::setw(11) << "场景" << std::right
+              << std::setw(8) << "请求" << std::setw(8) << "错误" << std::setw(10) << "req/s"
+              << std::setw(10) << "p50" << std::setw(10) << "p90" << std::setw(10) << "p99"
+              << std::setw(10) << "p99.9" << std::setw(10) << "max" << "  (ms)" << std::endl;
+
+    std::vector<std::string> scenarioJson;
+    uint64_t completed = 0, errors = 0;
+    for (auto& s : scenarios) {
+        uint64_t n = s->latency.count();
+        if (n == 0) continue;
+        completed += n;
+        errors += s->errors;
+        std::cout << std::left << std::setw(11) << s->name << std::right
+                  << std::setw(8) << n << std::setw(8) << s->errors.load()
+                  << std::setw(10) << n / elapsed
+                  << std::setw(10) << s->latency.percentile(50) / 1000.0
+                  << std::setw(10) << s->latency.percentile(90) / 1000.0
+                  << std::setw(10) << s->latency.percentile(99) / 1000.0
+                  << std::setw(10) << s->latency.percentile(99.9) / 1000.0
+                  << std::setw(10) << s->latency.max() / 1000.0 << std::endl;
+
+        static const char* classes[] = {"failed", "1xx", "2xx", "3xx", "4xx", "5xx"};
+        std::map<std::string, std::string> status;
+        for (int c = 0; c < 6; c++) {
+            if (s->status[c]) status[classes[c]] = std::to_string(s->status[c].load());
+        }
+        std::map<std::string, std::string> data;
+        data["name"] = Json::string(s->name);
+        data["requests"] = std::to_string(n);
+        data["errors"] = std::to_string(s->errors.load());
+        data["throughput"] = Json::number(n / elapsed);
+        data["status"] = Json::object(status);
+        data["latency_ms"] = latencyJson(s->latency);
+        data["service_ms"] = latencyJson(s->service);
+        scenarioJson.push_back(Json::object(data));
+    }
+    std::cout << "合计 " << completed << " 个请求, 错误 " << errors << ", 吞吐 " << completed / elapsed
+              << " req/s, 计划外延迟发送 " << lateStarts.load() << " 次" << std::endl;
+    if (lateStarts > total / 100) {
+        std::cout << "提示: 超过1%的请求未能按计划发出，压测端可能成为瓶颈，可增大 --workers" << std::endl;
+    }
+
+    // 系统调用按压测期间（含预热）服务器处理的请求数平均，其他客户端的请求也会计入
+    std::map<std::string, std::string> serverIo;
+    double served = ioAfter.requests - ioBefore.requests;
+    if (ioBefore.ok && ioAfter.ok && served > 0) {
+        std::map<std::string, std::string> perCall;
+        double totalCalls = 0;
+        std::cout << "服务器IO: " << ioAfter.backend << "，每请求系统调用 ";
+        std::ostringstream detail;
+        detail << std::fixed << std::setprecision(2);
+        for (const auto& [call, count] : ioAfter.syscalls) {
+            double delta = count - (ioBefore.syscalls.count(call) ? ioBefore.syscalls.at(call) : 0);
+            if (delta <= 0) continue;
+            totalCalls += delta;
+            perCall[call] = Json::number(delta / served);
+            detail << (perCall.size() > 1 ? ", " : "") << call << " " << delta / served;
+        }
+        std::cout << totalCalls / served << "（" << detail.str() << "）" << std::endl;
+        serverIo["backend"] = Json::string(ioAfter.backend);
+        serverIo["syscalls_per_request"] = Json::number(totalCalls / served);
+        serverIo["syscalls"] = Json::object(perCall);
+    }
+
+    char timestamp[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::map<std::string, std::string> config;
+    config["host"] = Json::string(cfg.host);
+    config["port"] = Json::number(cfg.port);
+    config["rate"] = Json::number(cfg.rate);
+    config["duration"] = Json::number(cfg.duration);
+    config["warmup"] = Json::number(cfg.warmup);
+    config["workers"] = Json::number(cfg.workers);
+    config["mix"] = Json::string(cfg.mix);
+    config["seed"] = std::to_string(cfg.seed);
+
+    std::map<std::string, std::string> result;
+    result["label"] = Json::string(cfg.label);
+    result["timestamp"] = Json::string(timestamp);
+    result["config"] = Json::object(config);
+    result["requests"] = std::to_string(completed);
+    result["errors"] = std::to_string(errors);
+    result["late_starts"] = std::to_string(lateStarts.load());
+    result["throughput"] = Json::number(completed / elapsed);
+    result["scenarios"] = Json::array(scenarioJson);
+    if (!serverIo.empty()) result["server_io"] = Json::object(serverIo);
+
+    std::ofstream out(cfg.output);
+    out << Json::object(result) << std::endl;
+    std::cout << "结果已保存: " << cfg.output << std::endl;
+    return errors > 0 ? 2 : 0;
+}
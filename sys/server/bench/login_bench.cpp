@@ -0,0 +1,128 @@
+// 登录路径基准测试
+// 模拟 8:00 上课前的登录高峰：大量客户端同时登录，KDF迭代次数固定
+// 分两轮：冷启动（每个用户首次登录，全部走KDF）与重复登录（命中校验缓存）
+//
+// 用法: login_bench [--users N] [--clients N] [--iterations N] [--kdf-threads N] [--queue N]
+#include "auth_service.hpp"
+#include "password_hasher.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <string>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+
+struct RoundResult {
+    std::vector<double> latenciesUs;
+    size_t ok = 0;
+    size_t busy = 0;
+    size_t invalid = 0;
+    double seconds = 0;
+};
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t idx = static_cast<size_t>(p / 100.0 * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+static RoundResult runRound(int users, int clients) {
+    RoundResult result;
+    std::vector<std::vector<double>> perClient(clients);
+    std::atomic<int> next{0};
+    std::atomic<size_t> ok{0}, busy{0}, invalid{0};
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            while (true) {
+                int i = next.fetch_add(1);
+                if (i >= users) break;
+                auto t0 = Clock::now();
+                auto r = runSync(AuthService::getInstance().authenticate("stu" + std::to_string(i), "123456")).result;
+                auto t1 = Clock::now();
+                perClient[c].push_back(std::chrono::duration<double, std::micro>(t1 - t0).count());
+                if (r == AuthService::Result::Ok) ok++;
+                else if (r == AuthService::Result::Busy) busy++;
+                else invalid++;
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    for (auto& v : perClient) {
+        result.latenciesUs.insert(result.latenciesUs.end(), v.begin(), v.end());
+    }
+    result.ok = ok;
+    result.busy = busy;
+    result.invalid = invalid;
+    return result;
+}
+
+static void report(const std::string& name, RoundResult& r) {
+    double total = static_cast<double>(r.ok + r.busy + r.invalid);
+    std::cout << std::fixed << std::setprecision(3)
+              << name << ": " << total / r.seconds << " logins/s"
+              << "  ok=" << r.ok << " busy=" << r.busy << " invalid=" << r.invalid
+              << "  p50=" << percentile(r.latenciesUs, 50) / 1000 << "ms"
+              << "  p99=" << percentile(r.latenciesUs, 99) / 1000 << "ms"
+              << "  max=" << percentile(r.latenciesUs, 100) / 1000 << "ms" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int users = 2000;
+    int clients = 64;
+    int iterations = PasswordHasher::kDefaultIterations;
+    int kdfThreads = std::max(2u, std::thread::hardware_concurrency() / 2);
+    int queue = 256;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (arg == "--users") users = value;
+        else if (arg == "--clients") clients = value;
+        else if (arg == "--iterations") iterations = value;
+        else if (arg == "--kdf-threads") kdfThreads = value;
+        else if (arg == "--queue") queue = value;
+    }
+
+    // 预先生成少量哈希供所有用户轮流使用（盐不同不影响KDF开销）
+    const int distinctHashes = 16;
+    std::vector<std::string> hashes;
+    for (int i = 0; i < distinctHashes; i++) {
+        hashes.push_back(PasswordHasher::hash("123456", iterations));
+    }
+
+    auto& auth = AuthService::getInstance();
+    auth.setIterations(iterations);
+    auth.setUserLoader([&hashes](const std::string& username, AuthUser& user) {
+        if (username.compare(0, 3, "stu") != 0) return false;
+        user.id = std::stoi(username.substr(3)) + 1;
+        user.username = username;
+        user.role = "student";
+        user.realName = username;
+        user.passwordHash = hashes[user.id % hashes.size()];
+        return true;
+    });
+    auth.start(kdfThreads, queue);
+
+    std::cout << "users=" << users << " clients=" << clients << " iterations=" << iterations
+              << " kdf-threads=" << kdfThreads << " queue=" << queue << std::endl;
+
+    auto cold = runRound(users, clients);
+    report("冷启动(KDF)", cold);
+
+    auto warm = runRound(users, clients);
+    report("重复登录(缓存)", warm);
+
+    auth.stop();
+    return 0;
+}
@@ -0,0 +1,85 @@
+// 游标分页基准测试
+// 沿 X-Next-Cursor 连续翻页，记录每一页的响应时间，验证第1页到第1000页延迟基本不变
+// 需要先启动服务器并导入足够的数据（例如生成的大规模选课数据）
+//
+// 用法: pagination_bench [--host 127.0.0.1] [--port 8080] [--path /api/enrollments]
+//                        [--limit 50] [--pages 1000] [--fields id,student_id,course_id]
+#include "http_client.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+
+int main(int argc, char* argv[]) {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    std::string path = "/api/enrollments";
+    int limit = 50;
+    int pages = 1000;
+    std::string fields;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        std::string value = argv[i + 1];
+        if (arg == "--host") host = value;
+        else if (arg == "--port") port = std::atoi(value.c_str());
+        else if (arg == "--path") path = value;
+        else if (arg == "--limit") limit = std::atoi(value.c_str());
+        else if (arg == "--pages") pages = std::atoi(value.c_str());
+        else if (arg == "--fields") fields = value;
+    }
+
+    std::string base = path + "?limit=" + std::to_string(limit);
+    if (!fields.empty()) base += "&fields=" + fields;
+
+    std::vector<double> latencies;
+    std::string cursor;
+    size_t bytes = 0;
+
+    for (int page = 1; page <= pages; page++) {
+        std::string target = base + (cursor.empty() ? "" : "&cursor=" + cursor);
+        BenchResponse res;
+        auto t0 = Clock::now();
+        if (!benchRequest(host, port, "GET", target, "", res)) {
+            std::cerr << "请求失败: " << target << std::endl;
+            return 1;
+        }
+        latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - t0).count());
+        bytes += res.body.size();
+
+        if (res.status != 200) {
+            std::cerr << "HTTP " << res.status << ": " << res.body << std::endl;
+            return 1;
+        }
+        auto it = res.headers.find("X-Next-Cursor");
+        if (it == res.headers.end()) {
+            std::cout << "数据在第 " << page << " 页结束" << std::endl;
+            break;
+        }
+        cursor = it->second;
+    }
+
+    std::cout << std::fixed << std::setprecision(2)
+              << path << " limit=" << limit << " 共 " << latencies.size() << " 页, 平均每页 "
+              << bytes / std::max<size_t>(1, latencies.size()) << " 字节" << std::endl;
+
+    // 按页段汇总，分页代价与页码无关时各段中位数应接近
+    const int marks[] = {1, 10, 100, 1000};
+    size_t begin = 0;
+    for (int mark : marks) {
+        size_t end = std::min(latencies.size(), static_cast<size_t>(mark));
+        if (begin >= end) break;
+        std::vector<double> segment(latencies.begin() + begin, latencies.begin() + end);
+        std::sort(segment.begin(), segment.end());
+        std::cout << "第 " << std::setw(4) << begin + 1 << " - " << std::setw(4) << end << " 页:"
+                  << "  p50=" << segment[segment.size() / 2] << "ms"
+                  << "  p99=" << segment[static_cast<size_t>((segment.size() - 1) * 0.99)] << "ms"
+                  << "  max=" << segment.back() << "ms" << std::endl;
+        begin = end;
+    }
+    return 0;
+}
@@ -0,0 +1,246 @@
+// 多事件循环扩展性测试
+// 在进程内启动 HttpServer（只注册一个不访问数据库的 GET /ping），依次以“每连接一个线程”和
+// 1、2、4 … N 个 SO_REUSEPORT 事件循环（epoll 和/或 io_uring）运行，用闭环客户端压测，
+// 输出各配置的吞吐、延迟和服务器平均每个请求的网络IO系统调用次数。
+// 默认每个请求新建连接（压 accept 路径），--keepalive 时每个客户端线程复用一个连接。
+// 客户端与服务器共用本机CPU：要看服务器本身的扩展性，用 taskset 把进程限制在一组核上，
+// 并让 --max-loops 小于可用核数，给客户端留出余量。
+//
+// 用法: reuseport_bench [选项]
+//   --max-loops N       最大事件循环数（默认 CPU 核数）
+//   --clients 64        客户端线程数
+//   --duration 5        每个配置的压测秒数
+//   --port 18080        起始端口（每个配置换一个端口，避开上一轮的 TIME_WAIT）
+//   --keepalive         客户端使用长连接
+//   --pin               事件循环绑核
+//   --io epoll          事件循环的IO机制：epoll / io_uring / all（两者都测）
+#include "http_server.hpp"
+#include "http_client.hpp"
+#include "latency_histogram.hpp"
+#include "metrics.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Config {
+    int maxLoops = static_cast<int>(std::thread::hardware_concurrency());
+    int clients = 64;
+    int duration = 5;
+    int port = 18080;
+    bool keepAlive = false;
+    bool pin = false;
+    std::string io = "epoll";
+};
+
+struct Result {
+    double throughput = 0;
+    uint64_t errors = 0;
+    uint64_t p50 = 0;
+    uint64_t p99 = 0;
+    uint64_t p999 = 0;
+    double syscallsPerRequest = 0;
+};
+
+// 长连接客户端：发送一个请求并按 Content-Length 读完响应，失败时返回 false（调用方重连）；
+// 服务器回复 Connection: close 时 reusable 置为 false
+bool keepAliveRequest(int fd, const std::string& request, std::string& buffer, bool& reusable) {
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += n;
+    }
+    buffer.clear();
+    char chunk[4096];
+    size_t headerEnd = std::string::npos;
+    size_t expected = 0;
+    while (true) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        buffer.append(chunk, n);
+        if (headerEnd == std::string::npos) {
+            headerEnd = buffer.find("\r\n\r\n");
+            if (headerEnd == std::string::npos) continue;
+            size_t pos = buffer.find("Content-Length: ");
+            if (pos == std::string::npos || pos > headerEnd) return false;
+            expected = headerEnd + 4 + std::strtoull(buffer.c_str() + pos + 16, nullptr, 10);
+            size_t connection = buffer.find("Connection: close");
+            reusable = connection == std::string::npos || connection > headerEnd;
+        }
+        if (buffer.size() >= expected) return buffer.compare(0, 12, "HTTP/1.1 200") == 0;
+    }
+}
+
+int connectTo(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+Result runClients(const Config& config, int port) {
+    LatencyHistogram histogram;
+    std::atomic<uint64_t> errors{0};
+    std::atomic<bool> done{false};
+
+    std::vector<std::thread> clients;
+    for (int c = 0; c < config.clients; c++) {
+        clients.emplace_back([&]() {
+            const std::string request = "GET /ping HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+            std::string buffer;
+            int fd = -1;
+            while (!done.load(std::memory_order_relaxed)) {
+                auto start = Clock::now();
+                bool ok;
+                if (config.keepAlive) {
+                    if (fd < 0) fd = connectTo(port);
+                    bool reusable = false;
+                    ok = fd >= 0 && keepAliveRequest(fd, request, buffer, reusable);
+                    if ((!ok || !reusable) && fd >= 0) {
+                        close(fd);
+                        fd = -1;
+                    }
+                } else {
+                    BenchResponse response;
+                    ok = benchRequest("127.0.0.1", port, "GET", "/ping", "", response) && response.status == 200;
+                }
+                if (ok) {
+                    histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count());
+                } else {
+                    errors.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (fd >= 0) close(fd);
+        });
+    }
+
+    auto start = Clock::now();
+    std::this_thread::sleep_for(std::chrono::seconds(config.duration));
+    done = true;
+    for (auto& client : clients) {
+        client.join();
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    Result result;
+    result.throughput = histogram.count() / seconds;
+    result.errors = errors.load();
+    result.p50 = histogram.percentile(50);
+    result.p99 = histogram.percentile(99);
+    result.p999 = histogram.percentile(99.9);
+    return result;
+}
+
+// loops 为 0 时使用每连接一个线程的模式
+Result runServer(const Config& config, int loops, IoBackend backend, int port) {
+    HttpServer server(port);
+    server.get("/ping", [](const HttpRequest&, HttpResponse& res) {
+        res.setJson("{\"status\": \"ok\"}");
+    });
+    server.setEventLoops(loops, config.pin, backend);
+    std::thread serverThread([&server]() { server.start(); });
+
+    // 等待端口就绪
+    for (int i = 0; i < 100; i++) {
+        int fd = connectTo(port);
+        if (fd >= 0) {
+            close(fd);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    uint64_t syscalls = Metrics::getInstance().syscallTotal();
+    Result result = runClients(config, port);
+    syscalls = Metrics::getInstance().syscallTotal() - syscalls;
+    uint64_t requests = static_cast<uint64_t>(result.throughput * config.duration) + result.errors;
+    if (requests > 0) result.syscallsPerRequest = static_cast<double>(syscalls) / requests;
+    server.stop();
+    serverThread.join();
+    // 每连接一个线程的模式下，处理线程是分离的，留出时间让它们退出
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        auto next = [&]() { return i + 1 < argc ? argv[++i] : ""; };
+        if (arg == "--max-loops") config.maxLoops = std::atoi(next());
+        else if (arg == "--clients") config.clients = std::atoi(next());
+        else if (arg == "--duration") config.duration = std::atoi(next());
+        else if (arg == "--port") config.port = std::atoi(next());
+        else if (arg == "--keepalive") config.keepAlive = true;
+        else if (arg == "--pin") config.pin = true;
+        else if (arg == "--io") config.io = next();
+        else {
+            std::cerr << "未知参数: " << arg << std::endl;
+            return 1;
+        }
+    }
+    config.maxLoops = std::max(1, config.maxLoops);
+
+    std::vector<std::pair<IoBackend, const char*>> backends;
+    if (config.io == "epoll" || config.io == "all") backends.push_back({IoBackend::Epoll, "epoll"});
+    if (config.io == "io_uring" || config.io == "all") backends.push_back({IoBackend::IoUring, "io_uring"});
+    if (backends.empty()) {
+        std::cerr << "--io 只能是 epoll / io_uring / all" << std::endl;
+        return 1;
+    }
+    std::vector<int> steps;
+    for (int loops = 1; loops < config.maxLoops; loops *= 2) steps.push_back(loops);
+    steps.push_back(config.maxLoops);
+
+    std::cout << "客户端 " << config.clients << " 线程，" << (config.keepAlive ? "长连接" : "每请求新建连接")
+              << "，每个配置 " << config.duration << " 秒，CPU " << std::thread::hardware_concurrency() << " 核"
+              << std::endl;
+    std::cout << std::left << std::setw(22) << "模式" << std::right << std::setw(12) << "请求/秒"
+              << std::setw(10) << "扩展比" << std::setw(10) << "p50(us)" << std::setw(10) << "p99(us)"
+              << std::setw(11) << "p99.9(us)" << std::setw(12) << "调用/请求" << std::setw(8) << "错误" << std::endl;
+
+    int port = config.port;
+    auto print = [](const std::string& mode, const Result& result, double single) {
+        std::cout << std::left << std::setw(22) << mode << std::right << std::fixed << std::setprecision(0)
+                  << std::setw(12) << result.throughput << std::setw(10);
+        if (single > 0) {
+            std::cout << std::setprecision(2) << result.throughput / single;
+        } else {
+            std::cout << "-";
+        }
+        std::cout << std::setw(10) << result.p50 << std::setw(10) << result.p99 << std::setw(11) << result.p999
+                  << std::setprecision(2) << std::setw(12) << result.syscallsPerRequest << std::setw(8)
+                  << result.errors << std::endl;
+    };
+
+    print("每连接一线程", runServer(config, 0, IoBackend::Epoll, port++), 0);
+    for (const auto& [backend, name] : backends) {
+        double single = 0;
+        for (int loops : steps) {
+            Result result = runServer(config, loops, backend, port++);
+            if (loops == 1) single = result.throughput;
+            print(std::to_string(loops) + " 个 " + name + " 循环", result, single);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,234 @@
+#ifndef BENCH_SQL_FIXTURE_HPP
+#define BENCH_SQL_FIXTURE_HPP
+
+// 从 sys/database 下的建库脚本读取 INSERT 数据，作为基准测试的输入
+// 每张表的数据按倍数复制：自增 id 连续编号，*_code / username 等唯一列追加副本序号，
+// 其余列（外键、文本、数值）原样保留，使字段分布与真实数据一致
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <cctype>
+
+struct SqlTable {
+    std::vector<std::string> columns;                   // 含开头的 id 列
+    std::vector<std::vector<std::string>> rows;         // NULL 记为空串（与 Database::query 一致）
+};
+
+class SqlFixture {
+public:
+    // 读取一个 SQL 文件中的所有 INSERT 语句，返回解析到的行数
+    size_t load(const std::string& path) {
+        std::ifstream in(path);
+        if (!in) return 0;
+        std::stringstream ss;
+        ss << in.rdbuf();
+        const std::string sql = ss.str();
+
+        size_t count = 0;
+        size_t pos = 0;
+        while ((pos = findKeyword(sql, "INSERT", pos)) != std::string::npos) {
+            pos = parseInsert(sql, pos + 6, count);
+        }
+        return count;
+    }
+
+    // 按倍数复制后的表
+    std::map<std::string, SqlTable> scaled(int factor) const {
+        std::map<std::string, SqlTable> out;
+        for (const auto& [name, table] : tables_) {
+            SqlTable& t = out[name];
+            t.columns.push_back("id");
+            t.columns.insert(t.columns.end(), table.columns.begin(), table.columns.end());
+
+            std::vector<bool> unique;
+            for (const auto& column : table.columns) {
+                unique.push_back(isUniqueColumn(column));
+            }
+
+            t.rows.reserve(table.rows.size() * factor);
+            long long id = 1;
+            for (int copy = 0; copy < factor; copy++) {
+                for (const auto& source : table.rows) {
+                    std::vector<std::string> row;
+                    row.reserve(source.size() + 1);
+                    row.push_back(std::to_string(id++));
+                    for (size_t i = 0; i < source.size(); i++) {
+                        if (copy > 0 && unique[i] && !source[i].empty()) {
+                            row.push_back(source[i] + "-" + std::to_string(copy));
+                        } else {
+                            row.push_back(source[i]);
+                        }
+                    }
+                    t.rows.push_back(std::move(row));
+                }
+            }
+        }
+        return out;
+    }
+
+    size_t tableCount() const { return tables_.size(); }
+
+private:
+    std::map<std::string, SqlTable> tables_;
+
+    static bool isUniqueColumn(const std::string& column) {
+        auto endsWith = [&](const std::string& suffix) {
+            return column.size() >= suffix.size() &&
+                   column.compare(column.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        return endsWith("_code") || column == "username";
+    }
+
+    static size_t findKeyword(const std::string& sql, const std::string& word, size_t from) {
+        while (from < sql.size()) {
+            size_t pos = sql.find(word, from);
+            if (pos == std::string::npos) return pos;
+            bool startOfWord = pos == 0 || !std::isalnum(static_cast<unsigned char>(sql[pos - 1]));
+            if (startOfWord && !insideComment(sql, pos)) return pos;
+            from = pos + word.size();
+        }
+        return std::string::npos;
+    }
+
+    // 行注释（-- ...）中的关键字不算
+    static bool insideComment(const std::string& sql, size_t pos) {
+        size_t lineStart = sql.rfind('\n', pos);
+        lineStart = lineStart == std::string::npos ? 0 : lineStart + 1;
+        size_t dash = sql.find("--", lineStart);
+        return dash != std::string::npos && dash < pos;
+    }
+
+    // 跳过空白和行注释
+    static void skipSpace(const std::string& sql, size_t& pos) {
+        while (pos < sql.size()) {
+            if (std::isspace(static_cast<unsigned char>(sql[pos]))) {
+                pos++;
+            } else if (sql.compare(pos, 2, "--") == 0) {
+                size_t end = sql.find('\n', pos);
+                pos = end == std::string::npos ? sql.size() : end + 1;
+            } else {
+                break;
+            }
+        }
+    }
+
+    static std::string readIdentifier(const std::string& sql, size_t& pos) {
+        skipSpace(sql, pos);
+        std::string name;
+        bool quoted = pos < sql.size() && sql[pos] == '`';
+        if (quoted) pos++;
+        while (pos < sql.size()) {
+            char c = sql[pos];
+            if (quoted ? c == '`' : !(std::isalnum(static_cast<unsigned char>(c)) || c == '_')) break;
+            name += c;
+            pos++;
+        }
+        if (quoted && pos < sql.size()) pos++;
+        return name;
+    }
+
+    // 值：'字符串'（支持 '' 和 \ 转义）、数字、NULL；函数调用和子查询等表达式保留原文
+    static std::string readValue(const std::string& sql, size_t& pos) {
+        skipSpace(sql, pos);
+        std::string value;
+        if (pos < sql.size() && sql[pos] == '\'') {
+            pos++;
+            while (pos < sql.size()) {
+                char c = sql[pos++];
+                if (c == '\\' && pos < sql.size()) {
+                    char e = sql[pos++];
+                    value += e == 'n' ? '\n' : e == 't' ? '\t' : e;
+                } else if (c == '\'') {
+                    if (pos < sql.size() && sql[pos] == '\'') {
+                        value += '\'';
+                        pos++;
+                    } else {
+                        break;
+                    }
+                } else {
+                    value += c;
+                }
+            }
+            return value;
+        }
+        int depth = 0;
+        bool quoted = false;
+        while (pos < sql.size()) {
+            char c = sql[pos];
+            if (quoted) {
+                if (c == '\'') quoted = false;
+            } else if (c == '\'') {
+                quoted = true;
+            } else if (c == '(') {
+                depth++;
+            } else if (c == ')' || c == ',') {
+                if (depth == 0) break;
+                if (c == ')') depth--;
+            }
+            value += c;
+            pos++;
+        }
+        value.erase(value.find_last_not_of(" \t\r\n") + 1);
+        if (value == "NULL" || value == "null") value.clear();
+        return value;
+    }
+
+    // INSERT [IGNORE] INTO 表 (列, ...) VALUES (...), (...);
+    size_t parseInsert(const std::string& sql, size_t pos, size_t& count) {
+        size_t into = findKeyword(sql, "INTO", pos);
+        if (into == std::string::npos) return sql.size();
+        pos = into + 4;
+        std::string table = readIdentifier(sql, pos);
+
+        skipSpace(sql, pos);
+        if (pos >= sql.size() || sql[pos] != '(') return pos;
+        pos++;
+        std::vector<std::string> columns;
+        while (pos < sql.size()) {
+            columns.push_back(readIdentifier(sql, pos));
+            skipSpace(sql, pos);
+            if (pos < sql.size() && sql[pos] == ',') { pos++; continue; }
+            pos++;      // ')'
+            break;
+        }
+
+        size_t values = findKeyword(sql, "VALUES", pos);
+        if (values == std::string::npos) return sql.size();
+        pos = values + 6;
+
+        SqlTable& t = tables_[table];
+        if (t.columns.empty()) t.columns = columns;
+        while (pos < sql.size()) {
+            skipSpace(sql, pos);
+            if (pos >= sql.size() || sql[pos] != '(') break;
+            pos++;
+            std::map<std::string, std::string> byName;
+            for (size_t i = 0; pos < sql.size(); i++) {
+                std::string value = readValue(sql, pos);
+                if (i < columns.size()) byName[columns[i]] = value;
+                skipSpace(sql, pos);
+                if (pos < sql.size() && sql[pos] == ',') { pos++; continue; }
+                pos++;  // ')'
+                break;
+            }
+            // 同一张表在不同脚本中的列可能不同，统一按第一次出现的列输出，缺失的列为空
+            std::vector<std::string> row;
+            row.reserve(t.columns.size());
+            for (const auto& column : t.columns) {
+                auto it = byName.find(column);
+                row.push_back(it == byName.end() ? "" : it->second);
+            }
+            t.rows.push_back(std::move(row));
+            count++;
+
+            skipSpace(sql, pos);
+            if (pos < sql.size() && sql[pos] == ',') { pos++; continue; }
+            break;
+        }
+        return pos;
+    }
+};
+
+#endif // BENCH_SQL_FIXTURE_HPP
@@ -0,0 +1,152 @@
+// 课表物化基准测试
+// 模拟开学时 20000 名学生同时打开课表：先用合成数据全量物化，再并发读取全部学生课表，
+// 最后测量一次排课变更触发的增量重建耗时
+//
+// 用法: timetable_bench [--students N] [--courses N] [--per-student N] [--clients N]
+#include "timetable_store.hpp"
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+using Row = TimetableStore::Row;
+
+static double percentile(std::vector<double>& v, double p) {
+    if (v.empty()) return 0;
+    size_t idx = static_cast<size_t>(p / 100.0 * (v.size() - 1));
+    std::nth_element(v.begin(), v.begin() + idx, v.end());
+    return v[idx];
+}
+
+static Row makeScheduleRow(int scheduleId, int courseId, int teacherId, int classroomId,
+                           int weekday, int section, const std::string& courseName) {
+    Row row;
+    row["schedule_id"] = std::to_string(scheduleId);
+    row["course_id"] = std::to_string(courseId);
+    row["teacher_id"] = std::to_string(teacherId);
+    row["classroom_id"] = std::to_string(classroomId);
+    row["class_id"] = "";
+    row["semester"] = "2024-2025-1";
+    row["weekday"] = std::to_string(weekday);
+    row["start_section"] = std::to_string(section);
+    row["end_section"] = std::to_string(section + 1);
+    row["start_week"] = "1";
+    row["end_week"] = "16";
+    row["week_type"] = "all";
+    row["course_code"] = "C" + std::to_string(courseId);
+    row["course_name"] = courseName;
+    row["teacher_code"] = "T" + std::to_string(teacherId);
+    row["teacher_name"] = "教师" + std::to_string(teacherId);
+    row["classroom_code"] = "R" + std::to_string(classroomId);
+    row["classroom_name"] = "教室" + std::to_string(classroomId);
+    row["building"] = "A楼";
+    row["class_code"] = "";
+    row["class_name"] = "";
+    return row;
+}
+
+int main(int argc, char* argv[]) {
+    int students = 20000;
+    int courses = 800;
+    int perStudent = 8;
+    int clients = 64;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string arg = argv[i];
+        int value = std::atoi(argv[i + 1]);
+        if (arg == "--students") students = value;
+        else if (arg == "--courses") courses = value;
+        else if (arg == "--per-student") perStudent = value;
+        else if (arg == "--clients") clients = value;
+    }
+
+    // ===== 合成数据：每门课每周两次课，选课人数按 Zipf 分布倾斜 =====
+    std::mt19937 rng(42);
+    std::vector<Row> scheduleRows;
+    int scheduleId = 1;
+    for (int c = 1; c <= courses; c++) {
+        for (int k = 0; k < 2; k++) {
+            scheduleRows.push_back(makeScheduleRow(scheduleId++, c, 1 + c % 200, 1 + c % 300,
+                                                   1 + (c + k * 2) % 5, 1 + 2 * ((c / 5 + k) % 5),
+                                                   "课程" + std::to_string(c)));
+        }
+    }
+
+    std::vector<double> weights(courses);
+    for (int c = 0; c < courses; c++) weights[c] = 1.0 / (c + 1);
+    std::discrete_distribution<int> pick(weights.begin(), weights.end());
+
+    std::vector<Row> enrollmentRows;
+    for (int s = 1; s <= students; s++) {
+        std::vector<int> chosen;
+        while (static_cast<int>(chosen.size()) < std::min(perStudent, courses)) {
+            int c = pick(rng) + 1;
+            if (std::find(chosen.begin(), chosen.end(), c) == chosen.end()) chosen.push_back(c);
+        }
+        for (int c : chosen) {
+            enrollmentRows.push_back({{"student_id", std::to_string(s)},
+                                      {"course_id", std::to_string(c)},
+                                      {"semester", "2024-2025-1"}});
+        }
+    }
+
+    auto& store = TimetableStore::getInstance();
+    store.setLoader([&](const std::string& sql) {
+        return sql.find("FROM enrollment") != std::string::npos ? enrollmentRows : scheduleRows;
+    });
+
+    auto t0 = Clock::now();
+    store.load();
+    double loadMs = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+    std::cout << "全量物化: " << std::fixed << std::setprecision(1) << loadMs << " ms" << std::endl;
+
+    // ===== 并发读取全部学生课表 =====
+    std::vector<std::vector<double>> perClient(clients);
+    std::atomic<int> next{1};
+    std::atomic<size_t> bytes{0};
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int c = 0; c < clients; c++) {
+        threads.emplace_back([&, c] {
+            size_t local = 0;
+            while (true) {
+                int s = next.fetch_add(1);
+                if (s > students) break;
+                auto r0 = Clock::now();
+                std::string body = *store.studentTimetable(s, "2024-2025-1");  // 与 res.setJson 一样拷贝一次
+                auto r1 = Clock::now();
+                local += body.size();
+                perClient[c].push_back(std::chrono::duration<double, std::micro>(r1 - r0).count());
+            }
+            bytes += local;
+        });
+    }
+    for (auto& t : threads) t.join();
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<double> latencies;
+    for (auto& v : perClient) latencies.insert(latencies.end(), v.begin(), v.end());
+
+    std::cout << std::setprecision(2)
+              << students << " 名学生并发读取(" << clients << " 线程): " << seconds * 1000 << " ms, "
+              << students / seconds << " 次/s, 平均 " << bytes.load() / students << " 字节"
+              << "  p50=" << percentile(latencies, 50) << "us"
+              << "  p99=" << percentile(latencies, 99) << "us"
+              << "  max=" << percentile(latencies, 100) << "us" << std::endl;
+
+    // ===== 增量更新：修改最热门课程的一次课（影响人数最多） =====
+    Row changed = makeScheduleRow(1, 1, 1 + 1 % 200, 1 + 1 % 300, 5, 9, "课程1(调课)");
+    auto u0 = Clock::now();
+    store.applySchedules({TimetableStore::entryFromRow(changed)});
+    double updateMs = std::chrono::duration<double, std::milli>(Clock::now() - u0).count();
+    std::cout << "增量更新热门课程排课: " << updateMs << " ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,121 @@
+#ifndef ADMISSION_HPP
+#define ADMISSION_HPP
+
+#include <string>
+#include <deque>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <cstdint>
+
+// 准入控制：按路由类别限制同时处理的请求数
+// 名额用完时请求进入该类别的队列，每个请求带截止时间；队列已满、或按当前处理速度排到时已过截止时间的请求
+// 立即以 503 + Retry-After 拒绝，不再占用处理线程和数据库。
+// 名额上限按处理延迟自适应（AIMD）：每个窗口的平均延迟不超过空载延迟的 tolerance 倍且名额被用满时加 1，
+// 超过时乘以 backoff。过载时多出的请求在队列里等待或被快速拒绝，已接纳的请求保持接近空载时的延迟
+class AdmissionController {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        double initialLimit = 16;
+        double minLimit = 2;
+        double maxLimit = 256;
+        size_t maxQueue = 256;
+        std::chrono::milliseconds deadline{1000};     // 排队的最长时间
+        double tolerance = 2.0;                         // 平均延迟 / 空载延迟 超过该值视为过载
+        double backoff = 0.9;
+    };
+
+    // 排队的请求得到名额（true）或超过截止时间（false）时调用，调用线程是释放名额或新请求到达的线程；
+    // 等待者已经放弃时返回 false，名额转给下一个
+    using Grant = std::function<bool(bool admitted)>;
+
+    enum class Result { Admitted, Queued, Rejected };
+
+    class RouteClass {
+    public:
+        struct Snapshot {
+            double limit = 0;
+            int inFlight = 0;
+            size_t queued = 0;
+            uint64_t minLatencyNanos = 0;
+            uint64_t admitted = 0;
+            uint64_t rejectedFull = 0;          // 队列已满
+            uint64_t rejectedDeadline = 0;      // 预计等不到名额
+            uint64_t expired = 0;               // 排队超过截止时间
+        };
+
+        const std::string& name() const { return name_; }
+        Options options() const;
+        Snapshot snapshot() const;
+
+    private:
+        friend class AdmissionController;
+
+        struct Waiter {
+            Clock::time_point deadline;
+            Grant grant;
+        };
+
+        explicit RouteClass(const std::string& name) : name_(name) {}
+
+        // 取出已过截止时间的等待者（调用方在锁外通知）
+        void expireLocked(Clock::time_point now, std::vector<Grant>& expired);
+        // 一个请求处理完：更新延迟窗口并按需调整上限
+        void sampleLocked(uint64_t nanos);
+
+        std::string name_;
+        mutable std::mutex mutex_;
+        Options options_;
+        double limit_ = 0;
+        int inFlight_ = 0;
+        std::deque<Waiter> queue_;
+
+        // 延迟窗口：每 max(10, limit) 个请求结算一次
+        uint64_t windowCount_ = 0;
+        uint64_t windowSum_ = 0;
+        bool windowSaturated_ = false;          // 窗口内出现过名额用满
+        uint64_t windows_ = 0;
+        uint64_t minLatency_ = 0;               // 空载延迟的估计（历次窗口平均的最小值）
+        uint64_t lastLatency_ = 0;              // 上一个窗口的平均延迟，用于估算排队时间
+
+        Snapshot counters_;
+    };
+
+    static AdmissionController& getInstance();
+
+    // 创建或修改类别
+    RouteClass* configure(const std::string& name, const Options& options);
+    // 未配置的类别返回 nullptr
+    RouteClass* find(const std::string& name);
+
+    // 申请名额。Queued 时 grant 稍后被调用恰好一次；Admitted / Rejected 时不调用 grant
+    Result acquire(RouteClass& routeClass, Grant grant);
+    // 阻塞版（每连接一线程模式）：得到名额返回 true，被拒绝或超时返回 false
+    bool acquire(RouteClass& routeClass);
+    // 归还名额，nanos 为从得到名额到处理完成的时间
+    void release(RouteClass& routeClass, uint64_t nanos);
+    // 通知已过截止时间的等待者。acquire / release 时也会顺带检查，但类别上没有新请求和完成的请求时
+    // 排队的请求要靠调用方在截止时间调用这里，才能及时拿到 503
+    void expire(RouteClass& routeClass);
+
+    // Prometheus文本格式的各类别状态
+    std::string render() const;
+
+private:
+    AdmissionController() = default;
+    AdmissionController(const AdmissionController&) = delete;
+    AdmissionController& operator=(const AdmissionController&) = delete;
+
+    // 把空出的名额交给队首的等待者
+    void dispatch(RouteClass& routeClass);
+
+    mutable std::mutex mutex_;
+    std::map<std::string, std::unique_ptr<RouteClass>> classes_;
+};
+
+#endif // ADMISSION_HPP
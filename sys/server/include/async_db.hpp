@@ -0,0 +1,77 @@
+#ifndef ASYNC_DB_HPP
+#define ASYNC_DB_HPP
+
+#include "db.hpp"
+#include "task.hpp"
+#include "thread_pool.hpp"
+#include "tracer.hpp"
+#include <coroutine>
+#include <functional>
+#include <memory>
+#include <string>
+
+// 协程版数据库访问：co_await AsyncDb::getInstance().query(sql)
+// 语句交给专用的数据库IO线程通过 Database 执行，发起的协程挂起，调用线程（事件循环）继续处理其他连接；
+// 语句完成后把恢复动作投递回发起线程的执行器。以下情况不挂起、在调用线程上同步执行：
+// 未调用 start()、当前线程没有执行器、IO线程队列已满
+class AsyncDb {
+public:
+    // 等待一条语句执行完成的 awaitable，结果为 T
+    template <typename T>
+    class Awaiter {
+    public:
+        Awaiter(ThreadPool* pool, std::function<T()> work) : pool_(pool), work_(std::move(work)) {}
+
+        bool await_ready() {
+            if (pool_ && Executor::current()) return false;
+            result_ = work_();
+            return true;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            Executor* executor = Executor::current();
+            // 被采样的请求的追踪随语句带到IO线程，数据库的 span 仍记在该请求下
+            trace_ = Tracer::detach();
+            bool submitted = pool_->trySubmit([this, executor, handle]() {
+                Tracer::attach(std::move(trace_));
+                result_ = work_();
+                trace_ = Tracer::detach();
+                executor->post([this, handle]() {
+                    Tracer::attach(std::move(trace_));
+                    handle.resume();
+                });
+            });
+            if (!submitted) {
+                Tracer::attach(std::move(trace_));
+                result_ = work_();
+            }
+            return submitted;
+        }
+
+        T await_resume() { return std::move(result_); }
+
+    private:
+        ThreadPool* pool_;
+        std::function<T()> work_;
+        T result_{};
+        Tracer::Context trace_;
+    };
+
+    static AsyncDb& getInstance();
+
+    // 启动 threads 个IO线程，最多 maxQueue 条语句排队；之后的 query/execute 才会真正异步
+    void start(size_t threads, size_t maxQueue);
+    void stop();
+
+    Awaiter<DbResult> query(std::string sql);
+    Awaiter<bool> execute(std::string sql);
+
+private:
+    AsyncDb() = default;
+    AsyncDb(const AsyncDb&) = delete;
+    AsyncDb& operator=(const AsyncDb&) = delete;
+
+    std::unique_ptr<ThreadPool> pool_;
+};
+
+#endif // ASYNC_DB_HPP
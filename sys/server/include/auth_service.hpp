@@ -0,0 +1,160 @@
+#ifndef AUTH_SERVICE_HPP
+#define AUTH_SERVICE_HPP
+
+#include "thread_pool.hpp"
+#include "task.hpp"
+#include "tracer.hpp"
+#include <coroutine>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <functional>
+#include <memory>
+#include <future>
+#include <mutex>
+#include <cstdint>
+
+// 登录用户记录
+struct AuthUser {
+    int id = 0;
+    std::string username;
+    std::string role;
+    std::string realName;
+    std::string passwordHash;
+};
+
+// 登录校验服务
+// - 密码哈希在服务器内完成（PBKDF2），运行在独立的有界线程池上，高峰期不会占满请求线程；
+//   事件循环线程上 co_await 等待时挂起，不阻塞同一循环上的其他连接
+// - 按用户名缓存用户记录，命中时不访问数据库
+// - 校验通过后缓存一个以进程内随机密钥计算的HMAC，重复登录只需一次HMAC而不必重跑KDF
+class AuthService {
+public:
+    enum class Result {
+        Ok,
+        Invalid,    // 用户不存在或密码错误
+        Busy        // KDF线程池已满
+    };
+
+    // 登录结果
+    struct Login {
+        Result result = Result::Invalid;
+        AuthUser user;
+    };
+
+    // 等待KDF线程池上一次计算的 awaitable，线程池已满时结果为空。
+    // 当前线程有执行器（事件循环）时挂起，完成后把恢复动作投递回该执行器；
+    // 否则在本线程上等待计算完成（每连接一线程），未调用 start() 时在本线程上直接计算
+    template <typename T>
+    class KdfAwaiter {
+    public:
+        KdfAwaiter(ThreadPool* pool, std::function<T()> work) : pool_(pool), work_(std::move(work)) {}
+
+        bool await_ready() {
+            if (!pool_) {
+                result_ = work_();
+                return true;
+            }
+            if (Executor::current()) return false;
+            auto promise = std::make_shared<std::promise<T>>();
+            auto future = promise->get_future();
+            if (pool_->trySubmit([promise, work = work_] { promise->set_value(work()); })) {
+                result_ = future.get();
+            }
+            return true;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            Executor* executor = Executor::current();
+            trace_ = Tracer::detach();
+            bool submitted = pool_->trySubmit([this, executor, handle]() {
+                result_ = work_();
+                executor->post([this, handle]() {
+                    Tracer::attach(std::move(trace_));
+                    handle.resume();
+                });
+            });
+            if (!submitted) Tracer::attach(std::move(trace_));
+            return submitted;
+        }
+
+        std::optional<T> await_resume() { return std::move(result_); }
+
+    private:
+        ThreadPool* pool_;
+        std::function<T()> work_;
+        std::optional<T> result_;
+        Tracer::Context trace_;
+    };
+
+    // 按用户名加载用户记录，不存在返回false
+    using UserLoader = std::function<bool(const std::string& username, AuthUser& user)>;
+    // 旧格式哈希校验通过后写回新哈希
+    using HashUpdater = std::function<void(int userId, const std::string& passwordHash)>;
+
+    static AuthService& getInstance();
+
+    // 配置（需在start之前调用）
+    void setIterations(int iterations);
+    int iterations() const { return iterations_; }
+    void setCacheTtl(int seconds);
+    void setUserLoader(UserLoader loader);
+    void setHashUpdater(HashUpdater updater);
+
+    void start(size_t kdfThreads, size_t maxQueue);
+    void stop();
+
+    // 校验用户名和密码；校验缓存未命中时 co_await KDF线程池，线程池已满时结果为 Busy
+    Task<Login> authenticate(std::string username, std::string password);
+
+    // 在KDF线程池上生成新密码哈希（创建用户/修改密码）
+    KdfAwaiter<std::string> hashPassword(std::string password);
+
+    // 批量生成密码哈希（批量导入用户），按线程数分块在KDF线程池上并行计算，调用线程等待全部完成；
+    // 线程池满时返回空。只用于批量导入路由，其准入类别把并发限制在一两个请求
+    std::vector<std::string> hashPasswords(const std::vector<std::string>& passwords);
+
+    // 用户信息或密码变更后失效缓存
+    void invalidate(const std::string& username);
+    void invalidateUser(int userId);
+    void clear();
+
+    size_t cacheSize() const;
+
+private:
+    AuthService();
+    AuthService(const AuthService&) = delete;
+    AuthService& operator=(const AuthService&) = delete;
+
+    struct CacheEntry {
+        AuthUser user;
+        std::string verifier;        // HMAC(secret, salt || password)，空表示尚未校验通过
+        int64_t loadedAt = 0;
+        int64_t verifiedAt = 0;
+    };
+
+    static constexpr size_t kMaxCacheEntries = 100000;
+
+    // 校验的KDF结果：密码正确时 ok，旧格式哈希需要升级时 newHash 非空
+    struct Outcome {
+        bool ok = false;
+        std::string newHash;
+    };
+
+    std::string makeVerifier(const AuthUser& user, const std::string& password) const;
+    bool runOnPool(std::function<void()> task);
+    static int64_t now();
+
+    int iterations_;
+    int cacheTtl_;
+    std::string secret_;
+    UserLoader loader_;
+    HashUpdater updater_;
+    std::unique_ptr<ThreadPool> pool_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, CacheEntry> cache_;
+};
+
+#endif // AUTH_SERVICE_HPP
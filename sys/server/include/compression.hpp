@@ -0,0 +1,62 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <string>
+#include <functional>
+#include <cstddef>
+#include <zlib.h>
+
+// 响应体的内容编码
+enum class ContentCoding { Identity, Gzip, Deflate };
+
+// 响应压缩配置
+struct CompressionOptions {
+    bool enabled = true;
+    int level = 3;                          // 1（最快）~ 9（最小）；列表 JSON 上 3 与 1 耗时相当、体积接近 6
+    size_t minSize = 1024;                  // 小于此值不压缩：省下的字节抵不过头部和CPU开销
+    size_t chunkedSize = 256 * 1024;        // 不小于此值时压缩输出直接以 chunked 分段写入响应，不先攒出完整压缩体
+};
+
+// zlib 压缩器，每个线程一个（事件循环线程、数据库IO线程上长期复用）
+// 两种编码各保留一个 z_stream，每次压缩只 deflateReset，不重新分配约 256KB 的压缩状态；
+// 每连接一线程模式下线程随连接退出，压缩状态也随之释放
+class ResponseCompressor {
+public:
+    static constexpr size_t kChunkSize = 16 * 1024;
+    using Sink = std::function<void(const char* data, size_t size)>;
+
+    // 当前线程的压缩器
+    static ResponseCompressor& local();
+
+    // 按 Accept-Encoding（含 q 值）选择编码：优先 gzip，其次 deflate，都不接受时为 Identity
+    static ContentCoding negotiate(const std::string& acceptEncoding);
+    // 文本类内容（JSON、HTML、CSS、JS、SVG 等）才值得压缩
+    static bool compressible(const std::string& contentType);
+    static const char* codingName(ContentCoding coding);
+
+    // 流式压缩：输出每攒满 kChunkSize 字节（以及结尾）交给 sink 一次；失败返回 false
+    bool compress(ContentCoding coding, int level, const char* data, size_t size, const Sink& sink);
+    // 压缩到字符串
+    bool compress(ContentCoding coding, int level, const std::string& input, std::string& output);
+
+    ~ResponseCompressor();
+    ResponseCompressor(const ResponseCompressor&) = delete;
+    ResponseCompressor& operator=(const ResponseCompressor&) = delete;
+
+private:
+    ResponseCompressor() = default;
+
+    struct Stream {
+        z_stream zs{};
+        bool initialized = false;
+        int level = 0;
+    };
+
+    // 取对应编码的流并重置；级别变化时重新初始化
+    z_stream* acquire(ContentCoding coding, int level);
+
+    Stream streams_[2];                     // gzip、deflate
+    char buffer_[kChunkSize];
+};
+
+#endif // COMPRESSION_HPP
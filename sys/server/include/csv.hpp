@@ -0,0 +1,54 @@
+#ifndef CSV_HPP
+#define CSV_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 简单CSV工具（批量导入使用）
+class Csv {
+public:
+    static std::string_view trim(std::string_view s) {
+        while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+        while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '\r')) s.remove_suffix(1);
+        return s;
+    }
+    
+    // 拆分一行CSV，字段可用双引号包围（"" 表示一个引号）
+    static std::vector<std::string> splitLine(std::string_view line) {
+        std::vector<std::string> fields;
+        size_t i = 0;
+        while (true) {
+            std::string field;
+            while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) i++;
+            if (i < line.size() && line[i] == '"') {
+                i++;
+                while (i < line.size()) {
+                    if (line[i] == '"') {
+                        if (i + 1 < line.size() && line[i + 1] == '"') {
+                            field += '"';
+                            i += 2;
+                            continue;
+                        }
+                        i++;
+                        break;
+                    }
+                    field += line[i++];
+                }
+                size_t comma = line.find(',', i);
+                i = comma == std::string_view::npos ? line.size() : comma;
+            } else {
+                size_t comma = line.find(',', i);
+                size_t end = comma == std::string_view::npos ? line.size() : comma;
+                field = std::string(trim(line.substr(i, end - i)));
+                i = end;
+            }
+            fields.push_back(std::move(field));
+            if (i >= line.size()) break;
+            i++;    // 跳过逗号
+        }
+        return fields;
+    }
+};
+
+#endif // CSV_HPP
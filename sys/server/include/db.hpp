@@ -1,24 +1,24 @@
 #ifndef DB_HPP
 #define DB_HPP
 
+#include "db_backend.hpp"
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
 #include <mutex>
-#include <mysql.h>
-
-// 数据库结果行
-using DbRow = std::map<std::string, std::string>;
-using DbResult = std::vector<DbRow>;
+#include <chrono>
 
 class Database {
 public:
     static Database& getInstance();
     
+    // 连接 MySQL（未启用 MySQL 支持时返回 false）
     bool connect(const std::string& host, const std::string& user, 
                  const std::string& password, const std::string& database, 
                  unsigned int port = 3306);
+    // 使用指定后端（如嵌入式 SQLite），替换当前连接
+    bool connect(std::unique_ptr<DbBackend> backend);
     void disconnect();
     bool isConnected() const;
     bool ensureConnected();  // 检查连接并自动重连
@@ -29,6 +29,9 @@ public:
     // 执行非查询语句（INSERT/UPDATE/DELETE）
     bool execute(const std::string& sql);
     
+    // 在一个事务中依次执行多条语句，期间独占连接；任一条失败即回滚并返回 false
+    bool executeTransaction(const std::vector<std::string>& statements);
+    
     // 获取最后插入的ID
     unsigned long long lastInsertId() const;
     
@@ -40,6 +43,18 @@ public:
     
     // 获取错误信息
     std::string getError() const;
+    
+    // 等待连接的最长时间（超时的调用按失败返回）和单条语句的最长执行时间（超时中断语句，0 表示不限），启动时设置
+    void setTimeouts(std::chrono::milliseconds checkout, std::chrono::milliseconds statement);
+    
+    // 把一行原始结果转换为DbRow（NULL 转为空串）；字段名由调用方每个结果集构造一次
+    static DbRow buildRow(const std::vector<std::string>& names, const char* const* values) {
+        DbRow row;
+        for (size_t i = 0; i < names.size(); i++) {
+            row.insert_or_assign(names[i], values[i] ? values[i] : "");   // 同名列以后出现的为准
+        }
+        return row;
+    }
 
 private:
     Database();
@@ -47,16 +62,24 @@ private:
     Database(const Database&) = delete;
     Database& operator=(const Database&) = delete;
     
-    MYSQL* conn_;
-    bool connected_;
-    mutable std::mutex mutex_;  // 线程安全锁
+    // 在等待时间内取得连接，超时返回 false
+    bool checkout(std::unique_lock<std::timed_mutex>& lock);
+    // 执行一条语句，超过语句超时即中断；调用前必须已持有锁
+    bool runStatement(const std::string& sql, DbResult* result, StatementTiming& timing, bool& timedOut);
+    // 记录语句耗时，慢查询时捕获执行计划；调用后锁已释放
+    void finishStatement(const std::string& sql, const StatementTiming& timing,
+                         std::unique_lock<std::timed_mutex>& lock);
+    // finishStatement 的两部分：持锁时记录追踪并捕获慢查询计划，释放锁后写入统计
+    bool captureStatement(const std::string& sql, const StatementTiming& timing,
+                          std::string& fingerprint, std::string& plan);
+    void recordStatement(const std::string& sql, const StatementTiming& timing,
+                         std::string fingerprint, const std::string& plan, bool slow);
+    std::string explain(const std::string& sql);
     
-    // 保存连接参数用于重连
-    std::string host_;
-    std::string user_;
-    std::string password_;
-    std::string database_;
-    unsigned int port_;
+    std::unique_ptr<DbBackend> backend_;
+    mutable std::timed_mutex mutex_;  // 线程安全锁（同时是唯一连接的归属）
+    std::chrono::milliseconds checkoutTimeout_{5000};
+    std::chrono::milliseconds statementTimeout_{30000};
 };
 
 #endif // DB_HPP
@@ -0,0 +1,49 @@
+#ifndef DB_BACKEND_HPP
+#define DB_BACKEND_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+struct StatementTiming;
+
+using DbRow = std::map<std::string, std::string>;
+using DbResult = std::vector<DbRow>;
+
+// 数据库后端接口
+// Database 负责加锁、重试、计时统计和追踪，后端只负责在一条连接上执行语句；
+// 调用方保证同一时刻只有一个线程访问后端
+class DbBackend {
+public:
+    virtual ~DbBackend() = default;
+
+    // 后端名称（日志用），如 "mysql" / "sqlite"
+    virtual const char* name() const = 0;
+
+    virtual bool connect() = 0;
+    virtual void disconnect() = 0;
+    // 连接是否可用（会实际探测）
+    virtual bool ping() = 0;
+    // 检查连接，断开时自动重连
+    virtual bool ensureConnected() = 0;
+
+    // 执行一条语句；result 不为空且语句有结果集时逐行写入 result。
+    // 各阶段耗时（exec/fetch/convert）写入 timing，失败返回 false
+    virtual bool run(const std::string& sql, DbResult* result, StatementTiming& timing) = 0;
+
+    virtual unsigned long long lastInsertId() const = 0;
+    virtual unsigned long long affectedRows() const = 0;
+
+    // 按后端的字符串字面量规则转义
+    virtual std::string escape(const std::string& str) = 0;
+    virtual std::string error() const = 0;
+
+    // 查看执行计划的语句前缀，如 "EXPLAIN "
+    virtual std::string explainPrefix() const = 0;
+
+    // 让正在执行的 run 尽快以失败返回（语句超时），由其他线程调用；不支持时什么也不做
+    virtual void interrupt() {}
+};
+
+#endif // DB_BACKEND_HPP
@@ -0,0 +1,140 @@
+#ifndef EVENT_LOOP_HPP
+#define EVENT_LOOP_HPP
+
+#include "http_server.hpp"
+#include "task.hpp"
+#include "timer_wheel.hpp"
+#include "metrics.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <functional>
+
+// 事件循环（HttpServer 的多循环模式）
+// 每个循环独占一个 SO_REUSEPORT 监听socket、连接表和读缓冲，循环之间不共享任何状态，
+// 新连接由内核按四元组哈希分到各个监听socket。请求在循环线程上处理，
+// 同一连接上的后续请求（keep-alive、流水线）按顺序处理：异步处理函数挂起期间，该连接上的后续请求等待，
+// 循环继续服务其他连接；循环同时是这些协程的执行器，恢复动作经 post 回到循环线程。
+// 每个连接在时间轮上有一个定时器，只在所处阶段（空闲、读请求头、读请求体、发送、等待处理函数）变化时重新计时，
+// 因此逐字节慢速发送的客户端也会在阶段超时后被关闭
+class EventLoop : public Executor {
+public:
+    EventLoop(HttpServer& server, int index);
+    ~EventLoop() override;
+
+    virtual const char* backend() const = 0;
+    // 创建监听socket和事件通知机制
+    virtual bool listen(int port) = 0;
+    // 运行到 stop()；cpu >= 0 时把当前线程绑定到该CPU
+    virtual void run(int cpu) = 0;
+    // 可在任意线程（包括信号处理函数）调用
+    virtual void stop() = 0;
+
+    void post(std::function<void()> task) override;
+
+    // 本循环的时间轮，只能在循环线程上使用（例如给排队等待准入名额的请求设截止时间）
+    virtual TimerWheel& timers() = 0;
+
+protected:
+    using Clock = std::chrono::steady_clock;
+
+    // 绑定端口的 SO_REUSEPORT 监听socket，失败返回 -1
+    int openListenSocket(int port, bool nonBlocking);
+    void pinToCpu(int cpu);
+
+    // in 开头已有完整请求时取出到 request（frame 随之复位，taken 为该请求的读取结果）
+    static bool takeRequest(std::string& in, RequestFrame& frame, std::string& request, RequestFrame& taken);
+
+    // 返回 false 表示由异步处理函数稍后在循环线程上调用 write
+    bool process(const std::string& request, const RequestFrame& frame, Clock::time_point acceptedAt,
+                 Clock::time_point readStart, ResponseWriter write,
+                 std::shared_ptr<const std::atomic<bool>> closed) {
+        return server_.processRequest(request, frame, acceptedAt, readStart, std::move(write), std::move(closed));
+    }
+
+    // 连接所处阶段的超时时长
+    std::chrono::milliseconds timeoutFor(TimeoutKind kind) const;
+    // 读请求超时回 408、处理函数超时回 504（尽力发送，不等待），其余阶段直接关闭；调用方随后关闭连接
+    void sendTimeoutResponse(int fd, TimeoutKind kind);
+
+    // 唤醒阻塞等待中的循环（stop 和 post 使用）
+    void wake();
+    // 循环被 wakeFd_ 唤醒后调用：清除计数并执行已投递的任务
+    void runPosted();
+
+    HttpServer& server_;
+    int index_;
+    int wakeFd_;                        // eventfd
+
+private:
+    std::mutex postMutex_;
+    std::vector<std::function<void()>> posted_;
+};
+
+// 基于 epoll（水平触发）的事件循环
+class EpollLoop : public EventLoop {
+public:
+    EpollLoop(HttpServer& server, int index);
+    ~EpollLoop() override;
+
+    const char* backend() const override { return "epoll"; }
+    bool listen(int port) override;
+    void run(int cpu) override;
+    void stop() override;
+    TimerWheel& timers() override { return wheel_; }
+
+private:
+    struct Connection {
+        int fd = -1;
+        uint64_t id = 0;                // fd 会被复用，异步响应按 fd + id 找回连接
+        std::string in;                 // 已收到未处理的数据
+        std::string out;                // 待发送的响应
+        size_t outPos = 0;
+        RequestFrame frame;
+        Clock::time_point acceptedAt;   // 连接建立或上一个响应发完的时间
+        Clock::time_point readStart;    // 当前请求第一段数据到达的时间
+        uint32_t events = 0;            // 当前注册的事件
+        bool closeAfterWrite = false;
+        bool peerClosed = false;        // 对端已关闭写方向
+        bool awaiting = false;          // 等待异步处理函数的响应
+        bool writeFailed = false;
+        bool served = false;            // 已回复过请求（之后没有数据时按空闲计时）
+        TimeoutKind phase = TimeoutKind::Count;
+        TimerWheel::Timer timer;
+        std::shared_ptr<std::atomic<bool>> closed = std::make_shared<std::atomic<bool>>(false);
+        ConnectionTakeover takeover;    // 响应要求接管连接：afterResponse 时交出
+    };
+
+    void acceptConnections();
+    void onReadable(Connection& conn);
+    void onWritable(Connection& conn);
+    // 处理 in 中已完整的请求，直到需要等待更多数据、发送缓冲满或等待异步响应；返回 false 表示连接已关闭
+    bool processBuffered(Connection& conn);
+    // 响应写入 out 之后的处理；返回 false 表示连接已关闭
+    bool afterResponse(Connection& conn);
+    // 交付响应：同步处理时在 process 内调用，异步处理函数完成时在循环线程上调用
+    void deliver(int fd, uint64_t id, const std::string& response, ConnectionTakeover takeover);
+    // 把连接移出 epoll 和连接表（不关闭 socket），连同未发出和已收到的数据交给接管方
+    void handOff(Connection& conn);
+    // 尽量发送 out；出错返回 false
+    bool flush(Connection& conn);
+    // EPOLLIN / EPOLLOUT / 0（等待异步响应时不读取，只接收 EPOLLHUP/EPOLLERR）
+    void updateInterest(Connection& conn, uint32_t events);
+    // 按连接当前所处的阶段设置定时器（阶段不变时保留原截止时间）
+    void refreshTimer(Connection& conn);
+    void onTimeout(int fd, TimeoutKind kind);
+    void closeConnection(int fd);
+
+    int listenFd_;
+    int epollFd_;
+    std::atomic<bool> running_;
+    uint64_t nextId_;
+    TimerWheel wheel_;
+    std::unordered_map<int, Connection> connections_;
+    std::vector<char> buffer_;          // 本循环所有连接共用的读缓冲
+};
+
+#endif // EVENT_LOOP_HPP
@@ -10,38 +10,103 @@
 #include <thread>
 #include <vector>
 #include <atomic>
+#include <chrono>
+#include <memory>
+#include "task.hpp"
+#include "admission.hpp"
+#include "compression.hpp"
+#include "response_cache.hpp"
+
+class RouteMetrics;
+class EventLoop;
 
 // HTTP请求结构
 struct HttpRequest {
     std::string method;
     std::string path;
     std::string query;
+    std::string version;                        // 如 "HTTP/1.1"
     std::map<std::string, std::string> headers;
     std::map<std::string, std::string> params;  // URL参数
     std::string body;
     
+    // 由中间件填充的登录用户信息（未登录时userId为0）
+    int userId = 0;
+    std::string username;
+    std::string role;
+    
+    bool isAuthenticated() const { return userId > 0; }
+    
     // 解析查询参数
     std::map<std::string, std::string> parseQuery() const;
     
     // 获取路径中的参数（如 /api/classrooms/123 中的 123）
     std::string getPathParam(const std::string& pattern, int index) const;
+    
+    // 请求头（名称不区分大小写），没有时为空串
+    std::string header(const std::string& name) const;
 };
 
+// 连接接管：响应头发出后由接管方持有连接（SSE、WebSocket 等长连接），服务器不再读写也不关闭它。
+// 接管方拿到 socket、尚未发出的字节（至少包含这个响应头）和请求之后已读到的数据，负责之后的收发和关闭
+using ConnectionTakeover = std::function<void(int fd, std::string unsent, std::string received)>;
+
 // HTTP响应结构
 struct HttpResponse {
     int statusCode = 200;
     std::map<std::string, std::string> headers;
     std::string body;
+    ConnectionTakeover takeover;        // 非空时只发响应头（不带 Content-Length、不压缩），之后交出连接
     
     void setJson(const std::string& json);
     void setHtml(const std::string& html);
     void setStatus(int code, const std::string& message = "");
     std::string toString() const;
+    // 状态行和各响应头（不含 Content-Length 和结束空行）
+    std::string head() const;
 };
 
+// 请求报文的读取进度：读到请求头结束后按 Content-Length 确定整个请求的长度
+struct RequestFrame {
+    static constexpr size_t kMaxHeaderSize = 64 * 1024;
+    static constexpr size_t kMaxBodySize = 32 * 1024 * 1024;     // 批量导入等上传的上限
+    
+    size_t headerEnd = std::string::npos;
+    size_t expected = 0;        // 请求头 + 请求体的总长度
+    bool tooLarge = false;
+    bool keepAlive = false;     // HTTP/1.1 未带 Connection: close，或 HTTP/1.0 带 keep-alive
+    
+    // raw 开头已是一个完整请求（或已判定过大）时返回 true
+    bool complete(const std::string& raw);
+    void reset() { *this = RequestFrame{}; }
+};
+
+// 连接与请求各阶段的超时：到期时关闭连接（读请求超时先回 408，处理函数超时先回 504）。
+// 每连接一线程模式下只有 header（从连接建立算起）和 body 生效，处理函数的执行时间由数据库语句超时约束
+struct ServerTimeouts {
+    std::chrono::milliseconds idle{60000};      // keep-alive 连接上两次请求之间
+    std::chrono::milliseconds header{10000};    // 从请求第一个字节（新连接从建立）到请求头结束
+    std::chrono::milliseconds body{30000};      // 请求头结束后读完请求体
+    std::chrono::milliseconds write{30000};     // 响应发不出去（对端不读）
+    std::chrono::milliseconds handler{30000};   // 异步处理函数挂起或排队等待准入名额
+};
+
+// 事件循环模式下的IO机制；io_uring 不可用时回退到 epoll
+enum class IoBackend { Epoll, IoUring };
+
+// 发出序列化好的响应；响应要求接管连接时 takeover 非空，由写方在响应之后交出连接
+using ResponseWriter = std::function<void(const std::string& response, ConnectionTakeover takeover)>;
+
 // 路由处理函数类型
 using RouteHandler = std::function<void(const HttpRequest&, HttpResponse&)>;
 
+// 协程处理函数：co_await 异步操作（如 AsyncDb）时挂起，事件循环线程继续处理其他连接，
+// 完成后在同一线程上恢复并发出响应
+using AsyncRouteHandler = std::function<Task<HttpResponse>(const HttpRequest&)>;
+
+// 中间件类型：在路由处理前执行，返回false表示已直接生成响应，不再继续处理
+using Middleware = std::function<bool(HttpRequest&, HttpResponse&)>;
+
 // 简单HTTP服务器
 class HttpServer {
 public:
@@ -53,25 +118,93 @@ public:
     void post(const std::string& path, RouteHandler handler);
     void put(const std::string& path, RouteHandler handler);
     void del(const std::string& path, RouteHandler handler);
+    void get(const std::string& path, AsyncRouteHandler handler);
+    void post(const std::string& path, AsyncRouteHandler handler);
+    void put(const std::string& path, AsyncRouteHandler handler);
+    void del(const std::string& path, AsyncRouteHandler handler);
+    
+    // 准入控制：已注册的、method（"*" 为任意）和路由模式前缀都匹配的路由归入 routeClass，
+    // 后设置的覆盖先设置的；routeClass 为 nullptr 表示不限制
+    void admit(const std::string& method, const std::string& pathPrefix, AdmissionController::RouteClass* routeClass);
+    
+    // 响应缓存（需先注册路由）：GET 路由 path 的 200 响应按路径参数和查询参数缓存序列化好的报文，
+    // 命中时不经过准入控制和处理函数；tables 为处理函数所读的表，任一表版本变化后条目失效。
+    // 只用于结果只取决于参数和这些表的路由（不随登录用户、时间变化）
+    void cache(const std::string& path, std::vector<Table> tables);
+    
+    // 注册中间件（按注册顺序执行）
+    void use(Middleware middleware);
     
     // 设置静态文件目录
     void setStaticDir(const std::string& dir);
     
-    // 启动服务器
+    // 事件循环模式：loops 个线程各自持有 SO_REUSEPORT 监听socket、epoll（或 io_uring）和连接表，
+    // 由内核分配新连接，支持 keep-alive；pinCpus 时第 i 个循环绑定到第 i 个可用CPU。
+    // loops 为 0（默认）时每个连接一个线程
+    void setEventLoops(int loops, bool pinCpus = false, IoBackend backend = IoBackend::Epoll);
+    
+    void setTimeouts(const ServerTimeouts& timeouts) { timeouts_ = timeouts; }
+    
+    // 响应压缩：请求带 Accept-Encoding 且响应为文本类、不小于 minSize 时以 gzip/deflate 发出
+    void setCompression(const CompressionOptions& options) { compression_ = options; }
+    
+    // 启动服务器（阻塞到 stop）
     void start();
     void stop();
     
+    // 请求解析与路由匹配不依赖服务器状态，静态公开便于基准测试单独调用
+    static HttpRequest parseRequest(const std::string& raw);
+    static bool matchRoute(const std::string& pattern, const std::string& path, HttpRequest& req);
+    // 读请求超时（408）或处理函数超时（504）时发出的响应，发出后关闭连接
+    static std::string timeoutResponse(int statusCode);
+    
 private:
+    friend class EventLoop;
+    
     int port_;
     int serverFd_;
+    int portLockFd_;                // 事件循环模式下按端口持有的文件锁，防止两个进程共用端口
     std::atomic<bool> running_;
     std::string staticDir_;
+    int loopCount_;
+    bool pinCpus_;
+    IoBackend ioBackend_;
+    ServerTimeouts timeouts_;
+    CompressionOptions compression_;
+    std::vector<std::unique_ptr<EventLoop>> loops_;
+    
+    // 路由表：method -> 路由模式 -> 处理函数及其指标
+    struct Route {
+        RouteHandler handler;
+        AsyncRouteHandler asyncHandler;     // 非空时代替 handler
+        RouteMetrics* metrics;
+        AdmissionController::RouteClass* admission = nullptr;
+        std::shared_ptr<const ResponseCache::Policy> cache = nullptr;  // 非空时启用响应缓存
+    };
+    std::map<std::string, std::map<std::string, Route>> routes_;
+    std::vector<Middleware> middlewares_;
+    
+    // 未注册路由的请求（CORS预检、静态文件、404）单独计数
+    RouteMetrics* optionsMetrics_;
+    RouteMetrics* staticMetrics_;
+    RouteMetrics* notFoundMetrics_;
+    
+    void addRoute(const std::string& method, const std::string& path, RouteHandler handler,
+                  AsyncRouteHandler asyncHandler = nullptr);
     
-    std::map<std::string, std::map<std::string, RouteHandler>> routes_;
+    void handleClient(int clientFd, std::chrono::steady_clock::time_point acceptedAt);
+    void runEventLoops();
     
-    void handleClient(int clientFd);
-    HttpRequest parseRequest(const std::string& raw);
-    bool matchRoute(const std::string& pattern, const std::string& path, HttpRequest& req);
+    // 处理一个完整的请求报文：中间件、路由、处理函数，响应序列化后交给 write 发出并记录指标。
+    // acceptedAt 为连接建立（keep-alive 连接上为请求开始到达）的时间，readStart 为开始读取的时间。
+    // 协程处理函数挂起时返回 false，之后 write 在当前线程的执行器上被调用。
+    // 响应要求接管连接时，写方不再从该连接读取后续请求，交出连接后也不再关闭它。
+    // closed 由连接在关闭时置位，排队等待准入名额的请求据此放弃执行
+    bool processRequest(const std::string& raw, const RequestFrame& frame,
+                        std::chrono::steady_clock::time_point acceptedAt,
+                        std::chrono::steady_clock::time_point readStart,
+                        ResponseWriter write,
+                        std::shared_ptr<const std::atomic<bool>> closed = nullptr);
     void serveStaticFile(const std::string& path, HttpResponse& res);
     std::string getMimeType(const std::string& path);
 };
@@ -0,0 +1,100 @@
+#ifndef IO_URING_LOOP_HPP
+#define IO_URING_LOOP_HPP
+
+#include "event_loop.hpp"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <atomic>
+#include <cstdint>
+#include <linux/time_types.h>
+
+// 基于 io_uring 的事件循环（直接使用 linux/io_uring.h 系统调用接口，不依赖 liburing）
+// 1. 每个循环一个提交/完成队列，accept、recv、send、close 都以 SQE 提交，每轮只调用一次 io_uring_enter
+//    同时完成批量提交和等待，空闲连接不占用任何系统调用
+// 2. 多次触发的 accept 和 recv（multishot），内核不支持 multishot recv 时退回单次 recv 并在完成后重新提交
+// 3. recv 的数据直接写入预先交给内核的接收缓冲（缓冲环，不支持时用 PROVIDE_BUFFERS），处理完立即归还，
+//    连接本身不预留读缓冲
+// 4. 同一连接同时只有一个 send 在途，其间产生的响应排在后面合并发送
+// 5. 连接超时由循环自己的时间轮管理，有定时器时挂一个 IORING_OP_TIMEOUT 按最近的到期时间唤醒
+class IoUringLoop : public EventLoop {
+public:
+    IoUringLoop(HttpServer& server, int index);
+    ~IoUringLoop() override;
+
+    // 检查内核是否支持所需功能（建环、缓冲环、各操作码），不支持时 reason 给出原因
+    static bool available(std::string& reason);
+
+    const char* backend() const override { return "io_uring"; }
+    bool listen(int port) override;
+    void run(int cpu) override;
+    void stop() override;
+    TimerWheel& timers() override { return wheel_; }
+
+private:
+    struct Ring;
+    enum class Op : uint8_t { Accept = 1, Recv, Send, Close, Cancel, Wake, Provide, Timeout };
+
+    struct Connection {
+        int fd = -1;
+        uint32_t id = 0;
+        std::string in;                 // 已收到未处理的数据
+        std::string out;                // 已生成、等待当前 send 完成后发送的响应
+        std::string sending;            // 在途 send 的数据（完成前不能改动）
+        size_t sendPos = 0;
+        RequestFrame frame;
+        Clock::time_point acceptedAt;
+        Clock::time_point readStart;
+        int pending = 0;                // 未完成的 SQE 数，关闭后归零才能释放
+        bool recvArmed = false;
+        bool sendInFlight = false;
+        bool closeAfterWrite = false;
+        bool peerClosed = false;
+        bool awaiting = false;          // 协程处理函数挂起中，等待它的响应
+        bool closing = false;
+        bool served = false;            // 已回复过请求（之后没有数据时按空闲计时）
+        TimeoutKind phase = TimeoutKind::Count;
+        TimerWheel::Timer timer;
+        std::shared_ptr<std::atomic<bool>> closed = std::make_shared<std::atomic<bool>>(false);
+        ConnectionTakeover takeover;    // 响应要求接管连接：停止收发，在途 SQE 都完成后交出
+        bool recvCancelled = false;
+    };
+
+    void armAccept();
+    void armRecv(Connection& conn);
+    void armWake();
+    // 时间轮上有定时器且没有在途的 TIMEOUT 时，按最近的到期时间提交一个
+    void armTimeout();
+    void startSend(Connection& conn);
+    void closeConnection(Connection& conn);
+    // 关闭中的连接在途 SQE 都完成后释放；待接管的连接此时交出
+    void releaseIfDone(Connection& conn);
+    // 待接管的连接：取消 recv 和定时器，等在途的 send 完成
+    void beginHandOff(Connection& conn);
+    // 把连接移出连接表（不关闭 socket），连同未发出和已收到的数据交给接管方
+    void handOff(Connection& conn);
+
+    void onAccept(int res, uint32_t flags);
+    void onRecv(Connection& conn, int res, uint32_t flags);
+    void onSend(Connection& conn, int res);
+    void processBuffered(Connection& conn);
+    void requestDone(Connection& conn);
+    // 请求 id 的响应（同步处理时在 processBuffered 内，异步时由执行器回调）
+    void deliver(uint32_t id, const std::string& response, ConnectionTakeover takeover);
+    // 按连接当前所处的阶段设置定时器（阶段不变时保留原截止时间）
+    void refreshTimer(Connection& conn);
+    void onTimeout(uint32_t id, TimeoutKind kind);
+
+    std::unique_ptr<Ring> ring_;
+    int listenFd_;
+    std::atomic<bool> running_;
+    bool multishotAccept_;
+    bool multishotRecv_;
+    uint32_t nextId_;
+    TimerWheel wheel_;
+    __kernel_timespec timeout_{};       // 在途 TIMEOUT 的等待时长（完成前不能改动）
+    bool timeoutArmed_ = false;
+    std::unordered_map<uint32_t, Connection> connections_;
+};
+
+#endif // IO_URING_LOOP_HPP
@@ -6,6 +6,7 @@
 #include <map>
 #include <sstream>
 #include <iomanip>
+#include <cstdint>
 
 // 简单JSON构建器
 class Json {
@@ -83,6 +84,60 @@ public:
         return array(items);
     }
     
+    static std::string escapeString(const std::string& s) {
+        std::ostringstream oss;
+        for (char c : s) {
+            switch (c) {
+                case '"': oss << "\\\""; break;
+                case '\\': oss << "\\\\"; break;
+                case '\b': oss << "\\b"; break;
+                case '\f': oss << "\\f"; break;
+                case '\n': oss << "\\n"; break;
+                case '\r': oss << "\\r"; break;
+                case '\t': oss << "\\t"; break;
+                default: oss << c;
+            }
+        }
+        return oss.str();
+    }
+    
+    // 读取 pos 处（指向开头的引号）的JSON字符串并解码转义，返回结束引号之后的位置，格式错误返回 npos
+    static size_t readString(const std::string& json, size_t pos, std::string& value) {
+        value.clear();
+        if (pos >= json.size() || json[pos] != '"') return std::string::npos;
+        for (size_t i = pos + 1; i < json.size(); i++) {
+            char c = json[i];
+            if (c == '"') return i + 1;
+            if (c != '\\' || i + 1 >= json.size()) {
+                value += c;
+                continue;
+            }
+            char e = json[++i];
+            switch (e) {
+                case 'n': value += '\n'; break;
+                case 'r': value += '\r'; break;
+                case 't': value += '\t'; break;
+                case 'b': value += '\b'; break;
+                case 'f': value += '\f'; break;
+                case 'u': {
+                    if (i + 4 >= json.size()) return std::string::npos;
+                    uint32_t cp = hex4(json, i + 1);
+                    i += 4;
+                    // 代理对
+                    if (cp >= 0xD800 && cp < 0xDC00 && i + 6 < json.size() && json[i + 1] == '\\' && json[i + 2] == 'u') {
+                        uint32_t low = hex4(json, i + 3);
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                    appendUtf8(value, cp);
+                    break;
+                }
+                default: value += e; break;     // \" \\ \/
+            }
+        }
+        return std::string::npos;
+    }
+    
     // 简单JSON解析（只支持简单对象）
     static std::map<std::string, std::string> parse(const std::string& json) {
         std::map<std::string, std::string> result;
@@ -131,21 +186,34 @@ public:
     }
     
 private:
-    static std::string escapeString(const std::string& s) {
-        std::ostringstream oss;
-        for (char c : s) {
-            switch (c) {
-                case '"': oss << "\\\""; break;
-                case '\\': oss << "\\\\"; break;
-                case '\b': oss << "\\b"; break;
-                case '\f': oss << "\\f"; break;
-                case '\n': oss << "\\n"; break;
-                case '\r': oss << "\\r"; break;
-                case '\t': oss << "\\t"; break;
-                default: oss << c;
-            }
+    static uint32_t hex4(const std::string& s, size_t pos) {
+        uint32_t cp = 0;
+        for (size_t i = pos; i < pos + 4; i++) {
+            char c = s[i];
+            cp <<= 4;
+            if (c >= '0' && c <= '9') cp |= c - '0';
+            else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+        }
+        return cp;
+    }
+    
+    static void appendUtf8(std::string& out, uint32_t cp) {
+        if (cp < 0x80) {
+            out += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            out += static_cast<char>(0xC0 | (cp >> 6));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += static_cast<char>(0xE0 | (cp >> 12));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (cp >> 18));
+            out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (cp & 0x3F));
         }
-        return oss.str();
     }
     
     static bool isNumber(const std::string& s) {
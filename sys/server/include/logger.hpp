@@ -0,0 +1,132 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdio>
+#include <cstdint>
+
+enum class LogLevel { Debug = 0, Info, Warn, Error, Off };
+
+// 异步日志
+// 调用线程只把定长记录写入本线程的无锁环形缓冲（单生产者单消费者），不加锁、不做IO；
+// 后台线程批量取出、格式化并写入文件，文件超过大小上限时轮转（server.log -> server.log.1 ...）
+// 缓冲写满时丢弃新记录并计数；每个级别可设置每秒条数上限，超出部分同样只计数
+// 未调用 start() 时同步写到 stderr，便于工具程序和启动早期使用
+class Logger {
+public:
+    static constexpr size_t kMessageSize = 480;     // 单条消息最大长度，超出截断
+    static constexpr size_t kRingSize = 256;        // 每个线程的缓冲记录数（2的幂）
+
+    static Logger& getInstance();
+
+    void setLevel(LogLevel level);
+    bool enabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    // 输出文件（为空时写 stderr），maxBytes 为单个文件上限，maxFiles 为保留的历史文件数
+    void setFile(const std::string& path, size_t maxBytes = 10 * 1024 * 1024, int maxFiles = 5);
+    // 每秒最多记录多少条该级别的日志，0 表示不限
+    void setRateLimit(LogLevel level, int perSecond);
+
+    void start();
+    void stop();        // 写完所有已提交的记录后停止
+    void flush();       // 等待当前已提交的记录全部写出
+
+    void log(LogLevel level, const char* format, ...) __attribute__((format(printf, 3, 4)));
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t suppressed() const { return suppressed_.load(std::memory_order_relaxed); }
+
+    static const char* levelName(LogLevel level);
+    static LogLevel parseLevel(const std::string& name);
+
+private:
+    Logger();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    struct Record {
+        int64_t timeNs;
+        uint32_t threadId;
+        uint16_t length;
+        uint8_t level;
+        char text[kMessageSize];
+    };
+
+    // head 由生产者推进，tail 由后台线程推进
+    struct Ring {
+        alignas(64) std::atomic<uint64_t> head{0};
+        alignas(64) std::atomic<uint64_t> tail{0};
+        Record records[kRingSize];
+    };
+
+    struct RateLimit {
+        std::atomic<int> perSecond{0};
+        std::atomic<int64_t> window{0};
+        std::atomic<int> count{0};
+    };
+
+    // 线程退出时把缓冲交还给空闲列表，供之后的线程复用
+    struct RingHolder {
+        Ring* ring = nullptr;
+        uint32_t threadId = 0;
+        ~RingHolder();
+    };
+
+    Ring* acquireRing();
+    void releaseRing(Ring* ring);
+    bool allow(LogLevel level, int64_t nowNs);
+
+    void run();
+    size_t drain(std::string& batch);
+    void write(const std::string& batch);
+    void openFile();
+    void rotate();
+    static void format(const Record& record, std::string& out);
+
+    std::atomic<int> level_;
+    RateLimit limits_[static_cast<int>(LogLevel::Off)];
+    std::atomic<uint64_t> dropped_;
+    std::atomic<uint64_t> suppressed_;
+    uint64_t reportedDropped_;
+    uint64_t reportedSuppressed_;
+
+    std::mutex ringsMutex_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+    std::vector<Ring*> freeRings_;
+
+    std::mutex mutex_;                  // 保护文件和后台线程状态
+    std::condition_variable wake_;
+    std::condition_variable flushed_;
+    std::thread worker_;
+    std::atomic<bool> running_;
+    uint64_t flushRequests_;
+    uint64_t flushDone_;
+
+    std::string path_;
+    size_t maxBytes_;
+    int maxFiles_;
+    FILE* file_;
+    size_t fileSize_;
+};
+
+#define LOG_AT(level, ...)                                                  \
+    do {                                                                    \
+        Logger& logger_ = Logger::getInstance();                            \
+        if (logger_.enabled(level)) logger_.log(level, __VA_ARGS__);        \
+    } while (0)
+
+#define LOG_DEBUG(...) LOG_AT(LogLevel::Debug, __VA_ARGS__)
+#define LOG_INFO(...)  LOG_AT(LogLevel::Info, __VA_ARGS__)
+#define LOG_WARN(...)  LOG_AT(LogLevel::Warn, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::Error, __VA_ARGS__)
+
+#endif // LOGGER_HPP
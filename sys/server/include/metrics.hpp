@@ -0,0 +1,184 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <string>
+#include <deque>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <cstdint>
+
+// 运行指标（Prometheus文本格式导出）
+// 计数按线程分片：线程首次记录时按顺序领取一个分片并一直使用（relaxed原子加，无锁），抓取时把所有分片合并，
+// 记录一次请求只需十几个纳秒。事件循环、工作线程池等常驻线程不超过分片数时各用各的分片、没有竞争；
+// 每连接一线程模式下每个连接线程都领取下一个分片，同时在线的连接线程可能共用分片，只是多一些缓存行争用
+constexpr int kMetricShards = 32;
+
+// 直方图桶上界（纳秒），最后一个桶为 +Inf
+constexpr std::array<uint64_t, 16> kLatencyBounds = {
+    100000ULL, 250000ULL, 500000ULL,                    // 0.1ms 0.25ms 0.5ms
+    1000000ULL, 2500000ULL, 5000000ULL,                 // 1ms 2.5ms 5ms
+    10000000ULL, 25000000ULL, 50000000ULL,              // 10ms 25ms 50ms
+    100000000ULL, 250000000ULL, 500000000ULL,           // 100ms 250ms 500ms
+    1000000000ULL, 2500000000ULL, 5000000000ULL,        // 1s 2.5s 5s
+    10000000000ULL,                                     // 10s
+};
+constexpr int kLatencyBuckets = static_cast<int>(kLatencyBounds.size()) + 1;
+
+// 当前线程使用的分片下标
+int metricShardIndex();
+
+// 单个分片内的直方图计数
+struct HistogramCells {
+    std::atomic<uint64_t> buckets[kLatencyBuckets] = {};
+    std::atomic<uint64_t> sumNanos{0};
+
+    void observe(uint64_t nanos) {
+        int i = 0;
+        while (i < kLatencyBuckets - 1 && nanos > kLatencyBounds[i]) i++;
+        buckets[i].fetch_add(1, std::memory_order_relaxed);
+        sumNanos.fetch_add(nanos, std::memory_order_relaxed);
+    }
+};
+
+// 合并后的直方图快照（各桶为非累计值）
+struct HistogramSnapshot {
+    std::array<uint64_t, kLatencyBuckets> buckets{};
+    uint64_t count = 0;
+    uint64_t sumNanos = 0;
+
+    void add(const HistogramCells& cells);
+};
+
+// 独立使用的分片直方图
+class Histogram {
+public:
+    void observe(uint64_t nanos) { shards_[metricShardIndex()].cells.observe(nanos); }
+    HistogramSnapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        HistogramCells cells;
+    };
+    Shard shards_[kMetricShards];
+};
+
+// 独立使用的分片计数器
+class Counter {
+public:
+    void add(uint64_t n = 1) { shards_[metricShardIndex()].value.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<uint64_t> value{0};
+    };
+    Shard shards_[kMetricShards];
+};
+
+// 单个路由的指标（按 method + 路由模式区分）
+class RouteMetrics {
+public:
+    RouteMetrics(const std::string& method, const std::string& pattern);
+
+    void record(int statusCode, uint64_t bytesIn, uint64_t bytesOut, uint64_t nanos) {
+        Shard& shard = shards_[metricShardIndex()];
+        int statusClass = statusCode / 100 - 1;
+        if (statusClass < 0 || statusClass > 4) statusClass = 4;
+        shard.status[statusClass].fetch_add(1, std::memory_order_relaxed);
+        shard.bytesIn.fetch_add(bytesIn, std::memory_order_relaxed);
+        shard.bytesOut.fetch_add(bytesOut, std::memory_order_relaxed);
+        shard.latency.observe(nanos);
+    }
+
+    const std::string& method() const { return method_; }
+    const std::string& pattern() const { return pattern_; }
+
+    struct Snapshot {
+        std::array<uint64_t, 5> status{};   // 1xx .. 5xx
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        HistogramSnapshot latency;
+    };
+    Snapshot snapshot() const;
+
+private:
+    struct alignas(64) Shard {
+        HistogramCells latency;
+        std::atomic<uint64_t> status[5] = {};
+        std::atomic<uint64_t> bytesIn{0};
+        std::atomic<uint64_t> bytesOut{0};
+    };
+
+    std::string method_;
+    std::string pattern_;
+    Shard shards_[kMetricShards];
+};
+
+// 数据库语句类型
+enum class StatementKind { Select, Insert, Update, Delete, Other, Count };
+
+// 网络IO系统调用类型（用于比较不同并发模式下每个请求的系统调用次数）
+enum class IoSyscall { Accept, Recv, Send, Close, Wait, Control, Thread, Enter, Count };
+
+// 超时类型
+enum class TimeoutKind { Idle, Header, Body, Write, Handler, DbCheckout, DbStatement, Count };
+
+// 指标注册表
+class Metrics {
+public:
+    static Metrics& getInstance();
+
+    static StatementKind statementKind(const std::string& sql);
+    static const char* statementKindName(StatementKind kind);
+    static const char* ioSyscallName(IoSyscall call);
+    static const char* timeoutKindName(TimeoutKind kind);
+
+    // 注册路由指标（同一 method + pattern 返回同一对象，地址在进程内保持不变）
+    RouteMetrics* route(const std::string& method, const std::string& pattern);
+
+    // 数据库：等待连接（锁）的时间，以及按语句类型统计的执行时间
+    void recordDbWait(uint64_t nanos) { dbWait_.observe(nanos); }
+    void recordDbQuery(StatementKind kind, uint64_t nanos) {
+        dbQuery_[static_cast<int>(kind)].observe(nanos);
+    }
+
+    // 服务器网络IO的系统调用次数，以及当前使用的IO模式
+    void recordSyscall(IoSyscall call, uint64_t n = 1) { syscalls_[static_cast<int>(call)].add(n); }
+    uint64_t syscallTotal() const;
+    void setIoBackend(const std::string& backend, int loops);
+
+    // 连接、请求和数据库各阶段的超时次数
+    void recordTimeout(TimeoutKind kind) { timeouts_[static_cast<int>(kind)].add(); }
+
+    // 响应压缩：压缩前后的字节数和耗时
+    void recordCompression(uint64_t bytesIn, uint64_t bytesOut, uint64_t nanos) {
+        compressed_.add();
+        compressionIn_.add(bytesIn);
+        compressionOut_.add(bytesOut);
+        compressionNanos_.add(nanos);
+    }
+
+    // 生成Prometheus文本格式
+    std::string render() const;
+
+private:
+    Metrics() = default;
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    mutable std::mutex mutex_;              // 只保护路由表的增删，不在记录路径上
+    std::deque<RouteMetrics> routes_;
+    Histogram dbWait_;
+    Histogram dbQuery_[static_cast<int>(StatementKind::Count)];
+    Counter syscalls_[static_cast<int>(IoSyscall::Count)];
+    Counter timeouts_[static_cast<int>(TimeoutKind::Count)];
+    Counter compressed_;
+    Counter compressionIn_;
+    Counter compressionOut_;
+    Counter compressionNanos_;
+    std::string ioBackend_ = "threads";     // 受 mutex_ 保护
+    int ioLoops_ = 0;
+};
+
+#endif // METRICS_HPP
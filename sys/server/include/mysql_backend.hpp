@@ -0,0 +1,56 @@
+#ifndef MYSQL_BACKEND_HPP
+#define MYSQL_BACKEND_HPP
+
+#include "db_backend.hpp"
+#include <mysql.h>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// MySQL 后端（libmysqlclient），断线时按保存的参数重连
+class MysqlBackend : public DbBackend {
+public:
+    MysqlBackend(const std::string& host, const std::string& user,
+                 const std::string& password, const std::string& database,
+                 unsigned int port = 3306);
+    ~MysqlBackend() override;
+
+    MysqlBackend(const MysqlBackend&) = delete;
+    MysqlBackend& operator=(const MysqlBackend&) = delete;
+
+    const char* name() const override { return "mysql"; }
+
+    bool connect() override;
+    void disconnect() override;
+    bool ping() override;
+    bool ensureConnected() override;
+
+    bool run(const std::string& sql, DbResult* result, StatementTiming& timing) override;
+
+    unsigned long long lastInsertId() const override;
+    unsigned long long affectedRows() const override;
+
+    std::string escape(const std::string& str) override;
+    std::string error() const override;
+    std::string explainPrefix() const override { return "EXPLAIN "; }
+    // 另开一条短连接执行 KILL QUERY（执行中的连接不能再发命令）；连上时超时的语句已结束则放弃
+    void interrupt() override;
+
+private:
+    void setOptions();
+
+    MYSQL* conn_;
+    bool connected_;
+    std::atomic<unsigned long> threadId_{0};    // 当前连接在服务端的线程号，供 interrupt 使用
+    // 语句序号：每条语句开始和结束各加 1，奇数表示有语句在执行。KILL 线程可能晚于连接对象结束，共享持有
+    std::shared_ptr<std::atomic<uint64_t>> statements_ = std::make_shared<std::atomic<uint64_t>>(0);
+
+    // 保存连接参数用于重连
+    std::string host_;
+    std::string user_;
+    std::string password_;
+    std::string database_;
+    unsigned int port_;
+};
+
+#endif // MYSQL_BACKEND_HPP
@@ -0,0 +1,59 @@
+#ifndef PAGINATION_HPP
+#define PAGINATION_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+
+// 列表字段：输出名 -> SQL表达式
+struct ListField {
+    std::string name;
+    std::string expr;
+};
+
+// 排序键（最后一个键必须唯一，保证游标可以精确续接）
+struct SortKey {
+    std::string name;       // 结果中的列名
+    std::string expr;       // SQL表达式
+    bool desc = false;
+    bool numeric = false;   // 数值列的游标值只允许数字
+};
+
+// 游标分页（keyset pagination）+ 字段投影
+// 参数: limit=每页条数  cursor=上一页响应头 X-Next-Cursor 中的值  fields=逗号分隔的字段名
+// 下一页从上一页最后一行的排序键继续，不使用OFFSET，翻到第几页的代价都一样。
+// limit 和 cursor 都没有时不分页，返回全部结果（不了解游标的旧客户端不会被截断）
+class KeysetPage {
+public:
+    static constexpr int kDefaultLimit = 500;     // 只带 cursor 时的每页条数
+    static constexpr int kMaxLimit = 1000;
+
+    KeysetPage(std::vector<ListField> fields, std::vector<SortKey> sortKeys);
+
+    // 解析请求参数，参数非法时返回false并给出错误信息
+    bool parse(const std::map<std::string, std::string>& params, std::string& error);
+
+    // "SELECT" 之后的列清单（请求字段 + 游标需要的排序键）
+    std::string selectList() const;
+    // 续接条件（以 " AND " 开头，第一页为空串）
+    std::string cursorCondition() const;
+    // " ORDER BY ... LIMIT n+1"（不分页时没有 LIMIT）
+    std::string orderAndLimit() const;
+
+    // 把查询结果转为JSON数组（只含请求的字段），有下一页时nextCursor非空
+    std::string toJson(const std::vector<std::map<std::string, std::string>>& rows, std::string& nextCursor) const;
+
+    int limit() const { return limit_; }     // 0 表示不分页
+
+private:
+    static std::string encodeCursor(const std::vector<std::string>& values);
+    static bool decodeCursor(const std::string& cursor, std::vector<std::string>& values);
+
+    std::vector<ListField> fields_;
+    std::vector<SortKey> sortKeys_;
+    std::vector<const ListField*> selected_;
+    std::vector<std::string> cursorValues_;
+    int limit_;
+};
+
+#endif // PAGINATION_HPP
@@ -0,0 +1,66 @@
+#ifndef PASSWORD_HASHER_HPP
+#define PASSWORD_HASHER_HPP
+
+#include <string>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+// SHA-256 摘要
+class Sha256 {
+public:
+    static constexpr size_t kDigestSize = 32;
+    static constexpr size_t kBlockSize = 64;
+    using Digest = std::array<uint8_t, kDigestSize>;
+
+    Sha256();
+    void update(const void* data, size_t len);
+    Digest finish();
+
+    static Digest hash(const std::string& data);
+
+private:
+    friend class HmacSha256;
+    void transform(const uint8_t* block);
+
+    uint32_t state_[8];
+    uint8_t buffer_[kBlockSize];
+    uint64_t totalLen_;
+    size_t bufferLen_;
+};
+
+// HMAC-SHA256，内外两层的初始状态只计算一次，PBKDF2迭代时复用
+class HmacSha256 {
+public:
+    explicit HmacSha256(const std::string& key);
+    Sha256::Digest compute(const void* data, size_t len) const;
+
+private:
+    Sha256 inner_;
+    Sha256 outer_;
+};
+
+// 密码哈希（PBKDF2-HMAC-SHA256，带随机盐，迭代次数可调）
+// 存储格式: pbkdf2_sha256$<迭代次数>$<盐hex>$<哈希hex>
+// 兼容旧数据：64位hex视为 SHA2(password, 256)，校验通过后应重新哈希
+class PasswordHasher {
+public:
+    static constexpr int kDefaultIterations = 50000;
+
+    static std::string hash(const std::string& password, int iterations = kDefaultIterations);
+
+    // needsRehash: 校验通过但存储格式过旧或迭代次数与期望不符
+    static bool verify(const std::string& password, const std::string& stored,
+                       int expectedIterations, bool& needsRehash);
+
+    static Sha256::Digest pbkdf2(const std::string& password, const std::string& salt, int iterations);
+
+    static std::string toHex(const uint8_t* data, size_t len);
+    static std::string fromHex(const std::string& hex);
+    static std::string randomBytes(size_t len);
+
+    // 定长比较，避免时序泄露
+    static bool constantTimeEquals(const std::string& a, const std::string& b);
+};
+
+#endif // PASSWORD_HASHER_HPP
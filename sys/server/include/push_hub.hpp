@@ -0,0 +1,156 @@
+#ifndef PUSH_HUB_HPP
+#define PUSH_HUB_HPP
+
+#include "http_server.hpp"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 变更推送：客户端以 SSE（text/event-stream）或 WebSocket 订阅主题，写操作成功后按主题发布事件，客户端不必轮询。
+// 订阅连接由 HttpServer 交出（ConnectionTakeover），全部挂在推送线程的一个 epoll 上，
+// 空闲的订阅者只占一个 socket 和几百字节，不占线程；每个主题维护自己的订阅者列表。
+// 发布方只把事件放进队列（加锁 O(1)），由推送线程按协议各格式化一次后追加到各订阅者的发送缓冲并发出。
+// 发送缓冲积压超过 coalesceBytes 的慢消费者不再追加，积压期间每个合并键（默认为主题）只保留最新一条，发完积压后补发：
+// 事件只表示"该主题（或该对象）有变化"，客户端收到后重新拉取或原地更新，合并掉中间的事件不影响结果。
+// WebSocket 连接上推送线程解析客户端帧：回应 ping、完成关闭握手，客户端发来的数据消息忽略；
+// 空闲时定期发 ping，收不到任何帧的连接超时断开
+class PushHub {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Options {
+        size_t maxSubscribers = 10000;
+        size_t coalesceBytes = 64 * 1024;
+        int sendBuffer = 64 * 1024;                 // 订阅连接的 SO_SNDBUF：限制每个慢消费者在内核里积压的旧事件
+        std::chrono::seconds heartbeat{20};         // 空闲连接定期发注释行（WebSocket 为 ping），防止代理或客户端判定超时
+        std::chrono::seconds stallTimeout{60};      // 有积压且这么久没有任何进展时断开
+        std::chrono::seconds receiveTimeout{60};    // WebSocket 连接这么久没收到任何帧（包括 pong）时断开
+    };
+
+    enum class Protocol { EventStream, WebSocket };
+
+    static PushHub& getInstance();
+
+    // start 之前调用
+    void configure(const Options& options) { options_ = options; }
+    bool start();
+    void stop();
+
+    // 在处理函数中调用：设置 SSE 响应头并接管连接，之后订阅 topics（"*" 为全部主题）；
+    // 推送未启动或订阅者已满时改为 503（并发建立的连接可能略超上限）
+    void acceptEventStream(HttpResponse& res, std::vector<std::string> topics);
+    // 同上，完成 WebSocket 握手（101）后接管连接；binary 为 true 时事件带二进制负载的以二进制帧发送。
+    // 不是合法的升级请求时回 426
+    void acceptWebSocket(const HttpRequest& req, HttpResponse& res, std::vector<std::string> topics, bool binary);
+
+    // 发布事件，可在任意线程调用；推送未启动时忽略。
+    // data 为 JSON：SSE 作为事件数据，WebSocket 文本帧为 {"topic", "id", "data"}；
+    // binary 非空时，以二进制帧订阅的 WebSocket 连接收到的是它；
+    // key 为慢消费者合并事件的键（空为主题），同一主题下各对象的增量用不同的键才不会互相覆盖
+    void publish(const std::string& topic, const std::string& data, const std::string& binary = "",
+                 const std::string& key = "");
+
+    // Prometheus文本格式的推送状态
+    std::string render() const;
+
+    ~PushHub();
+    PushHub(const PushHub&) = delete;
+    PushHub& operator=(const PushHub&) = delete;
+
+private:
+    struct Subscriber {
+        int fd = -1;
+        Protocol protocol = Protocol::EventStream;
+        bool binary = false;                                // WebSocket：优先发二进制帧
+        std::vector<std::string> topics;
+        std::string out;                                    // 发送队列（完整的事件和控制帧）
+        size_t outPos = 0;
+        std::unordered_map<std::string, std::string> coalesced;    // 积压期间各合并键最新的事件
+        bool writing = false;                               // 已注册 EPOLLOUT
+        bool closing = false;                               // 已排入关闭帧：发完即断开，不再追加事件
+        Clock::time_point lastProgress;
+        // WebSocket 接收状态
+        std::string in;                                     // 未解析完的帧
+        std::string message;                                // 分片消息已收到的部分
+        bool assembling = false;
+        Clock::time_point lastReceived;
+    };
+
+    struct Adoption {
+        int fd;
+        Protocol protocol;
+        bool binary;
+        std::string unsent;
+        std::string received;
+        std::vector<std::string> topics;
+    };
+
+    struct Event {
+        std::string topic;
+        std::string data;
+        std::string binary;
+        std::string key;
+    };
+
+    PushHub() = default;
+
+    // 推送未启动或订阅者已满时写入 503 并返回 false
+    bool admit(HttpResponse& res);
+    // 由连接交出时的线程调用：放进队列，由推送线程接管
+    void adopt(Adoption adoption);
+
+    // 以下只在推送线程上调用
+    void run();
+    void takeInbound();
+    void fanOut(const Event& event);
+    void enqueue(Subscriber& subscriber, const std::string& key, const std::string& frame);
+    // 排入控制帧（不受积压限制）
+    void enqueueControl(Subscriber& subscriber, const std::string& frame);
+    // 读取并处理客户端数据；连接已断开或协议出错需要立即关闭时返回 false
+    bool onReadable(Subscriber& subscriber);
+    void processFrames(Subscriber& subscriber);
+    // 排入关闭帧，发完后断开
+    void closeWebSocket(Subscriber& subscriber, uint16_t code);
+    // 尽量发出积压的数据；连接出错时返回 false（调用方移除）
+    bool flush(Subscriber& subscriber);
+    void setWriting(Subscriber& subscriber, bool writing);
+    void heartbeat(Clock::time_point now);
+    void remove(int fd);
+
+    Options options_;
+    int epollFd_ = -1;
+    int wakeFd_ = -1;                                       // eventfd
+    std::atomic<bool> running_{false};
+    std::thread thread_;
+
+    // 发布方和交出连接的线程写入，推送线程取走
+    std::mutex mutex_;
+    std::vector<Adoption> adoptions_;
+    std::vector<Event> events_;
+
+    // 推送线程独占
+    std::unordered_map<int, std::unique_ptr<Subscriber>> subscribers_;
+    std::unordered_map<std::string, std::vector<Subscriber*>> topics_;
+    std::vector<int> dirty_;                                // 本轮追加过数据的订阅者
+    uint64_t sequence_ = 0;                                 // SSE 事件 id
+    Clock::time_point nextHeartbeat_;
+
+    std::atomic<size_t> subscriberCount_{0};                // 含已交出、推送线程尚未取走的
+    std::atomic<size_t> webSocketCount_{0};
+    std::atomic<uint64_t> accepted_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> published_{0};
+    std::atomic<uint64_t> delivered_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> stalled_{0};
+    std::atomic<uint64_t> timedOut_{0};
+    std::atomic<uint64_t> framesReceived_{0};
+};
+
+#endif // PUSH_HUB_HPP
@@ -0,0 +1,97 @@
+#ifndef QUERY_STATS_HPP
+#define QUERY_STATS_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <array>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// 单条语句各阶段耗时（纳秒）
+struct StatementTiming {
+    uint64_t waitNs = 0;        // 等待数据库连接（锁）
+    uint64_t execNs = 0;        // mysql_query
+    uint64_t fetchNs = 0;       // mysql_store_result
+    uint64_t convertNs = 0;     // 结果转换为 DbResult
+    uint64_t rows = 0;
+
+    uint64_t totalNs() const { return execNs + fetchNs + convertNs; }
+};
+
+// SQL语句统计与慢查询日志
+// 语句先归一化为指纹（字符串/数字字面量替换为 ?，IN 列表折叠，空白合并），按指纹累计
+// 次数、总耗时、各阶段耗时、行数以及耗时分布（对数分桶，用于估算 p50/p99）；
+// 执行时间超过阈值的语句连同 EXPLAIN 结果记入慢查询日志（内存中保留最近若干条，同时写入日志文件）
+class QueryStats {
+public:
+    static QueryStats& getInstance();
+
+    static std::string fingerprint(const std::string& sql);
+
+    // 慢查询阈值（毫秒），0 表示关闭慢查询日志
+    void setSlowThresholdMs(int ms);
+    bool isSlow(const StatementTiming& timing) const;
+    // 同一指纹每分钟最多捕获一次 EXPLAIN，避免慢语句集中出现时反复执行
+    bool shouldExplain(const std::string& fingerprint);
+
+    void record(const std::string& fingerprint, const std::string& sql, const StatementTiming& timing);
+    void recordSlow(const std::string& fingerprint, const std::string& sql, const StatementTiming& timing,
+                    const std::string& explainJson);
+
+    // 按指纹汇总，sort: total / count / p99 / avg / rows
+    std::string statsJson(const std::string& sort, size_t limit) const;
+    // 最近的慢查询（新的在前）
+    std::string slowJson(size_t limit) const;
+    void reset();
+
+private:
+    QueryStats();
+    QueryStats(const QueryStats&) = delete;
+    QueryStats& operator=(const QueryStats&) = delete;
+
+    // 对数分桶：1us ~ 约 19 小时，每个二次幂区间再分 8 段，相对误差约 12%
+    static constexpr int kLinearBuckets = 16;
+    static constexpr int kSubBuckets = 8;
+    static constexpr int kBuckets = kLinearBuckets + 32 * kSubBuckets;
+    static int bucketOf(uint64_t micros);
+    static uint64_t bucketValue(int bucket);
+
+    struct Entry {
+        std::string fingerprint;
+        std::string sample;         // 第一次出现时的原始语句（截断）
+        uint64_t count = 0;
+        uint64_t slowCount = 0;
+        uint64_t rows = 0;
+        uint64_t totalNs = 0;
+        uint64_t waitNs = 0;
+        uint64_t execNs = 0;
+        uint64_t fetchNs = 0;
+        uint64_t convertNs = 0;
+        uint64_t maxNs = 0;
+        std::array<uint32_t, kBuckets> buckets{};
+
+        uint64_t percentileNs(double p) const;
+    };
+
+    struct SlowEntry {
+        int64_t time;               // unix 时间（秒）
+        std::string fingerprint;
+        std::string sql;
+        StatementTiming timing;
+        std::string explain;        // JSON数组
+    };
+
+    static constexpr size_t kMaxFingerprints = 2000;   // 超出后新指纹归入 "<other>"
+    static constexpr size_t kMaxSlowEntries = 200;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Entry> entries_;
+    std::deque<SlowEntry> slow_;
+    std::unordered_map<std::string, int64_t> lastExplain_;
+    std::atomic<uint64_t> slowThresholdNs_;
+};
+
+#endif // QUERY_STATS_HPP
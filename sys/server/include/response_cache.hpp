@@ -0,0 +1,120 @@
+#ifndef RESPONSE_CACHE_HPP
+#define RESPONSE_CACHE_HPP
+
+#include "table_versions.hpp"
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <atomic>
+#include <cstdint>
+
+struct HttpRequest;
+
+// 响应缓存：按路由开启，缓存序列化好的完整响应报文（含状态行、响应头，已按协商的编码压缩），命中时原样发出。
+// - 键为路由模式 + 路径参数 + 排序后的查询参数 + 变体（内容编码、是否保持连接、HTTP 版本）
+// - 每个条目记下计算前所读表的版本，取用时任一表版本变化即失效（写接口递增版本，不需要逐条清除）
+// - 分段 LRU：新条目进试用段，再次命中才进保护段（占总量的 80%），
+//   一次性扫描大量不同参数只会挤掉试用段里的条目，不冲掉反复命中的热点
+// - 同一键上并发的未命中只由第一个请求计算，其余请求等它的结果
+class ResponseCache {
+public:
+    struct Options {
+        bool enabled = true;
+        size_t maxBytes = 64 * 1024 * 1024;
+        size_t maxEntryBytes = 1024 * 1024;     // 更大的响应不缓存
+    };
+
+    // 一个路由的缓存策略
+    struct Policy {
+        std::string pattern;
+        std::vector<Table> tables;
+    };
+
+    using Buffer = std::shared_ptr<const std::string>;
+
+    // 可共用的结果：完整响应报文及其校验头（用于回答条件请求）
+    struct Shared {
+        Buffer buffer;                  // 为空表示没有可共用的结果（计算失败、非 200 或期间数据有变），需自行计算
+        std::string etag;
+        std::string cacheControl;
+    };
+    // 等待同一键上正在进行的计算，在计算方的线程上调用
+    using Waiter = std::function<void(const Shared& shared)>;
+
+    // 未命中时交给计算方：计算完成调用 complete，未调用就析构时视为放弃，等待者各自计算
+    class Ticket {
+    public:
+        Ticket() = default;
+        Ticket(Ticket&& other) noexcept { *this = std::move(other); }
+        Ticket& operator=(Ticket&& other) noexcept;
+        ~Ticket();
+        explicit operator bool() const { return cache_ != nullptr; }
+
+    private:
+        friend class ResponseCache;
+        ResponseCache* cache_ = nullptr;
+        std::string key_;
+        const Policy* policy_ = nullptr;
+        std::vector<uint64_t> versions_;
+    };
+
+    enum class Result { Hit, Miss, Pending };
+
+    static ResponseCache& getInstance();
+
+    void configure(const Options& options) { options_ = options; }
+    bool enabled() const { return options_.enabled && options_.maxBytes > 0; }
+
+    static std::string makeKey(const Policy& policy, const HttpRequest& req, const std::string& variant);
+
+    // Hit：shared 为缓存的结果；Miss：由调用方计算，ticket 有效；Pending：已有请求在计算，结果交给 waiter
+    Result lookup(const Policy& policy, const std::string& key, Shared& shared, Ticket& ticket, Waiter waiter);
+    // 计算完成：200 响应存入缓存并交给等待者
+    void complete(Ticket& ticket, Shared shared);
+
+    // Prometheus文本格式的缓存状态
+    std::string render() const;
+
+    ResponseCache(const ResponseCache&) = delete;
+    ResponseCache& operator=(const ResponseCache&) = delete;
+
+private:
+    struct Entry {
+        std::string key;
+        Shared shared;
+        std::vector<uint64_t> versions;
+        size_t bytes;
+        bool isProtected = false;
+    };
+    using EntryList = std::list<Entry>;
+
+    ResponseCache() = default;
+
+    static std::vector<uint64_t> snapshot(const Policy& policy);
+    // 以下在持有 mutex_ 时调用
+    void insert(Entry entry);
+    void erase(std::unordered_map<std::string, EntryList::iterator>::iterator it);
+    void promote(EntryList::iterator it);
+
+    Options options_;
+    mutable std::mutex mutex_;
+    EntryList probation_;
+    EntryList protected_;
+    std::unordered_map<std::string, EntryList::iterator> entries_;
+    std::unordered_map<std::string, std::vector<Waiter>> inflight_;
+    size_t bytes_ = 0;
+    size_t protectedBytes_ = 0;
+
+    std::atomic<uint64_t> hits_{0};
+    std::atomic<uint64_t> misses_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> stale_{0};
+    std::atomic<uint64_t> evictions_{0};
+    std::atomic<uint64_t> stores_{0};
+};
+
+#endif // RESPONSE_CACHE_HPP
@@ -0,0 +1,71 @@
+#ifndef SCHEDULE_IMPORT_HPP
+#define SCHEDULE_IMPORT_HPP
+
+#include <string>
+#include <vector>
+
+// 导入的一条排课及其结果
+struct ScheduleImportLine {
+    // 与之冲突的已有排课（scheduleId）或本批中更早的条目（line）
+    struct Conflict {
+        const char* resource;   // classroom / teacher / class
+        int scheduleId = 0;
+        int line = 0;
+    };
+
+    int line = 0;               // CSV为行号（含表头），JSON为数组下标 + 1
+    int courseId = 0;
+    int classroomId = 0;
+    int teacherId = 0;
+    int classId = 0;            // 0 表示不指定班级
+    std::string semester;
+    int weekday = 0;
+    int startSection = 0;
+    int endSection = 0;
+    int startWeek = 0;
+    int endWeek = 0;
+    std::string weekType = "all";
+    std::string remark;
+    std::string status;         // created / valid（试运行）/ conflict / invalid / failed
+    std::string error;
+    std::vector<Conflict> conflicts;
+};
+
+// 批量排课导入（POST /api/schedules/batch）
+// 请求体为JSON数组（或 {"schedules": [...]}），或带表头的CSV（text/csv），字段同 POST /api/schedules
+// 1. 课程、教室、教师、班级是否存在各用一次 IN 查询校验
+// 2. 一次查出所涉学期的全部排课，按 教室/教师/班级 建立 周×星期×节次 的占用位图（区分单双周）
+// 3. 按提交顺序逐条与位图求交：无冲突的条目占用时段，冲突的条目列出全部冲突对象，不占用时段
+// 4. 有效条目以多行 INSERT 在一个事务中写入；导入过程互斥执行，避免两批之间互相冲突
+class ScheduleImport {
+public:
+    static constexpr size_t kBatchSize = 1000;
+    static constexpr size_t kMaxLines = 20000;
+
+    enum class Result {
+        Ok,
+        BadFormat,  // 请求体无法解析
+        TooLarge,   // 超过 kMaxLines 条
+        DbError     // 写入失败，已回滚
+    };
+
+    struct Report {
+        int created = 0;
+        int failed = 0;
+        bool dryRun = false;
+        std::vector<ScheduleImportLine> lines;
+
+        // {"success": n, "failed": n, "dry_run": b, "results": [{"line", "status", "error", "conflicts"}, ...]}
+        std::string toJson() const;
+        // 成功写入的条目涉及的课程（用于刷新内存课表）
+        std::vector<int> createdCourseIds() const;
+    };
+
+    // 解析并校验字段，不访问数据库；格式错误的条目 status 为 invalid，整体无法解析时返回 false
+    static bool parse(const std::string& body, const std::string& contentType, std::vector<ScheduleImportLine>& lines);
+
+    // dryRun 为 true 时只校验，不写入
+    static Result run(const std::string& body, const std::string& contentType, bool dryRun, Report& report);
+};
+
+#endif // SCHEDULE_IMPORT_HPP
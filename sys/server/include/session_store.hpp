@@ -0,0 +1,105 @@
+#ifndef SESSION_STORE_HPP
+#define SESSION_STORE_HPP
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+
+// 会话信息
+struct Session {
+    int userId = 0;
+    std::string username;
+    std::string role;
+    std::string realName;
+    int64_t expiresAt = 0;     // 过期时间（秒，Unix时间戳），每次访问后顺延
+};
+
+// 内存会话存储
+// - token为32字节随机数的十六进制串
+// - 按token哈希分片，每个分片独立加锁，鉴权只需一次哈希查找
+// - 滑动过期：访问时只更新expiresAt（按时间轮精度顺延），由时间轮定期清理
+// - 可选持久化到文件，重启后恢复未过期的会话
+class SessionStore {
+public:
+    static SessionStore& getInstance();
+
+    // 配置（需在start之前调用）
+    void setTtl(int seconds);
+    void setPersistFile(const std::string& path);
+
+    // 启动/停止后台清理线程（停止时会落盘）
+    void start();
+    void stop();
+
+    // 创建会话，返回token
+    std::string create(int userId, const std::string& username,
+                       const std::string& role, const std::string& realName);
+
+    // 校验token，成功时顺延过期时间并填充session
+    bool validate(const std::string& token, Session& session);
+
+    // 注销
+    void remove(const std::string& token);
+
+    // 注销某用户的全部会话（如重置密码、删除用户）
+    void removeUser(int userId);
+
+    size_t size() const;
+
+    // 持久化
+    bool save() const;
+    bool load();
+
+private:
+    SessionStore();
+    ~SessionStore();
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+
+    static constexpr size_t kShardCount = 16;
+    static constexpr size_t kWheelSlots = 512;
+
+    // 时间轮槽位中的条目，rounds表示还需转几圈才到期
+    struct WheelEntry {
+        std::string token;
+        uint32_t rounds;
+    };
+
+    struct Shard {
+        mutable std::mutex mutex;
+        std::unordered_map<std::string, Session> sessions;
+        std::vector<std::vector<WheelEntry>> wheel;
+    };
+
+    Shard& shardFor(const std::string& token);
+    const Shard& shardFor(const std::string& token) const;
+
+    // 将token挂到时间轮上（调用前需持有分片锁）
+    void schedule(Shard& shard, const std::string& token, int64_t expiresAt);
+    // 推进一格时间轮，清理到期会话
+    void advance();
+    void sweepLoop();
+
+    static std::string generateToken();
+    static int64_t now();
+
+    Shard shards_[kShardCount];
+
+    int ttl_;                  // 会话有效期（秒）
+    int tickSeconds_;          // 时间轮每格的时长
+    std::atomic<size_t> cursor_;
+    std::string persistFile_;
+    mutable std::atomic<bool> dirty_;   // 自上次落盘后是否有变更
+
+    std::thread sweeper_;
+    std::atomic<bool> running_;
+    std::mutex sweepMutex_;
+    std::condition_variable sweepCv_;
+};
+
+#endif // SESSION_STORE_HPP
@@ -0,0 +1,55 @@
+#ifndef SQLITE_BACKEND_HPP
+#define SQLITE_BACKEND_HPP
+
+#include "db_backend.hpp"
+#include <string>
+#include <vector>
+
+struct sqlite3;
+
+// 嵌入式后端（SQLite），用于在没有 MySQL 的机器上运行和压测整个服务
+// path 为数据库文件，":memory:" 表示内存库；库中还没有表时依次执行 scripts 中的建库脚本
+// （init.sql、more_data.sql 等，MySQL 方言，加载时转换为 SQLite 语法）。
+// 运行期的语句也做同样的转换：INSERT IGNORE、START TRANSACTION、整数除法等，
+// 并注册 NOW()/CURDATE()/CONCAT()/SHA2() 等 MySQL 函数，处理函数中的 SQL 无需修改
+class SqliteBackend : public DbBackend {
+public:
+    explicit SqliteBackend(const std::string& path, std::vector<std::string> scripts = {});
+    ~SqliteBackend() override;
+
+    SqliteBackend(const SqliteBackend&) = delete;
+    SqliteBackend& operator=(const SqliteBackend&) = delete;
+
+    const char* name() const override { return "sqlite"; }
+
+    bool connect() override;
+    void disconnect() override;
+    bool ping() override;
+    bool ensureConnected() override;
+
+    bool run(const std::string& sql, DbResult* result, StatementTiming& timing) override;
+
+    unsigned long long lastInsertId() const override;
+    unsigned long long affectedRows() const override;
+
+    std::string escape(const std::string& str) override;
+    std::string error() const override;
+    std::string explainPrefix() const override { return "EXPLAIN QUERY PLAN "; }
+    void interrupt() override;
+
+    // 执行一个 MySQL 方言的 SQL 脚本（整体放在一个事务中），返回失败的语句数，-1 表示无法读取
+    int loadScript(const std::string& path);
+
+    // MySQL 方言转换为 SQLite；script 为 true 时同时转换 DDL（建表、索引、视图）和反斜杠转义
+    static std::string translate(const std::string& sql, bool script = false);
+
+private:
+    void registerFunctions();
+
+    std::string path_;
+    std::vector<std::string> scripts_;
+    sqlite3* db_;
+    std::string lastError_;
+};
+
+#endif // SQLITE_BACKEND_HPP
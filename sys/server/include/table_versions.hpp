@@ -0,0 +1,44 @@
+#ifndef TABLE_VERSIONS_HPP
+#define TABLE_VERSIONS_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <initializer_list>
+#include <cstdint>
+
+struct HttpRequest;
+
+// 业务表（teacher、student 只随用户管理变化，归入 User）
+enum class Table { Classroom, Equipment, Course, Schedule, ClassInfo, Notice, Booking, Enrollment, User, Count };
+
+// 表版本登记：写接口成功后递增所涉及表的版本，读接口据此生成 ETag。
+// - 版本只在本进程内递增，ETag 里混入进程启动时的随机纪元，重启后旧 ETag 全部失效
+// - 只覆盖经过写接口的修改；直接改库不会递增版本
+class TableVersions {
+public:
+    static TableVersions& getInstance();
+
+    // 数据提交之后调用，之后的读请求不再命中旧 ETag
+    void bump(std::initializer_list<Table> tables);
+    uint64_t version(Table table) const { return versions_[static_cast<int>(table)].load(std::memory_order_acquire); }
+    static const char* name(Table table);
+
+    // 弱 ETag：由所读表的版本、请求路径和排序后的查询参数计算；
+    // context 为请求之外影响结果的值（如未指定学期时按日期取的当前学期）
+    std::string etag(const HttpRequest& req, const std::vector<Table>& tables,
+                     const std::string& context = "") const;
+    // If-None-Match 中是否有与 etag 匹配的项（弱比较，支持 * 和逗号分隔的多个值）
+    static bool matches(const std::string& ifNoneMatch, const std::string& etag);
+
+    TableVersions(const TableVersions&) = delete;
+    TableVersions& operator=(const TableVersions&) = delete;
+
+private:
+    TableVersions();
+
+    uint64_t epoch_;
+    std::atomic<uint64_t> versions_[static_cast<int>(Table::Count)] = {};
+};
+
+#endif // TABLE_VERSIONS_HPP
@@ -0,0 +1,108 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+
+// 协程的恢复位置
+// 事件循环线程把自己登记为当前线程的执行器；异步操作在其他线程上完成后通过 post 把恢复动作投递回来，
+// 协程因此总在发起它的线程上继续执行，不需要额外加锁
+class Executor {
+public:
+    virtual ~Executor() = default;
+
+    // 可在任意线程调用，task 在执行器所在线程上运行
+    virtual void post(std::function<void()> task) = 0;
+
+    // 当前线程的执行器，没有时为 nullptr（异步操作随之退化为同步执行）
+    static Executor* current() { return current_; }
+    static void setCurrent(Executor* executor) { current_ = executor; }
+
+private:
+    inline static thread_local Executor* current_ = nullptr;
+};
+
+// 惰性启动的协程任务：被 co_await 时才开始执行，结束后直接恢复等待它的协程（对称转移，不增加栈深度）
+// 协程内抛出的异常在 co_await 处重新抛出
+template <typename T>
+class Task {
+public:
+    struct promise_type {
+        std::optional<T> value;
+        std::exception_ptr error;
+        std::coroutine_handle<> continuation;
+
+        Task get_return_object() { return Task(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                auto continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        template <typename U>
+        void return_value(U&& result) { value.emplace(std::forward<U>(result)); }
+        void unhandled_exception() { error = std::current_exception(); }
+    };
+
+    Task(Task&& other) noexcept : handle_(std::exchange(other.handle_, {})) {}
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    Task& operator=(Task&&) = delete;
+    ~Task() {
+        if (handle_) handle_.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle_.promise().continuation = awaiting;
+        return handle_;
+    }
+    T await_resume() {
+        auto& promise = handle_.promise();
+        if (promise.error) std::rethrow_exception(promise.error);
+        return std::move(*promise.value);
+    }
+
+private:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle_(handle) {}
+
+    std::coroutine_handle<promise_type> handle_;
+};
+
+// 不被等待的顶层协程：调用时立即开始执行，结束后自行销毁；异常必须在协程内处理
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+// 在没有执行器的线程上执行任务并取得结果（基准测试等）：此时异步操作都在调用线程上同步完成，任务不会挂起
+template <typename T>
+T runSync(Task<T> task) {
+    std::optional<T> result;
+    std::exception_ptr error;
+    [](Task<T> task, std::optional<T>& result, std::exception_ptr& error) -> DetachedTask {
+        try {
+            result.emplace(co_await task);
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }(std::move(task), result, error);
+    if (error) std::rethrow_exception(error);
+    return std::move(*result);
+}
+
+#endif // TASK_HPP
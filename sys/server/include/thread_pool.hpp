@@ -0,0 +1,40 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <functional>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// 固定线程数、有界队列的线程池
+// 用于把CPU密集型任务（如密码哈希）与请求处理线程隔离，队列满时直接拒绝而不是无限堆积
+class ThreadPool {
+public:
+    ThreadPool(size_t threads, size_t maxQueue);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // 提交任务，队列已满或线程池已停止时返回false
+    bool trySubmit(std::function<void()> task);
+
+    size_t pending() const;
+    size_t threadCount() const { return workers_.size(); }
+
+    void shutdown();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    size_t maxQueue_;
+    bool stopping_;
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,105 @@
+#ifndef TIMER_WHEEL_HPP
+#define TIMER_WHEEL_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// 分层时间轮：4 层 x 64 槽，tick 为最小粒度，覆盖 64^4 个 tick（tick=100ms 时约 194 天，更远的按最远处理）。
+// 定时器是由使用者持有的侵入式链表节点（嵌在连接等对象里），插入和取消都是 O(1)，不分配内存；
+// 低层转完一圈时把上一层对应槽的定时器重新分配到下层。不加锁，只能在持有它的线程上使用
+class TimerWheel {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void()>;
+
+    static constexpr int kLevels = 4;
+    static constexpr int kSlotBits = 6;
+    static constexpr int kSlots = 1 << kSlotBits;
+
+    class Timer {
+    public:
+        Timer() = default;
+        ~Timer() { cancel(); }
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+        bool armed() const { return wheel_ != nullptr; }
+        void cancel();
+
+    private:
+        friend class TimerWheel;
+
+        TimerWheel* wheel_ = nullptr;
+        Timer* prev_ = nullptr;
+        Timer* next_ = nullptr;
+        uint64_t expires_ = 0;          // 到期的 tick
+        int level_ = 0;
+        int slot_ = 0;
+        Callback callback_;
+    };
+
+    explicit TimerWheel(Clock::duration tick = std::chrono::milliseconds(100), Clock::time_point now = Clock::now());
+    ~TimerWheel();
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    // delay 后调用 callback（向上取整到 tick，至少一个 tick）；已在轮上的定时器先取消再重新插入
+    void schedule(Timer& timer, Clock::duration delay, Callback callback);
+    void cancel(Timer& timer);
+
+    // 推进到 now，依次调用到期的回调（回调中可以 schedule/cancel 任意定时器）；返回到期的个数
+    size_t advance(Clock::time_point now);
+
+    // 到最近可能有定时器到期的时间（毫秒，向上取整），供 epoll_wait / io_uring 等待超时使用；没有定时器时返回 -1
+    int timeoutMs(Clock::time_point now) const;
+
+    size_t size() const { return count_; }
+
+private:
+    uint64_t tickOf(Clock::time_point time) const;
+    void link(Timer& timer);
+    void unlink(Timer& timer);
+    // 把第 level 层当前槽的定时器重新分配到下层
+    void cascade(int level);
+
+    Clock::time_point start_;
+    Clock::duration tick_;
+    uint64_t current_ = 0;              // 已处理到的 tick
+    size_t count_ = 0;
+    Timer* slots_[kLevels][kSlots] = {};
+    uint64_t occupied_[kLevels] = {};   // 各层非空槽的位图
+};
+
+// 由独立线程驱动的时间轮，可在任意线程 schedule/cancel（加锁）
+// 用于阻塞在系统调用中的线程（每连接一线程模式的 recv、执行中的SQL语句）：到期回调在驱动线程上执行，
+// 负责把阻塞方唤醒（shutdown socket、中断语句），回调中不能再调用 TimerService。
+// 定时器销毁前必须先经 cancel 取下；cancel 返回后回调保证不在执行，之后可以放心销毁相关对象
+class TimerService {
+public:
+    using Timer = TimerWheel::Timer;
+
+    static TimerService& getInstance();
+
+    void schedule(Timer& timer, TimerWheel::Clock::duration delay, TimerWheel::Callback callback);
+    void cancel(Timer& timer);
+
+private:
+    TimerService();
+    ~TimerService();
+    TimerService(const TimerService&) = delete;
+    TimerService& operator=(const TimerService&) = delete;
+
+    void run();
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    TimerWheel wheel_;
+    bool running_ = true;
+    std::thread thread_;
+};
+
+#endif // TIMER_WHEEL_HPP
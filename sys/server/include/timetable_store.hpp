@@ -0,0 +1,99 @@
+#ifndef TIMETABLE_STORE_HPP
+#define TIMETABLE_STORE_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <shared_mutex>
+
+// 一条排课（v_schedule_detail 的一行，附带关联ID用于增量维护）
+struct TimetableEntry {
+    int scheduleId = 0;
+    int courseId = 0;
+    int teacherId = 0;
+    int classroomId = 0;
+    int classId = 0;
+    std::string semester;
+    int weekday = 0;
+    int startSection = 0;
+
+    std::string json;   // 预先序列化好的行JSON，与 v_schedule_detail 输出一致
+};
+
+// 课表物化存储
+// 按 (学生, 学期) 和 (教师, 学期) 保存已序列化好的课表JSON，请求直接从内存返回
+// 排课/选课变更时只重建受影响的学生和教师的课表
+class TimetableStore {
+public:
+    using Row = std::map<std::string, std::string>;
+    using RowLoader = std::function<std::vector<Row>(const std::string& sql)>;
+    using JsonPtr = std::shared_ptr<const std::string>;
+
+    static TimetableStore& getInstance();
+
+    void setLoader(RowLoader loader);
+
+    // 从数据库全量加载并物化所有课表
+    bool load();
+    bool isLoaded() const;
+
+    // 读取课表（未知的学生/教师返回空数组）
+    JsonPtr studentTimetable(int studentId, const std::string& semester) const;
+    JsonPtr teacherTimetable(int teacherId, const std::string& semester) const;
+
+    // ===== 增量维护（写接口返回后相关课表已更新） =====
+    // 重新从数据库读取满足 schedule.<column> = id 的排课（排课、课程、教室、班级变更时调用）
+    void refreshSchedules(const std::string& column, int id);
+    void refreshSchedules(const std::string& column, const std::vector<int>& ids);
+    void removeSchedule(int scheduleId);
+
+    void addEnrollment(int studentId, int courseId, const std::string& semester);
+    void removeEnrollment(int studentId, int courseId, const std::string& semester);
+
+    // 直接写入一批排课（全量加载和测试数据使用）
+    void applySchedules(const std::vector<TimetableEntry>& entries);
+
+    // 把一行排课明细转换为 TimetableEntry
+    static TimetableEntry entryFromRow(const Row& row);
+
+    size_t studentCount() const;
+    size_t teacherCount() const;
+
+private:
+    TimetableStore();
+    TimetableStore(const TimetableStore&) = delete;
+    TimetableStore& operator=(const TimetableStore&) = delete;
+
+    static std::string key(int id, const std::string& semester);
+    static std::string selectSql();
+
+    // 以下方法调用前需持有写锁
+    void insertEntry(const TimetableEntry& entry, std::set<std::string>& students, std::set<std::string>& teachers);
+    void eraseEntry(int scheduleId, std::set<std::string>& students, std::set<std::string>& teachers);
+    void collectCourseStudents(int courseId, const std::string& semester, std::set<std::string>& students) const;
+    void rebuildStudent(const std::string& k);
+    void rebuildTeacher(const std::string& k);
+    void rebuild(const std::set<std::string>& students, const std::set<std::string>& teachers);
+    JsonPtr serialize(std::vector<const TimetableEntry*>& entries) const;
+
+    RowLoader loader_;
+    bool loaded_;
+
+    mutable std::shared_mutex mutex_;
+
+    std::unordered_map<int, TimetableEntry> schedules_;
+    std::unordered_map<int, std::set<int>> courseSchedules_;     // course_id -> schedule_id
+    std::unordered_map<int, std::set<int>> teacherSchedules_;    // teacher_id -> schedule_id
+    std::unordered_map<std::string, std::set<int>> studentCourses_;   // (student, 学期) -> course_id
+    std::unordered_map<std::string, std::set<int>> courseStudents_;   // (course, 学期) -> student_id
+
+    std::unordered_map<std::string, JsonPtr> studentJson_;
+    std::unordered_map<std::string, JsonPtr> teacherJson_;
+    JsonPtr empty_;
+};
+
+#endif // TIMETABLE_STORE_HPP
@@ -0,0 +1,121 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+// 请求追踪
+// 每个请求开始时按采样率决定是否追踪；被采样的请求在本线程缓冲中记录各阶段span（单调时钟），
+// 请求结束时整体移入全局保留区，导出为 Chrome trace-event JSON（chrome://tracing 或 Perfetto 打开）
+// 未被采样时每个span只多一次线程局部变量判断
+class Tracer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static Tracer& getInstance();
+
+    // 采样率 0~1，0 表示关闭
+    void setSampleRate(double rate);
+    double sampleRate() const;
+    // 只保留耗时不低于该值的请求（毫秒），便于只看慢请求
+    void setMinDurationMs(int ms);
+    int minDurationMs() const;
+    // 最多保留的请求数，超出后丢弃最早的
+    void setCapacity(size_t traces);
+
+    // 请求开始/结束（同一线程内配对调用）
+    void beginRequest(Clock::time_point start);
+    void endRequest(const std::string& name, int statusCode);
+
+    static bool active() { return active_; }
+
+    // 协程挂起时把本线程正在追踪的请求移出，恢复时（可能先在数据库线程上记录span）再移入
+    struct Context;
+    static Context detach();
+    static void attach(Context&& context);
+
+    // 记录一个已结束的span（未追踪时直接返回）
+    static void addSpan(const char* name, Clock::time_point start, Clock::time_point end,
+                        const std::string& detail = "") {
+        if (active_) record(name, start, end, detail);
+    }
+
+    std::string exportJson(size_t limit) const;
+    void clear();
+    size_t size() const;
+
+private:
+    Tracer();
+    Tracer(const Tracer&) = delete;
+    Tracer& operator=(const Tracer&) = delete;
+
+    struct Span {
+        const char* name;
+        std::string detail;
+        Clock::time_point start;
+        Clock::time_point end;
+    };
+
+    struct Trace {
+        uint64_t id = 0;
+        std::string name;
+        int statusCode = 0;
+        Clock::time_point start;
+        Clock::time_point end;
+        std::vector<Span> spans;
+    };
+
+    static void record(const char* name, Clock::time_point start, Clock::time_point end,
+                       const std::string& detail);
+
+public:
+    struct Context {
+        bool active = false;
+        Trace trace;
+    };
+
+private:
+
+    inline static thread_local bool active_ = false;
+    static thread_local Trace current_;     // 当前线程正在追踪的请求
+
+    std::atomic<uint32_t> sampleThreshold_;     // 采样率 * 2^32
+    std::atomic<int64_t> minDurationNs_;
+    std::atomic<uint64_t> nextId_;
+    Clock::time_point epoch_;
+
+    mutable std::mutex mutex_;
+    std::deque<Trace> traces_;
+    size_t capacity_;
+};
+
+// 作用域span：构造时记开始时间，析构时记录
+class TraceSpan {
+public:
+    explicit TraceSpan(const char* name, std::string detail = "")
+        : name_(name), enabled_(Tracer::active()) {
+        if (enabled_) {
+            detail_ = std::move(detail);
+            start_ = Tracer::Clock::now();
+        }
+    }
+    ~TraceSpan() {
+        if (enabled_) Tracer::addSpan(name_, start_, Tracer::Clock::now(), detail_);
+    }
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name_;
+    bool enabled_;
+    std::string detail_;
+    Tracer::Clock::time_point start_;
+};
+
+#endif // TRACER_HPP
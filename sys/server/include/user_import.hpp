@@ -0,0 +1,59 @@
+#ifndef USER_IMPORT_HPP
+#define USER_IMPORT_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 导入文件中的一行及其结果
+struct UserImportLine {
+    int line = 0;               // 行号（从 1 开始，含表头和空行）
+    std::string username;
+    std::string realName;
+    std::string role;
+    std::string email;
+    std::string phone;
+    std::string password;       // 为空时使用默认密码
+    std::string status;         // created / exists / duplicate / invalid / failed
+    std::string error;
+};
+
+// 批量导入用户（POST /api/users/batch）
+// 每行: username,real_name,role[,email[,phone[,password]]]，字段可用双引号包围，首行为表头时跳过
+// 1. 单趟扫描上传内容逐行解析并校验，不拆分复制整个文本
+// 2. 文件内重复的用户名只保留第一行；已存在的用户名按 1000 个一组用 IN 查询一次找出
+// 3. 指定了密码的行在KDF线程池上并行哈希；其余行使用默认密码，整批共用一个哈希
+// 4. 每条 INSERT 写入 1000 行，全部语句在一个事务中执行，失败时整体回滚
+class UserImport {
+public:
+    static constexpr size_t kBatchSize = 1000;
+    static constexpr size_t kMaxLines = 100000;
+
+    enum class Result {
+        Ok,
+        TooLarge,   // 超过 kMaxLines 行
+        Busy,       // KDF线程池已满
+        DbError     // 写入失败，已回滚
+    };
+
+    struct Report {
+        int created = 0;
+        int failed = 0;
+        std::vector<UserImportLine> lines;
+
+        // {"success": n, "failed": n, "results": [{"line", "username", "status", "error"}, ...]}
+        std::string toJson() const;
+    };
+
+    // 从请求体取出CSV：text/csv 直接使用，否则按JSON取 "users" 字段（解码转义），
+    // JSON中的 "default_password" 覆盖默认密码
+    static std::string extractCsv(const std::string& body, const std::string& contentType,
+                                  std::string& defaultPassword);
+
+    // 解析并校验，不访问数据库；格式错误的行 status 为 invalid
+    static std::vector<UserImportLine> parse(std::string_view csv);
+
+    static Result run(std::string_view csv, const std::string& defaultPassword, Report& report);
+};
+
+#endif // USER_IMPORT_HPP
@@ -0,0 +1,101 @@
+#ifndef UTILIZATION_STATS_HPP
+#define UTILIZATION_STATS_HPP
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <array>
+#include <bitset>
+#include <unordered_map>
+#include <functional>
+#include <shared_mutex>
+
+// 教室利用率统计
+// 每间教室按学期维护"周次 x 星期 x 节次"的占用位图，排课变更时只重算该教室；
+// 查询时按任意周次范围对位图计数，按教室/楼栋/类别汇总，不再执行聚合SQL
+// 与原视图的区别：多节连上按实际节数计入，单双周和起止周次均按实际占用计算
+class UtilizationStats {
+public:
+    using Row = std::map<std::string, std::string>;
+    using RowLoader = std::function<std::vector<Row>(const std::string& sql)>;
+
+    static constexpr int kMaxWeeks = 30;
+    static constexpr int kWeekdays = 7;
+    static constexpr int kSections = 12;
+    static constexpr int kTeachingDays = 5;     // 利用率分母只计周一至周五
+
+    static UtilizationStats& getInstance();
+
+    void setLoader(RowLoader loader);
+    bool load();
+    bool isLoaded() const;
+
+    // ===== 增量维护 =====
+    void refreshClassroom(int classroomId);
+    // 重新读取满足 schedule.<column> = id 的排课（column: id / course_id / classroom_id）
+    void refreshSchedules(const std::string& column, int id);
+    void refreshSchedules(const std::string& column, const std::vector<int>& ids);
+    void removeSchedule(int scheduleId);
+
+    // 查询利用率，返回JSON数组
+    // groupBy: room / building / category；startWeek/endWeek 为0时取该学期的完整周次范围
+    std::string query(const std::string& semester, int startWeek, int endWeek,
+                      const std::string& groupBy) const;
+
+private:
+    UtilizationStats();
+    UtilizationStats(const UtilizationStats&) = delete;
+    UtilizationStats& operator=(const UtilizationStats&) = delete;
+
+    using SlotBits = std::bitset<kWeekdays * kSections>;
+    using WeekBits = std::array<SlotBits, kMaxWeeks + 1>;   // 下标即周次，0不用
+
+    struct Lesson {
+        int id = 0;
+        int classroomId = 0;
+        int courseId = 0;
+        std::string semester;
+        int weekday = 0;
+        int startSection = 0;
+        int endSection = 0;
+        int startWeek = 0;
+        int endWeek = 0;
+        std::string weekType;
+    };
+
+    struct Room {
+        int id = 0;
+        std::string code;
+        std::string name;
+        std::string building;
+        std::string category;
+        int seats = 0;
+        std::set<int> lessons;
+        std::unordered_map<std::string, WeekBits> occupancy;   // 学期 -> 占用位图
+    };
+
+    struct Usage {
+        int teachingSlots = 0;   // 工作日占用的节次·周
+        int weekendSlots = 0;
+    };
+
+    static Lesson lessonFromRow(const Row& row);
+    static void setBits(WeekBits& bits, const Lesson& lesson);
+    Usage count(const Room& room, const std::string& semester, int startWeek, int endWeek) const;
+
+    // 以下方法调用前需持有写锁
+    void insertLesson(const Lesson& lesson, std::set<int>& dirtyRooms);
+    void eraseLesson(int lessonId, std::set<int>& dirtyRooms);
+    void rebuildRoom(int classroomId);
+
+    RowLoader loader_;
+    bool loaded_;
+
+    mutable std::shared_mutex mutex_;
+    std::map<int, Room> rooms_;
+    std::unordered_map<int, Lesson> lessons_;
+    std::map<std::string, std::multiset<int>> semesterEndWeeks_;
+};
+
+#endif // UTILIZATION_STATS_HPP
@@ -0,0 +1,53 @@
+#ifndef WEBSOCKET_HPP
+#define WEBSOCKET_HPP
+
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+struct HttpRequest;
+
+// WebSocket（RFC 6455）的握手与帧编解码，不含连接管理（升级后的连接由 PushHub 持有）
+class WebSocket {
+public:
+    enum class Opcode : uint8_t {
+        Continuation = 0x0,
+        Text = 0x1,
+        Binary = 0x2,
+        Close = 0x8,
+        Ping = 0x9,
+        Pong = 0xA,
+    };
+
+    // 关闭码
+    static constexpr uint16_t kNormalClosure = 1000;
+    static constexpr uint16_t kGoingAway = 1001;
+    static constexpr uint16_t kProtocolError = 1002;
+    static constexpr uint16_t kMessageTooBig = 1009;
+
+    // 客户端消息（分片合并后）的上限；本服务只接收控制帧和很短的消息
+    static constexpr size_t kMaxMessageSize = 64 * 1024;
+
+    struct Frame {
+        bool fin = false;
+        Opcode opcode = Opcode::Text;
+        std::string payload;            // 已去掩码
+    };
+
+    enum class ParseResult { Incomplete, Ok, Error };
+
+    // 是 GET + Upgrade: websocket + Sec-WebSocket-Version: 13 且带 Sec-WebSocket-Key 的请求
+    static bool isUpgrade(const HttpRequest& req);
+    // Sec-WebSocket-Accept：base64(SHA1(key + 固定GUID))
+    static std::string acceptKey(const std::string& key);
+
+    // 服务器发出的帧（不加掩码，不分片）
+    static std::string encode(Opcode opcode, const std::string& payload);
+    static std::string encodeClose(uint16_t code);
+
+    // 从 data 的 pos 处解析一个客户端帧（必须带掩码），成功时 pos 前移到帧尾；
+    // 出错时 closeCode 为应回复的关闭码
+    static ParseResult parse(const std::string& data, size_t& pos, Frame& frame, uint16_t& closeCode);
+};
+
+#endif // WEBSOCKET_HPP
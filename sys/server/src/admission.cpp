@@ -0,0 +1,236 @@
+#include "admission.hpp"
+#include <algorithm>
+#include <condition_variable>
+#include <sstream>
+
+// ========== RouteClass ==========
+AdmissionController::Options AdmissionController::RouteClass::options() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return options_;
+}
+
+AdmissionController::RouteClass::Snapshot AdmissionController::RouteClass::snapshot() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Snapshot snap = counters_;
+    snap.limit = limit_;
+    snap.inFlight = inFlight_;
+    snap.queued = queue_.size();
+    snap.minLatencyNanos = minLatency_;
+    return snap;
+}
+
+void AdmissionController::RouteClass::expireLocked(Clock::time_point now, std::vector<Grant>& expired) {
+    // 同一类别的截止时间长度相同，队列按到达顺序排列即按截止时间排列
+    while (!queue_.empty() && queue_.front().deadline <= now) {
+        expired.push_back(std::move(queue_.front().grant));
+        queue_.pop_front();
+        counters_.expired++;
+    }
+}
+
+void AdmissionController::RouteClass::sampleLocked(uint64_t nanos) {
+    windowCount_++;
+    windowSum_ += nanos;
+    if (windowCount_ < std::max<uint64_t>(10, static_cast<uint64_t>(limit_))) return;
+
+    uint64_t average = windowSum_ / windowCount_;
+    if (minLatency_ == 0 || average < minLatency_) minLatency_ = average;
+
+    if (average > minLatency_ * options_.tolerance) {
+        // 延迟明显高于空载：请求在下游（数据库锁、CPU）排队，乘性减小
+        limit_ = std::max(options_.minLimit, limit_ * options_.backoff);
+    } else if (windowSaturated_) {
+        // 延迟正常且名额被用满：加性增大，试探更高的并发
+        limit_ = std::min(options_.maxLimit, limit_ + 1);
+    }
+    lastLatency_ = average;
+    windowCount_ = windowSum_ = 0;
+    windowSaturated_ = false;
+
+    // 空载延迟会随数据量、缓存变化，定期用当前窗口重新估计
+    if (++windows_ % 100 == 0) minLatency_ = average;
+}
+
+// ========== AdmissionController ==========
+AdmissionController& AdmissionController::getInstance() {
+    static AdmissionController instance;
+    return instance;
+}
+
+AdmissionController::RouteClass* AdmissionController::configure(const std::string& name, const Options& options) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& slot = classes_[name];
+    if (!slot) slot.reset(new RouteClass(name));
+
+    std::lock_guard<std::mutex> classLock(slot->mutex_);
+    slot->options_ = options;
+    slot->limit_ = std::clamp(options.initialLimit, options.minLimit, options.maxLimit);
+    return slot.get();
+}
+
+AdmissionController::RouteClass* AdmissionController::find(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = classes_.find(name);
+    return it == classes_.end() ? nullptr : it->second.get();
+}
+
+AdmissionController::Result AdmissionController::acquire(RouteClass& routeClass, Grant grant) {
+    auto now = Clock::now();
+    std::vector<Grant> expired;
+    Result result;
+    {
+        std::lock_guard<std::mutex> lock(routeClass.mutex_);
+        routeClass.expireLocked(now, expired);
+        const Options& options = routeClass.options_;
+
+        if (routeClass.inFlight_ < static_cast<int>(routeClass.limit_) && routeClass.queue_.empty()) {
+            routeClass.inFlight_++;
+            routeClass.counters_.admitted++;
+            if (routeClass.inFlight_ >= static_cast<int>(routeClass.limit_)) routeClass.windowSaturated_ = true;
+            result = Result::Admitted;
+        } else if (routeClass.queue_.size() >= options.maxQueue) {
+            routeClass.counters_.rejectedFull++;
+            result = Result::Rejected;
+        } else {
+            // 按上个窗口的平均延迟估算排到的时间，超过截止时间就不必排队
+            auto perSlot = std::chrono::nanoseconds(routeClass.lastLatency_);
+            auto expectedWait = perSlot * static_cast<int64_t>(routeClass.queue_.size() + 1)
+                                / std::max<int64_t>(1, static_cast<int64_t>(routeClass.limit_));
+            if (expectedWait > options.deadline) {
+                routeClass.counters_.rejectedDeadline++;
+                result = Result::Rejected;
+            } else {
+                routeClass.queue_.push_back({now + options.deadline, std::move(grant)});
+                routeClass.windowSaturated_ = true;
+                result = Result::Queued;
+            }
+        }
+    }
+    for (auto& waiter : expired) waiter(false);
+    return result;
+}
+
+bool AdmissionController::acquire(RouteClass& routeClass) {
+    struct State {
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool decided = false;
+        bool admitted = false;
+        bool abandoned = false;
+    };
+    auto state = std::make_shared<State>();
+    auto deadline = Clock::now() + routeClass.options().deadline;
+
+    Result result = acquire(routeClass, [state](bool admitted) {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (state->abandoned) return false;
+        state->decided = true;
+        state->admitted = admitted;
+        state->cv.notify_one();
+        return true;
+    });
+    if (result != Result::Queued) return result == Result::Admitted;
+
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (!state->cv.wait_until(lock, deadline, [&] { return state->decided; })) {
+        // 超时后名额若再到达，由 grant 返回 false 转给下一个等待者
+        state->abandoned = true;
+        return false;
+    }
+    return state->admitted;
+}
+
+void AdmissionController::release(RouteClass& routeClass, uint64_t nanos) {
+    {
+        std::lock_guard<std::mutex> lock(routeClass.mutex_);
+        routeClass.inFlight_--;
+        routeClass.sampleLocked(nanos);
+    }
+    dispatch(routeClass);
+}
+
+void AdmissionController::expire(RouteClass& routeClass) {
+    std::vector<Grant> expired;
+    {
+        std::lock_guard<std::mutex> lock(routeClass.mutex_);
+        routeClass.expireLocked(Clock::now(), expired);
+    }
+    for (auto& waiter : expired) waiter(false);
+}
+
+void AdmissionController::dispatch(RouteClass& routeClass) {
+    while (true) {
+        std::vector<Grant> expired;
+        Grant next;
+        {
+            std::lock_guard<std::mutex> lock(routeClass.mutex_);
+            routeClass.expireLocked(Clock::now(), expired);
+            if (!routeClass.queue_.empty() && routeClass.inFlight_ < static_cast<int>(routeClass.limit_)) {
+                next = std::move(routeClass.queue_.front().grant);
+                routeClass.queue_.pop_front();
+                routeClass.inFlight_++;
+                routeClass.counters_.admitted++;
+            }
+        }
+        for (auto& waiter : expired) waiter(false);
+        if (!next) return;
+        if (next(true)) continue;
+
+        // 等待者已放弃：名额收回，继续交给下一个
+        std::lock_guard<std::mutex> lock(routeClass.mutex_);
+        routeClass.inFlight_--;
+        routeClass.counters_.admitted--;
+    }
+}
+
+std::string AdmissionController::render() const {
+    std::vector<std::pair<std::string, RouteClass::Snapshot>> snapshots;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& [name, routeClass] : classes_) {
+            snapshots.push_back({name, routeClass->snapshot()});
+        }
+    }
+
+    std::ostringstream oss;
+    oss << "# HELP server_admission_limit 准入控制当前的并发上限（按路由类别）\n";
+    oss << "# TYPE server_admission_limit gauge\n";
+    for (const auto& [name, snap] : snapshots) {
+        oss << "server_admission_limit{class=\"" << name << "\"} " << snap.limit << "\n";
+    }
+
+    oss << "# HELP server_admission_in_flight 正在处理的请求数\n";
+    oss << "# TYPE server_admission_in_flight gauge\n";
+    for (const auto& [name, snap] : snapshots) {
+        oss << "server_admission_in_flight{class=\"" << name << "\"} " << snap.inFlight << "\n";
+    }
+
+    oss << "# HELP server_admission_queued 排队等待名额的请求数\n";
+    oss << "# TYPE server_admission_queued gauge\n";
+    for (const auto& [name, snap] : snapshots) {
+        oss << "server_admission_queued{class=\"" << name << "\"} " << snap.queued << "\n";
+    }
+
+    oss << "# HELP server_admission_min_latency_seconds 空载处理延迟的估计\n";
+    oss << "# TYPE server_admission_min_latency_seconds gauge\n";
+    for (const auto& [name, snap] : snapshots) {
+        oss << "server_admission_min_latency_seconds{class=\"" << name << "\"} "
+            << static_cast<double>(snap.minLatencyNanos) / 1e9 << "\n";
+    }
+
+    oss << "# HELP server_admission_admitted_total 得到名额的请求数\n";
+    oss << "# TYPE server_admission_admitted_total counter\n";
+    for (const auto& [name, snap] : snapshots) {
+        oss << "server_admission_admitted_total{class=\"" << name << "\"} " << snap.admitted << "\n";
+    }
+
+    oss << "# HELP server_admission_rejected_total 以 503 拒绝的请求数（queue_full/deadline/expired）\n";
+    oss << "# TYPE server_admission_rejected_total counter\n";
+    for (const auto& [name, snap] : snapshots) {
+        oss << "server_admission_rejected_total{class=\"" << name << "\",reason=\"queue_full\"} " << snap.rejectedFull << "\n";
+        oss << "server_admission_rejected_total{class=\"" << name << "\",reason=\"deadline\"} " << snap.rejectedDeadline << "\n";
+        oss << "server_admission_rejected_total{class=\"" << name << "\",reason=\"expired\"} " << snap.expired << "\n";
+    }
+
+    return oss.str();
+}
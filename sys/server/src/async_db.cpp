@@ -0,0 +1,29 @@
+#include "async_db.hpp"
+#include "logger.hpp"
+
+AsyncDb& AsyncDb::getInstance() {
+    static AsyncDb instance;
+    return instance;
+}
+
+void AsyncDb::start(size_t threads, size_t maxQueue) {
+    if (pool_) return;
+    pool_ = std::make_unique<ThreadPool>(threads, maxQueue);
+    LOG_INFO("数据库IO线程: %zu 个，队列上限 %zu", threads, maxQueue);
+}
+
+void AsyncDb::stop() {
+    if (pool_) pool_->shutdown();
+}
+
+AsyncDb::Awaiter<DbResult> AsyncDb::query(std::string sql) {
+    return Awaiter<DbResult>(pool_.get(), [sql = std::move(sql)]() {
+        return Database::getInstance().query(sql);
+    });
+}
+
+AsyncDb::Awaiter<bool> AsyncDb::execute(std::string sql) {
+    return Awaiter<bool>(pool_.get(), [sql = std::move(sql)]() {
+        return Database::getInstance().execute(sql);
+    });
+}
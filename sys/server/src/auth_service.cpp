@@ -0,0 +1,202 @@
+#include "auth_service.hpp"
+#include "password_hasher.hpp"
+#include <algorithm>
+#include <chrono>
+
+AuthService& AuthService::getInstance() {
+    static AuthService instance;
+    return instance;
+}
+
+AuthService::AuthService()
+    : iterations_(PasswordHasher::kDefaultIterations), cacheTtl_(600),
+      secret_(PasswordHasher::randomBytes(32)) {}
+
+void AuthService::setIterations(int iterations) {
+    iterations_ = iterations > 0 ? iterations : PasswordHasher::kDefaultIterations;
+}
+
+void AuthService::setCacheTtl(int seconds) {
+    cacheTtl_ = seconds;
+}
+
+void AuthService::setUserLoader(UserLoader loader) {
+    loader_ = loader;
+}
+
+void AuthService::setHashUpdater(HashUpdater updater) {
+    updater_ = updater;
+}
+
+void AuthService::start(size_t kdfThreads, size_t maxQueue) {
+    pool_ = std::make_unique<ThreadPool>(kdfThreads, maxQueue);
+}
+
+void AuthService::stop() {
+    if (pool_) {
+        pool_->shutdown();
+    }
+}
+
+int64_t AuthService::now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+std::string AuthService::makeVerifier(const AuthUser& user, const std::string& password) const {
+    // 绑定当前存储的哈希，密码被修改后旧的校验结果自然失效
+    std::string data = user.passwordHash;
+    data.push_back('\0');
+    data += password;
+    auto mac = HmacSha256(secret_).compute(data.data(), data.size());
+    return std::string(reinterpret_cast<const char*>(mac.data()), mac.size());
+}
+
+bool AuthService::runOnPool(std::function<void()> task) {
+    if (!pool_) {
+        task();
+        return true;
+    }
+    return pool_->trySubmit(std::move(task));
+}
+
+Task<AuthService::Login> AuthService::authenticate(std::string username, std::string password) {
+    Login login;
+    if (username.empty() || password.empty()) co_return login;
+
+    CacheEntry entry;
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = cache_.find(username);
+        if (it != cache_.end() && now() - it->second.loadedAt < cacheTtl_) {
+            entry = it->second;
+            cached = true;
+        }
+    }
+
+    if (!cached) {
+        if (!loader_ || !loader_(username, entry.user)) {
+            co_return login;
+        }
+        entry.loadedAt = now();
+        entry.verifier.clear();
+    }
+
+    // 快速路径：之前校验通过过同一密码
+    if (!entry.verifier.empty() && now() - entry.verifiedAt < cacheTtl_ &&
+        PasswordHasher::constantTimeEquals(makeVerifier(entry.user, password), entry.verifier)) {
+        login.result = Result::Ok;
+        login.user = entry.user;
+        co_return login;
+    }
+
+    // 慢速路径：在KDF线程池上校验
+    std::string storedHash = entry.user.passwordHash;
+    int expectedIterations = iterations_;
+    KdfAwaiter<Outcome> verify(pool_.get(), [password, storedHash, expectedIterations] {
+        Outcome outcome;
+        bool needsRehash = false;
+        outcome.ok = PasswordHasher::verify(password, storedHash, expectedIterations, needsRehash);
+        if (outcome.ok && needsRehash) {
+            outcome.newHash = PasswordHasher::hash(password, expectedIterations);
+        }
+        return outcome;
+    });
+    auto outcome = co_await verify;
+    if (!outcome) {
+        login.result = Result::Busy;
+        co_return login;
+    }
+
+    if (!outcome->ok) {
+        // 记录仍然缓存，避免错误密码重试时反复查库
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!cached) {
+            if (cache_.size() >= kMaxCacheEntries) cache_.erase(cache_.begin());
+            cache_[username] = entry;
+        }
+        co_return login;
+    }
+
+    if (!outcome->newHash.empty()) {
+        entry.user.passwordHash = outcome->newHash;
+        if (updater_) {
+            updater_(entry.user.id, outcome->newHash);
+        }
+    }
+
+    entry.verifier = makeVerifier(entry.user, password);
+    entry.verifiedAt = now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cache_.size() >= kMaxCacheEntries && !cache_.count(username)) {
+            cache_.erase(cache_.begin());
+        }
+        cache_[username] = entry;
+    }
+
+    login.result = Result::Ok;
+    login.user = entry.user;
+    co_return login;
+}
+
+AuthService::KdfAwaiter<std::string> AuthService::hashPassword(std::string password) {
+    int iterations = iterations_;
+    return KdfAwaiter<std::string>(pool_.get(), [password = std::move(password), iterations] {
+        return PasswordHasher::hash(password, iterations);
+    });
+}
+
+std::vector<std::string> AuthService::hashPasswords(const std::vector<std::string>& passwords) {
+    if (passwords.empty()) return {};
+    int iterations = iterations_;
+    size_t chunks = std::min(passwords.size(), pool_ ? pool_->threadCount() : size_t(1));
+    size_t chunkSize = (passwords.size() + chunks - 1) / chunks;
+
+    // 结果由各任务共同持有，提交中途失败时已提交的任务仍可安全写入
+    auto hashes = std::make_shared<std::vector<std::string>>(passwords.size());
+    auto input = std::make_shared<std::vector<std::string>>(passwords);
+    std::vector<std::future<void>> done;
+    for (size_t begin = 0; begin < passwords.size(); begin += chunkSize) {
+        size_t end = std::min(begin + chunkSize, passwords.size());
+        auto promise = std::make_shared<std::promise<void>>();
+        done.push_back(promise->get_future());
+        if (!runOnPool([promise, hashes, input, begin, end, iterations] {
+                for (size_t i = begin; i < end; i++) {
+                    (*hashes)[i] = PasswordHasher::hash((*input)[i], iterations);
+                }
+                promise->set_value();
+            })) {
+            return {};
+        }
+    }
+    for (auto& f : done) f.get();
+    return std::move(*hashes);
+}
+
+void AuthService::invalidate(const std::string& username) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.erase(username);
+}
+
+void AuthService::invalidateUser(int userId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        if (it->second.user.id == userId) {
+            it = cache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void AuthService::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cache_.clear();
+}
+
+size_t AuthService::cacheSize() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return cache_.size();
+}
@@ -0,0 +1,118 @@
+#include "compression.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <strings.h>
+
+namespace {
+
+std::string trim(const std::string& s, size_t begin, size_t end) {
+    while (begin < end && std::isspace(static_cast<unsigned char>(s[begin]))) begin++;
+    while (end > begin && std::isspace(static_cast<unsigned char>(s[end - 1]))) end--;
+    return s.substr(begin, end - begin);
+}
+
+} // namespace
+
+ResponseCompressor& ResponseCompressor::local() {
+    thread_local ResponseCompressor compressor;
+    return compressor;
+}
+
+ResponseCompressor::~ResponseCompressor() {
+    for (auto& stream : streams_) {
+        if (stream.initialized) deflateEnd(&stream.zs);
+    }
+}
+
+ContentCoding ResponseCompressor::negotiate(const std::string& acceptEncoding) {
+    // 未出现的编码 q 为 -1；"*" 覆盖未单独列出的编码
+    double gzip = -1, deflate = -1, any = -1;
+    size_t pos = 0;
+    while (pos < acceptEncoding.size()) {
+        size_t end = acceptEncoding.find(',', pos);
+        if (end == std::string::npos) end = acceptEncoding.size();
+        std::string item = trim(acceptEncoding, pos, end);
+        pos = end + 1;
+
+        double q = 1;
+        size_t semicolon = item.find(';');
+        std::string name = trim(item, 0, semicolon == std::string::npos ? item.size() : semicolon);
+        if (semicolon != std::string::npos) {
+            size_t qPos = item.find("q=", semicolon);
+            if (qPos != std::string::npos) q = std::strtod(item.c_str() + qPos + 2, nullptr);
+        }
+        if (strcasecmp(name.c_str(), "gzip") == 0 || strcasecmp(name.c_str(), "x-gzip") == 0) {
+            gzip = q;
+        } else if (strcasecmp(name.c_str(), "deflate") == 0) {
+            deflate = q;
+        } else if (name == "*") {
+            any = q;
+        }
+    }
+    if (gzip < 0) gzip = any;
+    if (deflate < 0) deflate = any;
+    if (gzip > 0 && gzip >= deflate) return ContentCoding::Gzip;
+    if (deflate > 0) return ContentCoding::Deflate;
+    return ContentCoding::Identity;
+}
+
+bool ResponseCompressor::compressible(const std::string& contentType) {
+    auto startsWith = [&](const char* prefix) {
+        return strncasecmp(contentType.c_str(), prefix, std::char_traits<char>::length(prefix)) == 0;
+    };
+    return startsWith("text/") || startsWith("application/json") || startsWith("application/javascript") ||
+           startsWith("application/xml") || startsWith("image/svg+xml");
+}
+
+const char* ResponseCompressor::codingName(ContentCoding coding) {
+    switch (coding) {
+        case ContentCoding::Gzip: return "gzip";
+        case ContentCoding::Deflate: return "deflate";
+        default: return "identity";
+    }
+}
+
+z_stream* ResponseCompressor::acquire(ContentCoding coding, int level) {
+    Stream& stream = streams_[coding == ContentCoding::Gzip ? 0 : 1];
+    level = std::clamp(level, 1, 9);
+    if (stream.initialized && stream.level != level) {
+        deflateEnd(&stream.zs);
+        stream.initialized = false;
+    }
+    if (!stream.initialized) {
+        stream.zs = z_stream{};
+        // windowBits 15 为 zlib 格式（HTTP 的 deflate），加 16 为 gzip 格式
+        int windowBits = coding == ContentCoding::Gzip ? 15 + 16 : 15;
+        if (deflateInit2(&stream.zs, level, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK) return nullptr;
+        stream.initialized = true;
+        stream.level = level;
+        return &stream.zs;
+    }
+    return deflateReset(&stream.zs) == Z_OK ? &stream.zs : nullptr;
+}
+
+bool ResponseCompressor::compress(ContentCoding coding, int level, const char* data, size_t size, const Sink& sink) {
+    if (coding == ContentCoding::Identity) return false;
+    z_stream* zs = acquire(coding, level);
+    if (!zs) return false;
+
+    zs->next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+    zs->avail_in = static_cast<uInt>(size);
+    int ret;
+    do {
+        zs->next_out = reinterpret_cast<Bytef*>(buffer_);
+        zs->avail_out = kChunkSize;
+        ret = deflate(zs, Z_FINISH);
+        if (ret == Z_STREAM_ERROR) return false;
+        size_t produced = kChunkSize - zs->avail_out;
+        if (produced > 0) sink(buffer_, produced);
+    } while (ret != Z_STREAM_END);
+    return true;
+}
+
+bool ResponseCompressor::compress(ContentCoding coding, int level, const std::string& input, std::string& output) {
+    output.clear();
+    return compress(coding, level, input.data(), input.size(),
+                    [&output](const char* data, size_t size) { output.append(data, size); });
+}
@@ -1,203 +1,300 @@
 #include "db.hpp"
-#include <iostream>
-#include <stdexcept>
+#include "metrics.hpp"
+#include "logger.hpp"
+#include "query_stats.hpp"
+#include "json.hpp"
+#include "tracer.hpp"
+#include "timer_wheel.hpp"
+#ifdef HAVE_MYSQL
+#include "mysql_backend.hpp"
+#endif
+#include <chrono>
+#include <atomic>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+} // namespace
 
 Database& Database::getInstance() {
     static Database instance;
     return instance;
 }
 
-Database::Database() : conn_(nullptr), connected_(false), port_(3306) {
-    conn_ = mysql_init(nullptr);
-    if (!conn_) {
-        throw std::runtime_error("MySQL init failed");
-    }
-}
+Database::Database() {}
 
 Database::~Database() {
     disconnect();
-    if (conn_) {
-        mysql_close(conn_);
-    }
 }
 
 bool Database::connect(const std::string& host, const std::string& user,
                        const std::string& password, const std::string& database,
                        unsigned int port) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
-    // 保存连接参数用于重连
-    host_ = host;
-    user_ = user;
-    password_ = password;
-    database_ = database;
-    port_ = port;
-    
-    if (connected_) {
-        connected_ = false;
-    }
-    
-    // 设置字符集
-    mysql_options(conn_, MYSQL_SET_CHARSET_NAME, "utf8mb4");
-    
-    // 设置自动重连
-    bool reconnect = true;
-    mysql_options(conn_, MYSQL_OPT_RECONNECT, &reconnect);
-    
-    // 设置连接超时
-    unsigned int timeout = 10;
-    mysql_options(conn_, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
-    mysql_options(conn_, MYSQL_OPT_READ_TIMEOUT, &timeout);
-    mysql_options(conn_, MYSQL_OPT_WRITE_TIMEOUT, &timeout);
-    
-    if (!mysql_real_connect(conn_, host.c_str(), user.c_str(), password.c_str(),
-                            database.c_str(), port, nullptr, 0)) {
-        std::cerr << "MySQL连接失败: " << mysql_error(conn_) << std::endl;
-        return false;
+#ifdef HAVE_MYSQL
+    return connect(std::make_unique<MysqlBackend>(host, user, password, database, port));
+#else
+    (void)host; (void)user; (void)password; (void)database; (void)port;
+    LOG_ERROR("未启用 MySQL 支持，请使用嵌入式数据库（DB_BACKEND=sqlite）");
+    return false;
+#endif
+}
+
+bool Database::connect(std::unique_ptr<DbBackend> backend) {
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    if (backend_) {
+        backend_->disconnect();
     }
-    
-    connected_ = true;
-    std::cout << "MySQL连接成功: " << host << ":" << port << "/" << database << std::endl;
-    return true;
+    backend_ = std::move(backend);
+    return backend_ && backend_->connect();
 }
 
 void Database::disconnect() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (connected_ && conn_) {
-        connected_ = false;
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    if (backend_) {
+        backend_->disconnect();
     }
 }
 
 bool Database::isConnected() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return connected_ && conn_ && mysql_ping(conn_) == 0;
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    return backend_ && backend_->ping();
 }
 
 // 检查并重连 (内部方法，调用前必须已持有锁)
 bool Database::ensureConnected() {
     // 注意：此方法由 query/execute 调用，它们已经持有锁
     // 不要在这里再次加锁，否则会死锁
-    
-    if (!conn_) return false;
-    
-    // 尝试ping，如果失败则重连
-    if (mysql_ping(conn_) != 0) {
-        std::cerr << "MySQL连接已断开，尝试重连..." << std::endl;
-        
-        // 手动重新连接
-        mysql_close(conn_);
-        conn_ = mysql_init(nullptr);
-        if (!conn_) {
-            std::cerr << "MySQL重新初始化失败" << std::endl;
-            connected_ = false;
-            return false;
-        }
-        
-        // 重新设置选项
-        mysql_options(conn_, MYSQL_SET_CHARSET_NAME, "utf8mb4");
-        bool reconnect = true;
-        mysql_options(conn_, MYSQL_OPT_RECONNECT, &reconnect);
-        
-        unsigned int timeout = 10;
-        mysql_options(conn_, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
-        mysql_options(conn_, MYSQL_OPT_READ_TIMEOUT, &timeout);
-        mysql_options(conn_, MYSQL_OPT_WRITE_TIMEOUT, &timeout);
-        
-        // 使用保存的连接参数重连
-        const char* host = host_.empty() ? "localhost" : host_.c_str();
-        const char* user = user_.empty() ? "root" : user_.c_str();
-        const char* pwd = password_.empty() ? "@123Fengaoran" : password_.c_str();
-        const char* db = database_.empty() ? "classroom_system" : database_.c_str();
-        
-        if (!mysql_real_connect(conn_, host, user, pwd, db, port_, nullptr, 0)) {
-            std::cerr << "MySQL重连失败: " << mysql_error(conn_) << std::endl;
-            connected_ = false;
-            return false;
-        }
-        
-        std::cout << "MySQL重连成功" << std::endl;
-        connected_ = true;
-    }
-    return true;
+    return backend_ && backend_->ensureConnected();
 }
 
 DbResult Database::query(const std::string& sql) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto waitStart = Clock::now();
+    std::unique_lock<std::timed_mutex> lock(mutex_, std::defer_lock);
     DbResult result;
+    if (!checkout(lock)) return result;
+    StatementTiming timing;
+    timing.waitNs = nanosSince(waitStart);
     
     if (!ensureConnected()) {
-        std::cerr << "数据库未连接" << std::endl;
+        LOG_ERROR("数据库未连接");
         return result;
     }
     
-    if (mysql_query(conn_, sql.c_str()) != 0) {
-        std::cerr << "SQL查询失败: " << mysql_error(conn_) << "\nSQL: " << sql << std::endl;
-        // 尝试重连后重试一次
-        if (ensureConnected() && mysql_query(conn_, sql.c_str()) != 0) {
+    bool timedOut = false;
+    if (!runStatement(sql, &result, timing, timedOut)) {
+        LOG_ERROR("SQL查询失败: %s | SQL: %s", backend_->error().c_str(), sql.c_str());
+        // 尝试重连后重试一次（被超时中断的语句不重试）
+        result.clear();
+        if (timedOut || !ensureConnected() || !runStatement(sql, &result, timing, timedOut)) {
+            finishStatement(sql, timing, lock);
             return result;
         }
     }
+    timing.rows = result.size();
     
-    MYSQL_RES* res = mysql_store_result(conn_);
-    if (!res) {
-        // 可能是非SELECT语句
-        return result;
-    }
+    finishStatement(sql, timing, lock);
+    return result;
+}
+
+bool Database::execute(const std::string& sql) {
+    auto waitStart = Clock::now();
+    std::unique_lock<std::timed_mutex> lock(mutex_, std::defer_lock);
+    if (!checkout(lock)) return false;
+    StatementTiming timing;
+    timing.waitNs = nanosSince(waitStart);
     
-    int numFields = mysql_num_fields(res);
-    MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    if (!ensureConnected()) {
+        LOG_ERROR("数据库未连接");
+        return false;
+    }
     
-    MYSQL_ROW row;
-    while ((row = mysql_fetch_row(res))) {
-        DbRow dbRow;
-        for (int i = 0; i < numFields; i++) {
-            std::string key = fields[i].name;
-            std::string value = row[i] ? row[i] : "";
-            dbRow[key] = value;
-        }
-        result.push_back(dbRow);
+    bool timedOut = false;
+    bool ok = runStatement(sql, nullptr, timing, timedOut);
+    if (!ok) {
+        LOG_ERROR("SQL执行失败: %s | SQL: %s", backend_->error().c_str(), sql.c_str());
+    } else {
+        timing.rows = backend_->affectedRows();
     }
     
-    mysql_free_result(res);
-    return result;
+    finishStatement(sql, timing, lock);
+    return ok;
 }
 
-bool Database::execute(const std::string& sql) {
-    std::lock_guard<std::mutex> lock(mutex_);
+bool Database::executeTransaction(const std::vector<std::string>& statements) {
+    auto waitStart = Clock::now();
+    std::unique_lock<std::timed_mutex> lock(mutex_, std::defer_lock);
+    if (!checkout(lock)) return false;
+    uint64_t waitNs = nanosSince(waitStart);
     
     if (!ensureConnected()) {
-        std::cerr << "数据库未连接" << std::endl;
+        LOG_ERROR("数据库未连接");
         return false;
     }
     
-    if (mysql_query(conn_, sql.c_str()) != 0) {
-        std::cerr << "SQL执行失败: " << mysql_error(conn_) << "\nSQL: " << sql << std::endl;
-        return false;
+    // 各语句的统计在提交并释放锁之后统一记录
+    struct Finished {
+        const std::string* sql;
+        StatementTiming timing;
+        std::string fingerprint;
+        std::string plan;
+        bool slow;
+    };
+    std::vector<Finished> finished;
+    finished.reserve(statements.size());
+    
+    StatementTiming ignored;
+    bool ok = backend_->run("START TRANSACTION", nullptr, ignored);
+    for (size_t i = 0; ok && i < statements.size(); i++) {
+        Finished f{&statements[i], {}, {}, {}, false};
+        f.timing.waitNs = i == 0 ? waitNs : 0;
+        bool timedOut = false;
+        ok = runStatement(statements[i], nullptr, f.timing, timedOut);
+        if (!ok) {
+            LOG_ERROR("SQL执行失败: %s | SQL: %.300s", backend_->error().c_str(), statements[i].c_str());
+        } else {
+            f.timing.rows = backend_->affectedRows();
+        }
+        f.slow = captureStatement(statements[i], f.timing, f.fingerprint, f.plan);
+        finished.push_back(std::move(f));
     }
+    if (ok) {
+        ok = backend_->run("COMMIT", nullptr, ignored);
+    }
+    if (!ok) {
+        backend_->run("ROLLBACK", nullptr, ignored);
+    }
+    lock.unlock();
     
-    return true;
+    for (auto& f : finished) {
+        recordStatement(*f.sql, f.timing, std::move(f.fingerprint), f.plan, f.slow);
+    }
+    return ok;
+}
+
+void Database::setTimeouts(std::chrono::milliseconds checkout, std::chrono::milliseconds statement) {
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    checkoutTimeout_ = checkout;
+    statementTimeout_ = statement;
+}
+
+// 只有一条连接：等锁就是等连接。等不到时按失败返回，调用方（处理函数）给出错误响应，
+// 而不是让请求无限期地排在一条慢语句后面
+bool Database::checkout(std::unique_lock<std::timed_mutex>& lock) {
+    if (lock.try_lock_for(checkoutTimeout_)) return true;
+    LOG_WARN("等待数据库连接超过 %lld ms，放弃本次调用", static_cast<long long>(checkoutTimeout_.count()));
+    Metrics::getInstance().recordTimeout(TimeoutKind::DbCheckout);
+    return false;
+}
+
+bool Database::runStatement(const std::string& sql, DbResult* result, StatementTiming& timing, bool& timedOut) {
+    if (statementTimeout_.count() <= 0) return backend_->run(sql, result, timing);
+    
+    // 到期回调在定时线程上中断语句；cancel 返回后回调不会再执行，backend_ 在持锁期间不会被替换
+    std::atomic<bool> interrupted{false};
+    TimerService::Timer timer;
+    DbBackend* backend = backend_.get();
+    TimerService::getInstance().schedule(timer, statementTimeout_, [backend, &interrupted]() {
+        interrupted.store(true, std::memory_order_relaxed);
+        backend->interrupt();
+    });
+    bool ok = backend_->run(sql, result, timing);
+    TimerService::getInstance().cancel(timer);
+    
+    timedOut = !ok && interrupted.load(std::memory_order_relaxed);
+    if (timedOut) {
+        LOG_WARN("SQL执行超过 %lld ms，已中断 | SQL: %.300s",
+                 static_cast<long long>(statementTimeout_.count()), sql.c_str());
+        Metrics::getInstance().recordTimeout(TimeoutKind::DbStatement);
+    }
+    return ok;
+}
+
+// 慢查询在仍持有连接时捕获EXPLAIN，其余统计在释放锁之后记录
+void Database::finishStatement(const std::string& sql, const StatementTiming& timing,
+                               std::unique_lock<std::timed_mutex>& lock) {
+    std::string fingerprint;
+    std::string plan;
+    bool slow = captureStatement(sql, timing, fingerprint, plan);
+    lock.unlock();
+    recordStatement(sql, timing, std::move(fingerprint), plan, slow);
+}
+
+// 调用前必须已持有锁
+bool Database::captureStatement(const std::string& sql, const StatementTiming& timing,
+                                std::string& fingerprint, std::string& plan) {
+    if (Tracer::active()) {
+        // 各阶段首尾相接，从结束时刻倒推
+        auto end = Clock::now();
+        auto convertStart = end - std::chrono::nanoseconds(timing.convertNs);
+        auto fetchStart = convertStart - std::chrono::nanoseconds(timing.fetchNs);
+        auto execStart = fetchStart - std::chrono::nanoseconds(timing.execNs);
+        auto waitStart = execStart - std::chrono::nanoseconds(timing.waitNs);
+        Tracer::addSpan("db.query", waitStart, end, sql.substr(0, 300));
+        Tracer::addSpan("db.wait", waitStart, execStart);
+        Tracer::addSpan("db.exec", execStart, fetchStart);
+        Tracer::addSpan("db.fetch", fetchStart, convertStart);
+        Tracer::addSpan("db.convert", convertStart, end);
+    }
+    
+    auto& stats = QueryStats::getInstance();
+    bool slow = stats.isSlow(timing);
+    if (slow) {
+        fingerprint = QueryStats::fingerprint(sql);
+        if (stats.shouldExplain(fingerprint)) {
+            TraceSpan span("db.explain");
+            plan = explain(sql);
+        }
+    }
+    return slow;
+}
+
+void Database::recordStatement(const std::string& sql, const StatementTiming& timing,
+                               std::string fingerprint, const std::string& plan, bool slow) {
+    auto& metrics = Metrics::getInstance();
+    metrics.recordDbWait(timing.waitNs);
+    metrics.recordDbQuery(Metrics::statementKind(sql), timing.totalNs());
+    
+    auto& stats = QueryStats::getInstance();
+    if (!slow) fingerprint = QueryStats::fingerprint(sql);
+    stats.record(fingerprint, sql, timing);
+    if (slow) {
+        stats.recordSlow(fingerprint, sql, timing, plan);
+    }
+}
+
+// 调用前必须已持有锁
+std::string Database::explain(const std::string& sql) {
+    DbResult plan;
+    StatementTiming timing;
+    if (!backend_->run(backend_->explainPrefix() + sql, &plan, timing)) {
+        LOG_WARN("EXPLAIN失败: %s", backend_->error().c_str());
+        return "";
+    }
+    return Json::fromDbResult(plan);
 }
 
 unsigned long long Database::lastInsertId() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return mysql_insert_id(conn_);
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    return backend_ ? backend_->lastInsertId() : 0;
 }
 
 unsigned long long Database::affectedRows() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return mysql_affected_rows(conn_);
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    return backend_ ? backend_->affectedRows() : 0;
 }
 
 std::string Database::escape(const std::string& str) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (!conn_) return str;
-    
-    std::vector<char> buffer(str.size() * 2 + 1);
-    mysql_real_escape_string(conn_, buffer.data(), str.c_str(), str.size());
-    return std::string(buffer.data());
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    if (!backend_) return str;
+    return backend_->escape(str);
 }
 
 std::string Database::getError() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return conn_ ? mysql_error(conn_) : "No connection";
+    std::lock_guard<std::timed_mutex> lock(mutex_);
+    return backend_ ? backend_->error() : "No connection";
 }
@@ -0,0 +1,448 @@
+#include "event_loop.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+constexpr size_t kReadBufferSize = 64 * 1024;
+constexpr int kMaxEvents = 256;
+constexpr int kListenBacklog = 4096;
+
+void countSyscall(IoSyscall call) {
+    Metrics::getInstance().recordSyscall(call);
+}
+
+} // namespace
+
+// ========== EventLoop ==========
+EventLoop::EventLoop(HttpServer& server, int index)
+    : server_(server), index_(index), wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) {}
+
+EventLoop::~EventLoop() {
+    if (wakeFd_ >= 0) close(wakeFd_);
+}
+
+void EventLoop::post(std::function<void()> task) {
+    bool first;
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        first = posted_.empty();
+        posted_.push_back(std::move(task));
+    }
+    // 队列非空时循环已被唤醒过，不必重复写 eventfd
+    if (first) wake();
+}
+
+void EventLoop::wake() {
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd_, &one, sizeof(one));
+        (void)written;
+    }
+}
+
+void EventLoop::runPosted() {
+    uint64_t count;
+    ssize_t n = read(wakeFd_, &count, sizeof(count));
+    (void)n;
+    
+    std::vector<std::function<void()>> tasks;
+    {
+        std::lock_guard<std::mutex> lock(postMutex_);
+        tasks.swap(posted_);
+    }
+    for (auto& task : tasks) {
+        task();
+    }
+}
+
+std::chrono::milliseconds EventLoop::timeoutFor(TimeoutKind kind) const {
+    const ServerTimeouts& timeouts = server_.timeouts_;
+    switch (kind) {
+        case TimeoutKind::Header: return timeouts.header;
+        case TimeoutKind::Body: return timeouts.body;
+        case TimeoutKind::Write: return timeouts.write;
+        case TimeoutKind::Handler: return timeouts.handler;
+        default: return timeouts.idle;
+    }
+}
+
+void EventLoop::sendTimeoutResponse(int fd, TimeoutKind kind) {
+    Metrics::getInstance().recordTimeout(kind);
+    int status = kind == TimeoutKind::Header || kind == TimeoutKind::Body ? 408
+               : kind == TimeoutKind::Handler ? 504 : 0;
+    if (status == 0) return;
+    std::string response = HttpServer::timeoutResponse(status);
+    ssize_t sent = send(fd, response.data(), response.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    (void)sent;
+    countSyscall(IoSyscall::Send);
+}
+
+int EventLoop::openListenSocket(int port, bool nonBlocking) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | (nonBlocking ? SOCK_NONBLOCK : 0), 0);
+    if (fd < 0) return -1;
+
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        LOG_ERROR("事件循环 %d: 不支持 SO_REUSEPORT: %s", index_, strerror(errno));
+        close(fd);
+        return -1;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    if (bind(fd, (sockaddr*)&addr, sizeof(addr)) < 0 || ::listen(fd, kListenBacklog) < 0) {
+        LOG_ERROR("事件循环 %d: 监听端口 %d 失败: %s", index_, port, strerror(errno));
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+void EventLoop::pinToCpu(int cpu) {
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        LOG_WARN("事件循环 %d: 绑定 CPU %d 失败", index_, cpu);
+    }
+}
+
+bool EventLoop::takeRequest(std::string& in, RequestFrame& frame, std::string& request, RequestFrame& taken) {
+    if (in.empty() || !frame.complete(in)) return false;
+    taken = frame;
+    if (taken.tooLarge || in.size() == taken.expected) {
+        request.swap(in);
+        in.clear();
+    } else {
+        request = in.substr(0, taken.expected);
+        in.erase(0, taken.expected);
+    }
+    if (taken.tooLarge) taken.keepAlive = false;
+    frame.reset();
+    return true;
+}
+
+// ========== EpollLoop ==========
+EpollLoop::EpollLoop(HttpServer& server, int index)
+    : EventLoop(server, index), listenFd_(-1), epollFd_(-1), running_(false), nextId_(1),
+      buffer_(kReadBufferSize) {}
+
+EpollLoop::~EpollLoop() {
+    for (auto& [fd, conn] : connections_) {
+        close(fd);
+    }
+    if (listenFd_ >= 0) close(listenFd_);
+    if (epollFd_ >= 0) close(epollFd_);
+}
+
+bool EpollLoop::listen(int port) {
+    listenFd_ = openListenSocket(port, true);
+    if (listenFd_ < 0) return false;
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) return false;
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listenFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &ev);
+    ev.data.fd = wakeFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    running_ = true;
+    return true;
+}
+
+void EpollLoop::stop() {
+    running_ = false;
+    wake();
+}
+
+void EpollLoop::run(int cpu) {
+    pinToCpu(cpu);
+    Executor::setCurrent(this);
+
+    epoll_event events[kMaxEvents];
+    while (running_) {
+        int n = epoll_wait(epollFd_, events, kMaxEvents, wheel_.timeoutMs(Clock::now()));
+        countSyscall(IoSyscall::Wait);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("事件循环 %d: epoll_wait 失败: %s", index_, strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd_) {
+                acceptConnections();
+                continue;
+            }
+            if (fd == wakeFd_) {
+                runPosted();
+                continue;
+            }
+
+            auto it = connections_.find(fd);
+            if (it == connections_.end()) continue;
+            Connection& conn = it->second;
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+            } else if (events[i].events & EPOLLOUT) {
+                onWritable(conn);
+            } else if (events[i].events & EPOLLIN) {
+                onReadable(conn);
+            }
+        }
+        wheel_.advance(Clock::now());
+    }
+    Executor::setCurrent(nullptr);
+}
+
+void EpollLoop::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        countSyscall(IoSyscall::Accept);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK && running_) {
+                LOG_WARN("事件循环 %d: accept 失败: %s", index_, strerror(errno));
+            }
+            return;
+        }
+
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        countSyscall(IoSyscall::Control);
+
+        epoll_event ev{};
+        ev.events = EPOLLIN;
+        ev.data.fd = fd;
+        countSyscall(IoSyscall::Control);
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            close(fd);
+            continue;
+        }
+        Connection& conn = connections_[fd];
+        conn.fd = fd;
+        conn.id = nextId_++;
+        conn.events = EPOLLIN;
+        conn.acceptedAt = Clock::now();
+        refreshTimer(conn);
+    }
+}
+
+void EpollLoop::onReadable(Connection& conn) {
+    while (true) {
+        ssize_t n = recv(conn.fd, buffer_.data(), buffer_.size(), 0);
+        countSyscall(IoSyscall::Recv);
+        if (n > 0) {
+            if (conn.in.empty()) conn.readStart = Clock::now();
+            conn.in.append(buffer_.data(), n);
+            if (static_cast<size_t>(n) < buffer_.size()) break;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+        if (n < 0) {
+            closeConnection(conn.fd);
+            return;
+        }
+        // 对端关闭写方向：已收到的完整请求仍然处理并回复
+        conn.peerClosed = true;
+        break;
+    }
+    if (!processBuffered(conn)) return;
+    if (conn.peerClosed && conn.out.empty() && !conn.awaiting) {
+        closeConnection(conn.fd);
+        return;
+    }
+    refreshTimer(conn);
+}
+
+void EpollLoop::onWritable(Connection& conn) {
+    if (!flush(conn)) {
+        closeConnection(conn.fd);
+        return;
+    }
+    if (conn.outPos < conn.out.size()) {
+        // 对端在读：发送超时从这次进展重新计算
+        conn.phase = TimeoutKind::Count;
+        refreshTimer(conn);
+        return;
+    }
+    if (conn.closeAfterWrite) {
+        closeConnection(conn.fd);
+        return;
+    }
+    updateInterest(conn, EPOLLIN);
+    if (processBuffered(conn)) refreshTimer(conn);
+}
+
+bool EpollLoop::processBuffered(Connection& conn) {
+    std::string request;
+    RequestFrame frame;
+    while (!conn.awaiting && conn.out.empty() && takeRequest(conn.in, conn.frame, request, frame)) {
+        conn.closeAfterWrite = !frame.keepAlive || conn.peerClosed;
+        bool done;
+        try {
+            done = process(request, frame, conn.acceptedAt, conn.readStart,
+                           [this, fd = conn.fd, id = conn.id](const std::string& response,
+                                                              ConnectionTakeover takeover) {
+                               deliver(fd, id, response, std::move(takeover));
+                           }, conn.closed);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Client handling error: %s", e.what());
+            closeConnection(conn.fd);
+            return false;
+        }
+        if (!done) {
+            // 异步处理函数挂起：等待期间不读取该连接
+            conn.awaiting = true;
+            updateInterest(conn, 0);
+            return true;
+        }
+        if (!afterResponse(conn)) return false;
+    }
+    // 请求头超过上限前一直等待更多数据
+    return true;
+}
+
+bool EpollLoop::afterResponse(Connection& conn) {
+    if (conn.takeover) {
+        handOff(conn);
+        return false;
+    }
+    // 下一个请求（流水线中已到达的数据）从现在开始计时
+    conn.acceptedAt = conn.readStart = Clock::now();
+    conn.served = true;
+    conn.phase = TimeoutKind::Count;    // 每个请求的各阶段重新计时
+    if (conn.writeFailed) {
+        closeConnection(conn.fd);
+        return false;
+    }
+    if (conn.outPos < conn.out.size()) {
+        updateInterest(conn, EPOLLOUT);
+        return true;
+    }
+    conn.out.clear();
+    conn.outPos = 0;
+    if (conn.closeAfterWrite) {
+        closeConnection(conn.fd);
+        return false;
+    }
+    updateInterest(conn, EPOLLIN);
+    return true;
+}
+
+void EpollLoop::deliver(int fd, uint64_t id, const std::string& response, ConnectionTakeover takeover) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end() || it->second.id != id) return;    // 等待期间连接已关闭
+    Connection& conn = it->second;
+    conn.out = response;
+    conn.outPos = 0;
+    // 接管连接的响应头由接管方发出
+    if (takeover) conn.takeover = std::move(takeover);
+    else conn.writeFailed = !flush(conn);
+    if (!conn.awaiting) return;     // 同步处理：由 processBuffered 继续
+
+    conn.awaiting = false;
+    if (!afterResponse(conn) || !processBuffered(conn)) return;
+    if (conn.peerClosed && conn.out.empty() && !conn.awaiting) {
+        closeConnection(fd);
+        return;
+    }
+    refreshTimer(conn);
+}
+
+bool EpollLoop::flush(Connection& conn) {
+    while (conn.outPos < conn.out.size()) {
+        ssize_t n = send(conn.fd, conn.out.data() + conn.outPos, conn.out.size() - conn.outPos, MSG_NOSIGNAL);
+        countSyscall(IoSyscall::Send);
+        if (n > 0) {
+            conn.outPos += n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        return n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+    }
+    conn.out.clear();
+    conn.outPos = 0;
+    return true;
+}
+
+void EpollLoop::updateInterest(Connection& conn, uint32_t events) {
+    if (conn.events == events) return;
+    conn.events = events;
+    // 等待发送或异步响应时不再读取，避免流水线请求在输入缓冲中无限堆积
+    epoll_event ev{};
+    ev.events = events;
+    ev.data.fd = conn.fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    countSyscall(IoSyscall::Control);
+}
+
+void EpollLoop::refreshTimer(Connection& conn) {
+    TimeoutKind phase;
+    if (conn.awaiting) {
+        phase = TimeoutKind::Handler;
+    } else if (conn.outPos < conn.out.size()) {
+        phase = TimeoutKind::Write;
+    } else if (conn.in.empty()) {
+        // 新连接的第一个请求从建立连接起就按请求头计时，只连不发的客户端不能占满空闲超时
+        phase = conn.served ? TimeoutKind::Idle : TimeoutKind::Header;
+    } else {
+        phase = conn.frame.headerEnd == std::string::npos ? TimeoutKind::Header : TimeoutKind::Body;
+    }
+    if (phase == conn.phase && conn.timer.armed()) return;
+    conn.phase = phase;
+    wheel_.schedule(conn.timer, timeoutFor(phase), [this, fd = conn.fd, phase]() { onTimeout(fd, phase); });
+}
+
+void EpollLoop::onTimeout(int fd, TimeoutKind kind) {
+    // 定时器随连接销毁而取消，回调执行时连接一定还在
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return;
+    if (it->second.outPos >= it->second.out.size()) sendTimeoutResponse(fd, kind);
+    else Metrics::getInstance().recordTimeout(kind);
+    closeConnection(fd);
+}
+
+void EpollLoop::handOff(Connection& conn) {
+    int fd = conn.fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    countSyscall(IoSyscall::Control);
+    ConnectionTakeover takeover = std::move(conn.takeover);
+    std::string unsent = conn.out.substr(conn.outPos);
+    std::string received = std::move(conn.in);
+    conn.closed->store(true, std::memory_order_relaxed);
+    connections_.erase(fd);         // 定时器随之取消
+    try {
+        takeover(fd, std::move(unsent), std::move(received));
+    } catch (const std::exception& e) {
+        LOG_ERROR("Connection takeover error: %s", e.what());
+        close(fd);
+    }
+}
+
+void EpollLoop::closeConnection(int fd) {
+    auto it = connections_.find(fd);
+    if (it != connections_.end()) it->second.closed->store(true, std::memory_order_relaxed);
+    // close 会自动把 fd 移出 epoll，不需要 EPOLL_CTL_DEL
+    close(fd);
+    countSyscall(IoSyscall::Close);
+    connections_.erase(fd);
+}
@@ -1,10 +1,430 @@
 #include "http_server.hpp"
+#include "metrics.hpp"
+#include "logger.hpp"
+#include "tracer.hpp"
+#include "event_loop.hpp"
+#include "io_uring_loop.hpp"
+#include "admission.hpp"
+#include "timer_wheel.hpp"
 #include <iostream>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
 #include <cstring>
+#include <strings.h>
+#include <cstdlib>
+#include <cstdio>
 #include <regex>
+#include <chrono>
+#include <future>
+#include <sched.h>
+#include <fcntl.h>
+#include <sys/file.h>
+
+namespace {
+
+// 追踪打点：记录从上一个打点到现在的span，未被采样时不取时钟
+struct TraceMarker {
+    Tracer::Clock::time_point last;
+    
+    void mark(const char* name, const std::string& detail = "") {
+        if (!Tracer::active()) return;
+        auto now = Tracer::Clock::now();
+        Tracer::addSpan(name, last, now, detail);
+        last = now;
+    }
+    
+    void markAt(const char* name, Tracer::Clock::time_point at) {
+        if (!Tracer::active()) return;
+        Tracer::addSpan(name, last, at);
+        last = at;
+    }
+};
+
+// 不带 SO_REUSEPORT 试绑定一次，端口已有监听者时返回 false
+bool portAvailable(int port) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return true;
+    int opt = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+    bool available = bind(fd, (sockaddr*)&addr, sizeof(addr)) == 0 || errno != EADDRINUSE;
+    close(fd);
+    return available;
+}
+
+// 按 Accept-Encoding 压缩响应体并序列化；不压缩（未启用、太小、非文本、客户端不接受）时返回 false。
+// 大响应以 chunked 发出，压缩输出边产生边分段写入 out，不需要先得到压缩后的总长度
+bool serializeCompressed(const HttpRequest& req, HttpResponse& res, const CompressionOptions& options,
+                         std::string& out) {
+    if (!options.enabled || res.body.size() < options.minSize) return false;
+    auto type = res.headers.find("Content-Type");
+    if (type == res.headers.end() || !ResponseCompressor::compressible(type->second)) return false;
+    if (res.headers.count("Content-Encoding")) return false;
+    
+    // 是否压缩取决于请求头，中间缓存需要按 Accept-Encoding 区分
+    res.headers["Vary"] = "Accept-Encoding";
+    ContentCoding coding = ResponseCompressor::negotiate(req.header("Accept-Encoding"));
+    if (coding == ContentCoding::Identity) return false;
+    
+    auto start = std::chrono::steady_clock::now();
+    size_t originalSize = res.body.size();
+    auto& compressor = ResponseCompressor::local();
+    res.headers["Content-Encoding"] = ResponseCompressor::codingName(coding);
+    bool chunked = res.body.size() >= options.chunkedSize && req.version == "HTTP/1.1";
+    size_t compressedSize = 0;
+    bool ok;
+    if (chunked) {
+        res.headers["Transfer-Encoding"] = "chunked";
+        out = res.head();
+        out += "\r\n";
+        ok = compressor.compress(coding, options.level, res.body.data(), res.body.size(),
+                                 [&](const char* data, size_t size) {
+            char length[24];
+            int n = snprintf(length, sizeof(length), "%zx\r\n", size);
+            out.append(length, n);
+            out.append(data, size);
+            out += "\r\n";
+            compressedSize += size;
+        });
+        out += "0\r\n\r\n";
+    } else {
+        std::string compressed;
+        ok = compressor.compress(coding, options.level, res.body, compressed);
+        if (ok) {
+            compressedSize = compressed.size();
+            res.body.swap(compressed);
+            out = res.toString();
+        }
+    }
+    if (!ok) {
+        LOG_WARN("响应压缩失败，改为不压缩发送");
+        res.headers.erase("Content-Encoding");
+        res.headers.erase("Transfer-Encoding");
+        return false;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    Metrics::getInstance().recordCompression(originalSize, compressedSize,
+                                             std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    return true;
+}
+
+// 一次请求的处理状态；协程处理函数挂起期间保存在堆上
+struct Exchange {
+    HttpRequest req;
+    HttpResponse res;
+    RouteMetrics* metrics = nullptr;
+    TraceMarker trace;
+    size_t bytesRead = 0;
+    bool keepAlive = false;
+    std::chrono::steady_clock::time_point startTime;
+    ResponseWriter write;
+    bool finished = false;
+    AdmissionController::RouteClass* admission = nullptr;  // 持有的准入名额，finish 时归还
+    std::chrono::steady_clock::time_point admittedAt;
+    Tracer::Context context;                                // 排队等待名额期间摘下的追踪
+    std::unique_ptr<TimerWheel::Timer> queueTimer;          // 排队等待名额的截止时间（事件循环模式，只在循环线程上使用）
+    std::shared_ptr<const std::atomic<bool>> closed;        // 连接已关闭（事件循环模式）
+    const CompressionOptions* compression = nullptr;
+    ResponseCache::Ticket ticket;                           // 缓存未命中的计算方：完成时存入缓存
+    std::string ifNoneMatch;                                // 启用缓存的路由上取下的条件请求头
+    
+    void admit(AdmissionController::RouteClass* routeClass) {
+        admission = routeClass;
+        admittedAt = std::chrono::steady_clock::now();
+        trace.mark("server.admission");
+    }
+    
+    // 发送响应并记录指标
+    void finish() {
+        if (admission) {
+            auto held = std::chrono::steady_clock::now() - admittedAt;
+            AdmissionController::getInstance().release(
+                *admission, std::chrono::duration_cast<std::chrono::nanoseconds>(held).count());
+            admission = nullptr;
+        }
+        std::string response;
+        if (res.takeover) {
+            // 长连接的响应体由接管方之后写出，这里只有响应头
+            response = res.head() + "\r\n";
+        } else {
+            if (!keepAlive) res.headers["Connection"] = "close";
+            if (!compression || !serializeCompressed(req, res, *compression, response)) response = res.toString();
+        }
+        trace.mark("server.serialize");
+        if (!ticket) {
+            send(response, std::move(res.takeover), res.statusCode);
+            return;
+        }
+        
+        // 缓存未命中的计算方：200 响应存入缓存并交给等待同一键的请求，自己再按条件请求回 304 或完整响应
+        ResponseCache::Shared shared;
+        if (res.statusCode == 200 && !res.takeover) {
+            shared.buffer = std::make_shared<const std::string>(std::move(response));
+            shared.etag = res.headers.count("ETag") ? res.headers["ETag"] : "";
+            shared.cacheControl = res.headers.count("Cache-Control") ? res.headers["Cache-Control"] : "";
+        }
+        ResponseCache::getInstance().complete(ticket, shared);
+        if (shared.buffer) {
+            finishCached(shared);
+        } else {
+            send(response, std::move(res.takeover), res.statusCode);
+        }
+    }
+    
+    // 发出缓存（或同一键上其他请求计算）的响应；条件请求仍有效时回 304
+    void finishCached(const ResponseCache::Shared& shared) {
+        if (!ifNoneMatch.empty() && !shared.etag.empty() && TableVersions::matches(ifNoneMatch, shared.etag)) {
+            HttpResponse notModified;
+            notModified.statusCode = 304;
+            notModified.headers["ETag"] = shared.etag;
+            if (!shared.cacheControl.empty()) notModified.headers["Cache-Control"] = shared.cacheControl;
+            if (!keepAlive) notModified.headers["Connection"] = "close";
+            send(notModified.toString(), nullptr, 304);
+            return;
+        }
+        send(*shared.buffer, nullptr, 200);
+    }
+    
+    void send(const std::string& response, ConnectionTakeover takeover, int statusCode) {
+        write(response, std::move(takeover));
+        trace.mark("server.send");
+        auto elapsed = std::chrono::steady_clock::now() - startTime;
+        metrics->record(statusCode, bytesRead, response.size(),
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        if (Tracer::active()) {
+            Tracer::getInstance().endRequest(req.method + " " + req.path, statusCode);
+        }
+        finished = true;
+    }
+};
+
+// 准入控制拒绝：快速返回 503，客户端稍后重试
+void rejectOverloaded(HttpResponse& res) {
+    res.setStatus(503);
+    res.headers["Retry-After"] = "1";
+    res.setJson("{\"error\": \"服务器繁忙，请稍后重试\"}");
+}
+
+// 执行普通处理函数（响应由调用方发出）
+void runHandler(const RouteHandler& handler, Exchange& exchange) {
+    try {
+        handler(exchange.req, exchange.res);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Handler error: %s %s: %s", exchange.req.method.c_str(), exchange.req.path.c_str(), e.what());
+        exchange.res.setStatus(500);
+        exchange.res.setJson("{\"error\": \"服务器内部错误\"}");
+    }
+    exchange.trace.mark("handler", exchange.metrics->pattern());
+}
+
+// 驱动协程处理函数直到完成并发出响应；首次挂起时返回到调用者
+DetachedTask runAsync(const AsyncRouteHandler& handler, std::shared_ptr<Exchange> exchange) {
+    try {
+        HttpResponse res = co_await handler(exchange->req);
+        // 中间件设置的响应头保留（处理函数设置的同名头优先）
+        res.headers.insert(exchange->res.headers.begin(), exchange->res.headers.end());
+        exchange->res = std::move(res);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Handler error: %s %s: %s", exchange->req.method.c_str(), exchange->req.path.c_str(), e.what());
+        exchange->res.setStatus(500);
+        exchange->res.setJson("{\"error\": \"服务器内部错误\"}");
+    }
+    exchange->trace.mark("handler", exchange->metrics->pattern());
+    try {
+        exchange->finish();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Client handling error: %s", e.what());
+        if (Tracer::active()) Tracer::getInstance().endRequest("(error)", 500);
+    }
+}
+
+// 执行路由的处理函数（需要准入名额时先取得名额）并发出响应；协程挂起或排队等待名额时返回 false
+bool dispatch(const RouteHandler& handler, const AsyncRouteHandler& asyncHandler,
+              AdmissionController::RouteClass* routeClass, std::shared_ptr<Exchange> pending) {
+    auto run = [&handler, &asyncHandler, pending]() {
+        if (asyncHandler) {
+            runAsync(asyncHandler, pending);
+        } else {
+            runHandler(handler, *pending);
+            pending->finish();
+        }
+    };
+    if (!routeClass) {
+        run();
+        return pending->finished;
+    }
+    
+    auto& controller = AdmissionController::getInstance();
+    Executor* executor = Executor::current();
+    bool admitted;
+    if (!executor) {
+        // 每连接一线程：在本线程上等待名额
+        admitted = controller.acquire(*routeClass);
+    } else {
+        auto result = controller.acquire(*routeClass, [executor, pending, run, routeClass](bool ok) {
+            // 排队期间连接已关闭（超时或对端断开）：名额转给下一个。截止定时器属于循环线程，回到那里取消
+            if (ok && pending->closed && pending->closed->load(std::memory_order_relaxed)) {
+                executor->post([pending]() { if (pending->queueTimer) pending->queueTimer->cancel(); });
+                return false;
+            }
+            executor->post([pending, run, routeClass, ok]() {
+                if (pending->queueTimer) pending->queueTimer->cancel();
+                Tracer::attach(std::move(pending->context));
+                if (ok) {
+                    pending->admit(routeClass);
+                    run();
+                } else {
+                    rejectOverloaded(pending->res);
+                    pending->finish();
+                }
+            });
+            return true;
+        });
+        if (result == AdmissionController::Result::Queued) {
+            // 名额到达时的回调投递到本线程，当前请求返回后才会执行。
+            // 类别上的请求都很慢时不会有新的到达或完成来检查截止时间，由本循环的时间轮在截止时间让它超时
+            pending->context = Tracer::detach();
+            if (auto* loop = dynamic_cast<EventLoop*>(executor)) {
+                pending->queueTimer = std::make_unique<TimerWheel::Timer>();
+                loop->timers().schedule(*pending->queueTimer, routeClass->options().deadline,
+                                        [routeClass]() { AdmissionController::getInstance().expire(*routeClass); });
+            }
+            return false;
+        }
+        admitted = result == AdmissionController::Result::Admitted;
+    }
+    if (!admitted) {
+        rejectOverloaded(pending->res);
+        pending->finish();
+        return true;
+    }
+    pending->admit(routeClass);
+    run();
+    return pending->finished;
+}
+
+// 启用缓存的路由：命中时直接发出缓存的报文；同一键上已有请求在计算时等它的结果，否则自己计算并存入缓存。
+// 等待期间不占准入名额；计算方没有可共用的结果时各自计算
+bool serveCached(const ResponseCache::Policy& policy, const RouteHandler& handler,
+                 const AsyncRouteHandler& asyncHandler, AdmissionController::RouteClass* routeClass,
+                 std::shared_ptr<Exchange> pending) {
+    HttpRequest& req = pending->req;
+    // 同一键下发出的报文逐字节相同：内容编码、是否保持连接、协议版本（chunked）都区分
+    ContentCoding coding = pending->compression && pending->compression->enabled
+        ? ResponseCompressor::negotiate(req.header("Accept-Encoding")) : ContentCoding::Identity;
+    std::string variant = std::string(ResponseCompressor::codingName(coding)) +
+                          (pending->keepAlive ? "/keep-alive" : "/close") + "/" + req.version;
+    std::string key = ResponseCache::makeKey(policy, req, variant);
+    
+    // 条件请求由缓存层回答：计算方的处理函数总是生成完整响应，才能存入缓存、交给等待者
+    pending->ifNoneMatch = req.header("If-None-Match");
+    for (auto it = req.headers.begin(); it != req.headers.end();) {
+        if (strcasecmp(it->first.c_str(), "If-None-Match") == 0) it = req.headers.erase(it);
+        else ++it;
+    }
+    
+    auto resume = [&handler, &asyncHandler, routeClass, pending](const ResponseCache::Shared& shared) {
+        if (shared.buffer) {
+            pending->finishCached(shared);
+            return true;
+        }
+        return dispatch(handler, asyncHandler, routeClass, pending);
+    };
+    Executor* executor = Executor::current();
+    std::shared_ptr<std::promise<ResponseCache::Shared>> handoff;
+    ResponseCache::Waiter waiter;
+    if (executor) {
+        waiter = [executor, pending, resume](const ResponseCache::Shared& shared) {
+            // 等待期间连接已关闭：不再计算
+            if (pending->closed && pending->closed->load(std::memory_order_relaxed)) return;
+            executor->post([pending, resume, shared]() {
+                Tracer::attach(std::move(pending->context));
+                resume(shared);
+            });
+        };
+    } else {
+        // 每连接一线程：在本线程上等待计算方的结果
+        handoff = std::make_shared<std::promise<ResponseCache::Shared>>();
+        waiter = [handoff](const ResponseCache::Shared& shared) { handoff->set_value(shared); };
+    }
+    
+    ResponseCache::Shared shared;
+    ResponseCache::Ticket ticket;
+    switch (ResponseCache::getInstance().lookup(policy, key, shared, ticket, std::move(waiter))) {
+        case ResponseCache::Result::Hit:
+            pending->trace.mark("server.cache");
+            pending->finishCached(shared);
+            return true;
+        case ResponseCache::Result::Miss:
+            pending->ticket = std::move(ticket);
+            return dispatch(handler, asyncHandler, routeClass, pending);
+        case ResponseCache::Result::Pending:
+            break;
+    }
+    if (executor) {
+        pending->context = Tracer::detach();
+        return false;
+    }
+    return resume(handoff->get_future().get());
+}
+
+// 请求头中的 Content-Length（不区分大小写），没有时为 0
+size_t contentLength(const std::string& raw, size_t headerEnd) {
+    size_t pos = 0;
+    while (pos < headerEnd) {
+        size_t lineEnd = raw.find("\r\n", pos);
+        if (lineEnd == std::string::npos || lineEnd > headerEnd) lineEnd = headerEnd;
+        if (lineEnd - pos > 15 && strncasecmp(raw.c_str() + pos, "content-length:", 15) == 0) {
+            return std::strtoull(raw.c_str() + pos + 15, nullptr, 10);
+        }
+        pos = lineEnd + 2;
+    }
+    return 0;
+}
+
+// 请求行的协议版本和 Connection 头决定响应后是否保持连接
+bool keepAliveRequested(const std::string& raw, size_t headerEnd) {
+    size_t lineEnd = raw.find("\r\n");
+    bool http11 = lineEnd != std::string::npos && lineEnd >= 8 && raw.compare(lineEnd - 8, 8, "HTTP/1.1") == 0;
+    size_t pos = lineEnd + 2;
+    while (lineEnd != std::string::npos && pos < headerEnd) {
+        lineEnd = raw.find("\r\n", pos);
+        if (lineEnd == std::string::npos || lineEnd > headerEnd) lineEnd = headerEnd;
+        if (lineEnd - pos > 11 && strncasecmp(raw.c_str() + pos, "connection:", 11) == 0) {
+            std::string value = raw.substr(pos + 11, lineEnd - pos - 11);
+            if (strcasestr(value.c_str(), "close")) return false;
+            if (strcasestr(value.c_str(), "keep-alive")) return true;
+        }
+        pos = lineEnd + 2;
+    }
+    return http11;
+}
+
+} // namespace
+
+// ========== RequestFrame ==========
+bool RequestFrame::complete(const std::string& raw) {
+    if (tooLarge) return true;
+    if (headerEnd == std::string::npos) {
+        headerEnd = raw.find("\r\n\r\n");
+        if (headerEnd == std::string::npos) {
+            tooLarge = raw.size() > kMaxHeaderSize;
+            return tooLarge;
+        }
+        size_t length = contentLength(raw, headerEnd);
+        if (length > kMaxBodySize) {
+            tooLarge = true;
+            return true;
+        }
+        expected = headerEnd + 4 + length;
+        keepAlive = keepAliveRequested(raw, headerEnd);
+    }
+    return raw.size() >= expected;
+}
 
 // ========== HttpRequest ==========
 std::map<std::string, std::string> HttpRequest::parseQuery() const {
@@ -52,6 +472,15 @@ std::string HttpRequest::getPathParam(const std::string& pattern, int index) con
     return "";
 }
 
+std::string HttpRequest::header(const std::string& name) const {
+    auto it = headers.find(name);
+    if (it != headers.end()) return it->second;
+    for (const auto& [key, value] : headers) {
+        if (strcasecmp(key.c_str(), name.c_str()) == 0) return value;
+    }
+    return "";
+}
+
 // ========== HttpResponse ==========
 void HttpResponse::setJson(const std::string& json) {
     headers["Content-Type"] = "application/json; charset=utf-8";
@@ -71,20 +500,34 @@ void HttpResponse::setStatus(int code, const std::string& message) {
 }
 
 std::string HttpResponse::toString() const {
+    std::string out = head();
+    out += "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    out += body;
+    return out;
+}
+
+std::string HttpResponse::head() const {
     std::ostringstream oss;
     
     // 状态行
     std::string statusText;
     switch (statusCode) {
+        case 101: statusText = "Switching Protocols"; break;
         case 200: statusText = "OK"; break;
         case 201: statusText = "Created"; break;
         case 204: statusText = "No Content"; break;
+        case 304: statusText = "Not Modified"; break;
         case 400: statusText = "Bad Request"; break;
         case 401: statusText = "Unauthorized"; break;
         case 403: statusText = "Forbidden"; break;
         case 404: statusText = "Not Found"; break;
+        case 408: statusText = "Request Timeout"; break;
         case 409: statusText = "Conflict"; break;
+        case 413: statusText = "Payload Too Large"; break;
+        case 426: statusText = "Upgrade Required"; break;
         case 500: statusText = "Internal Server Error"; break;
+        case 503: statusText = "Service Unavailable"; break;
+        case 504: statusText = "Gateway Timeout"; break;
         default: statusText = "Unknown";
     }
     
@@ -94,47 +537,101 @@ std::string HttpResponse::toString() const {
     oss << "Access-Control-Allow-Origin: *\r\n";
     oss << "Access-Control-Allow-Methods: GET, POST, PUT, DELETE, OPTIONS\r\n";
     oss << "Access-Control-Allow-Headers: Content-Type, Authorization\r\n";
+    oss << "Access-Control-Expose-Headers: X-Next-Cursor\r\n";
     
     // 自定义头
     for (const auto& [key, value] : headers) {
         oss << key << ": " << value << "\r\n";
     }
     
-    // Content-Length
-    oss << "Content-Length: " << body.size() << "\r\n";
-    oss << "\r\n";
-    oss << body;
-    
     return oss.str();
 }
 
 // ========== HttpServer ==========
-HttpServer::HttpServer(int port) : port_(port), serverFd_(-1), running_(false) {}
+HttpServer::HttpServer(int port)
+    : port_(port), serverFd_(-1), portLockFd_(-1), running_(false), loopCount_(0), pinCpus_(false), ioBackend_(IoBackend::Epoll) {
+    auto& metrics = Metrics::getInstance();
+    optionsMetrics_ = metrics.route("OPTIONS", "*");
+    staticMetrics_ = metrics.route("GET", "(static)");
+    notFoundMetrics_ = metrics.route("ANY", "(not found)");
+}
 
 HttpServer::~HttpServer() {
     stop();
 }
 
 void HttpServer::get(const std::string& path, RouteHandler handler) {
-    routes_["GET"][path] = handler;
+    addRoute("GET", path, handler);
 }
 
 void HttpServer::post(const std::string& path, RouteHandler handler) {
-    routes_["POST"][path] = handler;
+    addRoute("POST", path, handler);
 }
 
 void HttpServer::put(const std::string& path, RouteHandler handler) {
-    routes_["PUT"][path] = handler;
+    addRoute("PUT", path, handler);
 }
 
 void HttpServer::del(const std::string& path, RouteHandler handler) {
-    routes_["DELETE"][path] = handler;
+    addRoute("DELETE", path, handler);
+}
+
+void HttpServer::get(const std::string& path, AsyncRouteHandler handler) {
+    addRoute("GET", path, nullptr, handler);
+}
+
+void HttpServer::post(const std::string& path, AsyncRouteHandler handler) {
+    addRoute("POST", path, nullptr, handler);
+}
+
+void HttpServer::put(const std::string& path, AsyncRouteHandler handler) {
+    addRoute("PUT", path, nullptr, handler);
+}
+
+void HttpServer::del(const std::string& path, AsyncRouteHandler handler) {
+    addRoute("DELETE", path, nullptr, handler);
+}
+
+void HttpServer::addRoute(const std::string& method, const std::string& path, RouteHandler handler,
+                          AsyncRouteHandler asyncHandler) {
+    routes_[method][path] = Route{handler, asyncHandler, Metrics::getInstance().route(method, path)};
+}
+
+void HttpServer::admit(const std::string& method, const std::string& pathPrefix,
+                       AdmissionController::RouteClass* routeClass) {
+    for (auto& [routeMethod, patterns] : routes_) {
+        if (method != "*" && method != routeMethod) continue;
+        for (auto& [pattern, route] : patterns) {
+            if (pattern.compare(0, pathPrefix.size(), pathPrefix) == 0) route.admission = routeClass;
+        }
+    }
+}
+
+void HttpServer::cache(const std::string& path, std::vector<Table> tables) {
+    auto methodRoutes = routes_.find("GET");
+    if (methodRoutes == routes_.end()) return;
+    auto route = methodRoutes->second.find(path);
+    if (route == methodRoutes->second.end()) {
+        LOG_WARN("响应缓存: 未注册的路由 GET %s", path.c_str());
+        return;
+    }
+    route->second.cache = std::make_shared<const ResponseCache::Policy>(ResponseCache::Policy{path, std::move(tables)});
+}
+
+void HttpServer::use(Middleware middleware) {
+    middlewares_.push_back(middleware);
 }
 
 void HttpServer::setStaticDir(const std::string& dir) {
     staticDir_ = dir;
 }
 
+void HttpServer::setEventLoops(int loops, bool pinCpus, IoBackend backend) {
+    loopCount_ = std::max(0, loops);
+    pinCpus_ = pinCpus;
+    ioBackend_ = backend;
+}
+
 bool HttpServer::matchRoute(const std::string& pattern, const std::string& path, HttpRequest& req) {
     // 精确匹配
     if (pattern == path) return true;
@@ -179,7 +676,7 @@ HttpRequest HttpServer::parseRequest(const std::string& raw) {
         if (!line.empty() && line.back() == '\r') line.pop_back();
         
         std::istringstream lineStream(line);
-        lineStream >> req.method >> req.path;
+        lineStream >> req.method >> req.path >> req.version;
         
         // 分离路径和查询参数
         size_t queryPos = req.path.find('?');
@@ -248,49 +745,179 @@ void HttpServer::serveStaticFile(const std::string& path, HttpResponse& res) {
     res.statusCode = 200;
 }
 
-void HttpServer::handleClient(int clientFd) {
-    try {
-        char buffer[8192] = {0};
-        ssize_t bytesRead = recv(clientFd, buffer, sizeof(buffer) - 1, 0);
+void HttpServer::handleClient(int clientFd, std::chrono::steady_clock::time_point acceptedAt) {
+    auto readStart = std::chrono::steady_clock::now();
+    
+    // 请求头须在 header 超时内（从连接建立算起）到齐，之后请求体在 body 超时内读完；
+    // 到期时关闭读方向，阻塞中的 recv 随即返回 0
+    struct ReadDeadline {
+        TimerService::Timer timer;
+        std::atomic<int> expired{-1};       // 到期的 TimeoutKind
+        ~ReadDeadline() { TimerService::getInstance().cancel(timer); }
+        
+        void arm(int fd, std::chrono::milliseconds timeout, TimeoutKind kind) {
+            TimerService::getInstance().schedule(timer, timeout, [this, fd, kind]() {
+                expired = static_cast<int>(kind);
+                shutdown(fd, SHUT_RD);
+            });
+        }
+    } deadline;
     
-        if (bytesRead <= 0) {
+    try {
+        // 读到请求头结束，再按 Content-Length 读完请求体
+        std::string raw;
+        char buffer[8192];
+        RequestFrame frame;
+        auto& metrics = Metrics::getInstance();
+        bool readingBody = false;
+        deadline.arm(clientFd, timeouts_.header, TimeoutKind::Header);
+        while (true) {
+            ssize_t n = recv(clientFd, buffer, sizeof(buffer), 0);
+            metrics.recordSyscall(IoSyscall::Recv);
+            if (n <= 0) break;
+            raw.append(buffer, n);
+            if (frame.complete(raw)) break;
+            if (frame.headerEnd != std::string::npos && !readingBody) {
+                raw.reserve(frame.expected);
+                deadline.arm(clientFd, timeouts_.body, TimeoutKind::Body);
+                readingBody = true;
+            }
+        }
+        TimerService::getInstance().cancel(deadline.timer);
+        
+        if (deadline.expired >= 0) {
+            metrics.recordTimeout(static_cast<TimeoutKind>(deadline.expired.load()));
+            std::string response = timeoutResponse(408);
+            send(clientFd, response.c_str(), response.size(), MSG_NOSIGNAL);
+            metrics.recordSyscall(IoSyscall::Send);
+            raw.clear();
+        }
+        if (raw.empty()) {
             close(clientFd);
+            metrics.recordSyscall(IoSyscall::Close);
             return;
         }
         
-        HttpRequest req = parseRequest(buffer);
-        HttpResponse res;
+        // 每个连接只处理一个请求
+        frame.keepAlive = false;
+        bool handedOff = false;
+        processRequest(raw, frame, acceptedAt, readStart,
+                       [&](const std::string& response, ConnectionTakeover takeover) {
+            if (takeover) {
+                // 连同响应头一起交给接管方发送，本线程随即退出
+                handedOff = true;
+                takeover(clientFd, response, raw.size() > frame.expected ? raw.substr(frame.expected) : "");
+                return;
+            }
+            send(clientFd, response.c_str(), response.size(), MSG_NOSIGNAL);
+            metrics.recordSyscall(IoSyscall::Send);
+        });
+        if (handedOff) return;
+        close(clientFd);
+        metrics.recordSyscall(IoSyscall::Close);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Client handling error: %s", e.what());
+        close(clientFd);
+    } catch (...) {
+        LOG_ERROR("Unknown error in client handling");
+        close(clientFd);
+    }
+}
+
+std::string HttpServer::timeoutResponse(int statusCode) {
+    HttpResponse res;
+    res.setStatus(statusCode);
+    res.setJson(statusCode == 408 ? "{\"error\": \"请求超时\"}" : "{\"error\": \"处理超时\"}");
+    res.headers["Connection"] = "close";
+    return res.toString();
+}
+
+bool HttpServer::processRequest(const std::string& raw, const RequestFrame& frame,
+                                std::chrono::steady_clock::time_point acceptedAt,
+                                std::chrono::steady_clock::time_point readStart,
+                                ResponseWriter write,
+                                std::shared_ptr<const std::atomic<bool>> closed) {
+    auto& tracer = Tracer::getInstance();
+    tracer.beginRequest(acceptedAt);
+    Exchange exchange;
+    exchange.trace.last = acceptedAt;
+    exchange.trace.markAt("server.queue", readStart);
+    exchange.write = std::move(write);
+    exchange.closed = std::move(closed);
+    exchange.compression = &compression_;
+    exchange.keepAlive = frame.keepAlive;
+    exchange.metrics = notFoundMetrics_;
+    
+    try {
+        exchange.bytesRead = frame.tooLarge ? raw.size() : std::min(raw.size(), frame.expected);
+        exchange.startTime = std::chrono::steady_clock::now();
+        exchange.trace.mark("server.recv");
+        
+        HttpRequest& req = exchange.req;
+        HttpResponse& res = exchange.res;
+        if (!frame.tooLarge) req = parseRequest(raw);
+        exchange.trace.mark("server.parse");
+        
+        if (frame.tooLarge) {
+            res.setStatus(413, "{\"error\": \"请求过大\"}");
+            res.headers["Content-Type"] = "application/json";
+            exchange.finish();
+            return true;
+        }
         
         // OPTIONS请求（CORS预检）
         if (req.method == "OPTIONS") {
             res.statusCode = 204;
-            std::string response = res.toString();
-            send(clientFd, response.c_str(), response.size(), 0);
-            close(clientFd);
-            return;
+            exchange.metrics = optionsMetrics_;
+            exchange.finish();
+            return true;
         }
         
-        // 查找路由
-        bool found = false;
-        if (routes_.count(req.method)) {
-            for (const auto& [pattern, handler] : routes_[req.method]) {
+        // 查找路由（中间件拒绝的请求也计入对应路由）
+        const Route* route = nullptr;
+        auto methodRoutes = routes_.find(req.method);
+        if (methodRoutes != routes_.end()) {
+            for (const auto& [pattern, candidate] : methodRoutes->second) {
                 if (matchRoute(pattern, req.path, req)) {
-                    try {
-                        handler(req, res);
-                    } catch (const std::exception& e) {
-                        std::cerr << "Handler error: " << e.what() << std::endl;
-                        res.setStatus(500);
-                        res.setJson("{\"error\": \"服务器内部错误\"}");
-                    }
-                    found = true;
+                    route = &candidate;
+                    exchange.metrics = candidate.metrics;
                     break;
                 }
             }
         }
+        exchange.trace.mark("server.route");
+        
+        // 执行中间件
+        bool found = false;
+        for (const auto& middleware : middlewares_) {
+            if (!middleware(req, res)) {
+                found = true;
+                break;
+            }
+        }
+        
+        exchange.trace.mark("server.middleware");
+        
+        bool cached = route && route->cache && ResponseCache::getInstance().enabled();
+        if (!found && route && !route->admission && !route->asyncHandler && !cached) {
+            runHandler(route->handler, exchange);
+            exchange.finish();
+            return true;
+        }
+        
+        // 协程处理函数、需要准入名额或启用了缓存：交换状态移到堆上，挂起、排队或等待时在执行器上完成响应
+        if (!found && route) {
+            auto pending = std::make_shared<Exchange>(std::move(exchange));
+            if (cached) {
+                return serveCached(*route->cache, route->handler, route->asyncHandler, route->admission, pending);
+            }
+            return dispatch(route->handler, route->asyncHandler, route->admission, pending);
+        }
         
         // 未找到路由，尝试静态文件
         if (!found && !staticDir_.empty() && req.method == "GET") {
             serveStaticFile(req.path, res);
+            exchange.metrics = staticMetrics_;
             found = true;
         }
         
@@ -299,19 +926,20 @@ void HttpServer::handleClient(int clientFd) {
             res.headers["Content-Type"] = "application/json";
         }
         
-        std::string response = res.toString();
-        send(clientFd, response.c_str(), response.size(), 0);
-        close(clientFd);
-    } catch (const std::exception& e) {
-        std::cerr << "Client handling error: " << e.what() << std::endl;
-        close(clientFd);
+        exchange.finish();
+        return true;
     } catch (...) {
-        std::cerr << "Unknown error in client handling" << std::endl;
-        close(clientFd);
+        if (Tracer::active()) tracer.endRequest("(error)", 500);
+        throw;
     }
 }
 
 void HttpServer::start() {
+    if (loopCount_ > 0) {
+        runEventLoops();
+        return;
+    }
+    
     serverFd_ = socket(AF_INET, SOCK_STREAM, 0);
     if (serverFd_ < 0) {
         throw std::runtime_error("Failed to create socket");
@@ -338,27 +966,110 @@ void HttpServer::start() {
     running_ = true;
     std::cout << "服务器启动: http://localhost:" << port_ << std::endl;
     
+    auto& metrics = Metrics::getInstance();
+    metrics.setIoBackend("threads", 0);
     while (running_) {
         sockaddr_in clientAddr{};
         socklen_t clientLen = sizeof(clientAddr);
         int clientFd = accept(serverFd_, (sockaddr*)&clientAddr, &clientLen);
+        metrics.recordSyscall(IoSyscall::Accept);
         
         if (clientFd < 0) {
             if (running_) {
-                std::cerr << "Accept failed" << std::endl;
+                LOG_WARN("Accept failed");
             }
             continue;
         }
         
         // 使用线程处理客户端请求
-        std::thread(&HttpServer::handleClient, this, clientFd).detach();
+        std::thread(&HttpServer::handleClient, this, clientFd, std::chrono::steady_clock::now()).detach();
+        metrics.recordSyscall(IoSyscall::Thread);
+    }
+}
+
+void HttpServer::runEventLoops() {
+    // 各循环的监听 socket 带 SO_REUSEPORT，同一用户再启动一个进程也能绑定成功，内核在两个进程间分流连接
+    // （会话、ETag 互不相认）。先按端口取得文件锁（同时启动的两个进程只有一个能拿到），
+    // 再不带 SO_REUSEPORT 试绑定（端口被其他程序或未加锁的旧进程占用），任一失败即退出
+    std::string lockPath = "/tmp/http_server-" + std::to_string(port_) + ".lock";
+    portLockFd_ = open(lockPath.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (portLockFd_ >= 0 && flock(portLockFd_, LOCK_EX | LOCK_NB) < 0) {
+        close(portLockFd_);
+        portLockFd_ = -1;
+        throw std::runtime_error("Port " + std::to_string(port_) + " is owned by another server process (" +
+                                 lockPath + ")");
+    }
+    if (portLockFd_ >= 0) {
+        std::string pid = std::to_string(getpid()) + "\n";
+        if (ftruncate(portLockFd_, 0) == 0 && ::write(portLockFd_, pid.data(), pid.size()) < 0) {
+            LOG_WARN("写入 %s 失败", lockPath.c_str());
+        }
+    }
+    if (!portAvailable(port_)) {
+        throw std::runtime_error("Port " + std::to_string(port_) + " is already in use");
+    }
+    
+    // 可用CPU列表（受 taskset/cgroup 限制时只用允许的核）
+    std::vector<int> cpus;
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (pinCpus_ && sched_getaffinity(0, sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &allowed)) cpus.push_back(cpu);
+        }
+    }
+    
+    bool useIoUring = false;
+    if (ioBackend_ == IoBackend::IoUring) {
+        std::string reason;
+        useIoUring = IoUringLoop::available(reason);
+        if (!useIoUring) {
+            LOG_WARN("io_uring 不可用（%s），使用 epoll", reason.c_str());
+        }
+    }
+    
+    for (int i = 0; i < loopCount_; i++) {
+        std::unique_ptr<EventLoop> loop;
+        if (useIoUring) {
+            loop = std::make_unique<IoUringLoop>(*this, i);
+        } else {
+            loop = std::make_unique<EpollLoop>(*this, i);
+        }
+        if (!loop->listen(port_)) {
+            loops_.clear();
+            throw std::runtime_error("Failed to listen on port " + std::to_string(port_) + " (SO_REUSEPORT)");
+        }
+        loops_.push_back(std::move(loop));
+    }
+    
+    running_ = true;
+    const char* backend = loops_.front()->backend();
+    Metrics::getInstance().setIoBackend(backend, loopCount_);
+    std::cout << "服务器启动: http://localhost:" << port_ << "（" << loopCount_ << " 个 " << backend << " 事件循环"
+              << (cpus.empty() ? "" : "，已绑核") << "）" << std::endl;
+    
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < loops_.size(); i++) {
+        int cpu = cpus.empty() ? -1 : cpus[i % cpus.size()];
+        threads.emplace_back(&EventLoop::run, loops_[i].get(), cpu);
+    }
+    for (auto& thread : threads) {
+        thread.join();
     }
 }
 
 void HttpServer::stop() {
     running_ = false;
     if (serverFd_ >= 0) {
+        shutdown(serverFd_, SHUT_RDWR);     // 唤醒阻塞在 accept 的线程
         close(serverFd_);
         serverFd_ = -1;
     }
+    for (auto& loop : loops_) {
+        loop->stop();
+    }
+    if (portLockFd_ >= 0) {
+        close(portLockFd_);
+        portLockFd_ = -1;
+    }
 }
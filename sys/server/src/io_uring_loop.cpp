@@ -0,0 +1,752 @@
+#include "io_uring_loop.hpp"
+#include "logger.hpp"
+#include "metrics.hpp"
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// 缓冲环和 multishot recv 需要 Linux 6.0 及以上的头文件；更老的系统上只编译桩实现，运行时回退到 epoll
+#ifdef IORING_RECV_MULTISHOT
+
+namespace {
+
+constexpr unsigned kRingEntries = 4096;
+constexpr unsigned kBufferCount = 256;          // 必须是2的幂
+constexpr unsigned kBufferSize = 16 * 1024;
+constexpr uint16_t kBufferGroup = 0;
+// 一个连接等待发送的响应超过此值时暂停处理后续流水线请求
+constexpr size_t kMaxQueuedOutput = 1024 * 1024;
+// 暂停处理期间对端继续发送的数据上限，超过则断开
+constexpr size_t kMaxQueuedInput = RequestFrame::kMaxHeaderSize + RequestFrame::kMaxBodySize;
+
+void countSyscall(IoSyscall call) {
+    Metrics::getInstance().recordSyscall(call);
+}
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int uringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+// user_data：高位为连接编号（不用fd，fd关闭后可能立即被新连接复用），低8位为操作类型
+template <typename Op>
+uint64_t encode(uint32_t id, Op op) {
+    return (static_cast<uint64_t>(id) << 8) | static_cast<uint8_t>(op);
+}
+
+} // namespace
+
+// 提交/完成队列和缓冲环的内存映射
+struct IoUringLoop::Ring {
+    int fd = -1;
+    void* sqPtr = MAP_FAILED;
+    size_t sqSize = 0;
+    void* cqPtr = MAP_FAILED;
+    size_t cqSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqMask = 0;
+    unsigned sqEntries = 0;
+    unsigned localTail = 0;     // 已填写但未提交的 SQE 也计入
+    unsigned toSubmit = 0;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned cqMask = 0;
+    io_uring_cqe* cqes = nullptr;
+
+    io_uring_buf_ring* bufRing = static_cast<io_uring_buf_ring*>(MAP_FAILED);
+    size_t bufRingSize = 0;
+    unsigned bufMask = 0;
+    unsigned bufSize = 0;
+    uint16_t bufTail = 0;
+    bool ringBuffers = false;
+    std::vector<char> pool;
+
+    // 提交队列写满且无法提交时，后续 SQE 写到这里，循环随后退出
+    io_uring_sqe scratch{};
+    bool failed = false;
+
+    ~Ring() {
+        if (fd >= 0) close(fd);
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqPtr != MAP_FAILED && cqPtr != sqPtr) munmap(cqPtr, cqSize);
+        if (sqPtr != MAP_FAILED) munmap(sqPtr, sqSize);
+        if (bufRing != MAP_FAILED) munmap(bufRing, bufRingSize);
+    }
+
+    bool open(unsigned entries, std::string& error) {
+        io_uring_params params{};
+        // COOP_TASKRUN：完成事件在进入内核时处理，不用 IPI 打断循环线程（5.19+），老内核去掉重试
+        params.flags = IORING_SETUP_COOP_TASKRUN;
+        fd = uringSetup(entries, &params);
+        if (fd < 0 && errno == EINVAL) {
+            params = io_uring_params{};
+            fd = uringSetup(entries, &params);
+        }
+        if (fd < 0) {
+            error = std::string("io_uring_setup 失败: ") + strerror(errno);
+            return false;
+        }
+
+        sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cqSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMmap) sqSize = cqSize = std::max(sqSize, cqSize);
+
+        sqPtr = mmap(nullptr, sqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        if (sqPtr == MAP_FAILED) {
+            error = std::string("映射提交队列失败: ") + strerror(errno);
+            return false;
+        }
+        cqPtr = singleMmap ? sqPtr
+                           : mmap(nullptr, cqSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd,
+                                  IORING_OFF_CQ_RING);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe*>(
+            mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+        if (cqPtr == MAP_FAILED || sqes == MAP_FAILED) {
+            error = std::string("映射完成队列失败: ") + strerror(errno);
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sqPtr);
+        sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sqMask = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        localTail = *sqTail;
+
+        char* cq = static_cast<char*>(cqPtr);
+        cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // 内核所需的操作码是否都支持
+    bool probe(std::string& error) {
+        constexpr unsigned kProbeOps = 256;
+        std::vector<char> buffer(sizeof(io_uring_probe) + kProbeOps * sizeof(io_uring_probe_op), 0);
+        auto* info = reinterpret_cast<io_uring_probe*>(buffer.data());
+        if (uringRegister(fd, IORING_REGISTER_PROBE, info, kProbeOps) < 0) {
+            error = std::string("无法查询支持的操作: ") + strerror(errno);
+            return false;
+        }
+        const std::pair<int, const char*> required[] = {
+            {IORING_OP_ACCEPT, "accept"}, {IORING_OP_RECV, "recv"}, {IORING_OP_SEND, "send"},
+            {IORING_OP_CLOSE, "close"}, {IORING_OP_ASYNC_CANCEL, "cancel"}, {IORING_OP_POLL_ADD, "poll"}};
+        for (const auto& [op, name] : required) {
+            if (op > info->last_op || !(info->ops[op].flags & IO_URING_OP_SUPPORTED)) {
+                error = std::string("内核不支持 ") + name + " 操作";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 把 count 个 size 字节的接收缓冲（组 kBufferGroup）交给内核。优先用缓冲环（5.19+，归还缓冲只写共享内存），
+    // 注册失败或自检收不到数据时改用 PROVIDE_BUFFERS 操作（5.7+，归还一个缓冲占一个 SQE，随下一次提交一起进入内核）
+    bool registerBuffers(unsigned count, unsigned size, std::string& error) {
+        bufMask = count - 1;
+        bufSize = size;
+        pool.resize(static_cast<size_t>(count) * size);
+        if (registerBufferRing(count)) {
+            if (bufferRingWorks()) {
+                ringBuffers = true;
+                return true;
+            }
+            io_uring_buf_reg reg{};
+            reg.bgid = kBufferGroup;
+            uringRegister(fd, IORING_UNREGISTER_PBUF_RING, &reg, 1);
+            munmap(bufRing, bufRingSize);
+            bufRing = static_cast<io_uring_buf_ring*>(MAP_FAILED);
+        }
+
+        io_uring_sqe* sqe = acquire(encode(0, Op::Provide));
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = static_cast<int>(count);
+        sqe->addr = reinterpret_cast<uint64_t>(pool.data());
+        sqe->len = size;
+        sqe->off = 0;
+        sqe->buf_group = kBufferGroup;
+        io_uring_cqe cqe{};
+        if (!waitOne(cqe) || cqe.res < 0) {
+            error = std::string("提供接收缓冲失败: ") + strerror(cqe.res < 0 ? -cqe.res : errno);
+            return false;
+        }
+        return true;
+    }
+
+    const char* buffer(uint16_t bid) const { return pool.data() + static_cast<size_t>(bid) * bufSize; }
+
+    // 把缓冲归还给内核
+    void recycle(uint16_t bid) {
+        if (ringBuffers) {
+            pushRing(bid);
+            return;
+        }
+        io_uring_sqe* sqe = acquire(encode(0, Op::Provide));
+        sqe->opcode = IORING_OP_PROVIDE_BUFFERS;
+        sqe->fd = 1;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer(bid));
+        sqe->len = bufSize;
+        sqe->off = bid;
+        sqe->buf_group = kBufferGroup;
+    }
+
+    // 缓冲环：tail 与 bufs[0] 的保留字段重叠，只能写 addr/len/bid
+    void pushRing(uint16_t bid) {
+        io_uring_buf* buf = &bufRing->bufs[bufTail & bufMask];
+        buf->addr = reinterpret_cast<uint64_t>(buffer(bid));
+        buf->len = bufSize;
+        buf->bid = bid;
+        bufTail++;
+        __atomic_store_n(&bufRing->tail, bufTail, __ATOMIC_RELEASE);
+    }
+
+    bool registerBufferRing(unsigned count) {
+        bufRingSize = count * sizeof(io_uring_buf);
+        void* memory = mmap(nullptr, bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) return false;
+        bufRing = static_cast<io_uring_buf_ring*>(memory);
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(bufRing);
+        reg.ring_entries = count;
+        reg.bgid = kBufferGroup;
+        if (uringRegister(fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            munmap(bufRing, bufRingSize);
+            bufRing = static_cast<io_uring_buf_ring*>(MAP_FAILED);
+            return false;
+        }
+        for (unsigned i = 0; i <= bufMask; i++) {
+            pushRing(static_cast<uint16_t>(i));
+        }
+        return true;
+    }
+
+    // 有的内核注册缓冲环成功，但 recv 始终返回 ENOBUFS；用 socketpair 收一个字节确认
+    bool bufferRingWorks() {
+        int pair[2];
+        if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, pair) < 0) return false;
+        ssize_t written = write(pair[1], "x", 1);
+
+        io_uring_sqe* sqe = acquire(encode(0, Op::Recv));
+        sqe->opcode = IORING_OP_RECV;
+        sqe->fd = pair[0];
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = kBufferGroup;
+        sqe->len = bufSize;
+        io_uring_cqe cqe{};
+        bool ok = written == 1 && waitOne(cqe) && cqe.res == 1 && (cqe.flags & IORING_CQE_F_BUFFER);
+        if (cqe.flags & IORING_CQE_F_BUFFER) pushRing(static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT));
+        close(pair[0]);
+        close(pair[1]);
+        return ok;
+    }
+
+    // 初始化时使用：提交并等待一个完成事件
+    bool waitOne(io_uring_cqe& cqe) {
+        while (enter(1) < 0) {
+            if (errno != EINTR) return false;
+        }
+        unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE)) return false;
+        cqe = cqes[head & cqMask];
+        __atomic_store_n(cqHead, head + 1, __ATOMIC_RELEASE);
+        return true;
+    }
+
+    // 提交已填写的 SQE，minComplete > 0 时等待至少这么多完成事件
+    int enter(unsigned minComplete) {
+        __atomic_store_n(sqTail, localTail, __ATOMIC_RELEASE);
+        int ret = uringEnter(fd, toSubmit, minComplete, minComplete > 0 ? IORING_ENTER_GETEVENTS : 0);
+        countSyscall(IoSyscall::Enter);
+        if (ret > 0) toSubmit -= std::min(toSubmit, static_cast<unsigned>(ret));
+        return ret;
+    }
+
+    // 取一个清零的 SQE；队列满时先提交
+    io_uring_sqe* acquire(uint64_t userData) {
+        unsigned head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+        if (localTail - head >= sqEntries) {
+            while (enter(0) < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY)) {
+            }
+            head = __atomic_load_n(sqHead, __ATOMIC_ACQUIRE);
+            if (localTail - head >= sqEntries) {
+                failed = true;
+                scratch = io_uring_sqe{};
+                return &scratch;
+            }
+        }
+        unsigned index = localTail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        localTail++;
+        toSubmit++;
+        return sqe;
+    }
+};
+
+IoUringLoop::IoUringLoop(HttpServer& server, int index)
+    : EventLoop(server, index), listenFd_(-1), running_(false), multishotAccept_(true),
+      multishotRecv_(true), nextId_(1) {}
+
+IoUringLoop::~IoUringLoop() {
+    // 先关闭环，取消所有在途操作，再关闭还未提交 close 的连接
+    ring_.reset();
+    for (auto& [id, conn] : connections_) {
+        if (!conn.closing) close(conn.fd);
+    }
+    if (listenFd_ >= 0) close(listenFd_);
+}
+
+bool IoUringLoop::available(std::string& reason) {
+    Ring ring;
+    return ring.open(8, reason) && ring.probe(reason) && ring.registerBuffers(8, 64, reason);
+}
+
+bool IoUringLoop::listen(int port) {
+    std::string error;
+    ring_ = std::make_unique<Ring>();
+    if (!ring_->open(kRingEntries, error) || !ring_->registerBuffers(kBufferCount, kBufferSize, error)) {
+        LOG_ERROR("事件循环 %d: %s", index_, error.c_str());
+        return false;
+    }
+    if (index_ == 0) {
+        LOG_INFO("io_uring 接收缓冲: %s", ring_->ringBuffers ? "缓冲环" : "PROVIDE_BUFFERS");
+    }
+
+    listenFd_ = openListenSocket(port, true);
+    if (listenFd_ < 0 || wakeFd_ < 0) return false;
+    running_ = true;
+    return true;
+}
+
+void IoUringLoop::stop() {
+    running_ = false;
+    wake();
+}
+
+void IoUringLoop::run(int cpu) {
+    pinToCpu(cpu);
+    Executor::setCurrent(this);
+    armAccept();
+    armWake();
+
+    Ring& ring = *ring_;
+    while (running_ && !ring.failed) {
+        armTimeout();
+        // 一次调用同时提交上一轮产生的全部 SQE 并等待新的完成事件
+        if (ring.enter(1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            LOG_ERROR("事件循环 %d: io_uring_enter 失败: %s", index_, strerror(errno));
+            break;
+        }
+
+        unsigned head = *ring.cqHead;
+        unsigned tail = __atomic_load_n(ring.cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const io_uring_cqe& cqe = ring.cqes[head & ring.cqMask];
+            uint64_t userData = cqe.user_data;
+            int res = cqe.res;
+            uint32_t flags = cqe.flags;
+            __atomic_store_n(ring.cqHead, ++head, __ATOMIC_RELEASE);
+
+            Op op = static_cast<Op>(userData & 0xff);
+            if (op == Op::Accept) {
+                onAccept(res, flags);
+                continue;
+            }
+            if (op == Op::Wake) {
+                runPosted();
+                if (running_) armWake();
+                continue;
+            }
+            if (op == Op::Provide) {
+                if (res < 0) LOG_WARN("事件循环 %d: 归还接收缓冲失败: %s", index_, strerror(-res));
+                continue;
+            }
+            if (op == Op::Timeout) {
+                // 到期（-ETIME）或被其他完成事件提前结束，本轮末尾统一推进时间轮
+                timeoutArmed_ = false;
+                continue;
+            }
+
+            auto it = connections_.find(static_cast<uint32_t>(userData >> 8));
+            if (it == connections_.end()) {
+                // 连接已释放（不应出现），缓冲仍要归还
+                if (flags & IORING_CQE_F_BUFFER) ring.recycle(static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT));
+                continue;
+            }
+            Connection& conn = it->second;
+            if (op == Op::Recv) {
+                onRecv(conn, res, flags);
+            } else if (op == Op::Send) {
+                onSend(conn, res);
+            } else {
+                conn.pending--;
+                releaseIfDone(conn);
+            }
+        }
+        wheel_.advance(Clock::now());
+    }
+    if (ring.failed) {
+        LOG_ERROR("事件循环 %d: io_uring 提交队列已满，停止", index_);
+    }
+    Executor::setCurrent(nullptr);
+}
+
+void IoUringLoop::armAccept() {
+    io_uring_sqe* sqe = ring_->acquire(encode(0, Op::Accept));
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = listenFd_;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = multishotAccept_ ? IORING_ACCEPT_MULTISHOT : 0;
+}
+
+void IoUringLoop::armWake() {
+    io_uring_sqe* sqe = ring_->acquire(encode(0, Op::Wake));
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeFd_;
+    sqe->poll32_events = POLLIN;
+}
+
+void IoUringLoop::armTimeout() {
+    if (timeoutArmed_ || !running_) return;
+    int ms = wheel_.timeoutMs(Clock::now());
+    if (ms < 0) return;
+    // TIMEOUT 提交后不能提前，之后加入的更早的定时器最多推迟到下一次唤醒，所以每次最多等 1 秒
+    ms = std::min(ms, 1000);
+    timeout_.tv_sec = ms / 1000;
+    timeout_.tv_nsec = static_cast<long long>(ms % 1000) * 1000000;
+    io_uring_sqe* sqe = ring_->acquire(encode(0, Op::Timeout));
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&timeout_);
+    sqe->len = 1;
+    timeoutArmed_ = true;
+}
+
+void IoUringLoop::armRecv(Connection& conn) {
+    io_uring_sqe* sqe = ring_->acquire(encode(conn.id, Op::Recv));
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = conn.fd;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufferGroup;
+    // multishot 要求 len 为 0（每次用一个完整缓冲）
+    sqe->ioprio = multishotRecv_ ? IORING_RECV_MULTISHOT : 0;
+    sqe->len = multishotRecv_ ? 0 : kBufferSize;
+    conn.recvArmed = true;
+    conn.pending++;
+}
+
+void IoUringLoop::startSend(Connection& conn) {
+    if (conn.sendInFlight || conn.out.empty()) return;
+    conn.sending.swap(conn.out);
+    conn.out.clear();
+    conn.sendPos = 0;
+
+    io_uring_sqe* sqe = ring_->acquire(encode(conn.id, Op::Send));
+    sqe->opcode = IORING_OP_SEND;
+    sqe->fd = conn.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(conn.sending.data());
+    sqe->len = static_cast<uint32_t>(conn.sending.size());
+    sqe->msg_flags = MSG_NOSIGNAL;
+    conn.sendInFlight = true;
+    conn.pending++;
+}
+
+void IoUringLoop::closeConnection(Connection& conn) {
+    if (conn.closing) return;
+    conn.closing = true;
+    conn.closed->store(true, std::memory_order_relaxed);
+    conn.timer.cancel();
+    conn.in.clear();
+    conn.out.clear();
+
+    // 取消 multishot recv 与 close 同批提交；两者都完成（以及在途的 send 完成）后才释放连接
+    if (conn.recvArmed) {
+        io_uring_sqe* sqe = ring_->acquire(encode(conn.id, Op::Cancel));
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = encode(conn.id, Op::Recv);
+        conn.pending++;
+    }
+    io_uring_sqe* sqe = ring_->acquire(encode(conn.id, Op::Close));
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = conn.fd;
+    conn.pending++;
+}
+
+void IoUringLoop::releaseIfDone(Connection& conn) {
+    if (conn.pending != 0) return;
+    if (conn.closing) {
+        connections_.erase(conn.id);
+    } else if (conn.takeover) {
+        handOff(conn);
+    }
+}
+
+void IoUringLoop::beginHandOff(Connection& conn) {
+    conn.timer.cancel();
+    if (conn.recvArmed && !conn.recvCancelled) {
+        io_uring_sqe* sqe = ring_->acquire(encode(conn.id, Op::Cancel));
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = encode(conn.id, Op::Recv);
+        conn.pending++;
+        conn.recvCancelled = true;
+    }
+    releaseIfDone(conn);
+}
+
+void IoUringLoop::handOff(Connection& conn) {
+    int fd = conn.fd;
+    ConnectionTakeover takeover = std::move(conn.takeover);
+    std::string unsent = conn.sending.substr(conn.sendPos) + conn.out;
+    std::string received = std::move(conn.in);
+    conn.closed->store(true, std::memory_order_relaxed);
+    connections_.erase(conn.id);
+    try {
+        takeover(fd, std::move(unsent), std::move(received));
+    } catch (const std::exception& e) {
+        LOG_ERROR("Connection takeover error: %s", e.what());
+        close(fd);
+    }
+}
+
+void IoUringLoop::onAccept(int res, uint32_t flags) {
+    if (res >= 0) {
+        int one = 1;
+        setsockopt(res, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        countSyscall(IoSyscall::Control);
+
+        uint32_t id = nextId_++;
+        // 编号只占 56 位中的 32 位，回绕后跳过 0 和仍在使用的编号
+        while (id == 0 || connections_.count(id)) id = nextId_++;
+        Connection& conn = connections_[id];
+        conn.fd = res;
+        conn.id = id;
+        conn.acceptedAt = Clock::now();
+        armRecv(conn);
+        refreshTimer(conn);
+    } else if (res == -EINVAL && multishotAccept_) {
+        multishotAccept_ = false;
+        LOG_INFO("事件循环 %d: 内核不支持 multishot accept，改用单次 accept", index_);
+    } else if (res != -ECANCELED && running_) {
+        LOG_WARN("事件循环 %d: accept 失败: %s", index_, strerror(-res));
+    }
+    // multishot accept 出错或被内核结束时不再带 F_MORE，需要重新提交
+    if (!(flags & IORING_CQE_F_MORE) && running_) armAccept();
+}
+
+void IoUringLoop::onRecv(Connection& conn, int res, uint32_t flags) {
+    if (!(flags & IORING_CQE_F_MORE)) {
+        conn.recvArmed = false;
+        conn.pending--;
+    }
+    if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        if (res > 0 && !conn.closing) {
+            if (conn.in.empty()) conn.readStart = Clock::now();
+            conn.in.append(ring_->buffer(bid), res);
+        }
+        ring_->recycle(bid);
+    }
+    if (conn.closing || conn.takeover) {
+        // 待接管的连接：recv 已取消，之后到达的数据随连接一起交出
+        releaseIfDone(conn);
+        return;
+    }
+
+    if (res == 0) {
+        // 对端关闭写方向：已收到的完整请求仍然处理并回复
+        conn.peerClosed = true;
+    } else if (res == -EINVAL && multishotRecv_) {
+        multishotRecv_ = false;
+        LOG_INFO("事件循环 %d: 内核不支持 multishot recv，改用单次 recv", index_);
+    } else if (res < 0 && res != -ENOBUFS) {
+        // ENOBUFS 表示缓冲暂时用完（本轮归还后重新提交即可），其余错误断开
+        closeConnection(conn);
+        return;
+    }
+    if (conn.in.size() > kMaxQueuedInput) {
+        closeConnection(conn);
+        return;
+    }
+    if (!conn.recvArmed && !conn.peerClosed) armRecv(conn);
+    processBuffered(conn);
+}
+
+void IoUringLoop::onSend(Connection& conn, int res) {
+    conn.sendInFlight = false;
+    conn.pending--;
+    if (conn.closing) {
+        releaseIfDone(conn);
+        return;
+    }
+    if (res < 0) {
+        closeConnection(conn);
+        return;
+    }
+
+    conn.sendPos += res;
+    if (conn.sendPos < conn.sending.size()) {
+        // 发送缓冲满时只发出一部分，剩余部分重新提交
+        io_uring_sqe* sqe = ring_->acquire(encode(conn.id, Op::Send));
+        sqe->opcode = IORING_OP_SEND;
+        sqe->fd = conn.fd;
+        sqe->addr = reinterpret_cast<uint64_t>(conn.sending.data() + conn.sendPos);
+        sqe->len = static_cast<uint32_t>(conn.sending.size() - conn.sendPos);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        conn.sendInFlight = true;
+        conn.pending++;
+        // 对端在读：发送超时从这次进展重新计算
+        conn.phase = TimeoutKind::Count;
+        refreshTimer(conn);
+        return;
+    }
+    conn.sending.clear();
+    conn.sendPos = 0;
+    // 发送期间可能暂停了流水线请求的处理，这里继续
+    processBuffered(conn);
+}
+
+void IoUringLoop::processBuffered(Connection& conn) {
+    std::string request;
+    RequestFrame frame;
+    while (!conn.awaiting && !conn.closeAfterWrite && !conn.takeover && conn.out.size() < kMaxQueuedOutput &&
+           takeRequest(conn.in, conn.frame, request, frame)) {
+        conn.closeAfterWrite = !frame.keepAlive || conn.peerClosed;
+        bool done;
+        try {
+            done = process(request, frame, conn.acceptedAt, conn.readStart,
+                           [this, id = conn.id](const std::string& response, ConnectionTakeover takeover) {
+                               deliver(id, response, std::move(takeover));
+                           }, conn.closed);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Client handling error: %s", e.what());
+            closeConnection(conn);
+            return;
+        }
+        if (!done) {
+            // 异步处理函数挂起：响应按请求顺序发出，后面的流水线请求等它完成
+            conn.awaiting = true;
+            break;
+        }
+        requestDone(conn);
+    }
+
+    if (conn.takeover) {
+        // 之前的流水线响应和这个响应头都交给接管方发送
+        beginHandOff(conn);
+        return;
+    }
+    startSend(conn);
+    if (!conn.sendInFlight && !conn.awaiting && (conn.closeAfterWrite || conn.peerClosed)) {
+        closeConnection(conn);
+        return;
+    }
+    refreshTimer(conn);
+}
+
+void IoUringLoop::requestDone(Connection& conn) {
+    // 下一个请求（流水线中已到达的数据）从现在开始计时
+    conn.acceptedAt = conn.readStart = Clock::now();
+    conn.served = true;
+    conn.phase = TimeoutKind::Count;    // 每个请求的各阶段重新计时
+    if (conn.closeAfterWrite) conn.in.clear();
+}
+
+void IoUringLoop::deliver(uint32_t id, const std::string& response, ConnectionTakeover takeover) {
+    auto it = connections_.find(id);
+    if (it == connections_.end() || it->second.closing) return;    // 等待期间连接已关闭
+    Connection& conn = it->second;
+    conn.out += response;
+    if (takeover) conn.takeover = std::move(takeover);
+    if (!conn.awaiting) return;     // 同步处理：由 processBuffered 继续
+
+    conn.awaiting = false;
+    requestDone(conn);
+    processBuffered(conn);
+}
+
+void IoUringLoop::refreshTimer(Connection& conn) {
+    TimeoutKind phase;
+    if (conn.awaiting) {
+        phase = TimeoutKind::Handler;
+    } else if (conn.sendInFlight || !conn.out.empty()) {
+        phase = TimeoutKind::Write;
+    } else if (conn.in.empty()) {
+        phase = conn.served ? TimeoutKind::Idle : TimeoutKind::Header;
+    } else {
+        phase = conn.frame.headerEnd == std::string::npos ? TimeoutKind::Header : TimeoutKind::Body;
+    }
+    if (phase == conn.phase && conn.timer.armed()) return;
+    conn.phase = phase;
+    wheel_.schedule(conn.timer, timeoutFor(phase), [this, id = conn.id, phase]() { onTimeout(id, phase); });
+}
+
+void IoUringLoop::onTimeout(uint32_t id, TimeoutKind kind) {
+    auto it = connections_.find(id);
+    if (it == connections_.end() || it->second.closing) return;
+    Connection& conn = it->second;
+    // 在途 send 的数据还没发完时不能再插入别的字节
+    if (!conn.sendInFlight && conn.out.empty()) sendTimeoutResponse(conn.fd, kind);
+    else Metrics::getInstance().recordTimeout(kind);
+    closeConnection(conn);
+}
+
+#else
+
+struct IoUringLoop::Ring {};
+
+IoUringLoop::IoUringLoop(HttpServer& server, int index)
+    : EventLoop(server, index), listenFd_(-1), running_(false), multishotAccept_(false),
+      multishotRecv_(false), nextId_(1) {}
+
+IoUringLoop::~IoUringLoop() = default;
+
+bool IoUringLoop::available(std::string& reason) {
+    reason = "编译时的内核头文件不支持缓冲环";
+    return false;
+}
+
+bool IoUringLoop::listen(int) {
+    return false;
+}
+
+void IoUringLoop::run(int) {}
+
+void IoUringLoop::stop() {}
+
+#endif
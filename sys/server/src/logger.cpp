@@ -0,0 +1,311 @@
+#include "logger.hpp"
+#include <chrono>
+#include <cstdarg>
+#include <cstring>
+#include <ctime>
+#include <algorithm>
+
+namespace {
+
+int64_t nowNanos() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::atomic<uint32_t> g_nextThreadId{1};
+
+} // namespace
+
+Logger& Logger::getInstance() {
+    static Logger instance;
+    return instance;
+}
+
+Logger::Logger()
+    : level_(static_cast<int>(LogLevel::Info)), dropped_(0), suppressed_(0),
+      reportedDropped_(0), reportedSuppressed_(0), running_(false),
+      flushRequests_(0), flushDone_(0), maxBytes_(0), maxFiles_(0),
+      file_(nullptr), fileSize_(0) {}
+
+Logger::~Logger() {
+    stop();
+    if (file_) fclose(file_);
+}
+
+void Logger::setLevel(LogLevel level) {
+    level_.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void Logger::setFile(const std::string& path, size_t maxBytes, int maxFiles) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (file_) {
+        fclose(file_);
+        file_ = nullptr;
+    }
+    path_ = path;
+    maxBytes_ = maxBytes;
+    maxFiles_ = maxFiles;
+    openFile();
+}
+
+void Logger::setRateLimit(LogLevel level, int perSecond) {
+    if (level >= LogLevel::Off) return;
+    limits_[static_cast<int>(level)].perSecond.store(perSecond, std::memory_order_relaxed);
+}
+
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO";
+        case LogLevel::Warn: return "WARN";
+        case LogLevel::Error: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+LogLevel Logger::parseLevel(const std::string& name) {
+    std::string lower = name;
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    if (lower == "debug") return LogLevel::Debug;
+    if (lower == "warn" || lower == "warning") return LogLevel::Warn;
+    if (lower == "error") return LogLevel::Error;
+    if (lower == "off") return LogLevel::Off;
+    return LogLevel::Info;
+}
+
+// ========== 后台线程 ==========
+void Logger::start() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (running_) return;
+    running_ = true;
+    worker_ = std::thread(&Logger::run, this);
+}
+
+void Logger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!running_) return;
+        running_ = false;
+    }
+    wake_.notify_all();
+    if (worker_.joinable()) worker_.join();
+}
+
+void Logger::flush() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_) return;
+    uint64_t ticket = ++flushRequests_;
+    wake_.notify_one();
+    flushed_.wait(lock, [&] { return flushDone_ >= ticket || !running_; });
+}
+
+void Logger::run() {
+    std::string batch;
+    while (true) {
+        uint64_t target;
+        bool stopping;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            target = flushRequests_;
+            stopping = !running_;
+        }
+
+        // 在锁外取出记录并格式化，生产者始终不受影响
+        drain(batch);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (!batch.empty()) {
+            write(batch);
+            batch.clear();
+        }
+        flushDone_ = target;
+        flushed_.notify_all();
+        if (stopping) break;
+        wake_.wait_for(lock, std::chrono::milliseconds(20),
+                       [this] { return flushRequests_ > flushDone_ || !running_; });
+    }
+}
+
+size_t Logger::drain(std::string& batch) {
+    std::vector<Ring*> rings;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        rings.reserve(rings_.size());
+        for (const auto& ring : rings_) rings.push_back(ring.get());
+    }
+
+    size_t count = 0;
+    for (Ring* ring : rings) {
+        uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail < head; tail++) {
+            format(ring->records[tail & (kRingSize - 1)], batch);
+            count++;
+        }
+        ring->tail.store(tail, std::memory_order_release);
+    }
+
+    // 丢弃和限流只计数，由后台线程汇总成一条日志
+    auto report = [&](uint64_t total, uint64_t& reported, const char* what) {
+        if (total == reported) return;
+        Record record{};
+        record.timeNs = nowNanos();
+        record.level = static_cast<uint8_t>(LogLevel::Warn);
+        int n = snprintf(record.text, kMessageSize, "%s %llu 条日志", what,
+                         static_cast<unsigned long long>(total - reported));
+        record.length = static_cast<uint16_t>(std::max(0, n));
+        format(record, batch);
+        reported = total;
+    };
+    report(dropped_.load(std::memory_order_relaxed), reportedDropped_, "日志缓冲已满，丢弃");
+    report(suppressed_.load(std::memory_order_relaxed), reportedSuppressed_, "日志超出速率限制，丢弃");
+    return count;
+}
+
+void Logger::format(const Record& record, std::string& out) {
+    time_t seconds = static_cast<time_t>(record.timeNs / 1000000000);
+    int micros = static_cast<int>((record.timeNs / 1000) % 1000000);
+    tm local{};
+    localtime_r(&seconds, &local);
+
+    char prefix[80];
+    size_t n = strftime(prefix, sizeof(prefix), "%Y-%m-%d %H:%M:%S", &local);
+    snprintf(prefix + n, sizeof(prefix) - n, ".%06d %-5s [%u] ", micros,
+             levelName(static_cast<LogLevel>(record.level)), record.threadId);
+
+    out += prefix;
+    out.append(record.text, record.length);
+    out.push_back('\n');
+}
+
+// ========== 文件输出（调用前需持有 mutex_） ==========
+void Logger::openFile() {
+    if (path_.empty()) return;
+    file_ = fopen(path_.c_str(), "a");
+    if (!file_) {
+        fprintf(stderr, "无法打开日志文件: %s\n", path_.c_str());
+        return;
+    }
+    fseek(file_, 0, SEEK_END);
+    fileSize_ = static_cast<size_t>(std::max(0L, ftell(file_)));
+}
+
+void Logger::rotate() {
+    fclose(file_);
+    file_ = nullptr;
+    for (int i = maxFiles_ - 1; i >= 1; i--) {
+        std::string from = path_ + "." + std::to_string(i);
+        std::string to = path_ + "." + std::to_string(i + 1);
+        std::rename(from.c_str(), to.c_str());
+    }
+    if (maxFiles_ > 0) {
+        std::rename(path_.c_str(), (path_ + ".1").c_str());
+    } else {
+        std::remove(path_.c_str());
+    }
+    openFile();
+}
+
+void Logger::write(const std::string& batch) {
+    FILE* out = file_ ? file_ : stderr;
+    fwrite(batch.data(), 1, batch.size(), out);
+    fflush(out);
+    if (!file_) return;
+
+    fileSize_ += batch.size();
+    if (maxBytes_ > 0 && fileSize_ >= maxBytes_) {
+        rotate();
+    }
+}
+
+// ========== 生产者 ==========
+Logger::RingHolder::~RingHolder() {
+    if (ring) Logger::getInstance().releaseRing(ring);
+}
+
+Logger::Ring* Logger::acquireRing() {
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    if (!freeRings_.empty()) {
+        Ring* ring = freeRings_.back();
+        freeRings_.pop_back();
+        return ring;
+    }
+    rings_.push_back(std::make_unique<Ring>());
+    return rings_.back().get();
+}
+
+void Logger::releaseRing(Ring* ring) {
+    // 未写出的记录留在缓冲中，后台线程照常取走
+    std::lock_guard<std::mutex> lock(ringsMutex_);
+    freeRings_.push_back(ring);
+}
+
+bool Logger::allow(LogLevel level, int64_t nowNs) {
+    RateLimit& limit = limits_[static_cast<int>(level)];
+    int perSecond = limit.perSecond.load(std::memory_order_relaxed);
+    if (perSecond <= 0) return true;
+
+    int64_t second = nowNs / 1000000000;
+    int64_t window = limit.window.load(std::memory_order_relaxed);
+    if (window != second && limit.window.compare_exchange_strong(window, second)) {
+        limit.count.store(0, std::memory_order_relaxed);
+    }
+    if (limit.count.fetch_add(1, std::memory_order_relaxed) >= perSecond) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void Logger::log(LogLevel level, const char* format, ...) {
+    if (level >= LogLevel::Off) return;
+    int64_t now = nowNanos();
+    if (!allow(level, now)) return;
+
+    va_list args;
+    va_start(args, format);
+
+    // 后台线程未启动：同步写 stderr
+    if (!running_.load(std::memory_order_acquire)) {
+        Record record;
+        record.timeNs = now;
+        record.threadId = 0;
+        record.level = static_cast<uint8_t>(level);
+        int n = vsnprintf(record.text, kMessageSize, format, args);
+        va_end(args);
+        record.length = static_cast<uint16_t>(std::clamp(n, 0, static_cast<int>(kMessageSize) - 1));
+        std::string line;
+        Logger::format(record, line);
+        fputs(line.c_str(), stderr);
+        return;
+    }
+
+    thread_local RingHolder holder;
+    if (!holder.ring) {
+        holder.ring = acquireRing();
+        holder.threadId = g_nextThreadId.fetch_add(1, std::memory_order_relaxed);
+    }
+    Ring* ring = holder.ring;
+
+    uint64_t head = ring->head.load(std::memory_order_relaxed);
+    uint64_t used = head - ring->tail.load(std::memory_order_acquire);
+    if (used >= kRingSize) {
+        va_end(args);
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    Record& record = ring->records[head & (kRingSize - 1)];
+    record.timeNs = now;
+    record.threadId = holder.threadId;
+    record.level = static_cast<uint8_t>(level);
+    int n = vsnprintf(record.text, kMessageSize, format, args);
+    va_end(args);
+    record.length = static_cast<uint16_t>(std::clamp(n, 0, static_cast<int>(kMessageSize) - 1));
+    ring->head.store(head + 1, std::memory_order_release);
+
+    // 缓冲过半时提前唤醒后台线程
+    if (used + 1 == kRingSize / 2) {
+        wake_.notify_one();
+    }
+}
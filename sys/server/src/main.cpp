@@ -1,10 +1,34 @@
 #include "http_server.hpp"
 #include "db.hpp"
 #include "json.hpp"
+#include "session_store.hpp"
+#include "auth_service.hpp"
+#include "password_hasher.hpp"
+#include "timetable_store.hpp"
+#include "utilization_stats.hpp"
+#include "pagination.hpp"
+#include "metrics.hpp"
+#include "logger.hpp"
+#include "query_stats.hpp"
+#include "tracer.hpp"
+#include "user_import.hpp"
+#include "schedule_import.hpp"
+#include "async_db.hpp"
+#include "admission.hpp"
+#include "push_hub.hpp"
+#include "table_versions.hpp"
+#include "response_cache.hpp"
+#ifdef HAVE_SQLITE
+#include "sqlite_backend.hpp"
+#endif
 #include <iostream>
 #include <sstream>
 #include <cstdlib>
 #include <signal.h>
+#include <thread>
+#include <algorithm>
+#include <set>
+#include <cctype>
 
 HttpServer* g_server = nullptr;
 
@@ -13,6 +37,7 @@ void signalHandler([[maybe_unused]] int sig) {
     if (g_server) {
         g_server->stop();
     }
+    Logger::getInstance().stop();
     exit(0);
 }
 
@@ -21,36 +46,312 @@ std::string getCurrentSemester() {
     return "2024-2025-1";  // 实际应该根据日期计算
 }
 
+// 从Authorization头中取出Bearer token
+std::string getBearerToken(const HttpRequest& req) {
+    auto it = req.headers.find("Authorization");
+    if (it == req.headers.end()) it = req.headers.find("authorization");
+    if (it == req.headers.end()) return "";
+    
+    const std::string prefix = "Bearer ";
+    if (it->second.compare(0, prefix.size(), prefix) != 0) return "";
+    return it->second.substr(prefix.size());
+}
+
+// 解析分页参数，失败时直接写入400响应
+bool parsePage(KeysetPage& page, const std::map<std::string, std::string>& queryParams, HttpResponse& res) {
+    std::string error;
+    if (!page.parse(queryParams, error)) {
+        res.setStatus(400);
+        res.setJson("{\"error\": " + Json::string(error) + "}");
+        return false;
+    }
+    return true;
+}
+
+// 输出一页结果，下一页游标放在 X-Next-Cursor 响应头中（响应体仍为数组）
+void sendPage(const KeysetPage& page, const DbResult& result, HttpResponse& res) {
+    std::string nextCursor;
+    res.setJson(page.toJson(result, nextCursor));
+    if (!nextCursor.empty()) {
+        res.headers["X-Next-Cursor"] = nextCursor;
+    }
+}
+
+// 写操作成功后通知订阅了该主题的推送连接（客户端据此重新拉取，事件里只有动作和记录id）
+void publishChange(const char* topic, const char* action, const std::string& id = "") {
+    std::string data = std::string("{\"action\": \"") + action + "\"";
+    if (!id.empty()) data += ", \"id\": " + Json::string(id);
+    PushHub::getInstance().publish(topic, data + "}");
+}
+
+// 条件请求：由所读表的版本和查询参数生成 ETag，客户端缓存仍有效时直接回 304，不执行任何 SQL。
+// 结果还取决于请求之外的值（默认学期）时由 context 带入，学期切换后旧 ETag 即失效
+bool notModified(const HttpRequest& req, HttpResponse& res, const std::vector<Table>& tables,
+                 const std::string& context = "") {
+    std::string etag = TableVersions::getInstance().etag(req, tables, context);
+    res.headers["ETag"] = etag;
+    res.headers["Cache-Control"] = "no-cache";      // 浏览器可以缓存，但每次使用前带 If-None-Match 校验
+    std::string ifNoneMatch = req.header("If-None-Match");
+    if (ifNoneMatch.empty() || !TableVersions::matches(ifNoneMatch, etag)) return false;
+    res.statusCode = 304;
+    return true;
+}
+
+// 各读接口所读的表：处理函数生成 ETag 和 main 中开启响应缓存共用同一份声明，写接口递增其中任一表即失效
+const std::vector<Table> kClassroomReads = {Table::Classroom};
+const std::vector<Table> kClassroomDetailReads = {Table::Classroom, Table::Equipment};
+const std::vector<Table> kEquipmentReads = {Table::Equipment, Table::Classroom};
+const std::vector<Table> kCourseReads = {Table::Course, Table::User};
+const std::vector<Table> kScheduleReads = {Table::Schedule, Table::Course, Table::Classroom, Table::ClassInfo,
+                                           Table::User};
+const std::vector<Table> kStudentTimetableReads = {Table::Schedule, Table::Course, Table::Classroom,
+                                                   Table::ClassInfo, Table::User, Table::Enrollment};
+const std::vector<Table> kOccupancyReads = {Table::Classroom, Table::Schedule};    // 可用教室、利用率
+const std::vector<Table> kSuggestionReads = {Table::Classroom, Table::Course, Table::Schedule};
+const std::vector<Table> kUserReads = {Table::User};
+const std::vector<Table> kClassReads = {Table::ClassInfo};
+const std::vector<Table> kSectionTimeReads = {};
+const std::vector<Table> kNoticeReads = {Table::Notice, Table::User};
+const std::vector<Table> kBookingReads = {Table::Booking, Table::Classroom, Table::User};
+const std::vector<Table> kEnrollmentReads = {Table::Enrollment, Table::Course, Table::User};
+
+// 教室占用看板的增量（主题 room-status）：文本订阅收 JSON，二进制订阅收定长的大端编码，
+// 合并键按教室/预约区分，慢消费者积压时每个对象只保留最新状态
+void appendUint32(std::string& out, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) out += static_cast<char>((value >> shift) & 0xff);
+}
+
+// 教室状态变化：[1][u32 教室id][u8 状态：0 可用 1 维修 2 停用 255 已删除]
+void publishRoomStatus(int roomId, const std::string& status) {
+    uint8_t code = status == "available" ? 0 : status == "maintenance" ? 1 : status == "disabled" ? 2 : 255;
+    std::string binary(1, '\x01');
+    appendUint32(binary, static_cast<uint32_t>(roomId));
+    binary += static_cast<char>(code);
+    PushHub::getInstance().publish("room-status",
+        "{\"room\": " + std::to_string(roomId) + ", \"status\": " + Json::string(status) + "}",
+        binary, "room:" + std::to_string(roomId));
+}
+
+// 预约状态变化：[2][u32 教室id][u32 预约id][u8 状态：0 待审批 1 通过 2 拒绝 3 取消][u32 日期 yyyymmdd][u8 起始节][u8 结束节]
+void publishBookingState(const std::string& bookingId) {
+    auto rows = Database::getInstance().query(
+        "SELECT classroom_id, booking_date, start_section, end_section, status FROM booking WHERE id = " + bookingId);
+    if (rows.empty()) return;
+    auto& row = rows[0];
+    const std::string& status = row["status"];
+    uint8_t code = status == "pending" ? 0 : status == "approved" ? 1 : status == "rejected" ? 2 : 3;
+    std::string date = row["booking_date"].substr(0, 10);
+    std::string digits;
+    for (char c : date) {
+        if (std::isdigit(static_cast<unsigned char>(c))) digits += c;
+    }
+    int room = std::atoi(row["classroom_id"].c_str());
+    int start = std::atoi(row["start_section"].c_str());
+    int end = std::atoi(row["end_section"].c_str());
+    
+    std::string binary(1, '\x02');
+    appendUint32(binary, static_cast<uint32_t>(room));
+    appendUint32(binary, static_cast<uint32_t>(std::atoi(bookingId.c_str())));
+    binary += static_cast<char>(code);
+    appendUint32(binary, static_cast<uint32_t>(std::atoi(digits.c_str())));
+    binary += static_cast<char>(start);
+    binary += static_cast<char>(end);
+    PushHub::getInstance().publish("room-status",
+        "{\"room\": " + std::to_string(room) + ", \"booking\": " + bookingId + ", \"state\": " + Json::string(status) +
+        ", \"date\": " + Json::string(date) + ", \"start\": " + std::to_string(start) +
+        ", \"end\": " + std::to_string(end) + "}",
+        binary, "booking:" + bookingId);
+}
+
+// ========== 中间件 ==========
+
+// 鉴权中间件：通过内存会话表把登录用户挂到请求上，不访问数据库
+bool authMiddleware(HttpRequest& req, [[maybe_unused]] HttpResponse& res) {
+    Session session;
+    if (SessionStore::getInstance().validate(getBearerToken(req), session)) {
+        req.userId = session.userId;
+        req.username = session.username;
+        req.role = session.role;
+    }
+    return true;
+}
+
 // ========== API处理函数 ==========
 
+// 管理接口只允许管理员访问
+bool requireAdmin(const HttpRequest& req, HttpResponse& res) {
+    if (req.role == "admin") return true;
+    res.setStatus(req.isAuthenticated() ? 403 : 401);
+    res.setJson("{\"error\": \"需要管理员权限\"}");
+    return false;
+}
+
+// SQL语句统计（按指纹汇总）
+void handleGetQueryStats(const HttpRequest& req, HttpResponse& res) {
+    if (!requireAdmin(req, res)) return;
+    auto params = req.parseQuery();
+    std::string sort = params.count("sort") ? params["sort"] : "total";
+    int limit = params.count("limit") ? std::atoi(params["limit"].c_str()) : 50;
+    res.setJson(QueryStats::getInstance().statsJson(sort, limit > 0 ? limit : 50));
+}
+
+// 清空SQL语句统计和慢查询日志
+void handleResetQueryStats(const HttpRequest& req, HttpResponse& res) {
+    if (!requireAdmin(req, res)) return;
+    QueryStats::getInstance().reset();
+    res.setJson("{\"message\": \"统计已清空\"}");
+}
+
+// 最近的慢查询（含执行计划）
+void handleGetSlowQueries(const HttpRequest& req, HttpResponse& res) {
+    if (!requireAdmin(req, res)) return;
+    auto params = req.parseQuery();
+    int limit = params.count("limit") ? std::atoi(params["limit"].c_str()) : 50;
+    res.setJson(QueryStats::getInstance().slowJson(limit > 0 ? limit : 50));
+}
+
+// 导出追踪数据（Chrome trace-event JSON，可用 chrome://tracing 或 Perfetto 打开）
+void handleGetTrace(const HttpRequest& req, HttpResponse& res) {
+    if (!requireAdmin(req, res)) return;
+    auto params = req.parseQuery();
+    int limit = params.count("limit") ? std::atoi(params["limit"].c_str()) : 200;
+    auto& tracer = Tracer::getInstance();
+    res.setJson(tracer.exportJson(limit > 0 ? limit : 200));
+    if (params.count("clear") && params["clear"] == "1") {
+        tracer.clear();
+    }
+}
+
+// 调整追踪采样：{"sample_rate": 0.01, "min_duration_ms": 50}
+void handleUpdateTrace(const HttpRequest& req, HttpResponse& res) {
+    if (!requireAdmin(req, res)) return;
+    auto data = Json::parse(req.body);
+    auto& tracer = Tracer::getInstance();
+    try {
+        if (data.count("sample_rate")) tracer.setSampleRate(std::stod(data["sample_rate"]));
+        if (data.count("min_duration_ms")) tracer.setMinDurationMs(std::stoi(data["min_duration_ms"]));
+    } catch (...) {
+        res.setStatus(400);
+        res.setJson("{\"error\": \"参数无效\"}");
+        return;
+    }
+    
+    std::map<std::string, std::string> result;
+    result["sample_rate"] = std::to_string(tracer.sampleRate());
+    result["min_duration_ms"] = Json::number(tracer.minDurationMs());
+    result["traces"] = Json::number(static_cast<int>(tracer.size()));
+    res.setJson(Json::object(result));
+}
+
+// 运行指标（Prometheus文本格式）
+void handleMetrics([[maybe_unused]] const HttpRequest& req, HttpResponse& res) {
+    res.headers["Content-Type"] = "text/plain; version=0.0.4; charset=utf-8";
+    res.body = Metrics::getInstance().render() + AdmissionController::getInstance().render() +
+               PushHub::getInstance().render() + ResponseCache::getInstance().render();
+}
+
+// 推送订阅的鉴权和主题解析，失败时直接写入响应。
+// EventSource 和浏览器 WebSocket 都不能设置请求头，token 从查询参数取；不带 topics 时订阅全部主题
+bool parseSubscription(const HttpRequest& req, std::map<std::string, std::string>& queryParams,
+                       std::vector<std::string>& topics, HttpResponse& res) {
+    static const std::set<std::string> kTopics = {"classroom", "equipment", "course", "schedule", "class",
+                                                  "notice", "booking", "enrollment", "user", "room-status"};
+    Session session;
+    if (!req.isAuthenticated() && !SessionStore::getInstance().validate(queryParams["token"], session)) {
+        res.setStatus(401);
+        res.setJson("{\"error\": \"未登录\"}");
+        return false;
+    }
+    
+    std::stringstream ss(queryParams["topics"]);
+    std::string topic;
+    while (std::getline(ss, topic, ',')) {
+        if (topic.empty()) continue;
+        if (!kTopics.count(topic)) {
+            res.setStatus(400);
+            res.setJson("{\"error\": " + Json::string("未知主题: " + topic) + "}");
+            return false;
+        }
+        topics.push_back(topic);
+    }
+    if (topics.empty()) topics.push_back("*");
+    return true;
+}
+
+// 变更推送（SSE）：GET /api/events?topics=schedule,booking&token=...
+void handleEvents(const HttpRequest& req, HttpResponse& res) {
+    auto queryParams = req.parseQuery();
+    std::vector<std::string> topics;
+    if (!parseSubscription(req, queryParams, topics, res)) return;
+    PushHub::getInstance().acceptEventStream(res, std::move(topics));
+}
+
+// 变更推送（WebSocket）：GET /api/ws?topics=room-status&format=binary&token=...
+// format=binary 时带二进制编码的事件（room-status）以二进制帧发送，其余以 JSON 文本帧发送
+void handleWebSocket(const HttpRequest& req, HttpResponse& res) {
+    auto queryParams = req.parseQuery();
+    std::string format = queryParams.count("format") ? queryParams["format"] : "json";
+    if (format != "json" && format != "binary") {
+        res.setStatus(400);
+        res.setJson("{\"error\": \"format 只能是 json 或 binary\"}");
+        return;
+    }
+    std::vector<std::string> topics;
+    if (!parseSubscription(req, queryParams, topics, res)) return;
+    PushHub::getInstance().acceptWebSocket(req, res, std::move(topics), format == "binary");
+}
+
 // 登录
-void handleLogin(const HttpRequest& req, HttpResponse& res) {
+Task<HttpResponse> handleLogin(const HttpRequest& req) {
+    HttpResponse res;
     auto params = Json::parse(req.body);
     std::string username = params["username"];
     std::string password = params["password"];
     
-    auto& db = Database::getInstance();
-    std::string sql = "SELECT id, username, role, real_name FROM user WHERE username = '" 
-                    + db.escape(username) + "' AND password_hash = SHA2('" + db.escape(password) + "', 256)";
-    
-    auto result = db.query(sql);
-    if (result.empty()) {
+    // 密码在服务器内校验（KDF线程池 + 用户记录缓存），不再把明文交给SQL计算SHA2；
+    // 等待KDF期间协程挂起，事件循环继续处理其他连接
+    auto login = co_await AuthService::getInstance().authenticate(username, password);
+    const AuthUser& user = login.user;
+    if (login.result == AuthService::Result::Busy) {
+        res.setStatus(503);
+        res.headers["Retry-After"] = "1";
+        res.setJson("{\"error\": \"登录人数过多，请稍后重试\"}");
+        co_return res;
+    }
+    if (login.result != AuthService::Result::Ok) {
         res.setStatus(401);
         res.setJson("{\"error\": \"用户名或密码错误\"}");
-        return;
+        co_return res;
     }
     
-    // 简单token（实际应用应使用JWT）
-    std::string token = "token_" + result[0]["id"] + "_" + std::to_string(time(nullptr));
+    // 创建会话，后续请求通过Authorization头携带token
+    std::string token = SessionStore::getInstance().create(user.id, user.username, user.role, user.realName);
+    
+    std::map<std::string, std::string> userData;
+    userData["id"] = Json::number(user.id);
+    userData["username"] = Json::string(user.username);
+    userData["role"] = Json::string(user.role);
+    userData["real_name"] = user.realName.empty() ? Json::null() : Json::string(user.realName);
     
     std::map<std::string, std::string> data;
     data["token"] = Json::string(token);
-    data["user"] = Json::fromDbRow(result[0]);
+    data["user"] = Json::object(userData);
     res.setJson(Json::object(data));
+    co_return res;
+}
+
+// 注销
+void handleLogout(const HttpRequest& req, HttpResponse& res) {
+    std::string token = getBearerToken(req);
+    if (!token.empty()) {
+        SessionStore::getInstance().remove(token);
+    }
+    res.setJson("{\"message\": \"已退出登录\"}");
 }
 
 // ========== 教室管理 ==========
 void handleGetClassrooms(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kClassroomReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     
@@ -77,6 +378,7 @@ void handleGetClassrooms(const HttpRequest& req, HttpResponse& res) {
 }
 
 void handleGetClassroom(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kClassroomDetailReads)) return;
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
@@ -120,8 +422,13 @@ void handleCreateClassroom(const HttpRequest& req, HttpResponse& res) {
         + db.escape(params["remark"]) + "')";
     
     if (db.execute(sql)) {
+        unsigned long long classroomId = db.lastInsertId();
+        UtilizationStats::getInstance().refreshClassroom(static_cast<int>(classroomId));
+        TableVersions::getInstance().bump({Table::Classroom});
+        publishChange("classroom", "create", std::to_string(classroomId));
+        publishRoomStatus(static_cast<int>(classroomId), params["status"].empty() ? "available" : params["status"]);
         res.setStatus(201);
-        res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + ", \"message\": \"创建成功\"}");
+        res.setJson("{\"id\": " + std::to_string(classroomId) + ", \"message\": \"创建成功\"}");
     } else {
         res.setStatus(400);
         res.setJson("{\"error\": \"创建失败: " + db.getError() + "\"}");
@@ -146,6 +453,11 @@ void handleUpdateClassroom(const HttpRequest& req, HttpResponse& res) {
         "WHERE id = " + id;
     
     if (db.execute(sql)) {
+        TimetableStore::getInstance().refreshSchedules("classroom_id", std::stoi(id));
+        UtilizationStats::getInstance().refreshClassroom(std::stoi(id));
+        TableVersions::getInstance().bump({Table::Classroom});
+        publishChange("classroom", "update", id);
+        publishRoomStatus(std::stoi(id), params["status"]);
         res.setJson("{\"message\": \"更新成功\"}");
     } else {
         res.setStatus(400);
@@ -158,6 +470,11 @@ void handleDeleteClassroom(const HttpRequest& req, HttpResponse& res) {
     auto& db = Database::getInstance();
     
     if (db.execute("DELETE FROM classroom WHERE id = " + id)) {
+        TimetableStore::getInstance().refreshSchedules("classroom_id", std::stoi(id));
+        UtilizationStats::getInstance().refreshClassroom(std::stoi(id));
+        TableVersions::getInstance().bump({Table::Classroom, Table::Equipment, Table::Schedule, Table::Booking});
+        publishChange("classroom", "delete", id);
+        publishRoomStatus(std::stoi(id), "deleted");
         res.setStatus(204);
     } else {
         res.setStatus(400);
@@ -167,6 +484,7 @@ void handleDeleteClassroom(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 设备管理 ==========
 void handleGetEquipmentsByClassroom(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kClassroomDetailReads)) return;
     std::string classroomId = req.params.at("classroomId");
     auto& db = Database::getInstance();
     
@@ -178,6 +496,7 @@ void handleGetEquipmentsByClassroom(const HttpRequest& req, HttpResponse& res) {
 }
 
 void handleGetEquipments(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kEquipmentReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     
@@ -201,6 +520,7 @@ void handleGetEquipments(const HttpRequest& req, HttpResponse& res) {
 }
 
 void handleGetEquipment(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kEquipmentReads)) return;
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
@@ -236,6 +556,8 @@ void handleCreateEquipment(const HttpRequest& req, HttpResponse& res) {
         + db.escape(params["remark"]) + "')";
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::Equipment});
+        publishChange("equipment", "create");
         res.setStatus(201);
         res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + "}");
     } else {
@@ -265,6 +587,8 @@ void handleUpdateEquipment(const HttpRequest& req, HttpResponse& res) {
         "WHERE id = " + id;
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::Equipment});
+        publishChange("equipment", "update", id);
         res.setStatus(200);
         res.setJson("{\"success\": true}");
     } else {
@@ -278,6 +602,8 @@ void handleDeleteEquipment(const HttpRequest& req, HttpResponse& res) {
     auto& db = Database::getInstance();
     
     if (db.execute("DELETE FROM equipment WHERE id = " + id)) {
+        TableVersions::getInstance().bump({Table::Equipment});
+        publishChange("equipment", "delete", id);
         res.setStatus(204);
     } else {
         res.setStatus(400);
@@ -287,6 +613,7 @@ void handleDeleteEquipment(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 课程管理 ==========
 void handleGetCourses(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kCourseReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     
@@ -311,6 +638,7 @@ void handleGetCourses(const HttpRequest& req, HttpResponse& res) {
 }
 
 void handleGetCourse(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kCourseReads)) return;
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
@@ -340,6 +668,8 @@ void handleCreateCourse(const HttpRequest& req, HttpResponse& res) {
         + db.escape(params["remark"]) + "')";
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::Course});
+        publishChange("course", "create");
         res.setStatus(201);
         res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + "}");
     } else {
@@ -363,6 +693,9 @@ void handleUpdateCourse(const HttpRequest& req, HttpResponse& res) {
         "WHERE id = " + id;
     
     if (db.execute(sql)) {
+        TimetableStore::getInstance().refreshSchedules("course_id", std::stoi(id));
+        TableVersions::getInstance().bump({Table::Course});
+        publishChange("course", "update", id);
         res.setJson("{\"success\": true}");
     } else {
         res.setStatus(400);
@@ -379,6 +712,11 @@ void handleDeleteCourse(const HttpRequest& req, HttpResponse& res) {
     
     std::string sql = "DELETE FROM course WHERE id = " + id;
     if (db.execute(sql)) {
+        TimetableStore::getInstance().refreshSchedules("course_id", std::stoi(id));
+        UtilizationStats::getInstance().refreshSchedules("course_id", std::stoi(id));
+        TableVersions::getInstance().bump({Table::Course, Table::Schedule, Table::Enrollment});
+        publishChange("course", "delete", id);
+        publishChange("schedule", "delete");
         res.setStatus(204);
     } else {
         res.setStatus(400);
@@ -388,10 +726,26 @@ void handleDeleteCourse(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 排课管理 ==========
 void handleGetSchedules(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kScheduleReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     
-    std::string sql = "SELECT * FROM v_schedule_detail WHERE 1=1";
+    KeysetPage page({
+        {"schedule_id", "schedule_id"}, {"semester", "semester"}, {"weekday", "weekday"},
+        {"start_section", "start_section"}, {"end_section", "end_section"},
+        {"start_week", "start_week"}, {"end_week", "end_week"}, {"week_type", "week_type"},
+        {"course_code", "course_code"}, {"course_name", "course_name"},
+        {"teacher_code", "teacher_code"}, {"teacher_name", "teacher_name"},
+        {"classroom_code", "classroom_code"}, {"classroom_name", "classroom_name"},
+        {"building", "building"}, {"class_code", "class_code"}, {"class_name", "class_name"}
+    }, {
+        {"weekday", "weekday", false, true},
+        {"start_section", "start_section", false, true},
+        {"schedule_id", "schedule_id", false, true}
+    });
+    if (!parsePage(page, queryParams, res)) return;
+    
+    std::string sql = "SELECT " + page.selectList() + " FROM v_schedule_detail WHERE 1=1";
     
     if (queryParams.count("semester") && !queryParams["semester"].empty()) {
         sql += " AND semester = '" + db.escape(queryParams["semester"]) + "'";
@@ -406,10 +760,10 @@ void handleGetSchedules(const HttpRequest& req, HttpResponse& res) {
         sql += " AND weekday = " + queryParams["weekday"];
     }
     
-    sql += " ORDER BY weekday, start_section";
+    sql += page.cursorCondition() + page.orderAndLimit();
     
     auto result = db.query(sql);
-    res.setJson(Json::fromDbResult(result));
+    sendPage(page, result, res);
 }
 
 // 冲突检测
@@ -489,8 +843,13 @@ void handleCreateSchedule(const HttpRequest& req, HttpResponse& res) {
         + db.escape(params["remark"]) + "')";
     
     if (db.execute(sql)) {
+        unsigned long long scheduleId = db.lastInsertId();
+        TimetableStore::getInstance().refreshSchedules("id", static_cast<int>(scheduleId));
+        UtilizationStats::getInstance().refreshSchedules("id", static_cast<int>(scheduleId));
+        TableVersions::getInstance().bump({Table::Schedule});
+        publishChange("schedule", "create", std::to_string(scheduleId));
         res.setStatus(201);
-        res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + ", \"message\": \"排课成功\"}");
+        res.setJson("{\"id\": " + std::to_string(scheduleId) + ", \"message\": \"排课成功\"}");
     } else {
         res.setStatus(400);
         res.setJson("{\"error\": \"创建失败: " + db.getError() + "\"}");
@@ -502,6 +861,10 @@ void handleDeleteSchedule(const HttpRequest& req, HttpResponse& res) {
     auto& db = Database::getInstance();
     
     if (db.execute("DELETE FROM schedule WHERE id = " + id)) {
+        TimetableStore::getInstance().removeSchedule(std::stoi(id));
+        UtilizationStats::getInstance().removeSchedule(std::stoi(id));
+        TableVersions::getInstance().bump({Table::Schedule});
+        publishChange("schedule", "delete", id);
         res.setStatus(204);
     } else {
         res.setStatus(400);
@@ -509,12 +872,49 @@ void handleDeleteSchedule(const HttpRequest& req, HttpResponse& res) {
     }
 }
 
+void handleBatchCreateSchedules(const HttpRequest& req, HttpResponse& res) {
+    if (!requireAdmin(req, res)) return;
+    
+    auto queryParams = req.parseQuery();
+    bool dryRun = queryParams["dry_run"] == "1" || queryParams["dry_run"] == "true";
+    auto contentType = req.headers.find("Content-Type");
+    
+    ScheduleImport::Report report;
+    switch (ScheduleImport::run(req.body, contentType == req.headers.end() ? "" : contentType->second, dryRun, report)) {
+        case ScheduleImport::Result::BadFormat:
+            res.setStatus(400);
+            res.setJson("{\"error\": \"请求体应为排课JSON数组或带表头的CSV\"}");
+            return;
+        case ScheduleImport::Result::TooLarge:
+            res.setStatus(413);
+            res.setJson("{\"error\": \"单次最多导入 " + std::to_string(ScheduleImport::kMaxLines) + " 条排课\"}");
+            return;
+        case ScheduleImport::Result::DbError:
+            res.setStatus(500);
+            res.setJson("{\"error\": \"写入失败，已全部回滚\"}");
+            return;
+        case ScheduleImport::Result::Ok:
+            break;
+    }
+    
+    auto courseIds = report.createdCourseIds();
+    if (!courseIds.empty()) {
+        TimetableStore::getInstance().refreshSchedules("course_id", courseIds);
+        UtilizationStats::getInstance().refreshSchedules("course_id", courseIds);
+    }
+    if (!dryRun && report.created > 0) {
+        TableVersions::getInstance().bump({Table::Schedule});
+        publishChange("schedule", "import");
+    }
+    res.setJson(report.toJson());
+}
+
 // ========== 可用教室查询 ==========
 void handleGetAvailableClassrooms(const HttpRequest& req, HttpResponse& res) {
-    auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
-    
     std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    if (notModified(req, res, kOccupancyReads, semester)) return;
+    auto& db = Database::getInstance();
     std::string weekday = queryParams["weekday"];
     std::string startSection = queryParams["start_section"];
     std::string endSection = queryParams["end_section"];
@@ -559,33 +959,55 @@ void handleGetAvailableClassrooms(const HttpRequest& req, HttpResponse& res) {
 }
 
 // ========== 教师/学生管理 ==========
-void handleGetTeachers([[maybe_unused]] const HttpRequest& req, HttpResponse& res) {
+void handleGetTeachers(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kUserReads)) return;
     auto& db = Database::getInstance();
     auto result = db.query("SELECT * FROM teacher ORDER BY teacher_code");
     res.setJson(Json::fromDbResult(result));
 }
 
 void handleGetStudents(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kUserReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     
-    std::string sql = "SELECT * FROM student WHERE 1=1";
+    KeysetPage page({
+        {"id", "id"}, {"user_id", "user_id"}, {"student_code", "student_code"}, {"name", "name"},
+        {"major", "major"}, {"class_name", "class_name"}, {"grade", "grade"},
+        {"phone", "phone"}, {"email", "email"}, {"created_at", "created_at"}
+    }, {
+        {"student_code", "student_code", false, false}
+    });
+    if (!parsePage(page, queryParams, res)) return;
+    
+    std::string sql = "SELECT " + page.selectList() + " FROM student WHERE 1=1";
     if (queryParams.count("class_name") && !queryParams["class_name"].empty()) {
         sql += " AND class_name = '" + db.escape(queryParams["class_name"]) + "'";
     }
-    sql += " ORDER BY student_code";
+    sql += page.cursorCondition() + page.orderAndLimit();
     
     auto result = db.query(sql);
-    res.setJson(Json::fromDbResult(result));
+    sendPage(page, result, res);
 }
 
 // ========== 课表查询 ==========
-void handleGetTeacherTimetable(const HttpRequest& req, HttpResponse& res) {
+// 未物化时查询交给数据库IO线程，事件循环在等待期间继续处理其他连接
+Task<HttpResponse> handleGetTeacherTimetable(const HttpRequest& req) {
+    HttpResponse res;
+    auto queryParams = req.parseQuery();
+    std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    if (notModified(req, res, kScheduleReads, semester)) {
+        co_return res;
+    }
     std::string teacherId = req.params.at("id");
     auto& db = Database::getInstance();
-    auto queryParams = req.parseQuery();
     
-    std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    // 直接返回物化好的课表
+    auto& store = TimetableStore::getInstance();
+    if (store.isLoaded()) {
+        res.setJson(*store.teacherTimetable(std::stoi(teacherId), semester));
+        co_return res;
+    }
     
     std::string sql = R"(
         SELECT * FROM v_schedule_detail 
@@ -594,16 +1016,27 @@ void handleGetTeacherTimetable(const HttpRequest& req, HttpResponse& res) {
         ORDER BY weekday, start_section
     )";
     
-    auto result = db.query(sql);
+    auto result = co_await AsyncDb::getInstance().query(sql);
     res.setJson(Json::fromDbResult(result));
+    co_return res;
 }
 
-void handleGetStudentTimetable(const HttpRequest& req, HttpResponse& res) {
+Task<HttpResponse> handleGetStudentTimetable(const HttpRequest& req) {
+    HttpResponse res;
+    auto queryParams = req.parseQuery();
+    std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    if (notModified(req, res, kStudentTimetableReads, semester)) {
+        co_return res;
+    }
     std::string studentId = req.params.at("id");
     auto& db = Database::getInstance();
-    auto queryParams = req.parseQuery();
     
-    std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    // 直接返回物化好的课表
+    auto& store = TimetableStore::getInstance();
+    if (store.isLoaded()) {
+        res.setJson(*store.studentTimetable(std::stoi(studentId), semester));
+        co_return res;
+    }
     
     // 通过选课记录获取课表
     std::string sql = R"(
@@ -615,12 +1048,14 @@ void handleGetStudentTimetable(const HttpRequest& req, HttpResponse& res) {
         ORDER BY vsd.weekday, vsd.start_section
     )";
     
-    auto result = db.query(sql);
+    auto result = co_await AsyncDb::getInstance().query(sql);
     res.setJson(Json::fromDbResult(result));
+    co_return res;
 }
 
 // ========== 班级管理 ==========
 void handleGetClasses(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kClassReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     
@@ -642,6 +1077,7 @@ void handleGetClasses(const HttpRequest& req, HttpResponse& res) {
 }
 
 void handleGetClass(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kClassReads)) return;
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
@@ -668,6 +1104,8 @@ void handleCreateClass(const HttpRequest& req, HttpResponse& res) {
         + db.escape(params["remark"]) + "')";
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::ClassInfo});
+        publishChange("class", "create");
         res.setStatus(201);
         res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + "}");
     } else {
@@ -691,6 +1129,9 @@ void handleUpdateClass(const HttpRequest& req, HttpResponse& res) {
         "WHERE id = " + id;
     
     if (db.execute(sql)) {
+        TimetableStore::getInstance().refreshSchedules("class_id", std::stoi(id));
+        TableVersions::getInstance().bump({Table::ClassInfo});
+        publishChange("class", "update", id);
         res.setStatus(200);
         res.setJson("{\"success\": true}");
     } else {
@@ -704,6 +1145,9 @@ void handleDeleteClass(const HttpRequest& req, HttpResponse& res) {
     auto& db = Database::getInstance();
     
     if (db.execute("DELETE FROM class_info WHERE id = " + id)) {
+        TimetableStore::getInstance().refreshSchedules("class_id", std::stoi(id));
+        TableVersions::getInstance().bump({Table::ClassInfo, Table::Schedule});
+        publishChange("class", "delete", id);
         res.setStatus(204);
     } else {
         res.setStatus(400);
@@ -713,10 +1157,20 @@ void handleDeleteClass(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 统计分析 ==========
 void handleGetUtilization(const HttpRequest& req, HttpResponse& res) {
-    auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
-    
     std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    if (notModified(req, res, kOccupancyReads, semester)) return;
+    auto& db = Database::getInstance();
+    
+    // 从内存位图统计，支持按周次范围和楼栋/类别汇总
+    auto& stats = UtilizationStats::getInstance();
+    if (stats.isLoaded()) {
+        int startWeek = queryParams["start_week"].empty() ? 0 : std::stoi(queryParams["start_week"]);
+        int endWeek = queryParams["end_week"].empty() ? 0 : std::stoi(queryParams["end_week"]);
+        std::string groupBy = queryParams["group_by"].empty() ? "room" : queryParams["group_by"];
+        res.setJson(stats.query(semester, startWeek, endWeek, groupBy));
+        return;
+    }
     
     std::string sql = "SELECT * FROM v_classroom_utilization WHERE semester = '" + db.escape(semester) + "' OR semester IS NULL ORDER BY utilization_rate DESC";
     
@@ -726,11 +1180,12 @@ void handleGetUtilization(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 排课建议 ==========
 void handleGetScheduleSuggestion(const HttpRequest& req, HttpResponse& res) {
-    auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
+    std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
+    if (notModified(req, res, kSuggestionReads, semester)) return;
+    auto& db = Database::getInstance();
     
     std::string courseId = queryParams["course_id"];
-    std::string semester = queryParams.count("semester") ? queryParams["semester"] : getCurrentSemester();
     int requiredSeats = queryParams.count("seats") ? std::stoi(queryParams["seats"]) : 30;
     
     if (courseId.empty()) {
@@ -802,14 +1257,16 @@ void handleGetScheduleSuggestion(const HttpRequest& req, HttpResponse& res) {
 }
 
 // ========== 节次时间配置 ==========
-void handleGetSectionTimes([[maybe_unused]] const HttpRequest& req, HttpResponse& res) {
+void handleGetSectionTimes(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kSectionTimeReads)) return;
     auto& db = Database::getInstance();
     auto result = db.query("SELECT * FROM section_time ORDER BY section_no");
     res.setJson(Json::fromDbResult(result));
 }
 
 // ========== 通知公告 ==========
-void handleGetNotices([[maybe_unused]] const HttpRequest& req, HttpResponse& res) {
+void handleGetNotices(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kNoticeReads)) return;
     auto& db = Database::getInstance();
     std::string sql = R"(
         SELECT n.*, u.real_name as author_name 
@@ -823,12 +1280,15 @@ void handleGetNotices([[maybe_unused]] const HttpRequest& req, HttpResponse& res
     res.setJson(Json::fromDbResult(result));
 }
 
+// 每次查看都递增浏览次数：详情不做条件请求（否则 304 不计数），递增后列表的 ETag 随之失效
 void handleGetNotice(const HttpRequest& req, HttpResponse& res) {
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
     // 增加浏览次数
-    db.execute("UPDATE notice SET view_count = view_count + 1 WHERE id = " + id);
+    if (db.execute("UPDATE notice SET view_count = view_count + 1 WHERE id = " + id)) {
+        TableVersions::getInstance().bump({Table::Notice});
+    }
     
     auto result = db.query(
         "SELECT n.*, u.real_name as author_name FROM notice n "
@@ -855,6 +1315,8 @@ void handleCreateNotice(const HttpRequest& req, HttpResponse& res) {
         (data["is_top"] == "true" ? "1" : "0") + ")";
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::Notice});
+        publishChange("notice", "create");
         res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + ", \"message\": \"发布成功\"}");
     } else {
         res.setStatus(500);
@@ -874,6 +1336,8 @@ void handleUpdateNotice(const HttpRequest& req, HttpResponse& res) {
         " WHERE id = " + id;
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::Notice});
+        publishChange("notice", "update", id);
         res.setJson("{\"message\": \"更新成功\"}");
     } else {
         res.setStatus(500);
@@ -886,6 +1350,8 @@ void handleDeleteNotice(const HttpRequest& req, HttpResponse& res) {
     auto& db = Database::getInstance();
     
     if (db.execute("DELETE FROM notice WHERE id = " + id)) {
+        TableVersions::getInstance().bump({Table::Notice});
+        publishChange("notice", "delete", id);
         res.setStatus(204);
     } else {
         res.setStatus(500);
@@ -895,14 +1361,27 @@ void handleDeleteNotice(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 教室预约 ==========
 void handleGetBookings(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kBookingReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     std::string status = queryParams.count("status") ? queryParams["status"] : "";
     std::string classroomId = queryParams.count("classroom_id") ? queryParams["classroom_id"] : "";
     
-    std::string sql = R"(
-        SELECT b.*, c.classroom_code, c.name as classroom_name, 
-               u.real_name as applicant_name, a.real_name as approver_name
+    KeysetPage page({
+        {"id", "b.id"}, {"classroom_id", "b.classroom_id"}, {"applicant_id", "b.applicant_id"},
+        {"booking_date", "b.booking_date"}, {"start_section", "b.start_section"},
+        {"end_section", "b.end_section"}, {"purpose", "b.purpose"}, {"status", "b.status"},
+        {"approver_id", "b.approver_id"}, {"approved_at", "b.approved_at"}, {"remark", "b.remark"},
+        {"created_at", "b.created_at"}, {"classroom_code", "c.classroom_code"},
+        {"classroom_name", "c.name"}, {"applicant_name", "u.real_name"}, {"approver_name", "a.real_name"}
+    }, {
+        {"booking_date", "b.booking_date", true, false},
+        {"start_section", "b.start_section", false, true},
+        {"id", "b.id", false, true}
+    });
+    if (!parsePage(page, queryParams, res)) return;
+    
+    std::string sql = "SELECT " + page.selectList() + R"(
         FROM booking b
         LEFT JOIN classroom c ON b.classroom_id = c.id
         LEFT JOIN user u ON b.applicant_id = u.id
@@ -913,10 +1392,10 @@ void handleGetBookings(const HttpRequest& req, HttpResponse& res) {
     if (!status.empty()) sql += " AND b.status = '" + db.escape(status) + "'";
     if (!classroomId.empty()) sql += " AND b.classroom_id = " + classroomId;
     
-    sql += " ORDER BY b.booking_date DESC, b.start_section";
+    sql += page.cursorCondition() + page.orderAndLimit();
     
     auto result = db.query(sql);
-    res.setJson(Json::fromDbResult(result));
+    sendPage(page, result, res);
 }
 
 void handleCreateBooking(const HttpRequest& req, HttpResponse& res) {
@@ -945,7 +1424,11 @@ void handleCreateBooking(const HttpRequest& req, HttpResponse& res) {
         db.escape(data["purpose"]) + "')";
     
     if (db.execute(sql)) {
-        res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + ", \"message\": \"预约提交成功，等待审批\"}");
+        std::string bookingId = std::to_string(db.lastInsertId());
+        TableVersions::getInstance().bump({Table::Booking});
+        publishChange("booking", "create");
+        publishBookingState(bookingId);
+        res.setJson("{\"id\": " + bookingId + ", \"message\": \"预约提交成功，等待审批\"}");
     } else {
         res.setStatus(500);
         res.setJson("{\"error\": \"预约失败\"}");
@@ -963,6 +1446,9 @@ void handleApproveBooking(const HttpRequest& req, HttpResponse& res) {
         ", approved_at = NOW() WHERE id = " + id;
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::Booking});
+        publishChange("booking", status == "approved" ? "approve" : "reject", id);
+        publishBookingState(id);
         res.setJson("{\"message\": \"" + std::string(status == "approved" ? "审批通过" : "已拒绝") + "\"}");
     } else {
         res.setStatus(500);
@@ -972,14 +1458,24 @@ void handleApproveBooking(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 选课相关 ==========
 void handleGetEnrollments(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kEnrollmentReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     std::string studentId = queryParams.count("student_id") ? queryParams["student_id"] : "";
     std::string courseId = queryParams.count("course_id") ? queryParams["course_id"] : "";
     
-    std::string sql = R"(
-        SELECT e.*, s.student_code, s.name as student_name,
-               c.course_code, c.name as course_name, t.name as teacher_name
+    KeysetPage page({
+        {"id", "e.id"}, {"student_id", "e.student_id"}, {"course_id", "e.course_id"},
+        {"semester", "e.semester"}, {"status", "e.status"}, {"grade", "e.grade"},
+        {"created_at", "e.created_at"}, {"student_code", "s.student_code"}, {"student_name", "s.name"},
+        {"course_code", "c.course_code"}, {"course_name", "c.name"}, {"teacher_name", "t.name"}
+    }, {
+        {"created_at", "e.created_at", true, false},
+        {"id", "e.id", true, true}
+    });
+    if (!parsePage(page, queryParams, res)) return;
+    
+    std::string sql = "SELECT " + page.selectList() + R"(
         FROM enrollment e
         LEFT JOIN student s ON e.student_id = s.id
         LEFT JOIN course c ON e.course_id = c.id
@@ -990,29 +1486,30 @@ void handleGetEnrollments(const HttpRequest& req, HttpResponse& res) {
     if (!studentId.empty()) sql += " AND e.student_id = " + studentId;
     if (!courseId.empty()) sql += " AND e.course_id = " + courseId;
     
-    sql += " ORDER BY e.created_at DESC";
+    sql += page.cursorCondition() + page.orderAndLimit();
     
     auto result = db.query(sql);
-    res.setJson(Json::fromDbResult(result));
+    sendPage(page, result, res);
 }
 
-void handleEnrollCourse(const HttpRequest& req, HttpResponse& res) {
-    auto& db = Database::getInstance();
+Task<HttpResponse> handleEnrollCourse(const HttpRequest& req) {
+    HttpResponse res;
+    auto& db = AsyncDb::getInstance();
     auto data = Json::parse(req.body);
     
     // 检查是否已选
-    auto existing = db.query("SELECT id FROM enrollment WHERE student_id = " + data["student_id"] + 
+    auto existing = co_await db.query("SELECT id FROM enrollment WHERE student_id = " + data["student_id"] + 
         " AND course_id = " + data["course_id"] + " AND semester = '" + data["semester"] + "'");
     
     if (!existing.empty()) {
         res.setStatus(400);
         res.setJson("{\"error\": \"已选该课程\"}");
-        return;
+        co_return res;
     }
     
     // 检查课程容量
-    auto course = db.query("SELECT capacity FROM course WHERE id = " + data["course_id"]);
-    auto enrolled = db.query("SELECT COUNT(*) as cnt FROM enrollment WHERE course_id = " + data["course_id"] + 
+    auto course = co_await db.query("SELECT capacity FROM course WHERE id = " + data["course_id"]);
+    auto enrolled = co_await db.query("SELECT COUNT(*) as cnt FROM enrollment WHERE course_id = " + data["course_id"] + 
         " AND semester = '" + data["semester"] + "' AND status = 'enrolled'");
     
     if (!course.empty() && !enrolled.empty()) {
@@ -1021,26 +1518,40 @@ void handleEnrollCourse(const HttpRequest& req, HttpResponse& res) {
         if (current >= capacity) {
             res.setStatus(400);
             res.setJson("{\"error\": \"课程已满\"}");
-            return;
+            co_return res;
         }
     }
     
     std::string sql = "INSERT INTO enrollment (student_id, course_id, semester) VALUES (" +
         data["student_id"] + ", " + data["course_id"] + ", '" + data["semester"] + "')";
     
-    if (db.execute(sql)) {
+    if (co_await db.execute(sql)) {
+        TimetableStore::getInstance().addEnrollment(std::stoi(data["student_id"]), std::stoi(data["course_id"]),
+                                                    data["semester"]);
+        TableVersions::getInstance().bump({Table::Enrollment});
+        publishChange("enrollment", "create");
         res.setJson("{\"message\": \"选课成功\"}");
     } else {
         res.setStatus(500);
         res.setJson("{\"error\": \"选课失败\"}");
     }
+    co_return res;
 }
 
 void handleDropCourse(const HttpRequest& req, HttpResponse& res) {
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
+    auto enrollment = db.query("SELECT student_id, course_id, semester FROM enrollment WHERE id = " + id);
+    
     if (db.execute("UPDATE enrollment SET status = 'dropped' WHERE id = " + id)) {
+        if (!enrollment.empty()) {
+            TimetableStore::getInstance().removeEnrollment(std::stoi(enrollment[0]["student_id"]),
+                                                           std::stoi(enrollment[0]["course_id"]),
+                                                           enrollment[0]["semester"]);
+        }
+        TableVersions::getInstance().bump({Table::Enrollment});
+        publishChange("enrollment", "drop", id);
         res.setJson("{\"message\": \"退课成功\"}");
     } else {
         res.setStatus(500);
@@ -1050,12 +1561,22 @@ void handleDropCourse(const HttpRequest& req, HttpResponse& res) {
 
 // ========== 用户管理 ==========
 void handleGetUsers(const HttpRequest& req, HttpResponse& res) {
+    if (notModified(req, res, kUserReads)) return;
     auto& db = Database::getInstance();
     auto queryParams = req.parseQuery();
     std::string search = queryParams.count("search") ? queryParams["search"] : "";
     std::string role = queryParams.count("role") ? queryParams["role"] : "";
     
-    std::string sql = "SELECT id, username, real_name, role, email, phone, created_at FROM user WHERE 1=1";
+    KeysetPage page({
+        {"id", "id"}, {"username", "username"}, {"real_name", "real_name"}, {"role", "role"},
+        {"email", "email"}, {"phone", "phone"}, {"created_at", "created_at"}
+    }, {
+        {"created_at", "created_at", true, false},
+        {"id", "id", true, true}
+    });
+    if (!parsePage(page, queryParams, res)) return;
+    
+    std::string sql = "SELECT " + page.selectList() + " FROM user WHERE 1=1";
     
     if (!search.empty()) {
         sql += " AND (username LIKE '%" + db.escape(search) + "%' OR real_name LIKE '%" + db.escape(search) + "%')";
@@ -1064,13 +1585,14 @@ void handleGetUsers(const HttpRequest& req, HttpResponse& res) {
         sql += " AND role = '" + db.escape(role) + "'";
     }
     
-    sql += " ORDER BY created_at DESC";
+    sql += page.cursorCondition() + page.orderAndLimit();
     
     auto result = db.query(sql);
-    res.setJson(Json::fromDbResult(result));
+    sendPage(page, result, res);
 }
 
-void handleCreateUser(const HttpRequest& req, HttpResponse& res) {
+Task<HttpResponse> handleCreateUser(const HttpRequest& req) {
+    HttpResponse res;
     auto& db = Database::getInstance();
     auto data = Json::parse(req.body);
     
@@ -1079,48 +1601,77 @@ void handleCreateUser(const HttpRequest& req, HttpResponse& res) {
     if (!existing.empty()) {
         res.setStatus(400);
         res.setJson("{\"error\": \"用户名已存在\"}");
-        return;
+        co_return res;
     }
     
     std::string password = data["password"].empty() ? "123456" : data["password"];
+    auto passwordHash = co_await AuthService::getInstance().hashPassword(password);
+    if (!passwordHash) {
+        res.setStatus(503);
+        res.headers["Retry-After"] = "1";
+        res.setJson("{\"error\": \"服务器繁忙，请稍后重试\"}");
+        co_return res;
+    }
     
-    std::string sql = "INSERT INTO user (username, password, real_name, role, email, phone) VALUES ('" +
-        db.escape(data["username"]) + "', SHA2('" + db.escape(password) + "', 256), '" +
+    std::string sql = "INSERT INTO user (username, password_hash, real_name, role, email, phone) VALUES ('" +
+        db.escape(data["username"]) + "', '" + db.escape(*passwordHash) + "', '" +
         db.escape(data["real_name"]) + "', '" +
         db.escape(data["role"]) + "', '" +
         db.escape(data["email"]) + "', '" +
         db.escape(data["phone"]) + "')";
     
     if (db.execute(sql)) {
+        TableVersions::getInstance().bump({Table::User});
+        publishChange("user", "create");
         res.setJson("{\"id\": " + std::to_string(db.lastInsertId()) + ", \"message\": \"创建成功\"}");
     } else {
         res.setStatus(500);
         res.setJson("{\"error\": \"创建失败\"}");
     }
+    co_return res;
 }
 
-void handleUpdateUser(const HttpRequest& req, HttpResponse& res) {
+Task<HttpResponse> handleUpdateUser(const HttpRequest& req) {
+    HttpResponse res;
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     auto data = Json::parse(req.body);
     
+    // 会话里保存着登录时的角色：角色变化（如管理员降为学生）后旧令牌不能继续按原角色使用
+    auto current = db.query("SELECT role FROM user WHERE id = " + id);
+    bool roleChanged = !current.empty() && current[0]["role"] != data["role"];
+    
     std::string sql = "UPDATE user SET real_name = '" + db.escape(data["real_name"]) + 
         "', role = '" + db.escape(data["role"]) +
         "', email = '" + db.escape(data["email"]) +
         "', phone = '" + db.escape(data["phone"]) + "'";
     
     if (!data["password"].empty()) {
-        sql += ", password = SHA2('" + db.escape(data["password"]) + "', 256)";
+        auto passwordHash = co_await AuthService::getInstance().hashPassword(data["password"]);
+        if (!passwordHash) {
+            res.setStatus(503);
+            res.headers["Retry-After"] = "1";
+            res.setJson("{\"error\": \"服务器繁忙，请稍后重试\"}");
+            co_return res;
+        }
+        sql += ", password_hash = '" + db.escape(*passwordHash) + "'";
     }
     
     sql += " WHERE id = " + id;
     
     if (db.execute(sql)) {
+        AuthService::getInstance().invalidateUser(std::stoi(id));
+        if (!data["password"].empty() || roleChanged) {
+            SessionStore::getInstance().removeUser(std::stoi(id));
+        }
+        TableVersions::getInstance().bump({Table::User});
+        publishChange("user", "update", id);
         res.setJson("{\"message\": \"更新成功\"}");
     } else {
         res.setStatus(500);
         res.setJson("{\"error\": \"更新失败\"}");
     }
+    co_return res;
 }
 
 void handleDeleteUser(const HttpRequest& req, HttpResponse& res) {
@@ -1136,6 +1687,10 @@ void handleDeleteUser(const HttpRequest& req, HttpResponse& res) {
     }
     
     if (db.execute("DELETE FROM user WHERE id = " + id)) {
+        AuthService::getInstance().invalidateUser(std::stoi(id));
+        SessionStore::getInstance().removeUser(std::stoi(id));
+        TableVersions::getInstance().bump({Table::User, Table::Booking});
+        publishChange("user", "delete", id);
         res.setJson("{\"message\": \"删除成功\"}");
     } else {
         res.setStatus(500);
@@ -1143,65 +1698,65 @@ void handleDeleteUser(const HttpRequest& req, HttpResponse& res) {
     }
 }
 
-void handleResetPassword(const HttpRequest& req, HttpResponse& res) {
+Task<HttpResponse> handleResetPassword(const HttpRequest& req) {
+    HttpResponse res;
     std::string id = req.params.at("id");
     auto& db = Database::getInstance();
     
-    if (db.execute("UPDATE user SET password = SHA2('123456', 256) WHERE id = " + id)) {
+    auto passwordHash = co_await AuthService::getInstance().hashPassword("123456");
+    if (!passwordHash) {
+        res.setStatus(503);
+        res.headers["Retry-After"] = "1";
+        res.setJson("{\"error\": \"服务器繁忙，请稍后重试\"}");
+        co_return res;
+    }
+    
+    if (db.execute("UPDATE user SET password_hash = '" + db.escape(*passwordHash) + "' WHERE id = " + id)) {
+        AuthService::getInstance().invalidateUser(std::stoi(id));
+        SessionStore::getInstance().removeUser(std::stoi(id));
+        TableVersions::getInstance().bump({Table::User});
+        publishChange("user", "update", id);
         res.setJson("{\"message\": \"密码已重置为123456\"}");
     } else {
         res.setStatus(500);
         res.setJson("{\"error\": \"重置失败\"}");
     }
+    co_return res;
 }
 
+// 批量导入: text/csv 请求体，或 {"users": "<CSV文本>", "default_password": "..."}
+// 每行 username,real_name,role[,email[,phone[,password]]]，返回逐行结果
 void handleBatchCreateUsers(const HttpRequest& req, HttpResponse& res) {
-    auto& db = Database::getInstance();
-    auto data = Json::parse(req.body);
-    
-    int success = 0, failed = 0;
-    
-    // 解析用户数据 - 简单的逗号分隔格式: username,real_name,role,email
-    std::string usersData = data["users"];
-    std::istringstream stream(usersData);
-    std::string line;
-    
-    while (std::getline(stream, line)) {
-        if (line.empty()) continue;
-        
-        std::vector<std::string> parts;
-        std::istringstream lineStream(line);
-        std::string part;
-        while (std::getline(lineStream, part, ',')) {
-            parts.push_back(part);
-        }
-        
-        if (parts.size() >= 3) {
-            std::string username = parts[0];
-            std::string realName = parts[1];
-            std::string role = parts[2];
-            std::string email = parts.size() > 3 ? parts[3] : "";
-            
-            // 检查用户名是否已存在
-            auto existing = db.query("SELECT id FROM user WHERE username = '" + db.escape(username) + "'");
-            if (!existing.empty()) {
-                failed++;
-                continue;
-            }
-            
-            std::string sql = "INSERT INTO user (username, password, real_name, role, email) VALUES ('" +
-                db.escape(username) + "', SHA2('123456', 256), '" +
-                db.escape(realName) + "', '" + db.escape(role) + "', '" + db.escape(email) + "')";
-            
-            if (db.execute(sql)) {
-                success++;
-            } else {
-                failed++;
-            }
-        }
+    if (!requireAdmin(req, res)) return;
+    
+    auto contentType = req.headers.find("Content-Type");
+    std::string defaultPassword = "123456";
+    std::string csv = UserImport::extractCsv(req.body, contentType == req.headers.end() ? "" : contentType->second,
+                                             defaultPassword);
+    
+    UserImport::Report report;
+    switch (UserImport::run(csv, defaultPassword, report)) {
+        case UserImport::Result::TooLarge:
+            res.setStatus(413);
+            res.setJson("{\"error\": \"单次最多导入 " + std::to_string(UserImport::kMaxLines) + " 行\"}");
+            return;
+        case UserImport::Result::Busy:
+            res.setStatus(503);
+            res.headers["Retry-After"] = "1";
+            res.setJson("{\"error\": \"服务器繁忙，请稍后重试\"}");
+            return;
+        case UserImport::Result::DbError:
+            res.setStatus(500);
+            res.setJson("{\"error\": \"写入失败，已全部回滚\"}");
+            return;
+        case UserImport::Result::Ok:
+            break;
     }
-    
-    res.setJson("{\"success\": " + std::to_string(success) + ", \"failed\": " + std::to_string(failed) + "}");
+    if (report.created > 0) {
+        TableVersions::getInstance().bump({Table::User});
+        publishChange("user", "import");
+    }
+    res.setJson(report.toJson());
 }
 
 // ========== 主函数 ==========
@@ -1210,24 +1765,178 @@ int main() {
     signal(SIGINT, signalHandler);
     signal(SIGTERM, signalHandler);
     
-    // 数据库连接
+    // 日志：后台线程写入 server.log（单个文件 10MB，保留 5 个历史文件），级别可由 LOG_LEVEL 覆盖
+    auto& logger = Logger::getInstance();
+    logger.setLevel(LogLevel::Info);
+    if (const char* level = std::getenv("LOG_LEVEL")) {
+        logger.setLevel(Logger::parseLevel(level));
+    }
+    logger.setFile("server.log", 10 * 1024 * 1024, 5);
+    logger.setRateLimit(LogLevel::Warn, 1000);
+    logger.setRateLimit(LogLevel::Error, 1000);
+    logger.start();
+    
+    // 请求追踪默认关闭，可由 TRACE_SAMPLE_RATE（0~1）开启，或运行时通过 PUT /api/admin/trace 调整
+    if (const char* rate = std::getenv("TRACE_SAMPLE_RATE")) {
+        Tracer::getInstance().setSampleRate(std::atof(rate));
+    }
+    
+    // 慢查询阈值（毫秒），可由 SLOW_QUERY_MS 覆盖，0 表示关闭
+    QueryStats::getInstance().setSlowThresholdMs(200);
+    if (const char* slowMs = std::getenv("SLOW_QUERY_MS")) {
+        QueryStats::getInstance().setSlowThresholdMs(std::atoi(slowMs));
+    }
+    
+    // 数据库连接：默认本机 MySQL；DB_BACKEND=sqlite 时使用嵌入式数据库，
+    // DB_PATH 为数据库文件（默认内存库），空库时依次执行 DB_SCRIPTS 中的建库脚本（逗号分隔）
     auto& db = Database::getInstance();
-    if (!db.connect("localhost", "root", "@123Fengaoran", "classroom_system", 3306)) {
+#ifdef HAVE_MYSQL
+    std::string backend = "mysql";
+#else
+    std::string backend = "sqlite";
+#endif
+    if (const char* value = std::getenv("DB_BACKEND")) {
+        backend = value;
+    }
+    bool connected = false;
+    if (backend == "sqlite") {
+#ifdef HAVE_SQLITE
+        std::string path = std::getenv("DB_PATH") ? std::getenv("DB_PATH") : ":memory:";
+        std::string scripts = std::getenv("DB_SCRIPTS") ? std::getenv("DB_SCRIPTS")
+                                                        : "../../database/init.sql,../../database/more_data.sql";
+        std::vector<std::string> scriptList;
+        std::istringstream iss(scripts);
+        std::string script;
+        while (std::getline(iss, script, ',')) {
+            if (!script.empty()) scriptList.push_back(script);
+        }
+        connected = db.connect(std::make_unique<SqliteBackend>(path, scriptList));
+#else
+        std::cerr << "未编译嵌入式数据库支持（需要 SQLite3）" << std::endl;
+#endif
+    } else {
+        connected = db.connect("localhost", "root", "@123Fengaoran", "classroom_system", 3306);
+    }
+    if (!connected) {
         std::cerr << "数据库连接失败，请检查配置" << std::endl;
         return 1;
     }
     
-    // 创建HTTP服务器
+    // 会话存储（落盘到运行目录，重启后恢复登录状态）
+    auto& sessions = SessionStore::getInstance();
+    sessions.setTtl(2 * 3600);
+    sessions.setPersistFile("sessions.dat");
+    sessions.start();
+    
+    // 登录校验：KDF在独立线程池中执行，用户记录按用户名缓存
+    auto& auth = AuthService::getInstance();
+    auth.setIterations(PasswordHasher::kDefaultIterations);
+    auth.setUserLoader([](const std::string& username, AuthUser& user) {
+        auto& db = Database::getInstance();
+        auto result = db.query("SELECT id, username, role, real_name, password_hash FROM user WHERE username = '"
+                               + db.escape(username) + "'");
+        if (result.empty()) return false;
+        user.id = std::stoi(result[0]["id"]);
+        user.username = result[0]["username"];
+        user.role = result[0]["role"];
+        user.realName = result[0]["real_name"];
+        user.passwordHash = result[0]["password_hash"];
+        return true;
+    });
+    auth.setHashUpdater([](int userId, const std::string& passwordHash) {
+        auto& db = Database::getInstance();
+        db.execute("UPDATE user SET password_hash = '" + db.escape(passwordHash) + "' WHERE id = " + std::to_string(userId));
+    });
+    unsigned kdfThreads = std::max(2u, std::thread::hardware_concurrency() / 2);
+    auth.start(kdfThreads, 256);
+    
+    // 协程处理函数的数据库IO线程（DB_IO_THREADS，默认 4）：语句在这些线程上执行，事件循环不被阻塞
+    size_t dbIoThreads = 4;
+    if (const char* value = std::getenv("DB_IO_THREADS")) {
+        dbIoThreads = std::max(1, std::atoi(value));
+    }
+    AsyncDb::getInstance().start(dbIoThreads, 1024);
+    
+    // 课表物化：启动时全量加载，之后随排课/选课变更增量更新
+    auto& timetables = TimetableStore::getInstance();
+    timetables.setLoader([](const std::string& sql) { return Database::getInstance().query(sql); });
+    timetables.load();
+    
+    // 教室利用率：按教室维护占用位图
+    auto& utilization = UtilizationStats::getInstance();
+    utilization.setLoader([](const std::string& sql) { return Database::getInstance().query(sql); });
+    utilization.load();
+    
+    // 创建HTTP服务器：默认每个连接一个线程；SERVER_LOOPS=N（或 auto，按CPU数）时改为 N 个 SO_REUSEPORT 事件循环，
+    // SERVER_PIN_CPUS=1 时每个循环绑定一个CPU；SERVER_IO=io_uring 时循环使用 io_uring（未设 SERVER_LOOPS 时按 auto），
+    // 内核不支持则回退到 epoll
     HttpServer server(8080);
     g_server = &server;
+    const char* loops = std::getenv("SERVER_LOOPS");
+    const char* io = std::getenv("SERVER_IO");
+    bool ioUring = io && std::string(io) == "io_uring";
+    if (loops || ioUring) {
+        int count = !loops || std::string(loops) == "auto" ? static_cast<int>(std::thread::hardware_concurrency())
+                                                           : std::atoi(loops);
+        const char* pin = std::getenv("SERVER_PIN_CPUS");
+        server.setEventLoops(count, pin && std::string(pin) == "1", ioUring ? IoBackend::IoUring : IoBackend::Epoll);
+    }
+    
+    // 超时（毫秒）：连接空闲 60s、读请求头 10s、读请求体 30s、发送响应 30s、异步处理函数 30s，
+    // 可由 TIMEOUT_{IDLE,HEADER,BODY,WRITE,HANDLER}_MS 覆盖；等待数据库连接 5s（DB_CHECKOUT_MS），
+    // 单条语句 30s（DB_STATEMENT_MS，0 表示不限）
+    auto envMs = [](const char* name, std::chrono::milliseconds fallback) {
+        const char* value = std::getenv(name);
+        return value ? std::chrono::milliseconds(std::max(0, std::atoi(value))) : fallback;
+    };
+    ServerTimeouts timeouts;
+    timeouts.idle = envMs("TIMEOUT_IDLE_MS", timeouts.idle);
+    timeouts.header = envMs("TIMEOUT_HEADER_MS", timeouts.header);
+    timeouts.body = envMs("TIMEOUT_BODY_MS", timeouts.body);
+    timeouts.write = envMs("TIMEOUT_WRITE_MS", timeouts.write);
+    timeouts.handler = envMs("TIMEOUT_HANDLER_MS", timeouts.handler);
+    server.setTimeouts(timeouts);
+    db.setTimeouts(envMs("DB_CHECKOUT_MS", std::chrono::milliseconds(5000)),
+                   envMs("DB_STATEMENT_MS", std::chrono::milliseconds(30000)));
+    
+    // 响应压缩：客户端接受 gzip/deflate 且响应不小于 1KB 时压缩（COMPRESSION=off 关闭），
+    // COMPRESSION_LEVEL 为压缩级别（默认 3），COMPRESSION_MIN_SIZE 为最小字节数
+    CompressionOptions compression;
+    const char* compressionMode = std::getenv("COMPRESSION");
+    compression.enabled = !compressionMode || std::string(compressionMode) != "off";
+    if (const char* value = std::getenv("COMPRESSION_LEVEL")) compression.level = std::clamp(std::atoi(value), 1, 9);
+    if (const char* value = std::getenv("COMPRESSION_MIN_SIZE")) compression.minSize = std::max(0, std::atoi(value));
+    if (const char* value = std::getenv("COMPRESSION_CHUNKED_SIZE")) compression.chunkedSize = std::max(0, std::atoi(value));
+    server.setCompression(compression);
+    
+    // 变更推送：SSE 和 WebSocket 订阅连接交给推送线程持有（PUSH_MAX_SUBSCRIBERS，默认 10000）
+    PushHub::Options pushOptions;
+    if (const char* value = std::getenv("PUSH_MAX_SUBSCRIBERS")) pushOptions.maxSubscribers = std::max(0, std::atoi(value));
+    auto& push = PushHub::getInstance();
+    push.configure(pushOptions);
+    push.start();
+    
+    // 中间件
+    server.use(authMiddleware);
     
     // 设置静态文件目录 (使用绝对路径)
     server.setStaticDir("/Users/fengrr/Desktop/程序设计方法实现/code/sys/frontend");
     
     // ===== 注册路由 =====
     
+    // 运行指标
+    server.get("/metrics", handleMetrics);
+    server.get("/api/events", handleEvents);
+    server.get("/api/ws", handleWebSocket);
+    server.get("/api/admin/query-stats", handleGetQueryStats);
+    server.del("/api/admin/query-stats", handleResetQueryStats);
+    server.get("/api/admin/slow-queries", handleGetSlowQueries);
+    server.get("/api/admin/trace", handleGetTrace);
+    server.put("/api/admin/trace", handleUpdateTrace);
+    
     // 认证
     server.post("/api/login", handleLogin);
+    server.post("/api/logout", handleLogout);
     
     // 教室管理
     server.get("/api/classrooms", handleGetClassrooms);
@@ -1254,6 +1963,7 @@ int main() {
     // 排课管理
     server.get("/api/schedules", handleGetSchedules);
     server.post("/api/schedules", handleCreateSchedule);
+    server.post("/api/schedules/batch", handleBatchCreateSchedules);
     server.del("/api/schedules/:id", handleDeleteSchedule);
     
     // 可用教室查询
@@ -1308,6 +2018,76 @@ int main() {
     server.put("/api/users/:id/reset-password", handleResetPassword);
     server.post("/api/users/batch", handleBatchCreateUsers);
     
+    // ===== 准入控制 =====
+    // 读（GET）、写、批量导入、登录四类路由各自限制并发，过载时排队或快速返回 503（ADMISSION=off 关闭）。
+    // 登录的名额与KDF线程数相当，错误密码的重试只在登录类别里排队；
+    // 运行指标和管理接口不限，过载时仍可观测；推送订阅在建立后不占名额，也不限
+    const char* admissionMode = std::getenv("ADMISSION");
+    if (!admissionMode || std::string(admissionMode) != "off") {
+        auto& admission = AdmissionController::getInstance();
+        
+        AdmissionController::Options readOptions;
+        readOptions.initialLimit = 32;
+        readOptions.minLimit = 8;
+        readOptions.maxQueue = 512;
+        readOptions.deadline = std::chrono::milliseconds(500);
+        auto* read = admission.configure("read", readOptions);
+        
+        AdmissionController::Options writeOptions;
+        writeOptions.initialLimit = 16;
+        writeOptions.minLimit = 8;
+        writeOptions.maxLimit = 64;
+        writeOptions.maxQueue = 128;
+        writeOptions.deadline = std::chrono::milliseconds(2000);
+        auto* write = admission.configure("write", writeOptions);
+        
+        AdmissionController::Options bulkOptions;
+        bulkOptions.initialLimit = 1;
+        bulkOptions.minLimit = 1;
+        bulkOptions.maxLimit = 2;
+        bulkOptions.maxQueue = 4;
+        bulkOptions.deadline = std::chrono::milliseconds(30000);
+        auto* bulk = admission.configure("bulk", bulkOptions);
+        
+        AdmissionController::Options loginOptions;
+        loginOptions.initialLimit = kdfThreads;
+        loginOptions.minLimit = kdfThreads;
+        loginOptions.maxLimit = kdfThreads * 2;
+        loginOptions.maxQueue = 256;
+        loginOptions.deadline = std::chrono::milliseconds(1000);
+        auto* login = admission.configure("login", loginOptions);
+        
+        server.admit("GET", "/api/", read);
+        server.admit("POST", "/api/", write);
+        server.admit("PUT", "/api/", write);
+        server.admit("DELETE", "/api/", write);
+        server.admit("POST", "/api/users/batch", bulk);
+        server.admit("POST", "/api/schedules/batch", bulk);
+        server.admit("*", "/api/admin/", nullptr);
+        server.admit("POST", "/api/login", login);
+        server.admit("GET", "/api/events", nullptr);
+        server.admit("GET", "/api/ws", nullptr);
+    }
+    
+    // ===== 响应缓存 =====
+    // 结果只取决于参数和表数据的读接口缓存序列化好的响应，所列的表即处理函数生成 ETag 所用的声明；
+    // 写接口递增表版本后相应条目失效（RESPONSE_CACHE=off 关闭，RESPONSE_CACHE_MB 为内存上限，默认 64）。
+    // 未指定学期时按当前学期回答的接口（可用教室、利用率、课表、排课建议）不缓存：默认学期不在缓存键里
+    ResponseCache::Options cacheOptions;
+    const char* cacheMode = std::getenv("RESPONSE_CACHE");
+    cacheOptions.enabled = !cacheMode || std::string(cacheMode) != "off";
+    if (const char* value = std::getenv("RESPONSE_CACHE_MB")) {
+        cacheOptions.maxBytes = static_cast<size_t>(std::max(0, std::atoi(value))) * 1024 * 1024;
+    }
+    ResponseCache::getInstance().configure(cacheOptions);
+    server.cache("/api/classrooms", kClassroomReads);
+    server.cache("/api/classrooms/:id", kClassroomDetailReads);
+    server.cache("/api/equipments", kEquipmentReads);
+    server.cache("/api/courses", kCourseReads);
+    server.cache("/api/teachers", kUserReads);
+    server.cache("/api/classes", kClassReads);
+    server.cache("/api/section-times", kSectionTimeReads);
+    
     std::cout << "===== 教室资源管理系统后端 =====" << std::endl;
     std::cout << "API文档: http://localhost:8080/api" << std::endl;
     std::cout << "前端页面: http://localhost:8080" << std::endl;
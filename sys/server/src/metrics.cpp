@@ -0,0 +1,265 @@
+#include "metrics.hpp"
+#include <sstream>
+#include <vector>
+#include <iomanip>
+#include <cctype>
+
+int metricShardIndex() {
+    // 线程首次记录时按顺序领取下一个分片，之后固定使用；线程多于分片数时轮流共用
+    static std::atomic<unsigned> next{0};
+    thread_local int index = static_cast<int>(next.fetch_add(1, std::memory_order_relaxed) % kMetricShards);
+    return index;
+}
+
+// ========== 直方图 ==========
+void HistogramSnapshot::add(const HistogramCells& cells) {
+    for (int i = 0; i < kLatencyBuckets; i++) {
+        uint64_t n = cells.buckets[i].load(std::memory_order_relaxed);
+        buckets[i] += n;
+        count += n;
+    }
+    sumNanos += cells.sumNanos.load(std::memory_order_relaxed);
+}
+
+HistogramSnapshot Histogram::snapshot() const {
+    HistogramSnapshot result;
+    for (const auto& shard : shards_) {
+        result.add(shard.cells);
+    }
+    return result;
+}
+
+uint64_t Counter::value() const {
+    uint64_t total = 0;
+    for (const auto& shard : shards_) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+// ========== 路由指标 ==========
+RouteMetrics::RouteMetrics(const std::string& method, const std::string& pattern)
+    : method_(method), pattern_(pattern) {}
+
+RouteMetrics::Snapshot RouteMetrics::snapshot() const {
+    Snapshot result;
+    for (const auto& shard : shards_) {
+        for (int i = 0; i < 5; i++) {
+            result.status[i] += shard.status[i].load(std::memory_order_relaxed);
+        }
+        result.bytesIn += shard.bytesIn.load(std::memory_order_relaxed);
+        result.bytesOut += shard.bytesOut.load(std::memory_order_relaxed);
+        result.latency.add(shard.latency);
+    }
+    return result;
+}
+
+// ========== 注册表 ==========
+Metrics& Metrics::getInstance() {
+    static Metrics instance;
+    return instance;
+}
+
+StatementKind Metrics::statementKind(const std::string& sql) {
+    size_t i = 0;
+    while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) i++;
+
+    auto startsWith = [&](const char* word) {
+        size_t j = 0;
+        for (; word[j]; j++) {
+            if (i + j >= sql.size() || std::toupper(static_cast<unsigned char>(sql[i + j])) != word[j]) return false;
+        }
+        return true;
+    };
+
+    if (startsWith("SELECT") || startsWith("WITH")) return StatementKind::Select;
+    if (startsWith("INSERT") || startsWith("REPLACE")) return StatementKind::Insert;
+    if (startsWith("UPDATE")) return StatementKind::Update;
+    if (startsWith("DELETE")) return StatementKind::Delete;
+    return StatementKind::Other;
+}
+
+const char* Metrics::statementKindName(StatementKind kind) {
+    switch (kind) {
+        case StatementKind::Select: return "select";
+        case StatementKind::Insert: return "insert";
+        case StatementKind::Update: return "update";
+        case StatementKind::Delete: return "delete";
+        default: return "other";
+    }
+}
+
+const char* Metrics::ioSyscallName(IoSyscall call) {
+    switch (call) {
+        case IoSyscall::Accept: return "accept";
+        case IoSyscall::Recv: return "recv";
+        case IoSyscall::Send: return "send";
+        case IoSyscall::Close: return "close";
+        case IoSyscall::Wait: return "epoll_wait";
+        case IoSyscall::Control: return "control";
+        case IoSyscall::Thread: return "thread_create";
+        case IoSyscall::Enter: return "io_uring_enter";
+        default: return "other";
+    }
+}
+
+const char* Metrics::timeoutKindName(TimeoutKind kind) {
+    switch (kind) {
+        case TimeoutKind::Idle: return "idle";
+        case TimeoutKind::Header: return "header";
+        case TimeoutKind::Body: return "body";
+        case TimeoutKind::Write: return "write";
+        case TimeoutKind::Handler: return "handler";
+        case TimeoutKind::DbCheckout: return "db_checkout";
+        case TimeoutKind::DbStatement: return "db_statement";
+        default: return "other";
+    }
+}
+
+uint64_t Metrics::syscallTotal() const {
+    uint64_t total = 0;
+    for (const auto& counter : syscalls_) {
+        total += counter.value();
+    }
+    return total;
+}
+
+void Metrics::setIoBackend(const std::string& backend, int loops) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ioBackend_ = backend;
+    ioLoops_ = loops;
+}
+
+RouteMetrics* Metrics::route(const std::string& method, const std::string& pattern) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& route : routes_) {
+        if (route.method() == method && route.pattern() == pattern) return &route;
+    }
+    routes_.emplace_back(method, pattern);
+    return &routes_.back();
+}
+
+namespace {
+
+std::string seconds(uint64_t nanos) {
+    std::ostringstream oss;
+    oss << std::setprecision(9) << static_cast<double>(nanos) / 1e9;
+    return oss.str();
+}
+
+std::string escapeLabel(const std::string& value) {
+    std::string out;
+    for (char c : value) {
+        if (c == '\\' || c == '"') out.push_back('\\');
+        if (c == '\n') {
+            out += "\\n";
+            continue;
+        }
+        out.push_back(c);
+    }
+    return out;
+}
+
+// 输出一组直方图样本（Prometheus要求桶为累计值）
+void writeHistogram(std::ostringstream& oss, const std::string& name, const std::string& labels,
+                    const HistogramSnapshot& h) {
+    std::string prefix = labels.empty() ? "" : labels + ",";
+    uint64_t cumulative = 0;
+    for (int i = 0; i < kLatencyBuckets; i++) {
+        cumulative += h.buckets[i];
+        std::string le = i < kLatencyBuckets - 1 ? seconds(kLatencyBounds[i]) : "+Inf";
+        oss << name << "_bucket{" << prefix << "le=\"" << le << "\"} " << cumulative << "\n";
+    }
+    std::string braces = labels.empty() ? "" : "{" + labels + "}";
+    oss << name << "_sum" << braces << " " << seconds(h.sumNanos) << "\n";
+    oss << name << "_count" << braces << " " << h.count << "\n";
+}
+
+} // namespace
+
+std::string Metrics::render() const {
+    std::vector<std::pair<std::string, RouteMetrics::Snapshot>> routes;
+    std::string ioBackend;
+    int ioLoops;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ioBackend = ioBackend_;
+        ioLoops = ioLoops_;
+        for (const auto& route : routes_) {
+            std::string labels = "method=\"" + route.method() + "\",route=\"" + escapeLabel(route.pattern()) + "\"";
+            routes.push_back({labels, route.snapshot()});
+        }
+    }
+
+    static const char* classes[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+    std::ostringstream oss;
+
+    oss << "# HELP http_requests_total HTTP请求数（按路由和状态码类别）\n";
+    oss << "# TYPE http_requests_total counter\n";
+    for (const auto& [labels, snap] : routes) {
+        for (int i = 0; i < 5; i++) {
+            if (snap.status[i] == 0) continue;
+            oss << "http_requests_total{" << labels << ",code=\"" << classes[i] << "\"} " << snap.status[i] << "\n";
+        }
+    }
+
+    oss << "# HELP http_request_bytes_total 请求字节数\n";
+    oss << "# TYPE http_request_bytes_total counter\n";
+    for (const auto& [labels, snap] : routes) {
+        oss << "http_request_bytes_total{" << labels << "} " << snap.bytesIn << "\n";
+    }
+
+    oss << "# HELP http_response_bytes_total 响应字节数\n";
+    oss << "# TYPE http_response_bytes_total counter\n";
+    for (const auto& [labels, snap] : routes) {
+        oss << "http_response_bytes_total{" << labels << "} " << snap.bytesOut << "\n";
+    }
+
+    oss << "# HELP http_request_duration_seconds 请求处理耗时\n";
+    oss << "# TYPE http_request_duration_seconds histogram\n";
+    for (const auto& [labels, snap] : routes) {
+        writeHistogram(oss, "http_request_duration_seconds", labels, snap.latency);
+    }
+
+    oss << "# HELP db_pool_wait_seconds 等待数据库连接的时间\n";
+    oss << "# TYPE db_pool_wait_seconds histogram\n";
+    writeHistogram(oss, "db_pool_wait_seconds", "", dbWait_.snapshot());
+
+    oss << "# HELP db_query_duration_seconds SQL执行耗时（按语句类型）\n";
+    oss << "# TYPE db_query_duration_seconds histogram\n";
+    for (int i = 0; i < static_cast<int>(StatementKind::Count); i++) {
+        std::string labels = std::string("kind=\"") + statementKindName(static_cast<StatementKind>(i)) + "\"";
+        writeHistogram(oss, "db_query_duration_seconds", labels, dbQuery_[i].snapshot());
+    }
+
+    oss << "# HELP server_io_backend 网络IO模式（threads/epoll/io_uring）和事件循环数\n";
+    oss << "# TYPE server_io_backend gauge\n";
+    oss << "server_io_backend{backend=\"" << ioBackend << "\"} " << ioLoops << "\n";
+
+    oss << "# HELP server_io_syscalls_total 网络IO系统调用次数\n";
+    oss << "# TYPE server_io_syscalls_total counter\n";
+    for (int i = 0; i < static_cast<int>(IoSyscall::Count); i++) {
+        uint64_t count = syscalls_[i].value();
+        if (count == 0) continue;
+        oss << "server_io_syscalls_total{call=\"" << ioSyscallName(static_cast<IoSyscall>(i)) << "\"} " << count << "\n";
+    }
+
+    oss << "# HELP server_timeouts_total 超时次数（空闲连接、请求头/请求体读取、响应发送、处理函数、数据库连接等待与语句执行）\n";
+    oss << "# TYPE server_timeouts_total counter\n";
+    for (int i = 0; i < static_cast<int>(TimeoutKind::Count); i++) {
+        oss << "server_timeouts_total{kind=\"" << timeoutKindName(static_cast<TimeoutKind>(i)) << "\"} " << timeouts_[i].value() << "\n";
+    }
+
+    oss << "# HELP server_compression_responses_total 压缩发送的响应数\n";
+    oss << "# TYPE server_compression_responses_total counter\n";
+    oss << "server_compression_responses_total " << compressed_.value() << "\n";
+    oss << "# HELP server_compression_bytes_total 压缩前（in）和压缩后（out）的响应体字节数\n";
+    oss << "# TYPE server_compression_bytes_total counter\n";
+    oss << "server_compression_bytes_total{direction=\"in\"} " << compressionIn_.value() << "\n";
+    oss << "server_compression_bytes_total{direction=\"out\"} " << compressionOut_.value() << "\n";
+    oss << "# HELP server_compression_seconds_total 压缩耗时\n";
+    oss << "# TYPE server_compression_seconds_total counter\n";
+    oss << "server_compression_seconds_total " << static_cast<double>(compressionNanos_.value()) / 1e9 << "\n";
+
+    return oss.str();
+}
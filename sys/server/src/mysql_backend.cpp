@@ -0,0 +1,203 @@
+#include "mysql_backend.hpp"
+#include "db.hpp"
+#include "logger.hpp"
+#include "query_stats.hpp"
+#include <stdexcept>
+#include <chrono>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+} // namespace
+
+MysqlBackend::MysqlBackend(const std::string& host, const std::string& user,
+                           const std::string& password, const std::string& database,
+                           unsigned int port)
+    : conn_(nullptr), connected_(false),
+      host_(host), user_(user), password_(password), database_(database), port_(port) {
+    conn_ = mysql_init(nullptr);
+    if (!conn_) {
+        throw std::runtime_error("MySQL init failed");
+    }
+}
+
+MysqlBackend::~MysqlBackend() {
+    disconnect();
+    if (conn_) {
+        mysql_close(conn_);
+    }
+}
+
+void MysqlBackend::setOptions() {
+    // 设置字符集
+    mysql_options(conn_, MYSQL_SET_CHARSET_NAME, "utf8mb4");
+
+    // 设置自动重连
+    bool reconnect = true;
+    mysql_options(conn_, MYSQL_OPT_RECONNECT, &reconnect);
+
+    // 设置连接超时
+    unsigned int timeout = 10;
+    mysql_options(conn_, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+    mysql_options(conn_, MYSQL_OPT_READ_TIMEOUT, &timeout);
+    mysql_options(conn_, MYSQL_OPT_WRITE_TIMEOUT, &timeout);
+}
+
+bool MysqlBackend::connect() {
+    connected_ = false;
+    setOptions();
+
+    if (!mysql_real_connect(conn_, host_.c_str(), user_.c_str(), password_.c_str(),
+                            database_.c_str(), port_, nullptr, 0)) {
+        LOG_ERROR("MySQL连接失败: %s", mysql_error(conn_));
+        return false;
+    }
+
+    connected_ = true;
+    LOG_INFO("MySQL连接成功: %s:%u/%s", host_.c_str(), port_, database_.c_str());
+    return true;
+}
+
+void MysqlBackend::disconnect() {
+    if (connected_ && conn_) {
+        connected_ = false;
+    }
+}
+
+bool MysqlBackend::ping() {
+    return connected_ && conn_ && mysql_ping(conn_) == 0;
+}
+
+bool MysqlBackend::ensureConnected() {
+    if (!conn_) return false;
+
+    // 尝试ping，如果失败则重连
+    if (mysql_ping(conn_) != 0) {
+        LOG_WARN("MySQL连接已断开，尝试重连...");
+
+        // 手动重新连接
+        mysql_close(conn_);
+        conn_ = mysql_init(nullptr);
+        if (!conn_) {
+            LOG_ERROR("MySQL重新初始化失败");
+            connected_ = false;
+            return false;
+        }
+        setOptions();
+
+        // 使用保存的连接参数重连
+        const char* host = host_.empty() ? "localhost" : host_.c_str();
+        const char* user = user_.empty() ? "root" : user_.c_str();
+        const char* pwd = password_.empty() ? "@123Fengaoran" : password_.c_str();
+        const char* db = database_.empty() ? "classroom_system" : database_.c_str();
+
+        if (!mysql_real_connect(conn_, host, user, pwd, db, port_, nullptr, 0)) {
+            LOG_ERROR("MySQL重连失败: %s", mysql_error(conn_));
+            connected_ = false;
+            return false;
+        }
+
+        LOG_INFO("MySQL重连成功");
+        connected_ = true;
+    }
+    return true;
+}
+
+bool MysqlBackend::run(const std::string& sql, DbResult* result, StatementTiming& timing) {
+    auto phase = Clock::now();
+    threadId_.store(mysql_thread_id(conn_), std::memory_order_relaxed);
+    struct StatementScope {
+        std::atomic<uint64_t>& statements;
+        explicit StatementScope(std::atomic<uint64_t>& s) : statements(s) { statements.fetch_add(1); }
+        ~StatementScope() { statements.fetch_add(1); }
+    } scope(*statements_);
+    bool ok = mysql_query(conn_, sql.c_str()) == 0;
+    timing.execNs = nanosSince(phase);
+    if (!ok) return false;
+
+    if (!result) {
+        // 不需要结果时也要取走结果集，否则下一条语句会报 "Commands out of sync"
+        if (mysql_field_count(conn_) > 0) {
+            mysql_free_result(mysql_store_result(conn_));
+        }
+        return true;
+    }
+
+    phase = Clock::now();
+    MYSQL_RES* res = mysql_store_result(conn_);
+    timing.fetchNs = nanosSince(phase);
+    if (!res) {
+        // 可能是非SELECT语句
+        return true;
+    }
+
+    phase = Clock::now();
+    int numFields = mysql_num_fields(res);
+    MYSQL_FIELD* fields = mysql_fetch_fields(res);
+    std::vector<std::string> names;
+    names.reserve(numFields);
+    for (int i = 0; i < numFields; i++) {
+        names.emplace_back(fields[i].name);
+    }
+
+    result->reserve(result->size() + mysql_num_rows(res));
+    MYSQL_ROW row;
+    while ((row = mysql_fetch_row(res))) {
+        result->push_back(Database::buildRow(names, row));
+    }
+
+    mysql_free_result(res);
+    timing.convertNs = nanosSince(phase);
+    return true;
+}
+
+unsigned long long MysqlBackend::lastInsertId() const {
+    return mysql_insert_id(conn_);
+}
+
+unsigned long long MysqlBackend::affectedRows() const {
+    return mysql_affected_rows(conn_);
+}
+
+std::string MysqlBackend::escape(const std::string& str) {
+    if (!conn_) return str;
+
+    std::vector<char> buffer(str.size() * 2 + 1);
+    mysql_real_escape_string(conn_, buffer.data(), str.c_str(), str.size());
+    return std::string(buffer.data());
+}
+
+void MysqlBackend::interrupt() {
+    unsigned long threadId = threadId_.load(std::memory_order_relaxed);
+    uint64_t statement = statements_->load();
+    if (threadId == 0 || statement % 2 == 0) return;
+    // 调用方（定时线程）不能阻塞在建立连接上，KILL 放到单独的线程里。
+    // 建立连接最多要 2 秒，其间超时的语句可能已经结束、同一连接上开始了下一条（如事务的 COMMIT），
+    // 发 KILL 前确认仍是同一条语句
+    std::thread([host = host_, user = user_, password = password_, port = port_, threadId,
+                 statements = statements_, statement]() {
+        MYSQL* killer = mysql_init(nullptr);
+        if (!killer) return;
+        unsigned int timeout = 2;
+        mysql_options(killer, MYSQL_OPT_CONNECT_TIMEOUT, &timeout);
+        if (mysql_real_connect(killer, host.c_str(), user.c_str(), password.c_str(), nullptr, port, nullptr, 0) &&
+            statements->load() == statement) {
+            std::string sql = "KILL QUERY " + std::to_string(threadId);
+            if (mysql_query(killer, sql.c_str()) != 0) {
+                LOG_WARN("中断MySQL语句失败: %s", mysql_error(killer));
+            }
+        }
+        mysql_close(killer);
+        mysql_thread_end();
+    }).detach();
+}
+
+std::string MysqlBackend::error() const {
+    return conn_ ? mysql_error(conn_) : "No connection";
+}
@@ -0,0 +1,194 @@
+#include "pagination.hpp"
+#include "db.hpp"
+#include "json.hpp"
+#include <sstream>
+#include <algorithm>
+
+KeysetPage::KeysetPage(std::vector<ListField> fields, std::vector<SortKey> sortKeys)
+    : fields_(std::move(fields)), sortKeys_(std::move(sortKeys)), limit_(0) {
+    for (const auto& field : fields_) {
+        selected_.push_back(&field);
+    }
+}
+
+bool KeysetPage::parse(const std::map<std::string, std::string>& params, std::string& error) {
+    auto it = params.find("limit");
+    if (it != params.end() && !it->second.empty()) {
+        try {
+            limit_ = std::stoi(it->second);
+        } catch (...) {
+            error = "limit参数无效";
+            return false;
+        }
+        if (limit_ < 1) {
+            error = "limit参数无效";
+            return false;
+        }
+        limit_ = std::min(limit_, kMaxLimit);
+    }
+
+    it = params.find("fields");
+    if (it != params.end() && !it->second.empty()) {
+        selected_.clear();
+        std::istringstream iss(it->second);
+        std::string name;
+        while (std::getline(iss, name, ',')) {
+            if (name.empty()) continue;
+            auto field = std::find_if(fields_.begin(), fields_.end(),
+                                      [&name](const ListField& f) { return f.name == name; });
+            if (field == fields_.end()) {
+                error = "未知字段: " + name;
+                return false;
+            }
+            if (std::find(selected_.begin(), selected_.end(), &*field) == selected_.end()) {
+                selected_.push_back(&*field);
+            }
+        }
+        if (selected_.empty()) {
+            error = "fields参数无效";
+            return false;
+        }
+    }
+
+    it = params.find("cursor");
+    if (it != params.end() && !it->second.empty()) {
+        if (!decodeCursor(it->second, cursorValues_) || cursorValues_.size() != sortKeys_.size()) {
+            error = "cursor参数无效";
+            return false;
+        }
+        for (size_t i = 0; i < sortKeys_.size(); i++) {
+            if (!sortKeys_[i].numeric) continue;
+            const std::string& v = cursorValues_[i];
+            // 可选的负号后至少一位数字（只有 "-" 也会拼进SQL）
+            size_t start = !v.empty() && v[0] == '-' ? 1 : 0;
+            bool digits = v.size() > start && std::all_of(v.begin() + start, v.end(), ::isdigit);
+            if (!digits) {
+                error = "cursor参数无效";
+                return false;
+            }
+        }
+        if (limit_ == 0) limit_ = kDefaultLimit;
+    }
+    return true;
+}
+
+std::string KeysetPage::selectList() const {
+    std::string sql;
+    auto add = [&sql](const std::string& expr, const std::string& name) {
+        if (!sql.empty()) sql += ", ";
+        sql += expr + " AS `" + name + "`";
+    };
+
+    for (const auto* field : selected_) {
+        add(field->expr, field->name);
+    }
+    for (const auto& key : sortKeys_) {
+        bool present = std::any_of(selected_.begin(), selected_.end(),
+                                   [&key](const ListField* f) { return f->name == key.name; });
+        if (!present) add(key.expr, key.name);
+    }
+    return sql;
+}
+
+std::string KeysetPage::cursorCondition() const {
+    if (cursorValues_.empty()) return "";
+
+    auto& db = Database::getInstance();
+    std::vector<std::string> literals;
+    for (size_t i = 0; i < sortKeys_.size(); i++) {
+        literals.push_back(sortKeys_[i].numeric ? cursorValues_[i] : "'" + db.escape(cursorValues_[i]) + "'");
+    }
+
+    // 展开成 (k1 > v1) OR (k1 = v1 AND k2 > v2) OR ...，支持各列排序方向不同
+    std::string sql = " AND (";
+    for (size_t i = 0; i < sortKeys_.size(); i++) {
+        if (i > 0) sql += " OR ";
+        sql += "(";
+        for (size_t j = 0; j < i; j++) {
+            sql += sortKeys_[j].expr + " = " + literals[j] + " AND ";
+        }
+        sql += sortKeys_[i].expr + (sortKeys_[i].desc ? " < " : " > ") + literals[i] + ")";
+    }
+    sql += ")";
+    return sql;
+}
+
+std::string KeysetPage::orderAndLimit() const {
+    std::string sql = " ORDER BY ";
+    for (size_t i = 0; i < sortKeys_.size(); i++) {
+        if (i > 0) sql += ", ";
+        sql += sortKeys_[i].expr + (sortKeys_[i].desc ? " DESC" : " ASC");
+    }
+    // 多取一行用于判断是否还有下一页
+    if (limit_ > 0) sql += " LIMIT " + std::to_string(limit_ + 1);
+    return sql;
+}
+
+std::string KeysetPage::toJson(const std::vector<std::map<std::string, std::string>>& rows,
+                               std::string& nextCursor) const {
+    nextCursor.clear();
+    size_t count = limit_ > 0 ? std::min(rows.size(), static_cast<size_t>(limit_)) : rows.size();
+
+    std::vector<std::string> items;
+    items.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        std::map<std::string, std::string> projected;
+        for (const auto* field : selected_) {
+            auto it = rows[i].find(field->name);
+            projected[field->name] = it != rows[i].end() ? it->second : "";
+        }
+        items.push_back(Json::fromDbRow(projected));
+    }
+
+    if (rows.size() > count && count > 0) {
+        std::vector<std::string> values;
+        for (const auto& key : sortKeys_) {
+            auto it = rows[count - 1].find(key.name);
+            values.push_back(it != rows[count - 1].end() ? it->second : "");
+        }
+        nextCursor = encodeCursor(values);
+    }
+    return Json::array(items);
+}
+
+// 游标为排序键值以\x1f连接后的十六进制串
+std::string KeysetPage::encodeCursor(const std::vector<std::string>& values) {
+    static const char* hex = "0123456789abcdef";
+    std::string raw;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (i > 0) raw.push_back('\x1f');
+        raw += values[i];
+    }
+
+    std::string out;
+    out.reserve(raw.size() * 2);
+    for (unsigned char c : raw) {
+        out.push_back(hex[c >> 4]);
+        out.push_back(hex[c & 0x0f]);
+    }
+    return out;
+}
+
+bool KeysetPage::decodeCursor(const std::string& cursor, std::vector<std::string>& values) {
+    auto val = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    if (cursor.size() % 2 != 0) return false;
+
+    values.clear();
+    values.emplace_back();
+    for (size_t i = 0; i < cursor.size(); i += 2) {
+        int hi = val(cursor[i]), lo = val(cursor[i + 1]);
+        if (hi < 0 || lo < 0) return false;
+        char c = static_cast<char>((hi << 4) | lo);
+        if (c == '\x1f') {
+            values.emplace_back();
+        } else {
+            values.back().push_back(c);
+        }
+    }
+    return true;
+}
@@ -0,0 +1,274 @@
+#include "password_hasher.hpp"
+#include <cstring>
+#include <random>
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+// ========== Sha256 ==========
+namespace {
+
+const uint32_t kRoundConstants[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+inline uint32_t rotr(uint32_t x, int n) {
+    return (x >> n) | (x << (32 - n));
+}
+
+} // namespace
+
+Sha256::Sha256() : totalLen_(0), bufferLen_(0) {
+    state_[0] = 0x6a09e667; state_[1] = 0xbb67ae85;
+    state_[2] = 0x3c6ef372; state_[3] = 0xa54ff53a;
+    state_[4] = 0x510e527f; state_[5] = 0x9b05688c;
+    state_[6] = 0x1f83d9ab; state_[7] = 0x5be0cd19;
+}
+
+void Sha256::transform(const uint8_t* block) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++) {
+        w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+               (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+    }
+    for (int i = 16; i < 64; i++) {
+        uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state_[0], b = state_[1], c = state_[2], d = state_[3];
+    uint32_t e = state_[4], f = state_[5], g = state_[6], h = state_[7];
+
+    for (int i = 0; i < 64; i++) {
+        uint32_t S1 = rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25);
+        uint32_t ch = (e & f) ^ (~e & g);
+        uint32_t t1 = h + S1 + ch + kRoundConstants[i] + w[i];
+        uint32_t S0 = rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22);
+        uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+        uint32_t t2 = S0 + maj;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+
+    state_[0] += a; state_[1] += b; state_[2] += c; state_[3] += d;
+    state_[4] += e; state_[5] += f; state_[6] += g; state_[7] += h;
+}
+
+void Sha256::update(const void* data, size_t len) {
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    totalLen_ += len;
+
+    if (bufferLen_ > 0) {
+        size_t n = std::min(len, kBlockSize - bufferLen_);
+        std::memcpy(buffer_ + bufferLen_, p, n);
+        bufferLen_ += n;
+        p += n;
+        len -= n;
+        if (bufferLen_ == kBlockSize) {
+            transform(buffer_);
+            bufferLen_ = 0;
+        }
+    }
+    while (len >= kBlockSize) {
+        transform(p);
+        p += kBlockSize;
+        len -= kBlockSize;
+    }
+    if (len > 0) {
+        std::memcpy(buffer_, p, len);
+        bufferLen_ = len;
+    }
+}
+
+Sha256::Digest Sha256::finish() {
+    uint64_t bitLen = totalLen_ * 8;
+    uint8_t pad = 0x80;
+    update(&pad, 1);
+    uint8_t zero = 0;
+    while (bufferLen_ != 56) {
+        update(&zero, 1);
+    }
+    uint8_t lenBytes[8];
+    for (int i = 0; i < 8; i++) {
+        lenBytes[i] = static_cast<uint8_t>(bitLen >> (56 - i * 8));
+    }
+    update(lenBytes, 8);
+
+    Digest digest;
+    for (int i = 0; i < 8; i++) {
+        digest[i * 4] = static_cast<uint8_t>(state_[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(state_[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(state_[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(state_[i]);
+    }
+    return digest;
+}
+
+Sha256::Digest Sha256::hash(const std::string& data) {
+    Sha256 sha;
+    sha.update(data.data(), data.size());
+    return sha.finish();
+}
+
+// ========== HmacSha256 ==========
+HmacSha256::HmacSha256(const std::string& key) {
+    uint8_t block[Sha256::kBlockSize] = {0};
+    if (key.size() > Sha256::kBlockSize) {
+        auto d = Sha256::hash(key);
+        std::memcpy(block, d.data(), d.size());
+    } else {
+        std::memcpy(block, key.data(), key.size());
+    }
+
+    uint8_t ipad[Sha256::kBlockSize];
+    uint8_t opad[Sha256::kBlockSize];
+    for (size_t i = 0; i < Sha256::kBlockSize; i++) {
+        ipad[i] = block[i] ^ 0x36;
+        opad[i] = block[i] ^ 0x5c;
+    }
+    inner_.update(ipad, sizeof(ipad));
+    outer_.update(opad, sizeof(opad));
+}
+
+Sha256::Digest HmacSha256::compute(const void* data, size_t len) const {
+    Sha256 inner = inner_;
+    inner.update(data, len);
+    auto innerDigest = inner.finish();
+
+    Sha256 outer = outer_;
+    outer.update(innerDigest.data(), innerDigest.size());
+    return outer.finish();
+}
+
+// ========== PasswordHasher ==========
+std::string PasswordHasher::toHex(const uint8_t* data, size_t len) {
+    static const char* hex = "0123456789abcdef";
+    std::string out;
+    out.reserve(len * 2);
+    for (size_t i = 0; i < len; i++) {
+        out.push_back(hex[data[i] >> 4]);
+        out.push_back(hex[data[i] & 0x0f]);
+    }
+    return out;
+}
+
+std::string PasswordHasher::fromHex(const std::string& hex) {
+    auto val = [](char c) -> int {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+    if (hex.size() % 2 != 0) return "";
+
+    std::string out;
+    out.reserve(hex.size() / 2);
+    for (size_t i = 0; i < hex.size(); i += 2) {
+        int hi = val(hex[i]), lo = val(hex[i + 1]);
+        if (hi < 0 || lo < 0) return "";
+        out.push_back(static_cast<char>((hi << 4) | lo));
+    }
+    return out;
+}
+
+std::string PasswordHasher::randomBytes(size_t len) {
+    thread_local std::random_device rd;
+    std::string out;
+    out.reserve(len);
+    while (out.size() < len) {
+        uint32_t r = rd();
+        for (int i = 0; i < 4 && out.size() < len; i++) {
+            out.push_back(static_cast<char>(r >> (i * 8)));
+        }
+    }
+    return out;
+}
+
+bool PasswordHasher::constantTimeEquals(const std::string& a, const std::string& b) {
+    if (a.size() != b.size()) return false;
+    unsigned char diff = 0;
+    for (size_t i = 0; i < a.size(); i++) {
+        diff |= static_cast<unsigned char>(a[i] ^ b[i]);
+    }
+    return diff == 0;
+}
+
+// 只需要一个输出块（32字节）
+Sha256::Digest PasswordHasher::pbkdf2(const std::string& password, const std::string& salt, int iterations) {
+    HmacSha256 prf(password);
+
+    std::string first = salt;
+    first.append("\x00\x00\x00\x01", 4);
+    Sha256::Digest u = prf.compute(first.data(), first.size());
+    Sha256::Digest t = u;
+
+    for (int i = 1; i < iterations; i++) {
+        u = prf.compute(u.data(), u.size());
+        for (size_t j = 0; j < t.size(); j++) {
+            t[j] ^= u[j];
+        }
+    }
+    return t;
+}
+
+std::string PasswordHasher::hash(const std::string& password, int iterations) {
+    if (iterations < 1) iterations = kDefaultIterations;
+    std::string salt = randomBytes(16);
+    auto dk = pbkdf2(password, salt, iterations);
+
+    return "pbkdf2_sha256$" + std::to_string(iterations) + "$" +
+           toHex(reinterpret_cast<const uint8_t*>(salt.data()), salt.size()) + "$" +
+           toHex(dk.data(), dk.size());
+}
+
+bool PasswordHasher::verify(const std::string& password, const std::string& stored,
+                            int expectedIterations, bool& needsRehash) {
+    needsRehash = false;
+
+    // 旧格式：SHA2(password, 256) 的hex
+    if (stored.size() == 64 && stored.find('$') == std::string::npos) {
+        auto d = Sha256::hash(password);
+        std::string actual = toHex(d.data(), d.size());
+        std::string expected = stored;
+        for (auto& c : expected) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (!constantTimeEquals(actual, expected)) return false;
+        needsRehash = true;
+        return true;
+    }
+
+    std::vector<std::string> parts;
+    std::istringstream iss(stored);
+    std::string part;
+    while (std::getline(iss, part, '$')) {
+        parts.push_back(part);
+    }
+    if (parts.size() != 4 || parts[0] != "pbkdf2_sha256") return false;
+
+    int iterations = 0;
+    try {
+        iterations = std::stoi(parts[1]);
+    } catch (...) {
+        return false;
+    }
+    if (iterations < 1) return false;
+
+    std::string salt = fromHex(parts[2]);
+    std::string expected = fromHex(parts[3]);
+    if (salt.empty() || expected.size() != Sha256::kDigestSize) return false;
+
+    auto dk = pbkdf2(password, salt, iterations);
+    std::string actual(reinterpret_cast<const char*>(dk.data()), dk.size());
+    if (!constantTimeEquals(actual, expected)) return false;
+
+    needsRehash = iterations != expectedIterations;
+    return true;
+}
@@ -0,0 +1,541 @@
+#include "push_hub.hpp"
+#include "websocket.hpp"
+#include "logger.hpp"
+#include <sstream>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr int kMaxEvents = 256;
+constexpr size_t kMaxTopics = 16;               // 每个订阅者最多订阅的主题数
+constexpr size_t kIdleBufferCapacity = 4096;    // 发完后超过此容量的发送缓冲释放掉，空闲订阅者保持小内存
+
+// 一条 SSE 事件；data 中的换行拆成多行 data
+std::string formatEvent(uint64_t id, const std::string& topic, const std::string& data) {
+    std::string frame = "id: " + std::to_string(id) + "\nevent: " + topic + "\n";
+    size_t pos = 0;
+    while (true) {
+        size_t end = data.find('\n', pos);
+        frame += "data: ";
+        frame.append(data, pos, end == std::string::npos ? std::string::npos : end - pos);
+        frame += "\n";
+        if (end == std::string::npos) break;
+        pos = end + 1;
+    }
+    frame += "\n";
+    return frame;
+}
+
+// WebSocket 文本帧的负载：data 本身是 JSON，原样嵌入
+std::string formatMessage(uint64_t id, const std::string& topic, const std::string& data) {
+    return "{\"topic\": \"" + topic + "\", \"id\": " + std::to_string(id) + ", \"data\": " + data + "}";
+}
+
+} // namespace
+
+PushHub& PushHub::getInstance() {
+    static PushHub instance;
+    return instance;
+}
+
+PushHub::~PushHub() {
+    stop();
+}
+
+bool PushHub::start() {
+    if (running_) return true;
+    // 每个订阅者占一个文件描述符，默认的软限制（常见为 1024）容纳不了几千个订阅者
+    rlimit limit{};
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        if (setrlimit(RLIMIT_NOFILE, &limit) == 0) {
+            LOG_INFO("文件描述符上限提高到 %llu", static_cast<unsigned long long>(limit.rlim_cur));
+        }
+    }
+
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd_ < 0 || wakeFd_ < 0) {
+        LOG_ERROR("推送线程初始化失败: %s", strerror(errno));
+        if (epollFd_ >= 0) close(epollFd_);
+        if (wakeFd_ >= 0) close(wakeFd_);
+        epollFd_ = wakeFd_ = -1;
+        return false;
+    }
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+
+    nextHeartbeat_ = Clock::now() + options_.heartbeat;
+    running_ = true;
+    thread_ = std::thread(&PushHub::run, this);
+    return true;
+}
+
+void PushHub::stop() {
+    if (!running_.exchange(false)) return;
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+    if (thread_.joinable()) thread_.join();
+
+    for (const auto& [fd, subscriber] : subscribers_) close(fd);
+    subscribers_.clear();
+    topics_.clear();
+    for (const auto& adoption : adoptions_) close(adoption.fd);
+    adoptions_.clear();
+    events_.clear();
+    subscriberCount_ = 0;
+    webSocketCount_ = 0;
+    close(epollFd_);
+    close(wakeFd_);
+    epollFd_ = wakeFd_ = -1;
+}
+
+bool PushHub::admit(HttpResponse& res) {
+    if (running_ && subscriberCount_ < options_.maxSubscribers) return true;
+    rejected_++;
+    res.setStatus(503);
+    res.headers["Retry-After"] = "5";
+    res.setJson("{\"error\": \"推送连接已满，请稍后重试\"}");
+    return false;
+}
+
+void PushHub::acceptEventStream(HttpResponse& res, std::vector<std::string> topics) {
+    if (!admit(res)) return;
+    if (topics.size() > kMaxTopics) topics.resize(kMaxTopics);
+    res.statusCode = 200;
+    res.headers["Content-Type"] = "text/event-stream; charset=utf-8";
+    res.headers["Cache-Control"] = "no-cache";
+    res.headers["X-Accel-Buffering"] = "no";        // 经 nginx 反向代理时不缓冲
+    res.takeover = [this, topics = std::move(topics)](int fd, std::string unsent, std::string) mutable {
+        // 断线重连的间隔，随第一段数据发出
+        unsent += "retry: 3000\n\n";
+        adopt({fd, Protocol::EventStream, false, std::move(unsent), "", std::move(topics)});
+    };
+}
+
+void PushHub::acceptWebSocket(const HttpRequest& req, HttpResponse& res, std::vector<std::string> topics,
+                              bool binary) {
+    if (!WebSocket::isUpgrade(req)) {
+        res.setStatus(426);
+        res.headers["Upgrade"] = "websocket";
+        res.headers["Sec-WebSocket-Version"] = "13";
+        res.setJson("{\"error\": \"需要 WebSocket 升级请求\"}");
+        return;
+    }
+    if (!admit(res)) return;
+    if (topics.size() > kMaxTopics) topics.resize(kMaxTopics);
+    res.statusCode = 101;
+    res.headers["Upgrade"] = "websocket";
+    res.headers["Connection"] = "Upgrade";
+    res.headers["Sec-WebSocket-Accept"] = WebSocket::acceptKey(req.header("Sec-WebSocket-Key"));
+    // 客户端可能不等 101 就发出第一帧，连同交出时已读到的字节一起交给推送线程解析
+    res.takeover = [this, binary, topics = std::move(topics)](int fd, std::string unsent,
+                                                              std::string received) mutable {
+        adopt({fd, Protocol::WebSocket, binary, std::move(unsent), std::move(received), std::move(topics)});
+    };
+}
+
+void PushHub::adopt(Adoption adoption) {
+    int fd = adoption.fd;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (running_) {
+            if (adoption.protocol == Protocol::WebSocket) webSocketCount_++;
+            adoptions_.push_back(std::move(adoption));
+            subscriberCount_++;
+            accepted_++;
+            fd = -1;
+        }
+    }
+    if (fd >= 0) {
+        close(fd);
+        return;
+    }
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void PushHub::publish(const std::string& topic, const std::string& data, const std::string& binary,
+                      const std::string& key) {
+    if (!running_) return;
+    published_++;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        events_.push_back({topic, data, binary, key.empty() ? topic : key});
+        // 推送线程还没取走上一批时已经唤醒过
+        if (events_.size() > 1) return;
+    }
+    uint64_t one = 1;
+    ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+    (void)ignored;
+}
+
+void PushHub::run() {
+    epoll_event events[kMaxEvents];
+    while (running_) {
+        auto now = Clock::now();
+        int timeout = static_cast<int>(std::max<int64_t>(0,
+            std::chrono::duration_cast<std::chrono::milliseconds>(nextHeartbeat_ - now).count() + 1));
+        int n = epoll_wait(epollFd_, events, kMaxEvents, timeout);
+        if (n < 0 && errno != EINTR) {
+            LOG_ERROR("推送线程 epoll_wait 失败: %s", strerror(errno));
+            break;
+        }
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd_) {
+                uint64_t count;
+                ssize_t ignored = read(wakeFd_, &count, sizeof(count));
+                (void)ignored;
+                continue;
+            }
+            auto it = subscribers_.find(fd);
+            if (it == subscribers_.end()) continue;
+            uint32_t ev = events[i].events;
+            if (ev & (EPOLLERR | EPOLLHUP)) {
+                remove(fd);
+                continue;
+            }
+            if ((ev & (EPOLLIN | EPOLLRDHUP)) && !onReadable(*it->second)) {
+                remove(fd);
+                continue;
+            }
+            if ((ev & EPOLLOUT) && !flush(*it->second)) remove(fd);
+        }
+
+        takeInbound();
+        for (int fd : dirty_) {
+            auto it = subscribers_.find(fd);
+            if (it != subscribers_.end() && !it->second->writing && !flush(*it->second)) remove(fd);
+        }
+        dirty_.clear();
+
+        now = Clock::now();
+        if (now >= nextHeartbeat_) {
+            heartbeat(now);
+            nextHeartbeat_ = now + options_.heartbeat;
+        }
+    }
+}
+
+void PushHub::takeInbound() {
+    std::vector<Adoption> adoptions;
+    std::vector<Event> events;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        adoptions.swap(adoptions_);
+        events.swap(events_);
+    }
+
+    for (auto& adoption : adoptions) {
+        int flags = fcntl(adoption.fd, F_GETFL, 0);
+        fcntl(adoption.fd, F_SETFL, flags | O_NONBLOCK);
+        if (options_.sendBuffer > 0) {
+            setsockopt(adoption.fd, SOL_SOCKET, SO_SNDBUF, &options_.sendBuffer, sizeof(options_.sendBuffer));
+        }
+        epoll_event ev{};
+        ev.events = EPOLLIN | EPOLLRDHUP;
+        ev.data.fd = adoption.fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, adoption.fd, &ev) < 0) {
+            LOG_WARN("推送连接注册失败: %s", strerror(errno));
+            close(adoption.fd);
+            subscriberCount_--;
+            continue;
+        }
+        auto subscriber = std::make_unique<Subscriber>();
+        subscriber->fd = adoption.fd;
+        subscriber->protocol = adoption.protocol;
+        subscriber->binary = adoption.binary;
+        subscriber->topics = std::move(adoption.topics);
+        subscriber->out = std::move(adoption.unsent);
+        subscriber->lastProgress = subscriber->lastReceived = Clock::now();
+        for (const auto& topic : subscriber->topics) topics_[topic].push_back(subscriber.get());
+        dirty_.push_back(adoption.fd);
+        Subscriber& added = *subscriber;
+        subscribers_[adoption.fd] = std::move(subscriber);
+        if (added.protocol == Protocol::WebSocket && !adoption.received.empty()) {
+            added.in = std::move(adoption.received);
+            processFrames(added);
+        }
+    }
+
+    for (const auto& event : events) fanOut(event);
+}
+
+void PushHub::fanOut(const Event& event) {
+    auto exact = topics_.find(event.topic);
+    auto any = topics_.find("*");
+    bool hasExact = exact != topics_.end() && !exact->second.empty();
+    bool hasAny = any != topics_.end() && !any->second.empty();
+    if (!hasExact && !hasAny) return;
+
+    // 每种格式只在第一个需要它的订阅者处编码一次，所有订阅者共用
+    uint64_t id = ++sequence_;
+    std::string eventStream, text, binary;
+    auto deliver = [&](Subscriber& subscriber) {
+        std::string* frame;
+        if (subscriber.protocol == Protocol::EventStream) {
+            frame = &eventStream;
+            if (frame->empty()) *frame = formatEvent(id, event.topic, event.data);
+        } else if (subscriber.binary && !event.binary.empty()) {
+            frame = &binary;
+            if (frame->empty()) *frame = WebSocket::encode(WebSocket::Opcode::Binary, event.binary);
+        } else {
+            frame = &text;
+            if (frame->empty()) {
+                *frame = WebSocket::encode(WebSocket::Opcode::Text, formatMessage(id, event.topic, event.data));
+            }
+        }
+        enqueue(subscriber, event.key, *frame);
+    };
+    if (hasExact) {
+        for (Subscriber* subscriber : exact->second) deliver(*subscriber);
+    }
+    if (hasAny) {
+        for (Subscriber* subscriber : any->second) deliver(*subscriber);
+    }
+}
+
+void PushHub::enqueue(Subscriber& subscriber, const std::string& key, const std::string& frame) {
+    if (subscriber.closing) return;
+    if (subscriber.out.size() - subscriber.outPos >= options_.coalesceBytes) {
+        // 慢消费者：同一合并键只保留最新的一条
+        std::string& slot = subscriber.coalesced[key];
+        if (!slot.empty()) coalesced_++;
+        slot = frame;
+        return;
+    }
+    // 积压已降到阈值以下但还有合并中的旧事件：同一合并键的旧事件被这条取代，
+    // 否则它会在积压发完后才补发，晚于这条新事件到达
+    if (!subscriber.coalesced.empty() && subscriber.coalesced.erase(key)) coalesced_++;
+    if (subscriber.out.size() == subscriber.outPos) dirty_.push_back(subscriber.fd);
+    subscriber.out += frame;
+    delivered_++;
+}
+
+void PushHub::enqueueControl(Subscriber& subscriber, const std::string& frame) {
+    if (subscriber.out.size() == subscriber.outPos) dirty_.push_back(subscriber.fd);
+    subscriber.out += frame;
+}
+
+bool PushHub::onReadable(Subscriber& subscriber) {
+    char buffer[4096];
+    while (true) {
+        ssize_t r = recv(subscriber.fd, buffer, sizeof(buffer), 0);
+        if (r > 0) {
+            // SSE 订阅者不应再发送数据，读掉丢弃；已在关闭的 WebSocket 同样不再解析
+            if (subscriber.protocol == Protocol::WebSocket && !subscriber.closing) subscriber.in.append(buffer, r);
+            continue;
+        }
+        if (r < 0 && errno == EINTR) continue;
+        // 读到 EOF 说明客户端已断开
+        if (r == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) return false;
+        break;
+    }
+    if (!subscriber.in.empty()) processFrames(subscriber);
+    return true;
+}
+
+void PushHub::processFrames(Subscriber& subscriber) {
+    using Opcode = WebSocket::Opcode;
+    size_t pos = 0;
+    WebSocket::Frame frame;
+    while (!subscriber.closing) {
+        uint16_t closeCode = 0;
+        auto result = WebSocket::parse(subscriber.in, pos, frame, closeCode);
+        if (result == WebSocket::ParseResult::Incomplete) break;
+        if (result == WebSocket::ParseResult::Error) {
+            closeWebSocket(subscriber, closeCode);
+            break;
+        }
+        framesReceived_++;
+        subscriber.lastReceived = Clock::now();
+        switch (frame.opcode) {
+            case Opcode::Ping:
+                enqueueControl(subscriber, WebSocket::encode(Opcode::Pong, frame.payload));
+                break;
+            case Opcode::Pong:
+                break;
+            case Opcode::Close:
+                // 回送对方的关闭码完成关闭握手
+                if (frame.payload.size() >= 2) {
+                    subscriber.closing = true;
+                    subscriber.coalesced.clear();
+                    enqueueControl(subscriber, WebSocket::encode(Opcode::Close, frame.payload.substr(0, 2)));
+                } else {
+                    closeWebSocket(subscriber, WebSocket::kNormalClosure);
+                }
+                break;
+            case Opcode::Text:
+            case Opcode::Binary:
+                // 客户端不需要发消息，完整收下后丢弃；只按协议检查分片
+                if (subscriber.assembling) {
+                    closeWebSocket(subscriber, WebSocket::kProtocolError);
+                    break;
+                }
+                subscriber.assembling = !frame.fin;
+                subscriber.message = std::move(frame.payload);
+                break;
+            case Opcode::Continuation:
+                if (!subscriber.assembling) {
+                    closeWebSocket(subscriber, WebSocket::kProtocolError);
+                    break;
+                }
+                if (subscriber.message.size() + frame.payload.size() > WebSocket::kMaxMessageSize) {
+                    closeWebSocket(subscriber, WebSocket::kMessageTooBig);
+                    break;
+                }
+                subscriber.message += frame.payload;
+                subscriber.assembling = !frame.fin;
+                break;
+        }
+        if (!subscriber.assembling) subscriber.message.clear();
+    }
+    if (subscriber.closing) std::string().swap(subscriber.in);
+    else subscriber.in.erase(0, pos);
+}
+
+void PushHub::closeWebSocket(Subscriber& subscriber, uint16_t code) {
+    if (subscriber.closing) return;
+    subscriber.closing = true;
+    subscriber.coalesced.clear();
+    enqueueControl(subscriber, WebSocket::encodeClose(code));
+}
+
+bool PushHub::flush(Subscriber& subscriber) {
+    while (true) {
+        while (subscriber.outPos < subscriber.out.size()) {
+            ssize_t n = send(subscriber.fd, subscriber.out.data() + subscriber.outPos,
+                             subscriber.out.size() - subscriber.outPos, MSG_NOSIGNAL);
+            if (n > 0) {
+                subscriber.outPos += n;
+                subscriber.lastProgress = Clock::now();
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+                setWriting(subscriber, true);
+                return true;
+            }
+            return false;
+        }
+        if (subscriber.out.capacity() > kIdleBufferCapacity) std::string().swap(subscriber.out);
+        else subscriber.out.clear();
+        subscriber.outPos = 0;
+        // 关闭帧已发出：断开
+        if (subscriber.closing) return false;
+        if (subscriber.coalesced.empty()) break;
+        // 积压发完：补发合并期间各合并键的最新事件
+        for (auto& [topic, frame] : subscriber.coalesced) subscriber.out += frame;
+        delivered_ += subscriber.coalesced.size();
+        subscriber.coalesced.clear();
+    }
+    setWriting(subscriber, false);
+    return true;
+}
+
+void PushHub::setWriting(Subscriber& subscriber, bool writing) {
+    if (subscriber.writing == writing) return;
+    subscriber.writing = writing;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLRDHUP | (writing ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    ev.data.fd = subscriber.fd;
+    epoll_ctl(epollFd_, EPOLL_CTL_MOD, subscriber.fd, &ev);
+}
+
+void PushHub::heartbeat(Clock::time_point now) {
+    std::vector<int> failed;
+    for (auto& [fd, subscriber] : subscribers_) {
+        bool pending = subscriber->outPos < subscriber->out.size();
+        if (pending && now - subscriber->lastProgress > options_.stallTimeout) {
+            stalled_++;
+            failed.push_back(fd);
+            continue;
+        }
+        if (subscriber->protocol == Protocol::WebSocket) {
+            // ping 的回应（pong）也算收到帧；对端早已不在时 TCP 未必能及时发现
+            if (now - subscriber->lastReceived > options_.receiveTimeout) {
+                timedOut_++;
+                failed.push_back(fd);
+                continue;
+            }
+            if (subscriber->closing) continue;
+            // 控制帧排在积压之后，积压中的连接也发 ping，否则收不到 pong 会被误判超时
+            enqueueControl(*subscriber, WebSocket::encode(WebSocket::Opcode::Ping, ""));
+            if (!pending && !flush(*subscriber)) failed.push_back(fd);
+            continue;
+        }
+        if (pending) continue;
+        subscriber->out = ":\n\n";
+        if (!flush(*subscriber)) failed.push_back(fd);
+    }
+    for (int fd : failed) remove(fd);
+}
+
+void PushHub::remove(int fd) {
+    auto it = subscribers_.find(fd);
+    if (it == subscribers_.end()) return;
+    Subscriber* subscriber = it->second.get();
+    for (const auto& topic : subscriber->topics) {
+        auto list = topics_.find(topic);
+        if (list == topics_.end()) continue;
+        auto& subscribers = list->second;
+        auto pos = std::find(subscribers.begin(), subscribers.end(), subscriber);
+        if (pos != subscribers.end()) {
+            *pos = subscribers.back();
+            subscribers.pop_back();
+        }
+        if (subscribers.empty()) topics_.erase(list);
+    }
+    // close 会自动把 fd 移出 epoll
+    close(fd);
+    if (subscriber->protocol == Protocol::WebSocket) webSocketCount_--;
+    subscribers_.erase(it);
+    subscriberCount_--;
+}
+
+std::string PushHub::render() const {
+    std::ostringstream oss;
+    oss << "# HELP server_push_subscribers 当前的推送订阅连接数\n";
+    oss << "# TYPE server_push_subscribers gauge\n";
+    size_t webSockets = webSocketCount_.load();
+    size_t total = subscriberCount_.load();
+    oss << "server_push_subscribers{protocol=\"sse\"} " << (total > webSockets ? total - webSockets : 0) << "\n";
+    oss << "server_push_subscribers{protocol=\"websocket\"} " << webSockets << "\n";
+
+    oss << "# HELP server_push_connections_total 推送订阅连接数（按结果）\n";
+    oss << "# TYPE server_push_connections_total counter\n";
+    oss << "server_push_connections_total{result=\"accepted\"} " << accepted_.load() << "\n";
+    oss << "server_push_connections_total{result=\"rejected\"} " << rejected_.load() << "\n";
+    oss << "server_push_connections_total{result=\"stalled\"} " << stalled_.load() << "\n";
+    oss << "server_push_connections_total{result=\"timed_out\"} " << timedOut_.load() << "\n";
+
+    oss << "# HELP server_push_events_total 发布的事件数\n";
+    oss << "# TYPE server_push_events_total counter\n";
+    oss << "server_push_events_total " << published_.load() << "\n";
+
+    oss << "# HELP server_push_deliveries_total 写入订阅者发送缓冲的事件数\n";
+    oss << "# TYPE server_push_deliveries_total counter\n";
+    oss << "server_push_deliveries_total " << delivered_.load() << "\n";
+
+    oss << "# HELP server_push_coalesced_total 慢消费者积压期间被同主题新事件合并掉的事件数\n";
+    oss << "# TYPE server_push_coalesced_total counter\n";
+    oss << "server_push_coalesced_total " << coalesced_.load() << "\n";
+
+    oss << "# HELP server_push_frames_received_total 从 WebSocket 订阅者收到的帧数\n";
+    oss << "# TYPE server_push_frames_received_total counter\n";
+    oss << "server_push_frames_received_total " << framesReceived_.load() << "\n";
+    return oss.str();
+}
@@ -0,0 +1,315 @@
+#include "query_stats.hpp"
+#include "json.hpp"
+#include "logger.hpp"
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+
+namespace {
+
+const size_t kMaxSampleLength = 1000;
+
+bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$';
+}
+
+std::string micros(uint64_t nanos) {
+    return std::to_string(nanos / 1000);
+}
+
+// 把 "(?, ?, ?)" 折叠为 "(?+)"，再把连续重复的 ", (?+)" 合并（IN列表、多行VALUES）
+std::string collapseLists(const std::string& in) {
+    std::string out;
+    out.reserve(in.size());
+    size_t i = 0;
+    while (i < in.size()) {
+        if (in[i] == '(' && i + 1 < in.size() && in[i + 1] == '?') {
+            size_t j = i + 2;
+            while (in.compare(j, 3, ", ?") == 0) j += 3;
+            if (j < in.size() && in[j] == ')') {
+                out += "(?+)";
+                i = j + 1;
+                while (in.compare(i, 2, ", ") == 0 && in.compare(i + 2, 2, "(?") == 0) {
+                    size_t k = i + 4;
+                    while (in.compare(k, 3, ", ?") == 0) k += 3;
+                    if (k >= in.size() || in[k] != ')') break;
+                    i = k + 1;
+                }
+                continue;
+            }
+        }
+        out.push_back(in[i++]);
+    }
+    return out;
+}
+
+} // namespace
+
+QueryStats& QueryStats::getInstance() {
+    static QueryStats instance;
+    return instance;
+}
+
+QueryStats::QueryStats() : slowThresholdNs_(200ULL * 1000000) {}
+
+std::string QueryStats::fingerprint(const std::string& sql) {
+    std::string out;
+    out.reserve(std::min(sql.size(), static_cast<size_t>(4096)));
+
+    size_t i = 0;
+    while (i < sql.size()) {
+        char c = sql[i];
+
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) i++;
+            if (!out.empty()) out.push_back(' ');
+            continue;
+        }
+
+        // 字符串字面量
+        if (c == '\'' || c == '"') {
+            i++;
+            while (i < sql.size()) {
+                if (sql[i] == '\\') {
+                    i += 2;
+                } else if (sql[i] == c) {
+                    if (i + 1 < sql.size() && sql[i + 1] == c) {
+                        i += 2;
+                    } else {
+                        i++;
+                        break;
+                    }
+                } else {
+                    i++;
+                }
+            }
+            out.push_back('?');
+            continue;
+        }
+
+        // 反引号标识符原样保留
+        if (c == '`') {
+            size_t end = sql.find('`', i + 1);
+            end = end == std::string::npos ? sql.size() : end + 1;
+            out.append(sql, i, end - i);
+            i = end;
+            continue;
+        }
+
+        // 数字字面量（标识符中的数字除外）
+        if (std::isdigit(static_cast<unsigned char>(c)) && (out.empty() || !isIdentChar(out.back()))) {
+            while (i < sql.size() && (isIdentChar(sql[i]) || sql[i] == '.')) i++;
+            out.push_back('?');
+            continue;
+        }
+
+        // 逗号和括号两侧的空白统一，"(1,2)" 与 "( 1, 2 )" 得到同一指纹
+        if (c == ',' || c == ')') {
+            if (!out.empty() && out.back() == ' ') out.pop_back();
+            out += c == ',' ? ", " : ")";
+            i++;
+            if (c == ',') {
+                while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) i++;
+            }
+            continue;
+        }
+        if (c == '(') {
+            out.push_back('(');
+            i++;
+            while (i < sql.size() && std::isspace(static_cast<unsigned char>(sql[i]))) i++;
+            continue;
+        }
+
+        out.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+        i++;
+    }
+
+    while (!out.empty() && (out.back() == ' ' || out.back() == ';')) out.pop_back();
+    return collapseLists(out);
+}
+
+void QueryStats::setSlowThresholdMs(int ms) {
+    slowThresholdNs_.store(ms > 0 ? static_cast<uint64_t>(ms) * 1000000 : 0, std::memory_order_relaxed);
+}
+
+bool QueryStats::isSlow(const StatementTiming& timing) const {
+    uint64_t threshold = slowThresholdNs_.load(std::memory_order_relaxed);
+    return threshold > 0 && timing.totalNs() >= threshold;
+}
+
+bool QueryStats::shouldExplain(const std::string& fingerprint) {
+    // 只对查询语句EXPLAIN：写语句之后再执行EXPLAIN会覆盖 lastInsertId/affectedRows
+    static const char* explainable[] = {"select", "with"};
+    bool ok = std::any_of(std::begin(explainable), std::end(explainable), [&](const char* word) {
+        return fingerprint.compare(0, std::char_traits<char>::length(word), word) == 0;
+    });
+    if (!ok) return false;
+
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = lastExplain_.find(fingerprint);
+    if (it != lastExplain_.end() && now - it->second < 60) return false;
+    if (lastExplain_.size() >= kMaxFingerprints) lastExplain_.clear();
+    lastExplain_[fingerprint] = now;
+    return true;
+}
+
+// ========== 分桶 ==========
+int QueryStats::bucketOf(uint64_t micros) {
+    if (micros < kLinearBuckets) return static_cast<int>(micros);
+    int exponent = 63 - __builtin_clzll(micros);         // >= 4
+    int sub = static_cast<int>((micros >> (exponent - 3)) & (kSubBuckets - 1));
+    int bucket = kLinearBuckets + (exponent - 4) * kSubBuckets + sub;
+    return std::min(bucket, kBuckets - 1);
+}
+
+uint64_t QueryStats::bucketValue(int bucket) {
+    if (bucket < kLinearBuckets) return static_cast<uint64_t>(bucket);
+    int exponent = (bucket - kLinearBuckets) / kSubBuckets + 4;
+    int sub = (bucket - kLinearBuckets) % kSubBuckets;
+    // 取区间中点
+    uint64_t low = (1ULL << exponent) + (static_cast<uint64_t>(sub) << (exponent - 3));
+    return low + (1ULL << (exponent - 4));
+}
+
+uint64_t QueryStats::Entry::percentileNs(double p) const {
+    if (count == 0) return 0;
+    uint64_t target = static_cast<uint64_t>(p * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= target) return std::min(bucketValue(i) * 1000, maxNs);
+    }
+    return maxNs;
+}
+
+// ========== 记录 ==========
+void QueryStats::record(const std::string& fingerprint, const std::string& sql, const StatementTiming& timing) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(fingerprint);
+    if (it == entries_.end()) {
+        std::string key = entries_.size() < kMaxFingerprints ? fingerprint : "<other>";
+        it = entries_.try_emplace(key).first;
+        if (it->second.fingerprint.empty()) {
+            it->second.fingerprint = key;
+            it->second.sample = sql.substr(0, kMaxSampleLength);
+        }
+    }
+
+    Entry& entry = it->second;
+    uint64_t total = timing.totalNs();
+    entry.count++;
+    entry.rows += timing.rows;
+    entry.totalNs += total;
+    entry.waitNs += timing.waitNs;
+    entry.execNs += timing.execNs;
+    entry.fetchNs += timing.fetchNs;
+    entry.convertNs += timing.convertNs;
+    entry.maxNs = std::max(entry.maxNs, total);
+    entry.buckets[bucketOf(total / 1000)]++;
+}
+
+void QueryStats::recordSlow(const std::string& fingerprint, const std::string& sql, const StatementTiming& timing,
+                            const std::string& explainJson) {
+    LOG_WARN("慢查询 %llums (等待 %llums, 行数 %llu): %s",
+             static_cast<unsigned long long>(timing.totalNs() / 1000000),
+             static_cast<unsigned long long>(timing.waitNs / 1000000),
+             static_cast<unsigned long long>(timing.rows), sql.c_str());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(fingerprint);
+    if (it != entries_.end()) it->second.slowCount++;
+
+    SlowEntry entry;
+    entry.time = static_cast<int64_t>(std::time(nullptr));
+    entry.fingerprint = fingerprint;
+    entry.sql = sql.substr(0, kMaxSampleLength);
+    entry.timing = timing;
+    entry.explain = explainJson;
+    slow_.push_front(std::move(entry));
+    if (slow_.size() > kMaxSlowEntries) slow_.pop_back();
+}
+
+void QueryStats::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    slow_.clear();
+    lastExplain_.clear();
+}
+
+// ========== 查询 ==========
+std::string QueryStats::statsJson(const std::string& sort, size_t limit) const {
+    struct Item {
+        uint64_t key;
+        std::string json;
+    };
+    std::vector<Item> items;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        items.reserve(entries_.size());
+        for (const auto& [fp, entry] : entries_) {
+            uint64_t p50 = entry.percentileNs(0.50);
+            uint64_t p99 = entry.percentileNs(0.99);
+            uint64_t avg = entry.count ? entry.totalNs / entry.count : 0;
+
+            std::map<std::string, std::string> data;
+            data["fingerprint"] = Json::string(entry.fingerprint);
+            data["sample"] = Json::string(entry.sample);
+            data["count"] = std::to_string(entry.count);
+            data["slow_count"] = std::to_string(entry.slowCount);
+            data["rows"] = std::to_string(entry.rows);
+            data["total_us"] = micros(entry.totalNs);
+            data["avg_us"] = micros(avg);
+            data["p50_us"] = micros(p50);
+            data["p99_us"] = micros(p99);
+            data["max_us"] = micros(entry.maxNs);
+            data["wait_us"] = micros(entry.waitNs);
+            data["exec_us"] = micros(entry.execNs);
+            data["fetch_us"] = micros(entry.fetchNs);
+            data["convert_us"] = micros(entry.convertNs);
+
+            uint64_t key = sort == "count" ? entry.count
+                         : sort == "p99" ? p99
+                         : sort == "avg" ? avg
+                         : sort == "rows" ? entry.rows
+                         : entry.totalNs;
+            items.push_back({key, Json::object(data)});
+        }
+    }
+
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) { return a.key > b.key; });
+    if (items.size() > limit) items.resize(limit);
+
+    std::vector<std::string> result;
+    result.reserve(items.size());
+    for (auto& item : items) result.push_back(std::move(item.json));
+    return Json::array(result);
+}
+
+std::string QueryStats::slowJson(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<std::string> result;
+    for (const auto& entry : slow_) {
+        if (result.size() >= limit) break;
+
+        char time[32];
+        time_t t = static_cast<time_t>(entry.time);
+        tm local{};
+        localtime_r(&t, &local);
+        strftime(time, sizeof(time), "%Y-%m-%d %H:%M:%S", &local);
+
+        std::map<std::string, std::string> data;
+        data["time"] = Json::string(time);
+        data["fingerprint"] = Json::string(entry.fingerprint);
+        data["sql"] = Json::string(entry.sql);
+        data["rows"] = std::to_string(entry.timing.rows);
+        data["total_us"] = micros(entry.timing.totalNs());
+        data["wait_us"] = micros(entry.timing.waitNs);
+        data["exec_us"] = micros(entry.timing.execNs);
+        data["fetch_us"] = micros(entry.timing.fetchNs);
+        data["convert_us"] = micros(entry.timing.convertNs);
+        data["explain"] = entry.explain.empty() ? Json::null() : entry.explain;
+        result.push_back(Json::object(data));
+    }
+    return Json::array(result);
+}
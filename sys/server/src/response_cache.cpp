@@ -0,0 +1,200 @@
+#include "response_cache.hpp"
+#include "http_server.hpp"
+#include <sstream>
+#include <algorithm>
+
+namespace {
+
+constexpr size_t kEntryOverhead = 256;          // 链表节点、哈希表节点和版本数组的估计开销
+
+} // namespace
+
+ResponseCache::Ticket& ResponseCache::Ticket::operator=(Ticket&& other) noexcept {
+    if (this != &other) {
+        if (cache_) cache_->complete(*this, Shared{});
+        cache_ = other.cache_;
+        key_ = std::move(other.key_);
+        policy_ = other.policy_;
+        versions_ = std::move(other.versions_);
+        other.cache_ = nullptr;
+    }
+    return *this;
+}
+
+ResponseCache::Ticket::~Ticket() {
+    // 计算方没有完成就被丢弃（连接关闭、排队时被放弃等）：唤醒等待者让它们自行计算
+    if (cache_) cache_->complete(*this, Shared{});
+}
+
+ResponseCache& ResponseCache::getInstance() {
+    static ResponseCache instance;
+    return instance;
+}
+
+std::string ResponseCache::makeKey(const Policy& policy, const HttpRequest& req, const std::string& variant) {
+    // 各段以 \0 结尾；查询参数经 parseQuery 按名称排序、同名参数取最后一个，与处理函数看到的参数一致
+    std::string key = policy.pattern;
+    key += '\0';
+    for (const auto& [name, value] : req.params) {
+        key += name;
+        key += '=';
+        key += value;
+        key += '\0';
+    }
+    key += '?';
+    for (const auto& [name, value] : req.parseQuery()) {
+        key += name;
+        key += '=';
+        key += value;
+        key += '\0';
+    }
+    key += '#';
+    key += variant;
+    return key;
+}
+
+std::vector<uint64_t> ResponseCache::snapshot(const Policy& policy) {
+    auto& versions = TableVersions::getInstance();
+    std::vector<uint64_t> result;
+    result.reserve(policy.tables.size());
+    for (Table table : policy.tables) result.push_back(versions.version(table));
+    return result;
+}
+
+ResponseCache::Result ResponseCache::lookup(const Policy& policy, const std::string& key, Shared& shared,
+                                            Ticket& ticket, Waiter waiter) {
+    // 计算前取版本：计算期间有写入时，存下的条目下次取用即失效
+    auto versions = snapshot(policy);
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = entries_.find(key);
+    if (it != entries_.end()) {
+        if (it->second->versions == versions) {
+            promote(it->second);
+            shared = it->second->shared;
+            hits_++;
+            return Result::Hit;
+        }
+        stale_++;
+        erase(it);
+    }
+
+    auto flight = inflight_.find(key);
+    if (flight != inflight_.end()) {
+        flight->second.push_back(std::move(waiter));
+        coalesced_++;
+        return Result::Pending;
+    }
+    inflight_[key];
+    misses_++;
+    ticket.cache_ = this;
+    ticket.key_ = key;
+    ticket.policy_ = &policy;
+    ticket.versions_ = std::move(versions);
+    return Result::Miss;
+}
+
+void ResponseCache::complete(Ticket& ticket, Shared shared) {
+    if (!ticket) return;
+    ticket.cache_ = nullptr;
+    // 计算期间所读的表有写入：结果既不缓存也不交给等待者（它们可能在写入之后才到达）
+    if (shared.buffer && snapshot(*ticket.policy_) != ticket.versions_) shared = Shared{};
+
+    std::vector<Waiter> waiters;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto flight = inflight_.find(ticket.key_);
+        if (flight != inflight_.end()) {
+            waiters.swap(flight->second);
+            inflight_.erase(flight);
+        }
+        size_t limit = std::min(options_.maxEntryBytes, options_.maxBytes);
+        if (shared.buffer && shared.buffer->size() <= limit) {
+            size_t bytes = shared.buffer->size() + ticket.key_.size() * 2 + shared.etag.size() +
+                           shared.cacheControl.size() + kEntryOverhead;
+            insert(Entry{ticket.key_, shared, std::move(ticket.versions_), bytes});
+            stores_++;
+        }
+    }
+    for (const auto& waiter : waiters) waiter(shared);
+}
+
+void ResponseCache::insert(Entry entry) {
+    auto existing = entries_.find(entry.key);
+    if (existing != entries_.end()) erase(existing);
+
+    bytes_ += entry.bytes;
+    probation_.push_front(std::move(entry));
+    entries_[probation_.front().key] = probation_.begin();
+    // 先淘汰试用段最久未用的，试用段空了才动保护段
+    while (bytes_ > options_.maxBytes && entries_.size() > 1) {
+        EntryList& victims = probation_.size() > 1 || protected_.empty() ? probation_ : protected_;
+        erase(entries_.find(victims.back().key));
+        evictions_++;
+    }
+}
+
+void ResponseCache::erase(std::unordered_map<std::string, EntryList::iterator>::iterator it) {
+    EntryList::iterator entry = it->second;
+    bytes_ -= entry->bytes;
+    if (entry->isProtected) {
+        protectedBytes_ -= entry->bytes;
+        protected_.erase(entry);
+    } else {
+        probation_.erase(entry);
+    }
+    entries_.erase(it);
+}
+
+void ResponseCache::promote(EntryList::iterator it) {
+    if (it->isProtected) {
+        protected_.splice(protected_.begin(), protected_, it);
+        return;
+    }
+    // 试用段里再次命中：移入保护段；保护段超出份额时把最久未用的降回试用段
+    protected_.splice(protected_.begin(), probation_, it);
+    it->isProtected = true;
+    protectedBytes_ += it->bytes;
+    size_t protectedLimit = options_.maxBytes / 5 * 4;
+    while (protectedBytes_ > protectedLimit && protected_.size() > 1) {
+        auto demoted = std::prev(protected_.end());
+        demoted->isProtected = false;
+        protectedBytes_ -= demoted->bytes;
+        probation_.splice(probation_.begin(), protected_, demoted);
+    }
+}
+
+std::string ResponseCache::render() const {
+    size_t entries, bytes;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        entries = entries_.size();
+        bytes = bytes_;
+    }
+    std::ostringstream oss;
+    oss << "# HELP server_response_cache_requests_total 启用缓存的路由上的请求数（按结果）\n";
+    oss << "# TYPE server_response_cache_requests_total counter\n";
+    oss << "server_response_cache_requests_total{result=\"hit\"} " << hits_.load() << "\n";
+    oss << "server_response_cache_requests_total{result=\"miss\"} " << misses_.load() << "\n";
+    oss << "server_response_cache_requests_total{result=\"coalesced\"} " << coalesced_.load() << "\n";
+
+    oss << "# HELP server_response_cache_stale_total 因所读表的版本变化而失效的条目数\n";
+    oss << "# TYPE server_response_cache_stale_total counter\n";
+    oss << "server_response_cache_stale_total " << stale_.load() << "\n";
+
+    oss << "# HELP server_response_cache_stores_total 存入的条目数\n";
+    oss << "# TYPE server_response_cache_stores_total counter\n";
+    oss << "server_response_cache_stores_total " << stores_.load() << "\n";
+
+    oss << "# HELP server_response_cache_evictions_total 因超出内存上限淘汰的条目数\n";
+    oss << "# TYPE server_response_cache_evictions_total counter\n";
+    oss << "server_response_cache_evictions_total " << evictions_.load() << "\n";
+
+    oss << "# HELP server_response_cache_entries 当前的缓存条目数\n";
+    oss << "# TYPE server_response_cache_entries gauge\n";
+    oss << "server_response_cache_entries " << entries << "\n";
+
+    oss << "# HELP server_response_cache_bytes 缓存条目占用的内存（估计）\n";
+    oss << "# TYPE server_response_cache_bytes gauge\n";
+    oss << "server_response_cache_bytes " << bytes << "\n";
+    return oss.str();
+}
@@ -0,0 +1,442 @@
+#include "schedule_import.hpp"
+#include "db.hpp"
+#include "json.hpp"
+#include "csv.hpp"
+#include "logger.hpp"
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <bitset>
+#include <charconv>
+#include <map>
+#include <mutex>
+#include <set>
+
+namespace {
+
+using Fields = std::map<std::string, std::string>;
+
+constexpr int kMaxWeeks = 30;
+constexpr int kWeekdays = 7;
+constexpr int kSections = 12;
+
+// 一个学期内某教室/教师/班级的占用：位 (week-1)*84 + (weekday-1)*12 + (section-1)
+using SlotMask = std::bitset<kMaxWeeks * kWeekdays * kSections>;
+
+struct Occupant {
+    int scheduleId;     // 已有排课
+    int line;           // 本批条目
+    int weekday, startSection, endSection, startWeek, endWeek;
+    char weekType;      // a / o / e
+};
+
+struct Occupancy {
+    SlotMask mask;
+    std::vector<Occupant> occupants;
+};
+
+// 同时只允许一批导入，保证两批之间的冲突检测基于最新数据
+std::mutex importMutex;
+
+bool toInt(const std::string& text, int& value) {
+    const char* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    return ec == std::errc() && ptr == end;
+}
+
+char weekTypeCode(const std::string& weekType) {
+    return weekType == "odd" ? 'o' : weekType == "even" ? 'e' : 'a';
+}
+
+// 已有数据的周次和节次可能超出位图范围，截断到有效区间
+SlotMask buildMask(int weekday, int startSection, int endSection, int startWeek, int endWeek, char weekType) {
+    SlotMask mask;
+    if (weekday < 1 || weekday > kWeekdays) return mask;
+    int firstSection = std::max(1, startSection);
+    int lastSection = std::min(kSections, endSection);
+    for (int week = std::max(1, startWeek); week <= std::min(kMaxWeeks, endWeek); week++) {
+        if (weekType == 'o' && week % 2 == 0) continue;
+        if (weekType == 'e' && week % 2 == 1) continue;
+        size_t base = (week - 1) * kWeekdays * kSections + (weekday - 1) * kSections;
+        for (int section = firstSection; section <= lastSection; section++) {
+            mask.set(base + section - 1);
+        }
+    }
+    return mask;
+}
+
+// 位图命中后再逐个找出具体冲突对象
+bool overlaps(const Occupant& a, const Occupant& b) {
+    if (a.weekday != b.weekday) return false;
+    if (a.endSection < b.startSection || a.startSection > b.endSection) return false;
+    int first = std::max(a.startWeek, b.startWeek);
+    int last = std::min(a.endWeek, b.endWeek);
+    if (first > last) return false;
+    if (a.weekType != 'a' && b.weekType != 'a') return a.weekType == b.weekType;
+    // 至多一方限定单双周：区间超过一周必有符合的周，否则看唯一的那一周
+    char parity = a.weekType != 'a' ? a.weekType : b.weekType;
+    if (parity == 'a' || first < last) return true;
+    return (first % 2 == 1) == (parity == 'o');
+}
+
+std::string occupancyKey(const std::string& semester, char resource, int id) {
+    std::string key = semester;
+    key += '\x1f';
+    key += resource;
+    key += std::to_string(id);
+    return key;
+}
+
+void validate(ScheduleImportLine& line, const Fields& fields) {
+    auto get = [&fields](const char* name) -> const std::string& {
+        static const std::string empty;
+        auto it = fields.find(name);
+        return it == fields.end() ? empty : it->second;
+    };
+    auto number = [&](const char* name, int& value, bool required) {
+        const std::string& text = get(name);
+        if (text.empty() && !required) return true;
+        if (toInt(text, value)) return true;
+        if (line.error.empty()) line.error = std::string(name) + (text.empty() ? " 缺失" : " 不是整数");
+        return false;
+    };
+
+    number("course_id", line.courseId, true);
+    number("classroom_id", line.classroomId, true);
+    number("teacher_id", line.teacherId, true);
+    number("class_id", line.classId, false);
+    number("weekday", line.weekday, true);
+    number("start_section", line.startSection, true);
+    number("end_section", line.endSection, true);
+    number("start_week", line.startWeek, true);
+    number("end_week", line.endWeek, true);
+    line.semester = get("semester");
+    line.remark = get("remark");
+    if (!get("week_type").empty()) line.weekType = get("week_type");
+
+    if (!line.error.empty()) {
+        line.status = "invalid";
+        return;
+    }
+    if (line.semester.empty() || line.semester.size() > 20) {
+        line.error = "semester 为空或过长";
+    } else if (line.weekday < 1 || line.weekday > kWeekdays) {
+        line.error = "weekday 必须为 1-7";
+    } else if (line.startSection < 1 || line.endSection > kSections || line.startSection > line.endSection) {
+        line.error = "节次必须在 1-12 之间且开始不晚于结束";
+    } else if (line.startWeek < 1 || line.endWeek > kMaxWeeks || line.startWeek > line.endWeek) {
+        line.error = "周次必须在 1-30 之间且开始不晚于结束";
+    } else if (line.weekType != "all" && line.weekType != "odd" && line.weekType != "even") {
+        line.error = "week_type 必须为 all/odd/even";
+    } else if (line.weekType != "all" && line.startWeek == line.endWeek &&
+               (line.startWeek % 2 == 1) != (line.weekType == "odd")) {
+        line.error = "周次范围内没有符合单双周的周";
+    }
+    if (!line.error.empty()) line.status = "invalid";
+}
+
+// 解析JSON数组中的扁平对象，值为字符串、数字、布尔或 null
+bool parseJson(const std::string& body, std::vector<ScheduleImportLine>& lines) {
+    size_t pos = body.find_first_not_of(" \t\r\n");
+    if (pos == std::string::npos) return false;
+    if (body[pos] == '{') {
+        size_t key = body.find("\"schedules\"", pos);
+        if (key == std::string::npos) return false;
+        pos = body.find_first_not_of(" \t\r\n", body.find(':', key) + 1);
+    }
+    if (pos == std::string::npos || body[pos] != '[') return false;
+
+    auto skip = [&body](size_t p) { return body.find_first_not_of(" \t\r\n", p); };
+    pos = skip(pos + 1);
+    int index = 0;
+    while (pos != std::string::npos && body[pos] != ']') {
+        if (body[pos] != '{') return false;
+        Fields fields;
+        pos = skip(pos + 1);
+        while (pos != std::string::npos && body[pos] != '}') {
+            std::string key, value;
+            pos = Json::readString(body, pos, key);
+            if (pos == std::string::npos) return false;
+            pos = skip(pos);
+            if (pos == std::string::npos || body[pos] != ':') return false;
+            pos = skip(pos + 1);
+            if (pos == std::string::npos) return false;
+            if (body[pos] == '"') {
+                pos = Json::readString(body, pos, value);
+                if (pos == std::string::npos) return false;
+            } else {
+                size_t end = body.find_first_of(",}", pos);
+                if (end == std::string::npos) return false;
+                value = body.substr(pos, end - pos);
+                value.erase(value.find_last_not_of(" \t\r\n") + 1);
+                if (value == "null") value.clear();
+                if (!value.empty() && (value.front() == '{' || value.front() == '[')) return false;
+                pos = end;
+            }
+            fields[std::move(key)] = std::move(value);
+            pos = skip(pos);
+            if (pos != std::string::npos && body[pos] == ',') pos = skip(pos + 1);
+        }
+        if (pos == std::string::npos) return false;
+
+        ScheduleImportLine line;
+        line.line = ++index;
+        validate(line, fields);
+        lines.push_back(std::move(line));
+
+        pos = skip(pos + 1);
+        if (pos != std::string::npos && body[pos] == ',') pos = skip(pos + 1);
+    }
+    return pos != std::string::npos;
+}
+
+// 首个非空行为表头，给出各列字段名
+bool parseCsv(std::string_view csv, std::vector<ScheduleImportLine>& lines) {
+    std::vector<std::string> header;
+    size_t pos = 0;
+    int lineNo = 0;
+    while (pos < csv.size()) {
+        size_t end = csv.find('\n', pos);
+        if (end == std::string_view::npos) end = csv.size();
+        std::string_view text = Csv::trim(csv.substr(pos, end - pos));
+        pos = end + 1;
+        lineNo++;
+        if (text.empty()) continue;
+
+        auto values = Csv::splitLine(text);
+        if (header.empty()) {
+            header = std::move(values);
+            if (std::find(header.begin(), header.end(), "course_id") == header.end()) return false;
+            continue;
+        }
+        Fields fields;
+        for (size_t i = 0; i < header.size() && i < values.size(); i++) {
+            fields[header[i]] = std::move(values[i]);
+        }
+        ScheduleImportLine line;
+        line.line = lineNo;
+        validate(line, fields);
+        lines.push_back(std::move(line));
+    }
+    return !header.empty();
+}
+
+// 返回 ids 中在 table 里存在的部分
+std::unordered_set<int> existingIds(Database& db, const char* table, const std::set<int>& ids) {
+    std::unordered_set<int> found;
+    std::vector<int> list(ids.begin(), ids.end());
+    for (size_t begin = 0; begin < list.size(); begin += ScheduleImport::kBatchSize) {
+        size_t end = std::min(begin + ScheduleImport::kBatchSize, list.size());
+        std::string sql = std::string("SELECT id FROM ") + table + " WHERE id IN (";
+        for (size_t i = begin; i < end; i++) {
+            if (i > begin) sql += ", ";
+            sql += std::to_string(list[i]);
+        }
+        sql += ")";
+        for (const auto& row : db.query(sql)) {
+            int id;
+            if (toInt(row.at("id"), id)) found.insert(id);
+        }
+    }
+    return found;
+}
+
+} // namespace
+
+bool ScheduleImport::parse(const std::string& body, const std::string& contentType,
+                           std::vector<ScheduleImportLine>& lines) {
+    lines.clear();
+    if (contentType.find("text/csv") != std::string::npos || contentType.find("text/plain") != std::string::npos) {
+        return parseCsv(body, lines);
+    }
+    return parseJson(body, lines);
+}
+
+ScheduleImport::Result ScheduleImport::run(const std::string& body, const std::string& contentType, bool dryRun,
+                                           Report& report) {
+    report = Report{};
+    report.dryRun = dryRun;
+    if (!parse(body, contentType, report.lines)) return Result::BadFormat;
+    auto& lines = report.lines;
+    if (lines.size() > kMaxLines) return Result::TooLarge;
+
+    std::lock_guard<std::mutex> guard(importMutex);
+    auto& db = Database::getInstance();
+
+    // 外键校验：每张表一次 IN 查询
+    std::set<int> courses, classrooms, teachers, classes;
+    std::set<std::string> semesters;
+    for (const auto& line : lines) {
+        if (!line.status.empty()) continue;
+        courses.insert(line.courseId);
+        classrooms.insert(line.classroomId);
+        teachers.insert(line.teacherId);
+        if (line.classId) classes.insert(line.classId);
+        semesters.insert(line.semester);
+    }
+    auto knownCourses = existingIds(db, "course", courses);
+    auto knownClassrooms = existingIds(db, "classroom", classrooms);
+    auto knownTeachers = existingIds(db, "teacher", teachers);
+    auto knownClasses = existingIds(db, "class_info", classes);
+    for (auto& line : lines) {
+        if (!line.status.empty()) continue;
+        if (!knownCourses.count(line.courseId)) line.error = "课程不存在";
+        else if (!knownClassrooms.count(line.classroomId)) line.error = "教室不存在";
+        else if (!knownTeachers.count(line.teacherId)) line.error = "教师不存在";
+        else if (line.classId && !knownClasses.count(line.classId)) line.error = "班级不存在";
+        if (!line.error.empty()) line.status = "invalid";
+    }
+
+    // 已有排课的占用位图
+    std::unordered_map<std::string, Occupancy> occupancy;
+    auto occupy = [&occupancy](const std::string& semester, char resource, int id, const SlotMask& mask,
+                               const Occupant& occupant) {
+        auto& entry = occupancy[occupancyKey(semester, resource, id)];
+        entry.mask |= mask;
+        entry.occupants.push_back(occupant);
+    };
+    if (!semesters.empty()) {
+        std::string sql = "SELECT id, classroom_id, teacher_id, class_id, semester, weekday, start_section, end_section, "
+                          "start_week, end_week, week_type FROM schedule WHERE semester IN (";
+        bool first = true;
+        for (const auto& semester : semesters) {
+            if (!first) sql += ", ";
+            first = false;
+            sql += "'" + db.escape(semester) + "'";
+        }
+        sql += ")";
+        for (const auto& row : db.query(sql)) {
+            Occupant occupant{};
+            int classroomId = 0, teacherId = 0, classId = 0;
+            toInt(row.at("id"), occupant.scheduleId);
+            toInt(row.at("classroom_id"), classroomId);
+            toInt(row.at("teacher_id"), teacherId);
+            toInt(row.at("class_id"), classId);
+            toInt(row.at("weekday"), occupant.weekday);
+            toInt(row.at("start_section"), occupant.startSection);
+            toInt(row.at("end_section"), occupant.endSection);
+            toInt(row.at("start_week"), occupant.startWeek);
+            toInt(row.at("end_week"), occupant.endWeek);
+            occupant.weekType = weekTypeCode(row.at("week_type"));
+            SlotMask mask = buildMask(occupant.weekday, occupant.startSection, occupant.endSection,
+                                      occupant.startWeek, occupant.endWeek, occupant.weekType);
+            const std::string& semester = row.at("semester");
+            occupy(semester, 'R', classroomId, mask, occupant);
+            occupy(semester, 'T', teacherId, mask, occupant);
+            if (classId) occupy(semester, 'C', classId, mask, occupant);
+        }
+    }
+
+    // 按提交顺序检测：先到的条目占用时段
+    std::vector<size_t> accepted;
+    accepted.reserve(lines.size());
+    for (size_t i = 0; i < lines.size(); i++) {
+        auto& line = lines[i];
+        if (!line.status.empty()) continue;
+        Occupant occupant{0, line.line, line.weekday, line.startSection, line.endSection,
+                          line.startWeek, line.endWeek, weekTypeCode(line.weekType)};
+        SlotMask mask = buildMask(line.weekday, line.startSection, line.endSection, line.startWeek, line.endWeek,
+                                  occupant.weekType);
+
+        struct Resource { char code; const char* name; int id; };
+        const Resource resources[] = {{'R', "classroom", line.classroomId},
+                                      {'T', "teacher", line.teacherId},
+                                      {'C', "class", line.classId}};
+        for (const auto& resource : resources) {
+            if (!resource.id) continue;
+            auto it = occupancy.find(occupancyKey(line.semester, resource.code, resource.id));
+            if (it == occupancy.end() || !(it->second.mask & mask).any()) continue;
+            for (const auto& other : it->second.occupants) {
+                if (overlaps(occupant, other)) {
+                    line.conflicts.push_back({resource.name, other.scheduleId, other.line});
+                }
+            }
+        }
+        if (!line.conflicts.empty()) {
+            line.status = "conflict";
+            line.error = "时间冲突";
+            continue;
+        }
+        for (const auto& resource : resources) {
+            if (resource.id) occupy(line.semester, resource.code, resource.id, mask, occupant);
+        }
+        accepted.push_back(i);
+    }
+
+    // 多行 INSERT，全部在一个事务中执行
+    bool ok = true;
+    if (!dryRun && !accepted.empty()) {
+        std::vector<std::string> statements;
+        for (size_t begin = 0; begin < accepted.size(); begin += kBatchSize) {
+            size_t end = std::min(begin + kBatchSize, accepted.size());
+            std::string sql = "INSERT INTO schedule (course_id, classroom_id, teacher_id, class_id, semester, weekday, "
+                              "start_section, end_section, start_week, end_week, week_type, remark) VALUES ";
+            sql.reserve(sql.size() + (end - begin) * 80);
+            for (size_t j = begin; j < end; j++) {
+                const auto& line = lines[accepted[j]];
+                if (j > begin) sql += ", ";
+                sql += "(" + std::to_string(line.courseId) + ", " + std::to_string(line.classroomId) + ", " +
+                       std::to_string(line.teacherId) + ", " +
+                       (line.classId ? std::to_string(line.classId) : std::string("NULL")) + ", '" +
+                       db.escape(line.semester) + "', " + std::to_string(line.weekday) + ", " +
+                       std::to_string(line.startSection) + ", " + std::to_string(line.endSection) + ", " +
+                       std::to_string(line.startWeek) + ", " + std::to_string(line.endWeek) + ", '" +
+                       line.weekType + "', '" + db.escape(line.remark) + "')";
+            }
+            statements.push_back(std::move(sql));
+        }
+        ok = db.executeTransaction(statements);
+    }
+    for (size_t i : accepted) {
+        if (dryRun) {
+            lines[i].status = "valid";
+        } else {
+            lines[i].status = ok ? "created" : "failed";
+            if (!ok) lines[i].error = "写入失败，已回滚";
+        }
+    }
+    for (const auto& line : lines) {
+        if (line.status == "created" || line.status == "valid") report.created++; else report.failed++;
+    }
+    if (!ok) {
+        LOG_ERROR("批量排课失败，%zu 条已回滚", accepted.size());
+        return Result::DbError;
+    }
+    LOG_INFO("批量排课%s: 有效 %d，失败 %d", dryRun ? "（试运行）" : "", report.created, report.failed);
+    return Result::Ok;
+}
+
+std::string ScheduleImport::Report::toJson() const {
+    std::string json = "{\"success\": " + std::to_string(created) + ", \"failed\": " + std::to_string(failed) +
+                       ", \"dry_run\": " + (dryRun ? "true" : "false") + ", \"results\": [";
+    json.reserve(json.size() + lines.size() * 48);
+    for (size_t i = 0; i < lines.size(); i++) {
+        const auto& line = lines[i];
+        if (i > 0) json += ", ";
+        json += "{\"line\": " + std::to_string(line.line) + ", \"status\": \"" + line.status + "\"";
+        if (!line.error.empty()) json += ", \"error\": \"" + Json::escapeString(line.error) + "\"";
+        if (!line.conflicts.empty()) {
+            json += ", \"conflicts\": [";
+            for (size_t j = 0; j < line.conflicts.size(); j++) {
+                const auto& conflict = line.conflicts[j];
+                if (j > 0) json += ", ";
+                json += "{\"resource\": \"" + std::string(conflict.resource) + "\", ";
+                json += conflict.scheduleId ? "\"schedule_id\": " + std::to_string(conflict.scheduleId)
+                                            : "\"line\": " + std::to_string(conflict.line);
+                json += "}";
+            }
+            json += "]";
+        }
+        json += "}";
+    }
+    json += "]}";
+    return json;
+}
+
+std::vector<int> ScheduleImport::Report::createdCourseIds() const {
+    std::set<int> ids;
+    for (const auto& line : lines) {
+        if (line.status == "created") ids.insert(line.courseId);
+    }
+    return std::vector<int>(ids.begin(), ids.end());
+}
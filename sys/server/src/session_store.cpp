@@ -0,0 +1,324 @@
+#include "session_store.hpp"
+#include "logger.hpp"
+#include <fstream>
+#include <sstream>
+#include <random>
+#include <chrono>
+#include <functional>
+#include <cstdio>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+SessionStore& SessionStore::getInstance() {
+    static SessionStore instance;
+    return instance;
+}
+
+SessionStore::SessionStore()
+    : ttl_(7200), tickSeconds_(1), cursor_(0), dirty_(false), running_(false) {
+    for (auto& shard : shards_) {
+        shard.wheel.resize(kWheelSlots);
+    }
+    setTtl(ttl_);
+}
+
+SessionStore::~SessionStore() {
+    stop();
+}
+
+void SessionStore::setTtl(int seconds) {
+    ttl_ = seconds > 0 ? seconds : 7200;
+    // 时间轮精度取有效期的1/64，过期判断以expiresAt为准，槽位只决定回收时机
+    tickSeconds_ = std::max(1, ttl_ / 64);
+}
+
+void SessionStore::setPersistFile(const std::string& path) {
+    persistFile_ = path;
+}
+
+void SessionStore::start() {
+    if (running_) return;
+    if (!persistFile_.empty()) {
+        load();
+    }
+    running_ = true;
+    sweeper_ = std::thread(&SessionStore::sweepLoop, this);
+}
+
+void SessionStore::stop() {
+    if (!running_) return;
+    {
+        std::lock_guard<std::mutex> lock(sweepMutex_);
+        running_ = false;
+    }
+    sweepCv_.notify_all();
+    if (sweeper_.joinable()) {
+        sweeper_.join();
+    }
+    if (!persistFile_.empty()) {
+        save();
+    }
+}
+
+int64_t SessionStore::now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string SessionStore::generateToken() {
+    thread_local std::random_device rd;
+    static const char* hex = "0123456789abcdef";
+
+    std::string token;
+    token.reserve(64);
+    for (int i = 0; i < 8; i++) {
+        uint32_t r = rd();
+        for (int j = 0; j < 4; j++) {
+            uint8_t b = static_cast<uint8_t>(r >> (j * 8));
+            token.push_back(hex[b >> 4]);
+            token.push_back(hex[b & 0x0f]);
+        }
+    }
+    return token;
+}
+
+SessionStore::Shard& SessionStore::shardFor(const std::string& token) {
+    return shards_[std::hash<std::string>{}(token) % kShardCount];
+}
+
+const SessionStore::Shard& SessionStore::shardFor(const std::string& token) const {
+    return shards_[std::hash<std::string>{}(token) % kShardCount];
+}
+
+void SessionStore::schedule(Shard& shard, const std::string& token, int64_t expiresAt) {
+    int64_t remaining = expiresAt - now();
+    uint64_t ticks = remaining > 0 ? (remaining + tickSeconds_ - 1) / tickSeconds_ : 1;
+    if (ticks == 0) ticks = 1;
+
+    size_t slot = (cursor_.load() + ticks) % kWheelSlots;
+    uint32_t rounds = static_cast<uint32_t>((ticks - 1) / kWheelSlots);
+    shard.wheel[slot].push_back({token, rounds});
+}
+
+std::string SessionStore::create(int userId, const std::string& username,
+                                 const std::string& role, const std::string& realName) {
+    std::string token = generateToken();
+
+    Session session;
+    session.userId = userId;
+    session.username = username;
+    session.role = role;
+    session.realName = realName;
+    session.expiresAt = now() + ttl_;
+
+    Shard& shard = shardFor(token);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.sessions[token] = session;
+        schedule(shard, token, session.expiresAt);
+    }
+    dirty_ = true;
+    return token;
+}
+
+bool SessionStore::validate(const std::string& token, Session& session) {
+    if (token.empty()) return false;
+
+    Shard& shard = shardFor(token);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.sessions.find(token);
+    if (it == shard.sessions.end()) return false;
+
+    int64_t t = now();
+    if (it->second.expiresAt <= t) {
+        // 已过期但尚未被时间轮回收，时间轮扫到时发现不存在会直接丢弃
+        shard.sessions.erase(it);
+        dirty_ = true;
+        return false;
+    }
+
+    // 滑动过期：只更新时间戳，不动时间轮。按时间轮的精度顺延，
+    // 同一格内的多次访问不重复标记落盘，顺延后的过期时间在下次落盘时写入文件
+    if (t + ttl_ - it->second.expiresAt >= tickSeconds_) {
+        it->second.expiresAt = t + ttl_;
+        dirty_ = true;
+    }
+    session = it->second;
+    return true;
+}
+
+void SessionStore::remove(const std::string& token) {
+    Shard& shard = shardFor(token);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.sessions.erase(token)) {
+        dirty_ = true;
+    }
+}
+
+void SessionStore::removeUser(int userId) {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
+            if (it->second.userId == userId) {
+                it = shard.sessions.erase(it);
+                dirty_ = true;
+            } else {
+                ++it;
+            }
+        }
+    }
+}
+
+size_t SessionStore::size() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        total += shard.sessions.size();
+    }
+    return total;
+}
+
+void SessionStore::advance() {
+    size_t cursor = (cursor_.load() + 1) % kWheelSlots;
+    cursor_ = cursor;
+    int64_t t = now();
+
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        std::vector<WheelEntry> entries;
+        entries.swap(shard.wheel[cursor]);
+
+        for (auto& entry : entries) {
+            if (entry.rounds > 0) {
+                entry.rounds--;
+                shard.wheel[cursor].push_back(std::move(entry));
+                continue;
+            }
+
+            auto it = shard.sessions.find(entry.token);
+            if (it == shard.sessions.end()) continue;  // 已注销
+
+            if (it->second.expiresAt <= t) {
+                shard.sessions.erase(it);
+                dirty_ = true;
+            } else {
+                // 期间被访问过，按新的过期时间重新挂载
+                schedule(shard, entry.token, it->second.expiresAt);
+            }
+        }
+    }
+}
+
+void SessionStore::sweepLoop() {
+    const int saveEveryTicks = std::max(1, 60 / tickSeconds_);
+    int ticks = 0;
+
+    std::unique_lock<std::mutex> lock(sweepMutex_);
+    while (running_) {
+        sweepCv_.wait_for(lock, std::chrono::seconds(tickSeconds_), [this] { return !running_; });
+        if (!running_) break;
+
+        lock.unlock();
+        advance();
+        if (!persistFile_.empty() && ++ticks >= saveEveryTicks) {
+            ticks = 0;
+            if (dirty_) save();
+        }
+        lock.lock();
+    }
+}
+
+// 文件格式：每行一个会话，字段以\t分隔
+// token  userId  username  role  realName  expiresAt
+bool SessionStore::save() const {
+    auto clean = [](const std::string& s) {
+        std::string out = s;
+        for (auto& c : out) {
+            if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+        }
+        return out;
+    };
+
+    std::string content;
+    dirty_ = false;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        for (const auto& [token, s] : shard.sessions) {
+            content += token + '\t' + std::to_string(s.userId) + '\t' + clean(s.username) + '\t' +
+                       clean(s.role) + '\t' + clean(s.realName) + '\t' + std::to_string(s.expiresAt) + '\n';
+        }
+    }
+
+    // 文件里是可直接使用的 token：只允许本用户读写，先删掉可能残留的旧临时文件再独占创建
+    std::string tmpFile = persistFile_ + ".tmp";
+    unlink(tmpFile.c_str());
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    if (fd < 0) {
+        LOG_ERROR("会话文件写入失败: %s: %s", tmpFile.c_str(), strerror(errno));
+        dirty_ = true;
+        return false;
+    }
+    size_t written = 0;
+    while (written < content.size()) {
+        ssize_t n = ::write(fd, content.data() + written, content.size() - written);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        written += static_cast<size_t>(n);
+    }
+    if (close(fd) != 0 || written < content.size()) {
+        LOG_ERROR("会话文件写入失败: %s: %s", tmpFile.c_str(), strerror(errno));
+        unlink(tmpFile.c_str());
+        dirty_ = true;
+        return false;
+    }
+
+    if (std::rename(tmpFile.c_str(), persistFile_.c_str()) != 0) {
+        LOG_ERROR("会话文件替换失败: %s: %s", persistFile_.c_str(), strerror(errno));
+        unlink(tmpFile.c_str());
+        dirty_ = true;
+        return false;
+    }
+    return true;
+}
+
+bool SessionStore::load() {
+    std::ifstream in(persistFile_);
+    if (!in.is_open()) return false;
+
+    int64_t t = now();
+    size_t loaded = 0;
+    std::string line;
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::istringstream iss(line);
+        std::string field;
+        while (std::getline(iss, field, '\t')) {
+            fields.push_back(field);
+        }
+        if (fields.size() != 6) continue;
+
+        Session s;
+        try {
+            s.userId = std::stoi(fields[1]);
+            s.expiresAt = std::stoll(fields[5]);
+        } catch (...) {
+            continue;
+        }
+        if (s.expiresAt <= t) continue;
+        s.username = fields[2];
+        s.role = fields[3];
+        s.realName = fields[4];
+
+        Shard& shard = shardFor(fields[0]);
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.sessions[fields[0]] = s;
+        schedule(shard, fields[0], s.expiresAt);
+        loaded++;
+    }
+
+    LOG_INFO("恢复会话: %zu", loaded);
+    return true;
+}
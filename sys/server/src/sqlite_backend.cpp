@@ -0,0 +1,671 @@
+#include "sqlite_backend.hpp"
+#include "db.hpp"
+#include "logger.hpp"
+#include "query_stats.hpp"
+#include "password_hasher.hpp"
+#include <sqlite3.h>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <ctime>
+#include <cctype>
+#include <cstring>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+uint64_t nanosSince(Clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+// ========== MySQL 方言转换 ==========
+// 语句先切分为词法单元（字符串字面量解码后重新按 SQLite 规则编码），再按关键字改写
+
+struct Token {
+    enum Kind { Word, String, Quoted, Punct, Space } kind;
+    std::string text;       // String 为解码后的值，其余为原文
+};
+
+bool isWordChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == '$' ||
+           (static_cast<unsigned char>(c) & 0x80);
+}
+
+std::string upper(const std::string& s) {
+    std::string out = s;
+    for (auto& c : out) c = static_cast<char>(std::toupper(static_cast<unsigned char>(c)));
+    return out;
+}
+
+bool containsNoCase(const std::string& haystack, const char* needle) {
+    size_t n = std::strlen(needle);
+    if (haystack.size() < n) return false;
+    for (size_t i = 0; i + n <= haystack.size(); i++) {
+        size_t j = 0;
+        while (j < n && std::toupper(static_cast<unsigned char>(haystack[i + j])) == needle[j]) j++;
+        if (j == n) return true;
+    }
+    return false;
+}
+
+// backslashEscapes: MySQL 字符串中的 \' \\ \n 等转义（建库脚本）；运行期语句由 escape() 生成，反斜杠是普通字符
+std::vector<Token> tokenize(const std::string& sql, bool backslashEscapes) {
+    std::vector<Token> tokens;
+    auto space = [&]() {
+        if (tokens.empty() || tokens.back().kind != Token::Space) tokens.push_back({Token::Space, " "});
+    };
+
+    size_t i = 0, n = sql.size();
+    while (i < n) {
+        char c = sql[i];
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            space();
+            i++;
+        } else if (c == '#' || (c == '-' && i + 1 < n && sql[i + 1] == '-' &&
+                                (i + 2 >= n || std::isspace(static_cast<unsigned char>(sql[i + 2]))))) {
+            while (i < n && sql[i] != '\n') i++;
+            space();
+        } else if (c == '/' && i + 1 < n && sql[i + 1] == '*') {
+            size_t end = sql.find("*/", i + 2);
+            i = end == std::string::npos ? n : end + 2;
+            space();
+        } else if (c == '\'' || c == '"') {
+            // MySQL 默认把双引号也当作字符串
+            std::string value;
+            i++;
+            while (i < n) {
+                char d = sql[i++];
+                if (d == '\\' && backslashEscapes && i < n) {
+                    char e = sql[i++];
+                    switch (e) {
+                        case 'n': value += '\n'; break;
+                        case 't': value += '\t'; break;
+                        case 'r': value += '\r'; break;
+                        case '0': value += '\0'; break;
+                        case '%': case '_': value += '\\'; value += e; break;
+                        default: value += e;
+                    }
+                } else if (d == c) {
+                    if (i < n && sql[i] == c) {
+                        value += c;
+                        i++;
+                    } else {
+                        break;
+                    }
+                } else {
+                    value += d;
+                }
+            }
+            tokens.push_back({Token::String, value});
+        } else if (c == '`') {
+            size_t end = sql.find('`', i + 1);
+            end = end == std::string::npos ? n : end + 1;
+            tokens.push_back({Token::Quoted, sql.substr(i, end - i)});
+            i = end;
+        } else if (isWordChar(c)) {
+            size_t start = i;
+            while (i < n && isWordChar(sql[i])) i++;
+            tokens.push_back({Token::Word, sql.substr(start, i - start)});
+        } else {
+            tokens.push_back({Token::Punct, std::string(1, c)});
+            i++;
+        }
+    }
+    return tokens;
+}
+
+bool isWord(const Token& t, const char* word) {
+    return t.kind == Token::Word && upper(t.text) == word;
+}
+
+bool isPunct(const Token& t, char c) {
+    return t.kind == Token::Punct && t.text[0] == c;
+}
+
+// 下一个非空白单元的位置
+size_t next(const std::vector<Token>& tokens, size_t i) {
+    while (i < tokens.size() && tokens[i].kind == Token::Space) i++;
+    return i;
+}
+
+// 与 tokens[open] 处左括号匹配的右括号位置
+size_t matching(const std::vector<Token>& tokens, size_t open) {
+    int depth = 0;
+    for (size_t i = open; i < tokens.size(); i++) {
+        if (isPunct(tokens[i], '(')) depth++;
+        else if (isPunct(tokens[i], ')') && --depth == 0) return i;
+    }
+    return tokens.size();
+}
+
+// 通用改写（DML 和 DDL 都适用）后输出 [from, to) 的文本
+std::string emit(const std::vector<Token>& tokens, size_t from, size_t to) {
+    std::string out;
+    for (size_t i = from; i < to && i < tokens.size(); i++) {
+        const Token& t = tokens[i];
+        switch (t.kind) {
+            case Token::String: {
+                out += '\'';
+                for (char c : t.text) {
+                    if (c == '\'') out += '\'';
+                    out += c;
+                }
+                out += '\'';
+                break;
+            }
+            case Token::Punct:
+                // MySQL 的 / 是小数除法，SQLite 整数相除会截断
+                out += t.text == "/" ? "* 1.0 /" : t.text;
+                break;
+            case Token::Word: {
+                std::string word = upper(t.text);
+                size_t j = next(tokens, i + 1);
+                if (word == "INSERT" && j < to && isWord(tokens[j], "IGNORE")) {
+                    out += "INSERT OR IGNORE";
+                    i = j;
+                } else if (word == "START" && j < to && isWord(tokens[j], "TRANSACTION")) {
+                    out += "BEGIN";
+                    i = j;
+                } else {
+                    out += t.text;
+                }
+                break;
+            }
+            default:
+                out += t.text;
+        }
+    }
+    return out;
+}
+
+// 按顶层逗号切分 [from, to)，返回每段的 [begin, end)
+std::vector<std::pair<size_t, size_t>> splitItems(const std::vector<Token>& tokens, size_t from, size_t to) {
+    std::vector<std::pair<size_t, size_t>> items;
+    int depth = 0;
+    size_t start = from;
+    for (size_t i = from; i < to; i++) {
+        if (isPunct(tokens[i], '(')) depth++;
+        else if (isPunct(tokens[i], ')')) depth--;
+        else if (depth == 0 && isPunct(tokens[i], ',')) {
+            items.push_back({start, i});
+            start = i + 1;
+        }
+    }
+    if (start < to) items.push_back({start, to});
+    return items;
+}
+
+// 索引列表：去掉前缀长度，如 name(20)
+std::string indexColumns(const std::vector<Token>& tokens, size_t open) {
+    size_t close = matching(tokens, open);
+    std::string out = "(";
+    for (size_t i = open + 1; i < close; i++) {
+        if (isPunct(tokens[i], '(')) {
+            i = matching(tokens, i);
+            continue;
+        }
+        out += emit(tokens, i, i + 1);
+    }
+    return out + ")";
+}
+
+// [UNIQUE] INDEX|KEY [名称] (列...)  ->  CREATE [UNIQUE] INDEX
+std::string indexDefinition(const std::vector<Token>& tokens, size_t from, const std::string& table, int& counter) {
+    size_t i = next(tokens, from);
+    bool unique = isWord(tokens[i], "UNIQUE");
+    if (unique) i = next(tokens, i + 1);
+    if (isWord(tokens[i], "INDEX") || isWord(tokens[i], "KEY")) i = next(tokens, i + 1);
+
+    std::string name;
+    if (i < tokens.size() && !isPunct(tokens[i], '(')) {
+        name = tokens[i].text;
+        i = next(tokens, i + 1);
+    } else {
+        name = "idx_" + table + "_" + std::to_string(++counter);
+    }
+    if (i >= tokens.size() || !isPunct(tokens[i], '(')) return "";
+    return std::string("CREATE ") + (unique ? "UNIQUE " : "") + "INDEX IF NOT EXISTS " + name +
+           " ON " + table + " " + indexColumns(tokens, i);
+}
+
+// 列定义：去掉 AUTO_INCREMENT/COMMENT/ON UPDATE/字符集等 MySQL 专有部分，ENUM/SET 改为 TEXT
+std::string columnDefinition(const std::vector<Token>& tokens, size_t from, size_t to, bool& autoIncrement) {
+    size_t nameAt = next(tokens, from);
+    std::string out = emit(tokens, nameAt, nameAt + 1);
+    autoIncrement = false;
+    for (size_t i = nameAt + 1; i < to; i++) {
+        if (isWord(tokens[i], "AUTO_INCREMENT")) {
+            autoIncrement = true;
+        }
+    }
+    if (autoIncrement) return out + " INTEGER PRIMARY KEY AUTOINCREMENT";
+
+    for (size_t i = nameAt + 1; i < to; i++) {
+        const Token& t = tokens[i];
+        size_t j = next(tokens, i + 1);
+        if ((isWord(t, "ENUM") || isWord(t, "SET")) && j < to && isPunct(tokens[j], '(')) {
+            out += "TEXT";
+            i = matching(tokens, j);
+        } else if (isWord(t, "COMMENT") && j < to && tokens[j].kind == Token::String) {
+            i = j;
+        } else if (isWord(t, "ON") && j < to && isWord(tokens[j], "UPDATE")) {
+            i = next(tokens, j + 1);                                    // CURRENT_TIMESTAMP
+            size_t k = next(tokens, i + 1);
+            if (k < to && isPunct(tokens[k], '(')) i = matching(tokens, k);
+        } else if (isWord(t, "UNSIGNED") || isWord(t, "ZEROFILL")) {
+            continue;
+        } else if ((isWord(t, "CHARACTER") && j < to && isWord(tokens[j], "SET"))) {
+            i = next(tokens, j + 1);
+        } else if ((isWord(t, "CHARSET") || isWord(t, "COLLATE")) && j < to) {
+            i = j;
+        } else {
+            out += emit(tokens, i, i + 1);
+        }
+    }
+    return out;
+}
+
+// CREATE TABLE：表内 INDEX/KEY 拆成独立的 CREATE INDEX，表选项（ENGINE 等）丢弃
+std::string createTable(const std::vector<Token>& tokens) {
+    size_t open = 0;
+    while (open < tokens.size() && !isPunct(tokens[open], '(')) open++;
+    if (open >= tokens.size()) return emit(tokens, 0, tokens.size());
+    size_t nameAt = open;
+    while (nameAt > 0 && tokens[nameAt - 1].kind == Token::Space) nameAt--;
+    std::string table = nameAt > 0 ? tokens[nameAt - 1].text : "";
+    size_t close = matching(tokens, open);
+
+    std::vector<std::string> columns;
+    std::vector<std::string> indexes;
+    std::string autoColumn;
+    int counter = 0;
+    for (auto [from, to] : splitItems(tokens, open + 1, close)) {
+        size_t first = next(tokens, from);
+        if (first >= to) continue;
+        const Token& t = tokens[first];
+        size_t second = next(tokens, first + 1);
+        bool uniqueIndex = isWord(t, "UNIQUE") && second < to &&
+                           (isWord(tokens[second], "KEY") || isWord(tokens[second], "INDEX"));
+        if (isWord(t, "INDEX") || isWord(t, "KEY") || uniqueIndex) {
+            std::string index = indexDefinition(tokens, first, table, counter);
+            if (!index.empty()) indexes.push_back(index);
+        } else if (isWord(t, "FULLTEXT") || isWord(t, "SPATIAL")) {
+            continue;
+        } else if (isWord(t, "PRIMARY") && !autoColumn.empty()) {
+            // 自增列已经是主键
+            continue;
+        } else if (isWord(t, "PRIMARY") || isWord(t, "FOREIGN") || isWord(t, "CONSTRAINT") ||
+                   isWord(t, "CHECK") || isWord(t, "UNIQUE")) {
+            columns.push_back(emit(tokens, first, to));
+        } else {
+            bool autoIncrement = false;
+            columns.push_back(columnDefinition(tokens, first, to, autoIncrement));
+            if (autoIncrement) autoColumn = t.text;
+        }
+    }
+
+    std::string out = emit(tokens, 0, open) + "(\n    ";
+    for (size_t i = 0; i < columns.size(); i++) {
+        if (i > 0) out += ",\n    ";
+        out += columns[i];
+    }
+    out += "\n)";
+    for (const auto& index : indexes) out += ";\n" + index;
+    return out;
+}
+
+// ALTER TABLE t ADD [UNIQUE] INDEX ...  /  ADD [COLUMN] 列定义
+std::string alterTable(const std::vector<Token>& tokens) {
+    size_t i = next(tokens, next(tokens, 0) + 1);                   // TABLE
+    size_t nameAt = next(tokens, i + 1);
+    if (nameAt >= tokens.size()) return emit(tokens, 0, tokens.size());
+    std::string table = tokens[nameAt].text;
+
+    std::vector<std::string> statements;
+    int counter = 0;
+    for (auto [from, to] : splitItems(tokens, nameAt + 1, tokens.size())) {
+        size_t op = next(tokens, from);
+        size_t what = next(tokens, op + 1);
+        if (op < to && isWord(tokens[op], "ADD") && what < to &&
+            (isWord(tokens[what], "INDEX") || isWord(tokens[what], "KEY") || isWord(tokens[what], "UNIQUE"))) {
+            std::string index = indexDefinition(tokens, what, table, counter);
+            if (!index.empty()) statements.push_back(index);
+        } else if (op < to && isWord(tokens[op], "ADD")) {
+            if (isWord(tokens[what], "COLUMN")) what = next(tokens, what + 1);
+            bool autoIncrement = false;
+            statements.push_back("ALTER TABLE " + table + " ADD COLUMN " +
+                                 columnDefinition(tokens, what, to, autoIncrement));
+        } else {
+            statements.push_back("ALTER TABLE " + table + " " + emit(tokens, from, to));
+        }
+    }
+    std::string out;
+    for (const auto& s : statements) {
+        if (!out.empty()) out += ";\n";
+        out += s;
+    }
+    return out;
+}
+
+std::string translateScriptStatement(const std::vector<Token>& tokens) {
+    size_t first = next(tokens, 0);
+    if (first >= tokens.size()) return "";
+    std::string word = upper(tokens[first].text);
+    // 会话设置不需要；脚本整体已在一个事务中执行，其中的事务语句也忽略
+    if (word == "USE" || word == "SET" || word == "DELIMITER" || word == "LOCK" || word == "UNLOCK" ||
+        word == "START" || word == "BEGIN" || word == "COMMIT") {
+        return "";
+    }
+    if (word == "ALTER") return alterTable(tokens);
+    if (word != "CREATE") return emit(tokens, 0, tokens.size());
+
+    size_t second = next(tokens, first + 1);
+    if (second >= tokens.size()) return "";
+    std::string kind = upper(tokens[second].text);
+    if (kind == "DATABASE" || kind == "SCHEMA") return "";
+    if (kind == "TABLE") return createTable(tokens);
+    if (kind == "OR") {
+        // CREATE OR REPLACE VIEW v AS ...  ->  DROP VIEW IF EXISTS v; CREATE VIEW v AS ...
+        size_t replace = next(tokens, second + 1);
+        size_t view = next(tokens, replace + 1);
+        size_t name = next(tokens, view + 1);
+        if (name < tokens.size() && isWord(tokens[view], "VIEW")) {
+            return "DROP VIEW IF EXISTS " + tokens[name].text + ";\nCREATE VIEW " +
+                   emit(tokens, name, tokens.size());
+        }
+    }
+    return emit(tokens, 0, tokens.size());
+}
+
+// 从 pos 开始取下一条语句（不含分号），跳过字符串和注释中的分号
+bool nextStatement(const std::string& text, size_t& pos, std::string& statement) {
+    size_t n = text.size();
+    size_t start = pos;
+    char quote = 0;
+    while (pos < n) {
+        char c = text[pos];
+        if (quote) {
+            if (c == '\\') pos++;
+            else if (c == quote) quote = 0;
+        } else if (c == '\'' || c == '"' || c == '`') {
+            quote = c;
+        } else if (c == '#' || (c == '-' && pos + 1 < n && text[pos + 1] == '-')) {
+            while (pos < n && text[pos] != '\n') pos++;
+            continue;
+        } else if (c == '/' && pos + 1 < n && text[pos + 1] == '*') {
+            size_t end = text.find("*/", pos + 2);
+            pos = end == std::string::npos ? n : end + 2;
+            continue;
+        } else if (c == ';') {
+            statement = text.substr(start, pos - start);
+            pos++;
+            return true;
+        }
+        pos++;
+    }
+    statement = text.substr(start);
+    return statement.find_first_not_of(" \t\r\n") != std::string::npos;
+}
+
+// ========== MySQL 函数 ==========
+void now(sqlite3_context* ctx, int, sqlite3_value**) {
+    char buf[32];
+    std::time_t t = std::time(nullptr);
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &tm);
+    sqlite3_result_text(ctx, buf, -1, SQLITE_TRANSIENT);
+}
+
+void curdate(sqlite3_context* ctx, int, sqlite3_value**) {
+    char buf[16];
+    std::time_t t = std::time(nullptr);
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    std::strftime(buf, sizeof(buf), "%Y-%m-%d", &tm);
+    sqlite3_result_text(ctx, buf, -1, SQLITE_TRANSIENT);
+}
+
+void unixTimestamp(sqlite3_context* ctx, int, sqlite3_value**) {
+    sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(std::time(nullptr)));
+}
+
+// CONCAT：任一参数为 NULL 时结果为 NULL（与 MySQL 一致）
+void concat(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    std::string out;
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+        out.append(reinterpret_cast<const char*>(sqlite3_value_text(argv[i])), sqlite3_value_bytes(argv[i]));
+    }
+    sqlite3_result_text(ctx, out.data(), static_cast<int>(out.size()), SQLITE_TRANSIENT);
+}
+
+// SHA2(str, 256)：只支持 SHA-256（0 视为 256），其余长度返回 NULL
+void sha2(sqlite3_context* ctx, int, sqlite3_value** argv) {
+    int bits = sqlite3_value_int(argv[1]);
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL || (bits != 256 && bits != 0)) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    std::string input(reinterpret_cast<const char*>(sqlite3_value_text(argv[0])), sqlite3_value_bytes(argv[0]));
+    auto digest = Sha256::hash(input);
+    static const char* hex = "0123456789abcdef";
+    std::string out;
+    for (uint8_t b : digest) {
+        out += hex[b >> 4];
+        out += hex[b & 0xf];
+    }
+    sqlite3_result_text(ctx, out.data(), static_cast<int>(out.size()), SQLITE_TRANSIENT);
+}
+
+} // namespace
+
+SqliteBackend::SqliteBackend(const std::string& path, std::vector<std::string> scripts)
+    : path_(path), scripts_(std::move(scripts)), db_(nullptr) {}
+
+SqliteBackend::~SqliteBackend() {
+    disconnect();
+}
+
+bool SqliteBackend::connect() {
+    disconnect();
+    int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_NOMUTEX | SQLITE_OPEN_URI;
+    if (sqlite3_open_v2(path_.c_str(), &db_, flags, nullptr) != SQLITE_OK) {
+        LOG_ERROR("SQLite打开失败: %s (%s)", db_ ? sqlite3_errmsg(db_) : "out of memory", path_.c_str());
+        disconnect();
+        return false;
+    }
+
+    // 外键与 MySQL 一致开启；文件库使用 WAL，写入只在提交时同步
+    sqlite3_exec(db_, "PRAGMA foreign_keys = ON; PRAGMA synchronous = NORMAL; "
+                      "PRAGMA temp_store = MEMORY; PRAGMA cache_size = -65536;", nullptr, nullptr, nullptr);
+    if (path_ != ":memory:") {
+        sqlite3_exec(db_, "PRAGMA journal_mode = WAL;", nullptr, nullptr, nullptr);
+    }
+    registerFunctions();
+
+    // 空库时执行建库脚本
+    sqlite3_stmt* stmt = nullptr;
+    int tables = 0;
+    if (sqlite3_prepare_v2(db_, "SELECT COUNT(*) FROM sqlite_master WHERE type = 'table'", -1, &stmt, nullptr) == SQLITE_OK &&
+        sqlite3_step(stmt) == SQLITE_ROW) {
+        tables = sqlite3_column_int(stmt, 0);
+    }
+    sqlite3_finalize(stmt);
+
+    if (tables == 0) {
+        for (const auto& script : scripts_) {
+            auto start = Clock::now();
+            int failed = loadScript(script);
+            if (failed < 0) {
+                LOG_ERROR("无法读取建库脚本: %s", script.c_str());
+                disconnect();
+                return false;
+            }
+            LOG_INFO("已执行建库脚本 %s（%.0f ms，失败 %d 条）", script.c_str(), nanosSince(start) / 1e6, failed);
+        }
+    }
+
+    LOG_INFO("SQLite数据库已打开: %s", path_.c_str());
+    return true;
+}
+
+void SqliteBackend::disconnect() {
+    if (db_) {
+        sqlite3_close_v2(db_);
+        db_ = nullptr;
+    }
+}
+
+bool SqliteBackend::ping() {
+    return db_ != nullptr;
+}
+
+bool SqliteBackend::ensureConnected() {
+    return db_ != nullptr;
+}
+
+void SqliteBackend::registerFunctions() {
+    const int deterministic = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+    sqlite3_create_function(db_, "NOW", 0, SQLITE_UTF8, nullptr, now, nullptr, nullptr);
+    sqlite3_create_function(db_, "CURDATE", 0, SQLITE_UTF8, nullptr, curdate, nullptr, nullptr);
+    sqlite3_create_function(db_, "UNIX_TIMESTAMP", 0, SQLITE_UTF8, nullptr, unixTimestamp, nullptr, nullptr);
+    sqlite3_create_function(db_, "CONCAT", -1, deterministic, nullptr, concat, nullptr, nullptr);
+    sqlite3_create_function(db_, "SHA2", 2, deterministic, nullptr, sha2, nullptr, nullptr);
+}
+
+std::string SqliteBackend::translate(const std::string& sql, bool script) {
+    // 大多数运行期语句不含需要转换的内容，直接使用
+    bool plain = sql.find_first_of(script ? "/\"\\" : "/\"") == std::string::npos &&
+                 !containsNoCase(sql, "IGNORE") && !containsNoCase(sql, "TRANSACTION");
+    if (!script) {
+        return plain ? sql : emit(tokenize(sql, false), 0, std::string::npos);
+    }
+
+    std::string out;
+    size_t pos = 0;
+    std::string statement;
+    while (nextStatement(sql, pos, statement)) {
+        std::string translated = translateScriptStatement(tokenize(statement, true));
+        if (translated.empty()) continue;
+        out += translated;
+        out += ";\n";
+    }
+    return out;
+}
+
+int SqliteBackend::loadScript(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return -1;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+
+    int failed = 0;
+    sqlite3_exec(db_, "BEGIN", nullptr, nullptr, nullptr);
+    size_t pos = 0;
+    std::string statement;
+    while (nextStatement(text, pos, statement)) {
+        // 数据行较多的 INSERT 不含需要转换的内容时跳过词法分析
+        size_t first = statement.find_first_not_of(" \t\r\n");
+        bool plainInsert = first != std::string::npos &&
+                           upper(statement.substr(first, 7)) == "INSERT " &&
+                           statement.find_first_of("/\"\\") == std::string::npos &&
+                           !containsNoCase(statement.substr(0, 64), "IGNORE");
+        std::string translated = plainInsert ? statement : translateScriptStatement(tokenize(statement, true));
+        if (translated.empty()) continue;
+
+        char* err = nullptr;
+        if (sqlite3_exec(db_, translated.c_str(), nullptr, nullptr, &err) != SQLITE_OK) {
+            failed++;
+            LOG_WARN("建库脚本语句执行失败 (%s): %s | %.200s", path.c_str(), err ? err : "", translated.c_str());
+            sqlite3_free(err);
+        }
+    }
+    sqlite3_exec(db_, "COMMIT", nullptr, nullptr, nullptr);
+    return failed;
+}
+
+bool SqliteBackend::run(const std::string& sql, DbResult* result, StatementTiming& timing) {
+    lastError_.clear();
+    const std::string translated = translate(sql);
+    const char* tail = translated.c_str();
+    const char* end = tail + translated.size();
+
+    // SQLite 逐行执行：准备语句和第一步计入 exec，其余各步连同结果转换计入 convert
+    auto phase = Clock::now();
+    while (tail < end) {
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db_, tail, static_cast<int>(end - tail), &stmt, &tail) != SQLITE_OK) {
+            lastError_ = sqlite3_errmsg(db_);
+            timing.execNs += nanosSince(phase);
+            return false;
+        }
+        if (!stmt) break;      // 只剩空白或注释
+
+        int rc = sqlite3_step(stmt);
+        timing.execNs += nanosSince(phase);
+        phase = Clock::now();
+
+        if (rc == SQLITE_ROW && result) {
+            int numFields = sqlite3_column_count(stmt);
+            std::vector<std::string> names;
+            names.reserve(numFields);
+            for (int i = 0; i < numFields; i++) {
+                names.emplace_back(sqlite3_column_name(stmt, i));
+            }
+            std::vector<const char*> values(numFields);
+            do {
+                for (int i = 0; i < numFields; i++) {
+                    values[i] = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                }
+                result->push_back(Database::buildRow(names, values.data()));
+            } while ((rc = sqlite3_step(stmt)) == SQLITE_ROW);
+        } else {
+            while (rc == SQLITE_ROW) rc = sqlite3_step(stmt);
+        }
+        timing.convertNs += nanosSince(phase);
+
+        if (rc != SQLITE_DONE) {
+            lastError_ = sqlite3_errmsg(db_);
+            sqlite3_finalize(stmt);
+            return false;
+        }
+        sqlite3_finalize(stmt);
+        phase = Clock::now();
+    }
+    return true;
+}
+
+unsigned long long SqliteBackend::lastInsertId() const {
+    return db_ ? static_cast<unsigned long long>(sqlite3_last_insert_rowid(db_)) : 0;
+}
+
+unsigned long long SqliteBackend::affectedRows() const {
+    return db_ ? static_cast<unsigned long long>(sqlite3_changes(db_)) : 0;
+}
+
+// SQLite 字符串中只有单引号需要转义（双写），反斜杠是普通字符
+std::string SqliteBackend::escape(const std::string& str) {
+    std::string out;
+    out.reserve(str.size() + 8);
+    for (char c : str) {
+        if (c == '\'') out += '\'';
+        out += c;
+    }
+    return out;
+}
+
+void SqliteBackend::interrupt() {
+    // sqlite3_interrupt 可以从其他线程调用，执行中的语句以 SQLITE_INTERRUPT 失败
+    if (db_) sqlite3_interrupt(db_);
+}
+
+std::string SqliteBackend::error() const {
+    if (!lastError_.empty()) return lastError_;
+    return db_ ? sqlite3_errmsg(db_) : "No connection";
+}
@@ -0,0 +1,95 @@
+#include "table_versions.hpp"
+#include "http_server.hpp"
+#include <random>
+#include <cstdio>
+
+namespace {
+
+// FNV-1a 64位
+void mix(uint64_t& hash, const void* data, size_t size) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= p[i];
+        hash *= 1099511628211ULL;
+    }
+}
+
+void mix(uint64_t& hash, const std::string& value) {
+    mix(hash, value.data(), value.size());
+    mix(hash, "\0", 1);         // 分隔符，避免 "ab"+"c" 与 "a"+"bc" 相同
+}
+
+std::string trim(const std::string& s) {
+    size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string::npos) return "";
+    size_t end = s.find_last_not_of(" \t");
+    return s.substr(begin, end - begin + 1);
+}
+
+} // namespace
+
+TableVersions& TableVersions::getInstance() {
+    static TableVersions instance;
+    return instance;
+}
+
+TableVersions::TableVersions() {
+    std::random_device rd;
+    epoch_ = (static_cast<uint64_t>(rd()) << 32) | rd();
+}
+
+void TableVersions::bump(std::initializer_list<Table> tables) {
+    for (Table table : tables) versions_[static_cast<int>(table)].fetch_add(1, std::memory_order_acq_rel);
+}
+
+const char* TableVersions::name(Table table) {
+    switch (table) {
+        case Table::Classroom: return "classroom";
+        case Table::Equipment: return "equipment";
+        case Table::Course: return "course";
+        case Table::Schedule: return "schedule";
+        case Table::ClassInfo: return "class_info";
+        case Table::Notice: return "notice";
+        case Table::Booking: return "booking";
+        case Table::Enrollment: return "enrollment";
+        case Table::User: return "user";
+        default: return "";
+    }
+}
+
+std::string TableVersions::etag(const HttpRequest& req, const std::vector<Table>& tables,
+                                const std::string& context) const {
+    uint64_t hash = 14695981039346656037ULL;
+    mix(hash, &epoch_, sizeof(epoch_));
+    for (Table table : tables) {
+        uint64_t v = version(table);
+        int index = static_cast<int>(table);
+        mix(hash, &index, sizeof(index));
+        mix(hash, &v, sizeof(v));
+    }
+    mix(hash, req.path);
+    // parseQuery 按参数名排序，参数顺序不同的同一查询得到相同的 ETag
+    for (const auto& [key, value] : req.parseQuery()) {
+        mix(hash, key);
+        mix(hash, value);
+    }
+    mix(hash, context);
+    char buffer[24];
+    snprintf(buffer, sizeof(buffer), "W/\"%016llx\"", static_cast<unsigned long long>(hash));
+    return buffer;
+}
+
+bool TableVersions::matches(const std::string& ifNoneMatch, const std::string& etag) {
+    // 弱比较：忽略两边的 W/ 前缀
+    auto opaque = [](const std::string& tag) { return tag.compare(0, 2, "W/") == 0 ? tag.substr(2) : tag; };
+    std::string target = opaque(etag);
+    size_t pos = 0;
+    while (pos <= ifNoneMatch.size()) {
+        size_t comma = ifNoneMatch.find(',', pos);
+        if (comma == std::string::npos) comma = ifNoneMatch.size();
+        std::string tag = trim(ifNoneMatch.substr(pos, comma - pos));
+        if (tag == "*" || (!tag.empty() && opaque(tag) == target)) return true;
+        pos = comma + 1;
+    }
+    return false;
+}
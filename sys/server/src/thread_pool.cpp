@@ -0,0 +1,57 @@
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(size_t threads, size_t maxQueue)
+    : maxQueue_(maxQueue), stopping_(false) {
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i < threads; i++) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    shutdown();
+}
+
+bool ThreadPool::trySubmit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || queue_.size() >= maxQueue_) {
+            return false;
+        }
+        queue_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+    return true;
+}
+
+size_t ThreadPool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void ThreadPool::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            // 停止时先把已排队的任务执行完，避免等待方永远拿不到结果
+            if (queue_.empty()) return;
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        task();
+    }
+}
@@ -0,0 +1,190 @@
+#include "timer_wheel.hpp"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+constexpr uint64_t kSlotMask = TimerWheel::kSlots - 1;
+// 时间轮能表示的最远 tick 距离
+constexpr uint64_t kMaxDelta = (uint64_t(1) << (TimerWheel::kSlotBits * TimerWheel::kLevels)) - 1;
+
+} // namespace
+
+// ========== Timer ==========
+void TimerWheel::Timer::cancel() {
+    if (wheel_) wheel_->cancel(*this);
+}
+
+// ========== TimerWheel ==========
+TimerWheel::TimerWheel(Clock::duration tick, Clock::time_point now) : start_(now), tick_(tick) {}
+
+TimerWheel::~TimerWheel() {
+    // 仍在轮上的定时器与时间轮解绑，之后它们的析构不再访问时间轮
+    for (auto& level : slots_) {
+        for (Timer*& head : level) {
+            while (head) {
+                Timer* timer = head;
+                head = timer->next_;
+                timer->wheel_ = nullptr;
+                timer->prev_ = timer->next_ = nullptr;
+                timer->callback_ = nullptr;
+            }
+        }
+    }
+}
+
+uint64_t TimerWheel::tickOf(Clock::time_point time) const {
+    if (time <= start_) return 0;
+    return static_cast<uint64_t>((time - start_) / tick_);
+}
+
+void TimerWheel::schedule(Timer& timer, Clock::duration delay, Callback callback) {
+    if (timer.wheel_) unlink(timer);
+    // 到期时刻所在 tick 的下一个：advance 推进到它时一定已过 now + delay，定时器不会早于 delay 触发。
+    // 相对“现在”而不是已处理到的 tick：advance 之间过去的时间也要算上
+    uint64_t due = tickOf(Clock::now() + std::max(delay, Clock::duration::zero())) + 1;
+    timer.expires_ = std::clamp<uint64_t>(due, current_ + 1, current_ + kMaxDelta);
+    timer.callback_ = std::move(callback);
+    timer.wheel_ = this;
+    link(timer);
+    count_++;
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    if (timer.wheel_ != this) return;
+    unlink(timer);
+    timer.wheel_ = nullptr;
+    timer.callback_ = nullptr;
+    count_--;
+}
+
+void TimerWheel::link(Timer& timer) {
+    uint64_t delta = timer.expires_ > current_ ? timer.expires_ - current_ : 0;
+    int level = 0;
+    while (level < kLevels - 1 && delta >= (uint64_t(1) << (kSlotBits * (level + 1)))) level++;
+    // 已到期（级联时可能出现）的放进下一个要处理的槽
+    uint64_t expires = std::max(timer.expires_, current_ + 1);
+    int slot = static_cast<int>((expires >> (kSlotBits * level)) & kSlotMask);
+
+    timer.level_ = level;
+    timer.slot_ = slot;
+    timer.prev_ = nullptr;
+    timer.next_ = slots_[level][slot];
+    if (timer.next_) timer.next_->prev_ = &timer;
+    slots_[level][slot] = &timer;
+    occupied_[level] |= uint64_t(1) << slot;
+}
+
+void TimerWheel::unlink(Timer& timer) {
+    if (timer.prev_) {
+        timer.prev_->next_ = timer.next_;
+    } else {
+        slots_[timer.level_][timer.slot_] = timer.next_;
+    }
+    if (timer.next_) timer.next_->prev_ = timer.prev_;
+    if (!slots_[timer.level_][timer.slot_]) occupied_[timer.level_] &= ~(uint64_t(1) << timer.slot_);
+    timer.prev_ = timer.next_ = nullptr;
+}
+
+void TimerWheel::cascade(int level) {
+    int slot = static_cast<int>((current_ >> (kSlotBits * level)) & kSlotMask);
+    Timer* timer = slots_[level][slot];
+    slots_[level][slot] = nullptr;
+    occupied_[level] &= ~(uint64_t(1) << slot);
+    while (timer) {
+        Timer* next = timer->next_;
+        link(*timer);
+        timer = next;
+    }
+}
+
+size_t TimerWheel::advance(Clock::time_point now) {
+    uint64_t target = tickOf(now);
+    size_t fired = 0;
+    while (current_ < target) {
+        if (count_ == 0) {
+            current_ = target;
+            break;
+        }
+        current_++;
+        // 下层转完一圈：依次把上层当前槽分配下来
+        for (int level = 1; level < kLevels; level++) {
+            if ((current_ & ((uint64_t(1) << (kSlotBits * level)) - 1)) != 0) break;
+            cascade(level);
+        }
+
+        int slot = static_cast<int>(current_ & kSlotMask);
+        while (Timer* timer = slots_[0][slot]) {
+            // 回调可能销毁定时器所在的对象，先摘下再调用
+            Callback callback = std::move(timer->callback_);
+            cancel(*timer);
+            fired++;
+            callback();
+        }
+    }
+    return fired;
+}
+
+int TimerWheel::timeoutMs(Clock::time_point now) const {
+    if (count_ == 0) return -1;
+
+    // 第 0 层中当前位置之后最近的非空槽；没有时等到第 0 层转完一圈（届时有上层的定时器分配下来）
+    uint64_t ticks = kSlots - (current_ & kSlotMask);
+    int offset = static_cast<int>((current_ + 1) & kSlotMask);
+    uint64_t rotated = std::rotr(occupied_[0], offset);
+    if (rotated) ticks = std::countr_zero(rotated) + 1;
+
+    auto due = start_ + tick_ * static_cast<int64_t>(current_ + ticks);
+    if (due <= now) return 0;
+    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(due - now + std::chrono::microseconds(999));
+    return static_cast<int>(std::min<int64_t>(wait.count(), 24 * 3600 * 1000));
+}
+
+// ========== TimerService ==========
+TimerService& TimerService::getInstance() {
+    static TimerService instance;
+    return instance;
+}
+
+TimerService::TimerService() : wheel_(std::chrono::milliseconds(10)) {
+    thread_ = std::thread(&TimerService::run, this);
+}
+
+TimerService::~TimerService() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_ = false;
+    }
+    cv_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+void TimerService::schedule(Timer& timer, TimerWheel::Clock::duration delay, TimerWheel::Callback callback) {
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wasEmpty = wheel_.size() == 0;
+        wheel_.schedule(timer, delay, std::move(callback));
+    }
+    // 驱动线程只在轮为空时无限期等待，其余时候按 timeoutMs 定时醒来
+    if (wasEmpty) cv_.notify_one();
+}
+
+void TimerService::cancel(Timer& timer) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    wheel_.cancel(timer);
+}
+
+void TimerService::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (running_) {
+        int timeout = wheel_.timeoutMs(TimerWheel::Clock::now());
+        if (timeout < 0) {
+            cv_.wait(lock);
+        } else if (timeout > 0) {
+            cv_.wait_for(lock, std::chrono::milliseconds(timeout));
+        }
+        // 回调在持锁时执行：cancel 返回即保证回调不在执行
+        wheel_.advance(TimerWheel::Clock::now());
+    }
+}
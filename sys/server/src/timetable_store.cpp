@@ -0,0 +1,356 @@
+#include "timetable_store.hpp"
+#include "logger.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+int toInt(const std::map<std::string, std::string>& row, const std::string& field) {
+    auto it = row.find(field);
+    if (it == row.end() || it->second.empty()) return 0;
+    try {
+        return std::stoi(it->second);
+    } catch (...) {
+        return 0;
+    }
+}
+
+// v_schedule_detail 的输出列，物化结果必须与原先直接查视图的响应保持一致
+const char* kViewColumns[] = {
+    "schedule_id", "semester", "weekday", "start_section", "end_section",
+    "start_week", "end_week", "week_type", "course_code", "course_name",
+    "teacher_code", "teacher_name", "classroom_code", "classroom_name",
+    "building", "class_code", "class_name"
+};
+
+} // namespace
+
+TimetableStore& TimetableStore::getInstance() {
+    static TimetableStore instance;
+    return instance;
+}
+
+TimetableStore::TimetableStore()
+    : loaded_(false), empty_(std::make_shared<const std::string>("[]")) {}
+
+void TimetableStore::setLoader(RowLoader loader) {
+    loader_ = loader;
+}
+
+std::string TimetableStore::key(int id, const std::string& semester) {
+    return std::to_string(id) + "|" + semester;
+}
+
+std::string TimetableStore::selectSql() {
+    return R"(
+        SELECT s.id AS schedule_id, s.course_id, s.teacher_id, s.classroom_id, s.class_id,
+               s.semester, s.weekday, s.start_section, s.end_section,
+               s.start_week, s.end_week, s.week_type,
+               c.course_code, c.name AS course_name,
+               t.teacher_code, t.name AS teacher_name,
+               cr.classroom_code, cr.name AS classroom_name, cr.building,
+               ci.class_code, ci.class_name
+        FROM schedule s
+        JOIN course c ON s.course_id = c.id
+        JOIN teacher t ON s.teacher_id = t.id
+        JOIN classroom cr ON s.classroom_id = cr.id
+        LEFT JOIN class_info ci ON s.class_id = ci.id
+    )";
+}
+
+TimetableEntry TimetableStore::entryFromRow(const Row& row) {
+    TimetableEntry entry;
+    entry.scheduleId = toInt(row, "schedule_id");
+    entry.courseId = toInt(row, "course_id");
+    entry.teacherId = toInt(row, "teacher_id");
+    entry.classroomId = toInt(row, "classroom_id");
+    entry.classId = toInt(row, "class_id");
+    entry.weekday = toInt(row, "weekday");
+    entry.startSection = toInt(row, "start_section");
+    auto it = row.find("semester");
+    if (it != row.end()) entry.semester = it->second;
+
+    Row viewRow;
+    for (const char* column : kViewColumns) {
+        auto field = row.find(column);
+        viewRow[column] = field != row.end() ? field->second : "";
+    }
+    entry.json = Json::fromDbRow(viewRow);
+    return entry;
+}
+
+bool TimetableStore::load() {
+    if (!loader_) return false;
+
+    auto scheduleRows = loader_(selectSql());
+    auto enrollmentRows = loader_("SELECT student_id, course_id, semester FROM enrollment WHERE status = 'enrolled'");
+
+    std::vector<TimetableEntry> entries;
+    entries.reserve(scheduleRows.size());
+    for (const auto& row : scheduleRows) {
+        entries.push_back(entryFromRow(row));
+    }
+
+    {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        schedules_.clear();
+        courseSchedules_.clear();
+        teacherSchedules_.clear();
+        studentCourses_.clear();
+        courseStudents_.clear();
+        studentJson_.clear();
+        teacherJson_.clear();
+
+        for (const auto& row : enrollmentRows) {
+            int studentId = toInt(row, "student_id");
+            int courseId = toInt(row, "course_id");
+            const std::string& semester = row.at("semester");
+            studentCourses_[key(studentId, semester)].insert(courseId);
+            courseStudents_[key(courseId, semester)].insert(studentId);
+        }
+
+        std::set<std::string> students, teachers;
+        for (const auto& entry : entries) {
+            insertEntry(entry, students, teachers);
+        }
+        // 没有排课的选课也要物化（结果为空数组）
+        for (const auto& [k, courses] : studentCourses_) {
+            students.insert(k);
+        }
+        rebuild(students, teachers);
+        loaded_ = true;
+    }
+
+    LOG_INFO("课表物化完成: 排课 %zu 条, 学生课表 %zu 份, 教师课表 %zu 份", entries.size(), studentCount(),
+             teacherCount());
+    return true;
+}
+
+bool TimetableStore::isLoaded() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return loaded_;
+}
+
+TimetableStore::JsonPtr TimetableStore::studentTimetable(int studentId, const std::string& semester) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = studentJson_.find(key(studentId, semester));
+    return it != studentJson_.end() ? it->second : empty_;
+}
+
+TimetableStore::JsonPtr TimetableStore::teacherTimetable(int teacherId, const std::string& semester) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    auto it = teacherJson_.find(key(teacherId, semester));
+    return it != teacherJson_.end() ? it->second : empty_;
+}
+
+void TimetableStore::refreshSchedules(const std::string& column, int id) {
+    refreshSchedules(column, std::vector<int>{id});
+}
+
+void TimetableStore::refreshSchedules(const std::string& column, const std::vector<int>& ids) {
+    static const std::set<std::string> allowed = {"id", "course_id", "teacher_id", "classroom_id", "class_id"};
+    if (!loader_ || !allowed.count(column) || ids.empty()) return;
+
+    std::string list;
+    for (int id : ids) {
+        if (!list.empty()) list += ", ";
+        list += std::to_string(id);
+    }
+    auto rows = loader_(selectSql() + " WHERE s." + column + " IN (" + list + ")");
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!loaded_) return;
+
+    // 先移除内存中属于这些对象的排课，再写入数据库中的最新数据（已删除的自然消失）
+    std::vector<int> stale;
+    if (column == "id") {
+        stale = ids;
+    } else if (column == "course_id" || column == "teacher_id") {
+        const auto& index = column == "course_id" ? courseSchedules_ : teacherSchedules_;
+        for (int id : ids) {
+            auto it = index.find(id);
+            if (it != index.end()) stale.insert(stale.end(), it->second.begin(), it->second.end());
+        }
+    } else {
+        const std::set<int> wanted(ids.begin(), ids.end());
+        for (const auto& [scheduleId, entry] : schedules_) {
+            int value = column == "classroom_id" ? entry.classroomId : entry.classId;
+            if (wanted.count(value)) stale.push_back(scheduleId);
+        }
+    }
+
+    std::set<std::string> students, teachers;
+    for (int scheduleId : stale) {
+        eraseEntry(scheduleId, students, teachers);
+    }
+    for (const auto& row : rows) {
+        insertEntry(entryFromRow(row), students, teachers);
+    }
+    rebuild(students, teachers);
+}
+
+void TimetableStore::removeSchedule(int scheduleId) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::set<std::string> students, teachers;
+    eraseEntry(scheduleId, students, teachers);
+    rebuild(students, teachers);
+}
+
+void TimetableStore::addEnrollment(int studentId, int courseId, const std::string& semester) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::string k = key(studentId, semester);
+    studentCourses_[k].insert(courseId);
+    courseStudents_[key(courseId, semester)].insert(studentId);
+    rebuildStudent(k);
+}
+
+void TimetableStore::removeEnrollment(int studentId, int courseId, const std::string& semester) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::string k = key(studentId, semester);
+
+    auto it = studentCourses_.find(k);
+    if (it != studentCourses_.end()) {
+        it->second.erase(courseId);
+        if (it->second.empty()) studentCourses_.erase(it);
+    }
+    auto cs = courseStudents_.find(key(courseId, semester));
+    if (cs != courseStudents_.end()) {
+        cs->second.erase(studentId);
+        if (cs->second.empty()) courseStudents_.erase(cs);
+    }
+    rebuildStudent(k);
+}
+
+void TimetableStore::applySchedules(const std::vector<TimetableEntry>& entries) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::set<std::string> students, teachers;
+    for (const auto& entry : entries) {
+        eraseEntry(entry.scheduleId, students, teachers);
+        insertEntry(entry, students, teachers);
+    }
+    for (const auto& [k, courses] : studentCourses_) {
+        if (!studentJson_.count(k)) students.insert(k);
+    }
+    rebuild(students, teachers);
+    loaded_ = true;
+}
+
+size_t TimetableStore::studentCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return studentJson_.size();
+}
+
+size_t TimetableStore::teacherCount() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return teacherJson_.size();
+}
+
+// ========== 内部方法（需持有写锁） ==========
+void TimetableStore::collectCourseStudents(int courseId, const std::string& semester,
+                                           std::set<std::string>& students) const {
+    auto it = courseStudents_.find(key(courseId, semester));
+    if (it == courseStudents_.end()) return;
+    for (int studentId : it->second) {
+        students.insert(key(studentId, semester));
+    }
+}
+
+void TimetableStore::insertEntry(const TimetableEntry& entry, std::set<std::string>& students,
+                                 std::set<std::string>& teachers) {
+    schedules_[entry.scheduleId] = entry;
+    courseSchedules_[entry.courseId].insert(entry.scheduleId);
+    teacherSchedules_[entry.teacherId].insert(entry.scheduleId);
+
+    teachers.insert(key(entry.teacherId, entry.semester));
+    collectCourseStudents(entry.courseId, entry.semester, students);
+}
+
+void TimetableStore::eraseEntry(int scheduleId, std::set<std::string>& students, std::set<std::string>& teachers) {
+    auto it = schedules_.find(scheduleId);
+    if (it == schedules_.end()) return;
+    const TimetableEntry& entry = it->second;
+
+    teachers.insert(key(entry.teacherId, entry.semester));
+    collectCourseStudents(entry.courseId, entry.semester, students);
+
+    auto cs = courseSchedules_.find(entry.courseId);
+    if (cs != courseSchedules_.end()) {
+        cs->second.erase(scheduleId);
+        if (cs->second.empty()) courseSchedules_.erase(cs);
+    }
+    auto ts = teacherSchedules_.find(entry.teacherId);
+    if (ts != teacherSchedules_.end()) {
+        ts->second.erase(scheduleId);
+        if (ts->second.empty()) teacherSchedules_.erase(ts);
+    }
+    schedules_.erase(it);
+}
+
+TimetableStore::JsonPtr TimetableStore::serialize(std::vector<const TimetableEntry*>& entries) const {
+    if (entries.empty()) return empty_;
+
+    std::sort(entries.begin(), entries.end(), [](const TimetableEntry* a, const TimetableEntry* b) {
+        if (a->weekday != b->weekday) return a->weekday < b->weekday;
+        if (a->startSection != b->startSection) return a->startSection < b->startSection;
+        return a->scheduleId < b->scheduleId;
+    });
+
+    size_t size = 2;
+    for (const auto* entry : entries) size += entry->json.size() + 1;
+
+    std::string out;
+    out.reserve(size);
+    out.push_back('[');
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (i > 0) out.push_back(',');
+        out += entries[i]->json;
+    }
+    out.push_back(']');
+    return std::make_shared<const std::string>(std::move(out));
+}
+
+void TimetableStore::rebuildStudent(const std::string& k) {
+    auto courses = studentCourses_.find(k);
+    if (courses == studentCourses_.end()) {
+        studentJson_.erase(k);
+        return;
+    }
+    std::string semester = k.substr(k.find('|') + 1);
+
+    std::vector<const TimetableEntry*> entries;
+    for (int courseId : courses->second) {
+        auto cs = courseSchedules_.find(courseId);
+        if (cs == courseSchedules_.end()) continue;
+        for (int scheduleId : cs->second) {
+            const TimetableEntry& entry = schedules_.at(scheduleId);
+            if (entry.semester == semester) entries.push_back(&entry);
+        }
+    }
+    studentJson_[k] = serialize(entries);
+}
+
+void TimetableStore::rebuildTeacher(const std::string& k) {
+    size_t sep = k.find('|');
+    int teacherId = std::stoi(k.substr(0, sep));
+    std::string semester = k.substr(sep + 1);
+
+    std::vector<const TimetableEntry*> entries;
+    auto ts = teacherSchedules_.find(teacherId);
+    if (ts != teacherSchedules_.end()) {
+        for (int scheduleId : ts->second) {
+            const TimetableEntry& entry = schedules_.at(scheduleId);
+            if (entry.semester == semester) entries.push_back(&entry);
+        }
+    }
+    if (entries.empty()) {
+        teacherJson_.erase(k);
+    } else {
+        teacherJson_[k] = serialize(entries);
+    }
+}
+
+void TimetableStore::rebuild(const std::set<std::string>& students, const std::set<std::string>& teachers) {
+    for (const auto& k : students) rebuildStudent(k);
+    for (const auto& k : teachers) rebuildTeacher(k);
+}
@@ -0,0 +1,175 @@
+#include "tracer.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <cstdio>
+
+namespace {
+
+// 线程局部的 xorshift 随机数，用于采样判断
+uint32_t nextRandom() {
+    thread_local uint32_t state = static_cast<uint32_t>(
+        std::chrono::steady_clock::now().time_since_epoch().count()) | 1u;
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+std::string micros(Tracer::Clock::duration d) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "%.3f", std::chrono::duration<double, std::micro>(d).count());
+    return buf;
+}
+
+} // namespace
+
+thread_local Tracer::Trace Tracer::current_;
+
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::Tracer()
+    : sampleThreshold_(0), minDurationNs_(0), nextId_(1), epoch_(Clock::now()), capacity_(1000) {}
+
+void Tracer::setSampleRate(double rate) {
+    rate = std::clamp(rate, 0.0, 1.0);
+    // 阈值为0表示关闭；采样率为1时取最大值（极小概率漏采可以忽略）
+    uint32_t threshold = rate >= 1.0 ? UINT32_MAX : static_cast<uint32_t>(rate * 4294967296.0);
+    sampleThreshold_.store(threshold, std::memory_order_relaxed);
+}
+
+double Tracer::sampleRate() const {
+    uint32_t threshold = sampleThreshold_.load(std::memory_order_relaxed);
+    return threshold == UINT32_MAX ? 1.0 : threshold / 4294967296.0;
+}
+
+void Tracer::setMinDurationMs(int ms) {
+    minDurationNs_.store(std::max(0, ms) * 1000000LL, std::memory_order_relaxed);
+}
+
+int Tracer::minDurationMs() const {
+    return static_cast<int>(minDurationNs_.load(std::memory_order_relaxed) / 1000000);
+}
+
+void Tracer::setCapacity(size_t traces) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = std::max<size_t>(1, traces);
+    while (traces_.size() > capacity_) traces_.pop_front();
+}
+
+// ========== 记录 ==========
+void Tracer::beginRequest(Clock::time_point start) {
+    uint32_t threshold = sampleThreshold_.load(std::memory_order_relaxed);
+    active_ = threshold != 0 && nextRandom() <= threshold;
+    if (!active_) return;
+
+    current_.id = nextId_.fetch_add(1, std::memory_order_relaxed);
+    current_.start = start;
+    current_.spans.clear();
+}
+
+void Tracer::record(const char* name, Clock::time_point start, Clock::time_point end, const std::string& detail) {
+    current_.spans.push_back({name, detail, start, end});
+}
+
+void Tracer::endRequest(const std::string& name, int statusCode) {
+    if (!active_) return;
+    active_ = false;
+
+    current_.end = Clock::now();
+    if (current_.end - current_.start < std::chrono::nanoseconds(minDurationNs_.load(std::memory_order_relaxed))) {
+        return;
+    }
+    current_.name = name;
+    current_.statusCode = statusCode;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    traces_.push_back(std::move(current_));
+    current_ = Trace();
+    while (traces_.size() > capacity_) traces_.pop_front();
+}
+
+Tracer::Context Tracer::detach() {
+    Context context;
+    context.active = active_;
+    if (active_) {
+        context.trace = std::move(current_);
+        current_ = Trace();
+        active_ = false;
+    }
+    return context;
+}
+
+void Tracer::attach(Context&& context) {
+    active_ = context.active;
+    if (active_) current_ = std::move(context.trace);
+}
+
+void Tracer::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    traces_.clear();
+}
+
+size_t Tracer::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return traces_.size();
+}
+
+// ========== 导出 ==========
+// 每个请求占一行（tid = 请求编号），行名为 "方法 路径 状态码"
+std::string Tracer::exportJson(size_t limit) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t first = traces_.size() > limit ? traces_.size() - limit : 0;
+
+    std::string out = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool firstEvent = true;
+    auto append = [&](const std::map<std::string, std::string>& event) {
+        if (!firstEvent) out += ",";
+        out += Json::object(event);
+        firstEvent = false;
+    };
+
+    for (size_t i = first; i < traces_.size(); i++) {
+        const Trace& trace = traces_[i];
+        std::string tid = std::to_string(trace.id);
+
+        std::map<std::string, std::string> meta;
+        meta["name"] = Json::string("thread_name");
+        meta["ph"] = Json::string("M");
+        meta["pid"] = "1";
+        meta["tid"] = tid;
+        meta["args"] = "{\"name\":" + Json::string(trace.name + " " + std::to_string(trace.statusCode)) + "}";
+        append(meta);
+
+        std::map<std::string, std::string> request;
+        request["name"] = Json::string(trace.name);
+        request["cat"] = Json::string("request");
+        request["ph"] = Json::string("X");
+        request["pid"] = "1";
+        request["tid"] = tid;
+        request["ts"] = micros(trace.start - epoch_);
+        request["dur"] = micros(trace.end - trace.start);
+        request["args"] = "{\"status\":" + std::to_string(trace.statusCode) + "}";
+        append(request);
+
+        for (const auto& span : trace.spans) {
+            std::string name = span.name;
+            std::map<std::string, std::string> event;
+            event["name"] = Json::string(name);
+            event["cat"] = Json::string(name.substr(0, name.find('.')));     // server / db / handler
+            event["ph"] = Json::string("X");
+            event["pid"] = "1";
+            event["tid"] = tid;
+            event["ts"] = micros(span.start - epoch_);
+            event["dur"] = micros(span.end - span.start);
+            if (!span.detail.empty()) {
+                event["args"] = "{\"detail\":" + Json::string(span.detail) + "}";
+            }
+            append(event);
+        }
+    }
+    out += "]}";
+    return out;
+}
@@ -0,0 +1,232 @@
+#include "user_import.hpp"
+#include "db.hpp"
+#include "auth_service.hpp"
+#include "json.hpp"
+#include "csv.hpp"
+#include "logger.hpp"
+#include <unordered_set>
+#include <algorithm>
+#include <cctype>
+
+namespace {
+
+std::string normalizeRole(const std::string& role) {
+    std::string lower = role;
+    std::transform(lower.begin(), lower.end(), lower.begin(), [](unsigned char c) { return std::tolower(c); });
+    if (lower == "admin" || role == "管理员") return "admin";
+    if (lower == "teacher" || role == "教师") return "teacher";
+    if (lower == "student" || role == "学生") return "student";
+    return "";
+}
+
+// 去重用的用户名：user.username 的唯一约束不区分大小写（utf8mb4_unicode_ci），"Alice" 与 "alice" 视为重复
+std::string foldUsername(const std::string& username) {
+    std::string folded = username;
+    std::transform(folded.begin(), folded.end(), folded.begin(), [](unsigned char c) { return std::tolower(c); });
+    return folded;
+}
+
+bool validUsername(const std::string& username) {
+    if (username.empty() || username.size() > 50) return false;
+    for (unsigned char c : username) {
+        if (c <= ' ' || c == '\'' || c == '"' || c == '\\' || c == 0x7f) return false;
+    }
+    return true;
+}
+
+// 取出JSON对象中字符串字段的值并解码转义（Json::parse 不处理转义，多行文本会被截断）
+bool jsonStringField(const std::string& json, const std::string& key, std::string& value) {
+    std::string quoted = "\"" + key + "\"";
+    size_t pos = json.find(quoted);
+    if (pos == std::string::npos) return false;
+    pos = json.find(':', pos + quoted.size());
+    if (pos == std::string::npos) return false;
+    pos = json.find_first_not_of(" \t\r\n", pos + 1);
+    if (pos == std::string::npos) return false;
+    return Json::readString(json, pos, value) != std::string::npos;
+}
+
+} // namespace
+
+std::string UserImport::extractCsv(const std::string& body, const std::string& contentType,
+                                   std::string& defaultPassword) {
+    if (contentType.find("text/csv") != std::string::npos || contentType.find("text/plain") != std::string::npos) {
+        return body;
+    }
+    std::string csv;
+    jsonStringField(body, "users", csv);
+    std::string password;
+    if (jsonStringField(body, "default_password", password) && !password.empty()) {
+        defaultPassword = password;
+    }
+    return csv;
+}
+
+std::vector<UserImportLine> UserImport::parse(std::string_view csv) {
+    std::vector<UserImportLine> lines;
+    size_t pos = 0;
+    int lineNo = 0;
+    bool first = true;
+    while (pos < csv.size()) {
+        size_t end = csv.find('\n', pos);
+        if (end == std::string_view::npos) end = csv.size();
+        std::string_view text = Csv::trim(csv.substr(pos, end - pos));
+        pos = end + 1;
+        lineNo++;
+        if (text.empty()) continue;
+
+        auto fields = Csv::splitLine(text);
+        if (first) {
+            first = false;
+            std::string head = fields[0];
+            std::transform(head.begin(), head.end(), head.begin(), [](unsigned char c) { return std::tolower(c); });
+            if (head == "username" || head == "用户名") continue;
+        }
+
+        UserImportLine line;
+        line.line = lineNo;
+        line.username = fields[0];
+        if (fields.size() > 1) line.realName = fields[1];
+        if (fields.size() > 2) line.role = normalizeRole(fields[2]);
+        if (fields.size() > 3) line.email = fields[3];
+        if (fields.size() > 4) line.phone = fields[4];
+        if (fields.size() > 5) line.password = fields[5];
+
+        if (fields.size() < 3) {
+            line.error = "字段不足，至少需要 username,real_name,role";
+        } else if (!validUsername(line.username)) {
+            line.error = "用户名为空、过长或含非法字符";
+        } else if (line.role.empty()) {
+            line.error = "角色必须为 admin/teacher/student";
+        } else if (line.realName.size() > 100 || line.email.size() > 100 || line.phone.size() > 20) {
+            line.error = "字段过长";
+        }
+        if (!line.error.empty()) line.status = "invalid";
+        lines.push_back(std::move(line));
+    }
+    return lines;
+}
+
+UserImport::Result UserImport::run(std::string_view csv, const std::string& defaultPassword, Report& report) {
+    report = Report{};
+    report.lines = parse(csv);
+    auto& lines = report.lines;
+    if (lines.size() > kMaxLines) return Result::TooLarge;
+
+    // 文件内去重：同名（不区分大小写）的后续行标记为 duplicate
+    std::vector<size_t> pending;
+    pending.reserve(lines.size());
+    {
+        std::unordered_set<std::string> seen;
+        seen.reserve(lines.size() * 2);
+        for (size_t i = 0; i < lines.size(); i++) {
+            if (!lines[i].status.empty()) continue;
+            if (!seen.insert(foldUsername(lines[i].username)).second) {
+                lines[i].status = "duplicate";
+                lines[i].error = "与前面的行重复";
+                continue;
+            }
+            pending.push_back(i);
+        }
+    }
+
+    // 与已有用户去重：按组用 IN 查询（MySQL 按列的排序规则不区分大小写比较），转义结果留给 INSERT 复用
+    auto& db = Database::getInstance();
+    std::vector<std::string> escaped(lines.size());
+    std::unordered_set<std::string> existing;
+    for (size_t begin = 0; begin < pending.size(); begin += kBatchSize) {
+        size_t end = std::min(begin + kBatchSize, pending.size());
+        std::string sql = "SELECT username FROM user WHERE username IN (";
+        for (size_t j = begin; j < end; j++) {
+            size_t i = pending[j];
+            escaped[i] = db.escape(lines[i].username);
+            if (j > begin) sql += ", ";
+            sql += "'" + escaped[i] + "'";
+        }
+        sql += ")";
+        for (const auto& row : db.query(sql)) {
+            existing.insert(foldUsername(row.at("username")));
+        }
+    }
+    std::vector<size_t> toInsert;
+    toInsert.reserve(pending.size());
+    for (size_t i : pending) {
+        if (existing.count(foldUsername(lines[i].username))) {
+            lines[i].status = "exists";
+            lines[i].error = "用户名已存在";
+        } else {
+            toInsert.push_back(i);
+        }
+    }
+
+    // 密码哈希：指定密码的行并行计算，默认密码整批只算一次（排在最后一起提交）
+    std::vector<std::string> passwords;
+    std::vector<size_t> withPassword;
+    bool needDefault = false;
+    for (size_t i : toInsert) {
+        if (lines[i].password.empty()) {
+            needDefault = true;
+        } else {
+            withPassword.push_back(i);
+            passwords.push_back(lines[i].password);
+        }
+    }
+    if (needDefault) passwords.push_back(defaultPassword);
+    std::vector<std::string> hashes(lines.size());
+    if (!passwords.empty()) {
+        auto computed = AuthService::getInstance().hashPasswords(passwords);
+        if (computed.empty()) return Result::Busy;
+        for (size_t k = 0; k < withPassword.size(); k++) hashes[withPassword[k]] = std::move(computed[k]);
+        if (needDefault) {
+            for (size_t i : toInsert) {
+                if (lines[i].password.empty()) hashes[i] = computed.back();
+            }
+        }
+    }
+
+    // 多行 INSERT，全部在一个事务中执行
+    std::vector<std::string> statements;
+    for (size_t begin = 0; begin < toInsert.size(); begin += kBatchSize) {
+        size_t end = std::min(begin + kBatchSize, toInsert.size());
+        std::string sql = "INSERT INTO user (username, password_hash, real_name, role, email, phone) VALUES ";
+        sql.reserve(sql.size() + (end - begin) * 200);
+        for (size_t j = begin; j < end; j++) {
+            const auto& line = lines[toInsert[j]];
+            if (j > begin) sql += ", ";
+            sql += "('" + escaped[toInsert[j]] + "', '" + db.escape(hashes[toInsert[j]]) + "', '" +
+                   db.escape(line.realName) + "', '" + line.role + "', '" +
+                   db.escape(line.email) + "', '" + db.escape(line.phone) + "')";
+        }
+        statements.push_back(std::move(sql));
+    }
+    bool ok = statements.empty() || db.executeTransaction(statements);
+    for (size_t i : toInsert) {
+        lines[i].status = ok ? "created" : "failed";
+        if (!ok) lines[i].error = "写入失败，已回滚";
+    }
+    for (const auto& line : lines) {
+        if (line.status == "created") report.created++; else report.failed++;
+    }
+    if (!ok) {
+        LOG_ERROR("批量导入用户失败，%zu 行已回滚", toInsert.size());
+        return Result::DbError;
+    }
+    LOG_INFO("批量导入用户: 成功 %d，失败 %d", report.created, report.failed);
+    return Result::Ok;
+}
+
+std::string UserImport::Report::toJson() const {
+    std::string json = "{\"success\": " + std::to_string(created) + ", \"failed\": " + std::to_string(failed) +
+                       ", \"results\": [";
+    json.reserve(json.size() + lines.size() * 64);
+    for (size_t i = 0; i < lines.size(); i++) {
+        const auto& line = lines[i];
+        if (i > 0) json += ", ";
+        json += "{\"line\": " + std::to_string(line.line) + ", \"username\": \"" +
+                Json::escapeString(line.username) + "\", \"status\": \"" + line.status + "\"";
+        if (!line.error.empty()) json += ", \"error\": \"" + Json::escapeString(line.error) + "\"";
+        json += "}";
+    }
+    json += "]}";
+    return json;
+}
@@ -0,0 +1,345 @@
+#include "utilization_stats.hpp"
+#include "logger.hpp"
+#include "json.hpp"
+#include <algorithm>
+#include <mutex>
+
+namespace {
+
+int toInt(const std::map<std::string, std::string>& row, const std::string& field) {
+    auto it = row.find(field);
+    if (it == row.end() || it->second.empty()) return 0;
+    try {
+        return std::stoi(it->second);
+    } catch (...) {
+        return 0;
+    }
+}
+
+std::string field(const std::map<std::string, std::string>& row, const std::string& name) {
+    auto it = row.find(name);
+    return it != row.end() ? it->second : "";
+}
+
+const char* kLessonSql =
+    "SELECT id, classroom_id, course_id, semester, weekday, start_section, end_section, "
+    "start_week, end_week, week_type FROM schedule";
+
+const char* kClassroomSql =
+    "SELECT id, classroom_code, name, building, category, seats FROM classroom";
+
+// 学期没有任何排课时的默认周数
+const int kDefaultWeeks = 16;
+
+} // namespace
+
+UtilizationStats& UtilizationStats::getInstance() {
+    static UtilizationStats instance;
+    return instance;
+}
+
+UtilizationStats::UtilizationStats() : loaded_(false) {}
+
+void UtilizationStats::setLoader(RowLoader loader) {
+    loader_ = loader;
+}
+
+UtilizationStats::Lesson UtilizationStats::lessonFromRow(const Row& row) {
+    Lesson lesson;
+    lesson.id = toInt(row, "id");
+    lesson.classroomId = toInt(row, "classroom_id");
+    lesson.courseId = toInt(row, "course_id");
+    lesson.semester = field(row, "semester");
+    lesson.weekday = toInt(row, "weekday");
+    lesson.startSection = toInt(row, "start_section");
+    lesson.endSection = toInt(row, "end_section");
+    lesson.startWeek = toInt(row, "start_week");
+    lesson.endWeek = toInt(row, "end_week");
+    lesson.weekType = field(row, "week_type");
+    return lesson;
+}
+
+bool UtilizationStats::load() {
+    if (!loader_) return false;
+
+    auto roomRows = loader_(kClassroomSql);
+    auto lessonRows = loader_(kLessonSql);
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    rooms_.clear();
+    lessons_.clear();
+    semesterEndWeeks_.clear();
+
+    for (const auto& row : roomRows) {
+        Room room;
+        room.id = toInt(row, "id");
+        room.code = field(row, "classroom_code");
+        room.name = field(row, "name");
+        room.building = field(row, "building");
+        room.category = field(row, "category");
+        room.seats = toInt(row, "seats");
+        rooms_[room.id] = room;
+    }
+
+    std::set<int> dirtyRooms;
+    for (const auto& row : lessonRows) {
+        insertLesson(lessonFromRow(row), dirtyRooms);
+    }
+    for (int classroomId : dirtyRooms) {
+        rebuildRoom(classroomId);
+    }
+    loaded_ = true;
+
+    LOG_INFO("教室利用率统计加载完成: 教室 %zu 间, 排课 %zu 条", rooms_.size(), lessons_.size());
+    return true;
+}
+
+bool UtilizationStats::isLoaded() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return loaded_;
+}
+
+void UtilizationStats::refreshClassroom(int classroomId) {
+    if (!loader_) return;
+    auto rows = loader_(std::string(kClassroomSql) + " WHERE id = " + std::to_string(classroomId));
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!loaded_) return;
+
+    if (rows.empty()) {
+        // 教室已删除，排课随外键级联删除
+        auto it = rooms_.find(classroomId);
+        if (it == rooms_.end()) return;
+        std::set<int> dirtyRooms;
+        for (int lessonId : std::set<int>(it->second.lessons)) {
+            eraseLesson(lessonId, dirtyRooms);
+        }
+        rooms_.erase(classroomId);
+        return;
+    }
+
+    Room& room = rooms_[classroomId];
+    room.id = classroomId;
+    room.code = field(rows[0], "classroom_code");
+    room.name = field(rows[0], "name");
+    room.building = field(rows[0], "building");
+    room.category = field(rows[0], "category");
+    room.seats = toInt(rows[0], "seats");
+}
+
+void UtilizationStats::refreshSchedules(const std::string& column, int id) {
+    refreshSchedules(column, std::vector<int>{id});
+}
+
+void UtilizationStats::refreshSchedules(const std::string& column, const std::vector<int>& ids) {
+    static const std::set<std::string> allowed = {"id", "course_id", "classroom_id"};
+    if (!loader_ || !allowed.count(column) || ids.empty()) return;
+
+    std::string list;
+    for (int id : ids) {
+        if (!list.empty()) list += ", ";
+        list += std::to_string(id);
+    }
+    auto rows = loader_(std::string(kLessonSql) + " WHERE " + column + " IN (" + list + ")");
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    if (!loaded_) return;
+
+    const std::set<int> wanted(ids.begin(), ids.end());
+    std::vector<int> stale;
+    for (const auto& [lessonId, lesson] : lessons_) {
+        int value = column == "id" ? lesson.id : column == "course_id" ? lesson.courseId : lesson.classroomId;
+        if (wanted.count(value)) stale.push_back(lessonId);
+    }
+
+    std::set<int> dirtyRooms;
+    for (int lessonId : stale) {
+        eraseLesson(lessonId, dirtyRooms);
+    }
+    for (const auto& row : rows) {
+        insertLesson(lessonFromRow(row), dirtyRooms);
+    }
+    for (int classroomId : dirtyRooms) {
+        rebuildRoom(classroomId);
+    }
+}
+
+void UtilizationStats::removeSchedule(int scheduleId) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    std::set<int> dirtyRooms;
+    eraseLesson(scheduleId, dirtyRooms);
+    for (int classroomId : dirtyRooms) {
+        rebuildRoom(classroomId);
+    }
+}
+
+// ========== 内部方法（需持有写锁） ==========
+void UtilizationStats::insertLesson(const Lesson& lesson, std::set<int>& dirtyRooms) {
+    eraseLesson(lesson.id, dirtyRooms);
+    lessons_[lesson.id] = lesson;
+    semesterEndWeeks_[lesson.semester].insert(lesson.endWeek);
+
+    auto it = rooms_.find(lesson.classroomId);
+    if (it != rooms_.end()) {
+        it->second.lessons.insert(lesson.id);
+    }
+    dirtyRooms.insert(lesson.classroomId);
+}
+
+void UtilizationStats::eraseLesson(int lessonId, std::set<int>& dirtyRooms) {
+    auto it = lessons_.find(lessonId);
+    if (it == lessons_.end()) return;
+    const Lesson& lesson = it->second;
+
+    auto weeks = semesterEndWeeks_.find(lesson.semester);
+    if (weeks != semesterEndWeeks_.end()) {
+        auto w = weeks->second.find(lesson.endWeek);
+        if (w != weeks->second.end()) weeks->second.erase(w);
+        if (weeks->second.empty()) semesterEndWeeks_.erase(weeks);
+    }
+
+    auto room = rooms_.find(lesson.classroomId);
+    if (room != rooms_.end()) {
+        room->second.lessons.erase(lessonId);
+    }
+    dirtyRooms.insert(lesson.classroomId);
+    lessons_.erase(it);
+}
+
+void UtilizationStats::setBits(WeekBits& bits, const Lesson& lesson) {
+    if (lesson.weekday < 1 || lesson.weekday > kWeekdays) return;
+
+    int firstWeek = std::max(1, lesson.startWeek);
+    int lastWeek = std::min(kMaxWeeks, lesson.endWeek);
+    int firstSection = std::max(1, lesson.startSection);
+    int lastSection = std::min(kSections, lesson.endSection);
+
+    for (int week = firstWeek; week <= lastWeek; week++) {
+        if (lesson.weekType == "odd" && week % 2 == 0) continue;
+        if (lesson.weekType == "even" && week % 2 == 1) continue;
+        for (int section = firstSection; section <= lastSection; section++) {
+            bits[week].set((lesson.weekday - 1) * kSections + (section - 1));
+        }
+    }
+}
+
+void UtilizationStats::rebuildRoom(int classroomId) {
+    auto it = rooms_.find(classroomId);
+    if (it == rooms_.end()) return;
+    Room& room = it->second;
+
+    // 单间教室的排课很少，整体重算比维护逐位引用计数更简单
+    room.occupancy.clear();
+    for (int lessonId : room.lessons) {
+        const Lesson& lesson = lessons_.at(lessonId);
+        setBits(room.occupancy[lesson.semester], lesson);
+    }
+}
+
+UtilizationStats::Usage UtilizationStats::count(const Room& room, const std::string& semester,
+                                                int startWeek, int endWeek) const {
+    static const SlotBits teachingMask = [] {
+        SlotBits mask;
+        for (int i = 0; i < kTeachingDays * kSections; i++) mask.set(i);
+        return mask;
+    }();
+
+    Usage usage;
+    auto it = room.occupancy.find(semester);
+    if (it == room.occupancy.end()) return usage;
+
+    for (int week = startWeek; week <= endWeek; week++) {
+        const SlotBits& bits = it->second[week];
+        usage.teachingSlots += static_cast<int>((bits & teachingMask).count());
+        usage.weekendSlots += static_cast<int>((bits & ~teachingMask).count());
+    }
+    return usage;
+}
+
+// ========== 查询 ==========
+std::string UtilizationStats::query(const std::string& semester, int startWeek, int endWeek,
+                                    const std::string& groupBy) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    if (startWeek <= 0) startWeek = 1;
+    if (endWeek <= 0) {
+        auto weeks = semesterEndWeeks_.find(semester);
+        endWeek = weeks != semesterEndWeeks_.end() ? *weeks->second.rbegin() : kDefaultWeeks;
+    }
+    startWeek = std::min(startWeek, kMaxWeeks);
+    endWeek = std::min(endWeek, kMaxWeeks);
+    int weeks = std::max(0, endWeek - startWeek + 1);
+    int slotsPerRoom = weeks * kTeachingDays * kSections;
+
+    auto rate = [](int used, int total) {
+        return total > 0 ? static_cast<double>(used) * 100.0 / total : 0.0;
+    };
+
+    if (groupBy == "building" || groupBy == "category") {
+        struct Group {
+            int rooms = 0;
+            int used = 0;
+            int weekend = 0;
+        };
+        std::map<std::string, Group> groups;
+        for (const auto& [id, room] : rooms_) {
+            Usage usage = count(room, semester, startWeek, endWeek);
+            Group& group = groups[groupBy == "building" ? room.building : room.category];
+            group.rooms++;
+            group.used += usage.teachingSlots;
+            group.weekend += usage.weekendSlots;
+        }
+
+        std::vector<std::pair<double, std::string>> items;
+        for (const auto& [name, group] : groups) {
+            int total = group.rooms * slotsPerRoom;
+            std::map<std::string, std::string> data;
+            data[groupBy] = name.empty() ? Json::null() : Json::string(name);
+            data["semester"] = Json::string(semester);
+            data["classrooms"] = Json::number(group.rooms);
+            data["used_slots"] = Json::number(group.used);
+            data["weekend_slots"] = Json::number(group.weekend);
+            data["total_slots"] = Json::number(total);
+            data["utilization_rate"] = Json::number(rate(group.used, total));
+            items.push_back({rate(group.used, total), Json::object(data)});
+        }
+        std::stable_sort(items.begin(), items.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        std::vector<std::string> result;
+        for (auto& item : items) result.push_back(std::move(item.second));
+        return Json::array(result);
+    }
+
+    struct Item {
+        double rate;
+        const std::string* code;
+        std::string json;
+    };
+    std::vector<Item> items;
+    items.reserve(rooms_.size());
+    for (const auto& [id, room] : rooms_) {
+        Usage usage = count(room, semester, startWeek, endWeek);
+        std::map<std::string, std::string> data;
+        data["classroom_id"] = Json::number(room.id);
+        data["classroom_code"] = Json::string(room.code);
+        data["classroom_name"] = Json::string(room.name);
+        data["building"] = room.building.empty() ? Json::null() : Json::string(room.building);
+        data["category"] = Json::string(room.category);
+        data["seats"] = Json::number(room.seats);
+        data["semester"] = Json::string(semester);
+        data["used_slots"] = Json::number(usage.teachingSlots);
+        data["weekend_slots"] = Json::number(usage.weekendSlots);
+        data["total_slots"] = Json::number(slotsPerRoom);
+        data["utilization_rate"] = Json::number(rate(usage.teachingSlots, slotsPerRoom));
+        items.push_back({rate(usage.teachingSlots, slotsPerRoom), &room.code, Json::object(data)});
+    }
+    std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+        if (a.rate != b.rate) return a.rate > b.rate;
+        return *a.code < *b.code;
+    });
+
+    std::vector<std::string> result;
+    result.reserve(items.size());
+    for (auto& item : items) result.push_back(std::move(item.json));
+    return Json::array(result);
+}
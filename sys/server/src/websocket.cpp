@@ -0,0 +1,162 @@
+#include "websocket.hpp"
+#include "http_server.hpp"
+#include <cstring>
+#include <strings.h>
+
+namespace {
+
+const char* kHandshakeGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+inline uint32_t rotl(uint32_t x, int n) {
+    return (x << n) | (x >> (32 - n));
+}
+
+// SHA-1 只用于握手（RFC 6455 规定的算法，不涉及安全性）
+std::string sha1(const std::string& data) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+    std::string message = data;
+    uint64_t bitLength = static_cast<uint64_t>(data.size()) * 8;
+    message += static_cast<char>(0x80);
+    while (message.size() % 64 != 56) message += '\0';
+    for (int i = 7; i >= 0; i--) message += static_cast<char>((bitLength >> (i * 8)) & 0xff);
+
+    for (size_t offset = 0; offset < message.size(); offset += 64) {
+        const auto* block = reinterpret_cast<const uint8_t*>(message.data() + offset);
+        uint32_t w[80];
+        for (int i = 0; i < 16; i++) {
+            w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+                   (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+        }
+        for (int i = 16; i < 80; i++) w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; i++) {
+            uint32_t f, k;
+            if (i < 20) { f = (b & c) | (~b & d); k = 0x5A827999; }
+            else if (i < 40) { f = b ^ c ^ d; k = 0x6ED9EBA1; }
+            else if (i < 60) { f = (b & c) | (b & d) | (c & d); k = 0x8F1BBCDC; }
+            else { f = b ^ c ^ d; k = 0xCA62C1D6; }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d; d = c; c = rotl(b, 30); b = a; a = temp;
+        }
+        h[0] += a; h[1] += b; h[2] += c; h[3] += d; h[4] += e;
+    }
+
+    std::string digest(20, '\0');
+    for (int i = 0; i < 5; i++) {
+        for (int j = 0; j < 4; j++) digest[i * 4 + j] = static_cast<char>((h[i] >> (24 - j * 8)) & 0xff);
+    }
+    return digest;
+}
+
+std::string base64(const std::string& data) {
+    static const char* kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    out.reserve((data.size() + 2) / 3 * 4);
+    size_t i = 0;
+    for (; i + 2 < data.size(); i += 3) {
+        uint32_t n = (uint8_t(data[i]) << 16) | (uint8_t(data[i + 1]) << 8) | uint8_t(data[i + 2]);
+        out += kAlphabet[(n >> 18) & 63];
+        out += kAlphabet[(n >> 12) & 63];
+        out += kAlphabet[(n >> 6) & 63];
+        out += kAlphabet[n & 63];
+    }
+    if (i < data.size()) {
+        uint32_t n = uint8_t(data[i]) << 16;
+        if (i + 1 < data.size()) n |= uint8_t(data[i + 1]) << 8;
+        out += kAlphabet[(n >> 18) & 63];
+        out += kAlphabet[(n >> 12) & 63];
+        out += i + 1 < data.size() ? kAlphabet[(n >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+bool isControl(WebSocket::Opcode opcode) {
+    return static_cast<uint8_t>(opcode) & 0x8;
+}
+
+} // namespace
+
+bool WebSocket::isUpgrade(const HttpRequest& req) {
+    return req.method == "GET" &&
+           strcasecmp(req.header("Upgrade").c_str(), "websocket") == 0 &&
+           strcasestr(req.header("Connection").c_str(), "upgrade") != nullptr &&
+           req.header("Sec-WebSocket-Version") == "13" &&
+           !req.header("Sec-WebSocket-Key").empty();
+}
+
+std::string WebSocket::acceptKey(const std::string& key) {
+    return base64(sha1(key + kHandshakeGuid));
+}
+
+std::string WebSocket::encode(Opcode opcode, const std::string& payload) {
+    std::string frame;
+    frame.reserve(payload.size() + 10);
+    frame += static_cast<char>(0x80 | static_cast<uint8_t>(opcode));
+    size_t size = payload.size();
+    if (size < 126) {
+        frame += static_cast<char>(size);
+    } else if (size <= 0xffff) {
+        frame += static_cast<char>(126);
+        frame += static_cast<char>((size >> 8) & 0xff);
+        frame += static_cast<char>(size & 0xff);
+    } else {
+        frame += static_cast<char>(127);
+        for (int i = 7; i >= 0; i--) frame += static_cast<char>((static_cast<uint64_t>(size) >> (i * 8)) & 0xff);
+    }
+    frame += payload;
+    return frame;
+}
+
+std::string WebSocket::encodeClose(uint16_t code) {
+    std::string payload;
+    payload += static_cast<char>((code >> 8) & 0xff);
+    payload += static_cast<char>(code & 0xff);
+    return encode(Opcode::Close, payload);
+}
+
+WebSocket::ParseResult WebSocket::parse(const std::string& data, size_t& pos, Frame& frame, uint16_t& closeCode) {
+    size_t available = data.size() - pos;
+    if (available < 2) return ParseResult::Incomplete;
+    const auto* p = reinterpret_cast<const uint8_t*>(data.data() + pos);
+
+    frame.fin = p[0] & 0x80;
+    frame.opcode = static_cast<Opcode>(p[0] & 0x0f);
+    bool masked = p[1] & 0x80;
+    uint64_t length = p[1] & 0x7f;
+    size_t header = 2;
+    uint8_t op = p[0] & 0x0f;
+    // 未协商扩展时 RSV 位必须为 0；客户端帧必须加掩码
+    if ((p[0] & 0x70) || !masked || (op > 0x2 && op < 0x8) || op > 0xA) {
+        closeCode = kProtocolError;
+        return ParseResult::Error;
+    }
+    if (length == 126) {
+        if (available < 4) return ParseResult::Incomplete;
+        length = (uint64_t(p[2]) << 8) | p[3];
+        header = 4;
+    } else if (length == 127) {
+        if (available < 10) return ParseResult::Incomplete;
+        length = 0;
+        for (int i = 0; i < 8; i++) length = (length << 8) | p[2 + i];
+        header = 10;
+    }
+    // 控制帧不能分片，负载不超过 125 字节
+    if (isControl(frame.opcode) && (!frame.fin || length > 125)) {
+        closeCode = kProtocolError;
+        return ParseResult::Error;
+    }
+    if (length > kMaxMessageSize) {
+        closeCode = kMessageTooBig;
+        return ParseResult::Error;
+    }
+    if (available < header + 4 + length) return ParseResult::Incomplete;
+
+    const uint8_t* mask = p + header;
+    const uint8_t* payload = mask + 4;
+    frame.payload.resize(length);
+    for (size_t i = 0; i < length; i++) frame.payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+    pos += header + 4 + length;
+    return ParseResult::Ok;
+}